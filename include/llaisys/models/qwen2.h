@@ -58,5 +58,150 @@ __C {
                                                   size_t max_steps,
                                                   int64_t *out_tokens,
                                                   size_t out_ntoken);
+
+    // Asynchronous requests: generation runs on the model's background engine threads.
+    typedef enum {
+        LLAISYS_QWEN2_REQUEST_PENDING = 0,
+        LLAISYS_QWEN2_REQUEST_RUNNING = 1,
+        LLAISYS_QWEN2_REQUEST_FINISHED = 2,
+        LLAISYS_QWEN2_REQUEST_CANCELLED = 3,
+        LLAISYS_QWEN2_REQUEST_FAILED = 4,
+    } llaisysQwen2RequestStatus_t;
+
+    // Called on an engine thread for every generated token; finished != 0 marks the last call.
+    // A cancelled or failed request gets a final call with token = -1.
+    // Return nonzero to cancel the request.
+    typedef int (*llaisysQwen2TokenCallback)(int64_t request_id, int64_t token, int finished, void *user_data);
+
+    // Generates until eos, max_new_tokens or the context limit. callback can be nullptr.
+    // return: request id (>0), <0 error.
+    __export int64_t llaisysQwen2ModelSubmit(struct LlaisysQwen2Model * model,
+                                             int64_t *token_ids,
+                                             size_t ntoken,
+                                             size_t max_new_tokens,
+                                             llaisysQwen2TokenCallback callback,
+                                             void *user_data);
+
+    struct LlaisysQwen2GenerationConfig {
+        size_t max_new_tokens;
+        size_t max_length;       // prompt + generated limit, 0: context length only
+        int64_t *eos_token_ids;  // any of them ends generation; nullptr/0: meta end_token
+        size_t n_eos_token_ids;
+        int64_t *stop_tokens;    // stop sequences, concatenated
+        size_t *stop_lengths;    // length of each stop sequence
+        size_t n_stop_sequences;
+        int logprobs;            // nonzero: report the log-probability of every generated token
+        size_t top_logprobs;     // also report the top_logprobs most likely tokens of every step, 0: none
+    };
+
+    // Like llaisysQwen2ModelSubmit; stop conditions are checked after every step
+    // and the matched eos / stop sequence is kept in the output.
+    __export int64_t llaisysQwen2ModelSubmitWithConfig(struct LlaisysQwen2Model * model,
+                                                       int64_t *token_ids,
+                                                       size_t ntoken,
+                                                       const struct LlaisysQwen2GenerationConfig *config,
+                                                       llaisysQwen2TokenCallback callback,
+                                                       void *user_data);
+
+    // Takes up to out_ntoken tokens not yet polled. status (can be nullptr) receives the request status.
+    // return: <0 error, >=0 number of tokens taken.
+    __export int64_t llaisysQwen2ModelPoll(struct LlaisysQwen2Model * model,
+                                           int64_t request_id,
+                                           int64_t *out_tokens,
+                                           size_t out_ntoken,
+                                           llaisysQwen2RequestStatus_t *status);
+
+    // Like llaisysQwen2ModelPoll, and also takes the log-probabilities of a request submitted with
+    // logprobs or top_logprobs set. Only these few values are copied back from the device, never the logits.
+    // out_logprobs: out_ntoken entries, log-probability of each token taken (can be nullptr).
+    // out_top_tokens / out_top_logprobs: out_ntoken * out_ntop entries, the most likely tokens of each step
+    // and their log-probabilities, most likely first (can be nullptr). At most out_ntop alternatives are
+    // taken per step; slots beyond the request's top_logprobs are filled with token -1 and logprob -inf.
+    // return: <0 error, >=0 number of tokens taken.
+    __export int64_t llaisysQwen2ModelPollLogprobs(struct LlaisysQwen2Model * model,
+                                                   int64_t request_id,
+                                                   int64_t *out_tokens,
+                                                   float *out_logprobs,
+                                                   int64_t *out_top_tokens,
+                                                   float *out_top_logprobs,
+                                                   size_t out_ntop,
+                                                   size_t out_ntoken,
+                                                   llaisysQwen2RequestStatus_t *status);
+
+    // Blocks until there are unpolled tokens or the request has ended. timeout_ms < 0 waits forever.
+    // return: <0 error, otherwise llaisysQwen2RequestStatus_t.
+    __export int llaisysQwen2ModelWait(struct LlaisysQwen2Model * model, int64_t request_id, int64_t timeout_ms);
+
+    // Frees the request's KV cache right away, or after the step in flight.
+    // return: 1 cancelled, 0 already ended, <0 error.
+    __export int llaisysQwen2ModelCancel(struct LlaisysQwen2Model * model, int64_t request_id);
+
+    // Scoring: log p(token_ids[i + 1] | token_ids[0..i]) for every i, computed by chunked prefill without
+    // generating and without materializing the logits, so memory does not grow with the document beyond the KV cache.
+    // Scoring requests share the engine with generation and advance one chunk per turn.
+    // ntoken must be >= 2. return: request id (>0), <0 error. Wait for it with llaisysQwen2ModelWait.
+    __export int64_t llaisysQwen2ModelSubmitScore(struct LlaisysQwen2Model * model, int64_t *token_ids, size_t ntoken);
+
+    // Copies the log-probabilities computed so far (up to out_n) of a scoring request.
+    // return: <0 error, >=0 number computed so far (ntoken - 1 once finished).
+    __export int64_t llaisysQwen2ModelScores(struct LlaisysQwen2Model * model,
+                                             int64_t request_id,
+                                             float *out_logprobs,
+                                             size_t out_n);
+
+    // Blocking scoring of one sequence; out_logprobs receives ntoken - 1 values.
+    // return: <0 error, otherwise ntoken - 1.
+    __export int64_t llaisysQwen2ModelScore(struct LlaisysQwen2Model * model,
+                                            int64_t *token_ids,
+                                            size_t ntoken,
+                                            float *out_logprobs);
+
+    typedef enum {
+        LLAISYS_QWEN2_POOLING_LAST = 0, // hidden state of the last token
+        LLAISYS_QWEN2_POOLING_MEAN = 1, // mean over all tokens
+    } llaisysQwen2Pooling_t;
+
+    // Text embeddings: runs the decoder stack over nseq sequences packed into one batch (attention never crosses
+    // sequences) and pools the final-normed hidden states. No KV cache is allocated and lm_head is skipped.
+    // token_ids: the sequences concatenated; lengths: nseq lengths, each > 0.
+    // out_embeddings: caller-allocated, nseq * hs floats, one row per sequence.
+    // return: 0 on success, <0 error.
+    __export int llaisysQwen2ModelEmbed(struct LlaisysQwen2Model * model,
+                                       int64_t *token_ids,
+                                       size_t *lengths,
+                                       size_t nseq,
+                                       llaisysQwen2Pooling_t pooling,
+                                       float *out_embeddings);
+
+    // Drops the request record; an unfinished request is cancelled first.
+    __export void llaisysQwen2ModelRelease(struct LlaisysQwen2Model * model, int64_t request_id);
+
+    // Multi-turn sessions: the KV cache is kept between turns, so a turn only prefills the tokens added since the
+    // previous one instead of the whole history. Sessions live on the model's engine and are freed with the model.
+    // return: session id (>0), <0 error.
+    __export int64_t llaisysQwen2SessionCreate(struct LlaisysQwen2Model * model);
+
+    // Appends token_ids (the new turn, can be empty) to the session and generates like
+    // llaisysQwen2ModelSubmitWithConfig; poll, wait on and cancel the returned request as usual.
+    // Generated tokens stay in the session. max_length and stop conditions apply to the whole session.
+    // Only one turn per session at a time; a session whose turn failed cannot be used again.
+    // return: request id (>0), <0 error.
+    __export int64_t llaisysQwen2SessionSubmit(struct LlaisysQwen2Model * model,
+                                               int64_t session_id,
+                                               int64_t *token_ids,
+                                               size_t ntoken,
+                                               const struct LlaisysQwen2GenerationConfig *config,
+                                               llaisysQwen2TokenCallback callback,
+                                               void *user_data);
+
+    // Copies up to out_ntoken tokens of the whole session (all turns and everything generated).
+    // return: <0 error, otherwise the session length.
+    __export int64_t llaisysQwen2SessionTokens(struct LlaisysQwen2Model * model,
+                                               int64_t session_id,
+                                               int64_t *out_tokens,
+                                               size_t out_ntoken);
+
+    // Frees the session's KV cache; a turn in progress is cancelled first.
+    __export void llaisysQwen2SessionDestroy(struct LlaisysQwen2Model * model, int64_t session_id);
 }
 #endif // LLAISYS_MODELS_QWEN2_H
@@ -5,13 +5,58 @@
 
 __C {
     __export void llaisysAdd(llaisysTensor_t c, llaisysTensor_t a, llaisysTensor_t b);
+    // vals: [n] with max_idx/max_val: [1], or [rows, n] with max_idx/max_val: [rows]. First maximum wins; NaN is ignored.
     __export void llaisysArgmax(llaisysTensor_t max_idx, llaisysTensor_t max_val, llaisysTensor_t vals);
+    // c[i] = alpha * op(a[i]) * op(b[i / (B / Bb)]) + beta * c[i]; a: [B, M, K] ([B, K, M] if trans_a),
+    // b: [Bb, K, N] ([Bb, N, K] if trans_b), c: [B, M, N]. B must be a multiple of Bb; c is not read when beta == 0.
+    __export void llaisysBmm(llaisysTensor_t c, llaisysTensor_t a, llaisysTensor_t b, int trans_a, int trans_b, float alpha, float beta);
     __export void llaisysEmbedding(llaisysTensor_t out, llaisysTensor_t index, llaisysTensor_t weight);
     __export void llaisysLinear(llaisysTensor_t out, llaisysTensor_t in, llaisysTensor_t weight, llaisysTensor_t bias);
+    // Output-head linear fused with top-k: logits = in · weightᵀ (in: [m, K], weight: [n, K], rounded to in's dtype)
+    // are never materialized. out_idx (i64) and out_val (in's dtype) are [m, k] in llaisysTopk order.
+    // lse may be NULL; otherwise it is [m] (f32) and receives log Σ exp(logits) of each row.
+    __export void llaisysLinearTopk(llaisysTensor_t out_idx, llaisysTensor_t out_val, llaisysTensor_t lse, llaisysTensor_t in, llaisysTensor_t weight);
+    // Scoring head: out[i] = logits[i, target[i]] - log Σ exp(logits[i]), logits computed and rounded as in llaisysLinearTopk.
+    // out: [m] (f32), target: [m] (i64).
+    __export void llaisysLinearLogprob(llaisysTensor_t out, llaisysTensor_t in, llaisysTensor_t weight, llaisysTensor_t target);
+    // Writes k/v: [seq, nkvh, d] into the paged cache paged_kv: [num_pages, 2, nkvh, page_size, d];
+    // token i goes to row slot % page_size of page slot / page_size, slot = slot_mapping[i] (i64).
+    __export void llaisysPagedKVScatter(llaisysTensor_t paged_kv, llaisysTensor_t k, llaisysTensor_t v, llaisysTensor_t slot_mapping);
+    // Inverse of llaisysPagedKVScatter: reads the rows named by slot_mapping back into k/v: [seq, nkvh, d].
+    __export void llaisysPagedKVGather(llaisysTensor_t k, llaisysTensor_t v, llaisysTensor_t paged_kv, llaisysTensor_t slot_mapping);
     __export void llaisysRearrange(llaisysTensor_t out, llaisysTensor_t in);
     __export void llaisysRmsNorm(llaisysTensor_t out, llaisysTensor_t in, llaisysTensor_t weight, float eps);
     __export void llaisysROPE(llaisysTensor_t out, llaisysTensor_t in, llaisysTensor_t pos_ids, float theta);
+    // Fills the rope tables cos/sin: [max_pos, d/2] (f32) with cos/sin(p * theta^(-2k/d)).
+    __export void llaisysROPEInitTable(llaisysTensor_t cos, llaisysTensor_t sin, float theta);
+    // Table-driven rope; every pos_ids entry must be smaller than max_pos.
+    __export void llaisysROPETable(llaisysTensor_t out, llaisysTensor_t in, llaisysTensor_t pos_ids, llaisysTensor_t cos, llaisysTensor_t sin);
+    // Rotates q: [seq, nh, d] and k: [seq, nkvh, d] with the same pos_ids in one call.
+    __export void llaisysROPEQK(llaisysTensor_t q_out, llaisysTensor_t k_out, llaisysTensor_t q, llaisysTensor_t k,
+                                llaisysTensor_t pos_ids, llaisysTensor_t cos, llaisysTensor_t sin);
+    // Rotates k: [seq, nkvh, d] with the rope table and writes it, together with v, straight into the KV cache.
+    // k_cache/v_cache are contiguous [seq, nkvh, d] views of the destination cache rows.
+    __export void llaisysROPEAppendKV(llaisysTensor_t k_cache, llaisysTensor_t v_cache, llaisysTensor_t k, llaisysTensor_t v,
+                                      llaisysTensor_t pos_ids, llaisysTensor_t cos, llaisysTensor_t sin);
+    // Paged variant: paged_kv is [num_pages, 2, nkvh, page_size, d]; token i goes to row slot % page_size of
+    // page slot / page_size, slot = slot_mapping[i] (i64).
+    __export void llaisysROPEAppendKVPaged(llaisysTensor_t paged_kv, llaisysTensor_t k, llaisysTensor_t v, llaisysTensor_t pos_ids,
+                                           llaisysTensor_t cos, llaisysTensor_t sin, llaisysTensor_t slot_mapping);
     __export void llaisysSelfAttention(llaisysTensor_t attn_val, llaisysTensor_t q, llaisysTensor_t k, llaisysTensor_t v, float scale);
+    // Sliding-window causal attention: query i (aligned to the end of k/v) sees only the latest `window` keys, itself included.
+    // window == 0 is the same as llaisysSelfAttention.
+    __export void llaisysSelfAttentionWindowed(llaisysTensor_t attn_val, llaisysTensor_t q, llaisysTensor_t k, llaisysTensor_t v,
+                                               float scale, size_t window);
+    // k/v: [total_len, nkvh, d] in i8 or f8 (E4M3), dequantized as k * k_scale with k_scale/v_scale: [total_len, nkvh] (f32).
+    // window > 0 limits each query to the latest `window` keys (itself included); 0 attends over the whole causal prefix.
+    __export void llaisysSelfAttentionQuantized(llaisysTensor_t attn_val, llaisysTensor_t q, llaisysTensor_t k, llaisysTensor_t v,
+                                                llaisysTensor_t k_scale, llaisysTensor_t v_scale, float scale, size_t window);
+    // Symmetric per-(token, head) quantization of in: [seq, nkvh, d] into out (i8 or f8, same shape) and scale: [seq, nkvh] (f32).
+    // scale = amax / 127 (i8) or amax / 448 (f8), 1 for an all-zero row.
+    __export void llaisysQuantizeKV(llaisysTensor_t out, llaisysTensor_t scale, llaisysTensor_t in);
+    // The k largest entries of each row, sorted descending (ties: smaller index first). vals: [n] or [rows, n];
+    // out_idx (i64) and out_val: [k] or [rows, k], k is taken from their last dimension.
+    __export void llaisysTopk(llaisysTensor_t out_idx, llaisysTensor_t out_val, llaisysTensor_t vals);
     __export void llaisysSwiGLU(llaisysTensor_t out, llaisysTensor_t gate, llaisysTensor_t up);
 }
 
@@ -42,6 +42,13 @@ __C {
 
     // Llaisys API for switching device context
     __export void llaisysSetContextRuntime(llaisysDeviceType_t, int);
+
+    // Llaisys API for selecting the CPU kernel ISA ("scalar", "avx2", "avx512", "amx" or "auto").
+    // Returns 0 on success, -1 if the name is unknown or the CPU does not support it.
+    __export int llaisysSetCpuIsa(const char *isa);
+
+    // Llaisys API for querying the CPU kernel ISA in use; detected = 1 returns the best supported one.
+    __export const char *llaisysGetCpuIsa(int detected);
 }
 
 #endif // LLAISYS_RUNTIME_H
@@ -1,4 +1,4 @@
-from .runtime import RuntimeAPI
+from .runtime import RuntimeAPI, set_cpu_isa, get_cpu_isa
 from .libllaisys import DeviceType
 from .libllaisys import DataType
 from .libllaisys import MemcpyKind
@@ -11,6 +11,8 @@ from .models import *
 
 __all__ = [
     "RuntimeAPI",
+    "set_cpu_isa",
+    "get_cpu_isa",
     "DeviceType",
     "DataType",
     "MemcpyKind",
@@ -1,5 +1,5 @@
 from .tensor import llaisysTensor_t
-from ctypes import c_float
+from ctypes import c_float, c_int, c_size_t
 
 def load_ops(lib):
     lib.llaisysAdd.argtypes = [llaisysTensor_t, llaisysTensor_t, llaisysTensor_t]
@@ -8,12 +8,41 @@ def load_ops(lib):
     lib.llaisysArgmax.argtypes = [llaisysTensor_t, llaisysTensor_t, llaisysTensor_t]
     lib.llaisysArgmax.restype = None
 
+    lib.llaisysBmm.argtypes = [
+        llaisysTensor_t,  # c
+        llaisysTensor_t,  # a
+        llaisysTensor_t,  # b
+        c_int,  # trans_a
+        c_int,  # trans_b
+        c_float,  # alpha
+        c_float,  # beta
+    ]
+    lib.llaisysBmm.restype = None
+
     lib.llaisysEmbedding.argtypes = [llaisysTensor_t, llaisysTensor_t, llaisysTensor_t]
     lib.llaisysEmbedding.restype = None
 
     lib.llaisysLinear.argtypes = [llaisysTensor_t, llaisysTensor_t, llaisysTensor_t, llaisysTensor_t]
     lib.llaisysLinear.restype = None
 
+    lib.llaisysLinearTopk.argtypes = [
+        llaisysTensor_t,  # out_idx
+        llaisysTensor_t,  # out_val
+        llaisysTensor_t,  # lse, may be NULL
+        llaisysTensor_t,  # in
+        llaisysTensor_t,  # weight
+    ]
+    lib.llaisysLinearTopk.restype = None
+
+    lib.llaisysLinearLogprob.argtypes = [llaisysTensor_t, llaisysTensor_t, llaisysTensor_t, llaisysTensor_t]
+    lib.llaisysLinearLogprob.restype = None
+
+    lib.llaisysPagedKVScatter.argtypes = [llaisysTensor_t, llaisysTensor_t, llaisysTensor_t, llaisysTensor_t]
+    lib.llaisysPagedKVScatter.restype = None
+
+    lib.llaisysPagedKVGather.argtypes = [llaisysTensor_t, llaisysTensor_t, llaisysTensor_t, llaisysTensor_t]
+    lib.llaisysPagedKVGather.restype = None
+
     lib.llaisysRearrange.argtypes = [llaisysTensor_t, llaisysTensor_t]
     lib.llaisysRearrange.restype = None
 
@@ -23,6 +52,51 @@ def load_ops(lib):
     lib.llaisysROPE.argtypes = [llaisysTensor_t, llaisysTensor_t, llaisysTensor_t, c_float]
     lib.llaisysROPE.restype = None
 
+    lib.llaisysROPEInitTable.argtypes = [llaisysTensor_t, llaisysTensor_t, c_float]
+    lib.llaisysROPEInitTable.restype = None
+
+    lib.llaisysROPETable.argtypes = [
+        llaisysTensor_t,  # out
+        llaisysTensor_t,  # in
+        llaisysTensor_t,  # pos_ids
+        llaisysTensor_t,  # cos
+        llaisysTensor_t,  # sin
+    ]
+    lib.llaisysROPETable.restype = None
+
+    lib.llaisysROPEQK.argtypes = [
+        llaisysTensor_t,  # q_out
+        llaisysTensor_t,  # k_out
+        llaisysTensor_t,  # q
+        llaisysTensor_t,  # k
+        llaisysTensor_t,  # pos_ids
+        llaisysTensor_t,  # cos
+        llaisysTensor_t,  # sin
+    ]
+    lib.llaisysROPEQK.restype = None
+
+    lib.llaisysROPEAppendKV.argtypes = [
+        llaisysTensor_t,  # k_cache
+        llaisysTensor_t,  # v_cache
+        llaisysTensor_t,  # k
+        llaisysTensor_t,  # v
+        llaisysTensor_t,  # pos_ids
+        llaisysTensor_t,  # cos
+        llaisysTensor_t,  # sin
+    ]
+    lib.llaisysROPEAppendKV.restype = None
+
+    lib.llaisysROPEAppendKVPaged.argtypes = [
+        llaisysTensor_t,  # paged_kv
+        llaisysTensor_t,  # k
+        llaisysTensor_t,  # v
+        llaisysTensor_t,  # pos_ids
+        llaisysTensor_t,  # cos
+        llaisysTensor_t,  # sin
+        llaisysTensor_t,  # slot_mapping
+    ]
+    lib.llaisysROPEAppendKVPaged.restype = None
+
     lib.llaisysSelfAttention.argtypes = [
         llaisysTensor_t,  # attn_val
         llaisysTensor_t,  # q
@@ -32,5 +106,33 @@ def load_ops(lib):
     ]
     lib.llaisysSelfAttention.restype = None
 
+    lib.llaisysSelfAttentionWindowed.argtypes = [
+        llaisysTensor_t,  # attn_val
+        llaisysTensor_t,  # q
+        llaisysTensor_t,  # k
+        llaisysTensor_t,  # v
+        c_float,  # scale
+        c_size_t,  # window
+    ]
+    lib.llaisysSelfAttentionWindowed.restype = None
+
+    lib.llaisysSelfAttentionQuantized.argtypes = [
+        llaisysTensor_t,  # attn_val
+        llaisysTensor_t,  # q
+        llaisysTensor_t,  # k
+        llaisysTensor_t,  # v
+        llaisysTensor_t,  # k_scale
+        llaisysTensor_t,  # v_scale
+        c_float,  # scale
+        c_size_t,  # window
+    ]
+    lib.llaisysSelfAttentionQuantized.restype = None
+
+    lib.llaisysQuantizeKV.argtypes = [llaisysTensor_t, llaisysTensor_t, llaisysTensor_t]
+    lib.llaisysQuantizeKV.restype = None
+
     lib.llaisysSwiGLU.argtypes = [llaisysTensor_t, llaisysTensor_t, llaisysTensor_t]
     lib.llaisysSwiGLU.restype = None
+
+    lib.llaisysTopk.argtypes = [llaisysTensor_t, llaisysTensor_t, llaisysTensor_t]
+    lib.llaisysTopk.restype = None
@@ -7,6 +7,22 @@ from .weights_buffer import llaisysWeightBuffer_t
 
 llaisysQwen2Model_t = ctypes.c_void_p
 
+# llaisysQwen2RequestStatus_t
+llaisysQwen2RequestStatus_t = ctypes.c_int
+QWEN2_REQUEST_PENDING = 0
+QWEN2_REQUEST_RUNNING = 1
+QWEN2_REQUEST_FINISHED = 2
+QWEN2_REQUEST_CANCELLED = 3
+QWEN2_REQUEST_FAILED = 4
+
+# llaisysQwen2Pooling_t
+llaisysQwen2Pooling_t = ctypes.c_int
+QWEN2_POOLING_LAST = 0
+QWEN2_POOLING_MEAN = 1
+
+# int (*)(int64_t request_id, int64_t token, int finished, void *user_data)
+llaisysQwen2TokenCallback = ctypes.CFUNCTYPE(c_int, c_int64, c_int64, c_int, ctypes.c_void_p)
+
 
 class LlaisysQwen2Meta(ctypes.Structure):
     _fields_ = [
@@ -33,6 +49,20 @@ class LlaisysQwen2Meta(ctypes.Structure):
     ]
 
 
+class LlaisysQwen2GenerationConfig(ctypes.Structure):
+    _fields_ = [
+        ("max_new_tokens", c_size_t),
+        ("max_length", c_size_t),
+        ("eos_token_ids", POINTER(c_int64)),
+        ("n_eos_token_ids", c_size_t),
+        ("stop_tokens", POINTER(c_int64)),
+        ("stop_lengths", POINTER(c_size_t)),
+        ("n_stop_sequences", c_size_t),
+        ("logprobs", c_int),
+        ("top_logprobs", c_size_t),
+    ]
+
+
 def load_qwen2(lib):
     lib.llaisysQwen2ModelCreate.argtypes = [
         POINTER(LlaisysQwen2Meta),
@@ -68,4 +98,92 @@ def load_qwen2(lib):
     ]
     lib.llaisysQwen2ModelInferDialog.restype = c_int64
 
+    lib.llaisysQwen2ModelSubmit.argtypes = [
+        llaisysQwen2Model_t,
+        POINTER(c_int64),
+        c_size_t,
+        c_size_t,
+        llaisysQwen2TokenCallback,
+        ctypes.c_void_p,
+    ]
+    lib.llaisysQwen2ModelSubmit.restype = c_int64
+
+    lib.llaisysQwen2ModelSubmitWithConfig.argtypes = [
+        llaisysQwen2Model_t,
+        POINTER(c_int64),
+        c_size_t,
+        POINTER(LlaisysQwen2GenerationConfig),
+        llaisysQwen2TokenCallback,
+        ctypes.c_void_p,
+    ]
+    lib.llaisysQwen2ModelSubmitWithConfig.restype = c_int64
+
+    lib.llaisysQwen2ModelPoll.argtypes = [
+        llaisysQwen2Model_t,
+        c_int64,
+        POINTER(c_int64),
+        c_size_t,
+        POINTER(llaisysQwen2RequestStatus_t),
+    ]
+    lib.llaisysQwen2ModelPoll.restype = c_int64
+
+    lib.llaisysQwen2ModelPollLogprobs.argtypes = [
+        llaisysQwen2Model_t,
+        c_int64,
+        POINTER(c_int64),
+        POINTER(c_float),
+        POINTER(c_int64),
+        POINTER(c_float),
+        c_size_t,
+        c_size_t,
+        POINTER(llaisysQwen2RequestStatus_t),
+    ]
+    lib.llaisysQwen2ModelPollLogprobs.restype = c_int64
+
+    lib.llaisysQwen2ModelWait.argtypes = [llaisysQwen2Model_t, c_int64, c_int64]
+    lib.llaisysQwen2ModelWait.restype = c_int
+
+    lib.llaisysQwen2ModelCancel.argtypes = [llaisysQwen2Model_t, c_int64]
+    lib.llaisysQwen2ModelCancel.restype = c_int
+
+    lib.llaisysQwen2ModelSubmitScore.argtypes = [llaisysQwen2Model_t, POINTER(c_int64), c_size_t]
+    lib.llaisysQwen2ModelSubmitScore.restype = c_int64
+
+    lib.llaisysQwen2ModelScores.argtypes = [llaisysQwen2Model_t, c_int64, POINTER(c_float), c_size_t]
+    lib.llaisysQwen2ModelScores.restype = c_int64
+
+    lib.llaisysQwen2ModelScore.argtypes = [llaisysQwen2Model_t, POINTER(c_int64), c_size_t, POINTER(c_float)]
+    lib.llaisysQwen2ModelScore.restype = c_int64
+
+    lib.llaisysQwen2ModelEmbed.argtypes = [
+        llaisysQwen2Model_t,
+        POINTER(c_int64),
+        POINTER(c_size_t),
+        c_size_t,
+        llaisysQwen2Pooling_t,
+        POINTER(c_float),
+    ]
+    lib.llaisysQwen2ModelEmbed.restype = c_int
+
+    lib.llaisysQwen2ModelRelease.argtypes = [llaisysQwen2Model_t, c_int64]
+    lib.llaisysQwen2ModelRelease.restype = None
+
+    lib.llaisysQwen2SessionCreate.argtypes = [llaisysQwen2Model_t]
+    lib.llaisysQwen2SessionCreate.restype = c_int64
+
+    lib.llaisysQwen2SessionSubmit.argtypes = [
+        llaisysQwen2Model_t,
+        c_int64,
+        POINTER(c_int64),
+        c_size_t,
+        POINTER(LlaisysQwen2GenerationConfig),
+        llaisysQwen2TokenCallback,
+        ctypes.c_void_p,
+    ]
+    lib.llaisysQwen2SessionSubmit.restype = c_int64
+
+    lib.llaisysQwen2SessionTokens.argtypes = [llaisysQwen2Model_t, c_int64, POINTER(c_int64), c_size_t]
+    lib.llaisysQwen2SessionTokens.restype = c_int64
 
+    lib.llaisysQwen2SessionDestroy.argtypes = [llaisysQwen2Model_t, c_int64]
+    lib.llaisysQwen2SessionDestroy.restype = None
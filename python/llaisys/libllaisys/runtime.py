@@ -1,5 +1,5 @@
 import ctypes
-from ctypes import c_void_p, c_size_t, c_int, Structure, CFUNCTYPE
+from ctypes import c_void_p, c_size_t, c_int, c_char_p, Structure, CFUNCTYPE
 from .llaisys_types import *
 
 # Define function pointer types
@@ -46,3 +46,9 @@ def load_runtime(lib):
 
     lib.llaisysSetContextRuntime.argtypes = [llaisysDeviceType_t, c_int]
     lib.llaisysSetContextRuntime.restype = None
+
+    lib.llaisysSetCpuIsa.argtypes = [c_char_p]
+    lib.llaisysSetCpuIsa.restype = c_int
+
+    lib.llaisysGetCpuIsa.argtypes = [c_int]
+    lib.llaisysGetCpuIsa.restype = c_char_p
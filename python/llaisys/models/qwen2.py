@@ -2,7 +2,17 @@ import json
 from typing import Sequence, Optional, Dict, Any, List
 from ..libllaisys import LIB_LLAISYS
 from ..libllaisys import DeviceType, DataType
-from ..libllaisys.qwen2 import LlaisysQwen2Meta
+from ..libllaisys.qwen2 import (
+    LlaisysQwen2Meta,
+    LlaisysQwen2GenerationConfig,
+    llaisysQwen2TokenCallback,
+    llaisysQwen2RequestStatus_t,
+    QWEN2_REQUEST_FINISHED,
+    QWEN2_REQUEST_CANCELLED,
+    QWEN2_REQUEST_FAILED,
+    QWEN2_POOLING_LAST,
+    QWEN2_POOLING_MEAN,
+)
 from ..tensor import Tensor
 from ..weights_buffer import WeightBuffer
 from pathlib import Path
@@ -20,6 +30,9 @@ class Qwen2:
         self._device_ids = device_ids or []
         self._weight_buffer = WeightBuffer()
         self._model = None
+        # 异步请求的 ctypes 回调须保持引用，直到请求被 release
+        self._callbacks = {}
+        self._eos_token_ids = self._load_eos_token_ids(model_path)
         self._meta = self._load_meta(model_path)
         files = sorted(model_path.glob("*.safetensors"))
         print(f"safetensors files: {len(files)}", flush=True)
@@ -38,6 +51,7 @@ class Qwen2:
 
     def __del__(self):
         if hasattr(self, "_model") and self._model:
+            # 销毁时未结束的请求被取消且不再回调
             LIB_LLAISYS.llaisysQwen2ModelDestroy(self._model)
             self._model = None
 
@@ -48,6 +62,9 @@ class Qwen2:
         top_k: int = 1,
         top_p: float = 0.8,
         temperature: float = 0.8,
+        stop_sequences: Sequence[Sequence[int]] = None,
+        eos_token_ids: Sequence[int] = None,
+        max_length: int = None,
     ):
         if self._model is None:
             raise RuntimeError("Model is not initialized")
@@ -57,7 +74,257 @@ class Qwen2:
             raise ValueError("inputs must be a non-empty sequence of token ids")
 
         tokens = list(int(t) for t in inputs)
-        return self._infer_dialog(tokens, max_new_tokens)
+        if not stop_sequences and eos_token_ids is None and max_length is None and not self._eos_token_ids:
+            return self._infer_dialog(tokens, max_new_tokens)
+        # 停止条件在 C++ 侧每步检查，不必多生成再截断
+        generated = list(
+            self.stream(
+                tokens,
+                max_new_tokens,
+                stop_sequences=stop_sequences,
+                eos_token_ids=eos_token_ids,
+                max_length=max_length,
+            )
+        )
+        return tokens + generated
+
+    def submit(
+        self,
+        inputs: Sequence[int],
+        max_new_tokens: int = 1,
+        on_token=None,
+        stop_sequences: Sequence[Sequence[int]] = None,
+        eos_token_ids: Sequence[int] = None,
+        max_length: int = None,
+        logprobs: bool = False,
+        top_logprobs: int = 0,
+    ) -> int:
+        """
+        Queue a generation request on the background engine and return its id immediately.
+        on_token(request_id, token, finished) runs on an engine thread for every generated token
+        (token == -1 when the request ends without one); returning True cancels the request.
+        Generation stops at any of eos_token_ids (default: generation_config.json, then the
+        model's end token), at any of stop_sequences, or at max_length total tokens.
+        With logprobs or top_logprobs set, every token also carries its log-probability and the
+        top_logprobs most likely alternatives; read them with poll_logprobs.
+        """
+        if self._model is None:
+            raise RuntimeError("Model is not initialized")
+        tokens = list(int(t) for t in inputs)
+        in_buf = (ctypes.c_int64 * max(1, len(tokens)))(*tokens)
+        callback = self._make_callback(on_token)
+        config, _bufs = self._make_config(
+            max_new_tokens, stop_sequences, eos_token_ids, max_length, logprobs, top_logprobs
+        )
+        request_id = int(
+            LIB_LLAISYS.llaisysQwen2ModelSubmitWithConfig(
+                self._model, in_buf, len(tokens), ctypes.byref(config), callback, None
+            )
+        )
+        if request_id < 0:
+            raise RuntimeError("llaisysQwen2ModelSubmitWithConfig failed")
+        self._callbacks[request_id] = callback
+        return request_id
+
+    @staticmethod
+    def _make_callback(on_token):
+        if on_token is None:
+            return llaisysQwen2TokenCallback()
+
+        def _trampoline(request_id, token, finished, _user_data):
+            return 1 if on_token(int(request_id), int(token), bool(finished)) else 0
+
+        return llaisysQwen2TokenCallback(_trampoline)
+
+    def _make_config(self, max_new_tokens, stop_sequences, eos_token_ids, max_length, logprobs, top_logprobs):
+        # 返回的缓冲须在提交调用结束前保持引用
+        if eos_token_ids is None:
+            eos_token_ids = self._eos_token_ids
+        eos = [int(t) for t in eos_token_ids or []]
+        stops = [[int(t) for t in seq] for seq in stop_sequences or [] if len(seq) > 0]
+        stop_tokens = [t for seq in stops for t in seq]
+        eos_buf = (ctypes.c_int64 * max(1, len(eos)))(*eos)
+        stop_buf = (ctypes.c_int64 * max(1, len(stop_tokens)))(*stop_tokens)
+        stop_len_buf = (ctypes.c_size_t * max(1, len(stops)))(*[len(seq) for seq in stops])
+        config = LlaisysQwen2GenerationConfig(
+            max_new_tokens=max_new_tokens,
+            max_length=max_length or 0,
+            eos_token_ids=eos_buf,
+            n_eos_token_ids=len(eos),
+            stop_tokens=stop_buf,
+            stop_lengths=stop_len_buf,
+            n_stop_sequences=len(stops),
+            logprobs=int(bool(logprobs)),
+            top_logprobs=top_logprobs,
+        )
+        return config, (eos_buf, stop_buf, stop_len_buf)
+
+    def poll(self, request_id: int, max_tokens: int = 64):
+        """Return (new tokens, finished) without blocking; finished is True once the request has ended."""
+        out_buf = (ctypes.c_int64 * max_tokens)()
+        status = llaisysQwen2RequestStatus_t()
+        n = int(LIB_LLAISYS.llaisysQwen2ModelPoll(self._model, request_id, out_buf, max_tokens, ctypes.byref(status)))
+        if n < 0:
+            raise RuntimeError("llaisysQwen2ModelPoll failed")
+        if status.value == QWEN2_REQUEST_FAILED:
+            raise RuntimeError(f"request {request_id} failed")
+        ended = status.value in (QWEN2_REQUEST_FINISHED, QWEN2_REQUEST_CANCELLED)
+        return [int(out_buf[i]) for i in range(n)], ended
+
+    def poll_logprobs(self, request_id: int, top_logprobs: int = 0, max_tokens: int = 64):
+        """
+        Like poll for a request submitted with logprobs / top_logprobs; returns
+        ([(token, logprob, [(alt_token, alt_logprob), ...]), ...], finished).
+        At most top_logprobs alternatives are returned per token, however many the request asked for.
+        """
+        out_buf = (ctypes.c_int64 * max_tokens)()
+        lp_buf = (ctypes.c_float * max_tokens)()
+        top_tokens = (ctypes.c_int64 * max(1, max_tokens * top_logprobs))()
+        top_lps = (ctypes.c_float * max(1, max_tokens * top_logprobs))()
+        status = llaisysQwen2RequestStatus_t()
+        n = int(
+            LIB_LLAISYS.llaisysQwen2ModelPollLogprobs(
+                self._model,
+                request_id,
+                out_buf,
+                lp_buf,
+                top_tokens if top_logprobs > 0 else None,
+                top_lps if top_logprobs > 0 else None,
+                top_logprobs,
+                max_tokens,
+                ctypes.byref(status),
+            )
+        )
+        if n < 0:
+            raise RuntimeError("llaisysQwen2ModelPollLogprobs failed")
+        if status.value == QWEN2_REQUEST_FAILED:
+            raise RuntimeError(f"request {request_id} failed")
+        ended = status.value in (QWEN2_REQUEST_FINISHED, QWEN2_REQUEST_CANCELLED)
+        steps = []
+        for i in range(n):
+            alts = [
+                (int(top_tokens[i * top_logprobs + j]), float(top_lps[i * top_logprobs + j]))
+                for j in range(top_logprobs)
+                if top_tokens[i * top_logprobs + j] >= 0
+            ]
+            steps.append((int(out_buf[i]), float(lp_buf[i]), alts))
+        return steps, ended
+
+    def wait(self, request_id: int, timeout: float = None) -> int:
+        """Block (without holding the GIL) until new tokens arrive or the request ends; returns the status."""
+        timeout_ms = -1 if timeout is None else int(timeout * 1000)
+        status = int(LIB_LLAISYS.llaisysQwen2ModelWait(self._model, request_id, timeout_ms))
+        if status < 0:
+            raise RuntimeError("llaisysQwen2ModelWait failed")
+        return status
+
+    def cancel(self, request_id: int) -> bool:
+        """Cancel a request and free its KV cache; False if it had already ended."""
+        ret = int(LIB_LLAISYS.llaisysQwen2ModelCancel(self._model, request_id))
+        if ret < 0:
+            raise RuntimeError("llaisysQwen2ModelCancel failed")
+        return ret == 1
+
+    def release(self, request_id: int):
+        LIB_LLAISYS.llaisysQwen2ModelRelease(self._model, request_id)
+        self._callbacks.pop(request_id, None)
+
+    def stream(self, inputs: Sequence[int], max_new_tokens: int = 1, **stop_kwargs):
+        """
+        Yield generated tokens as soon as each one is produced; stop_kwargs as in submit.
+        With logprobs or top_logprobs set, yields (token, logprob, alternatives) as poll_logprobs does.
+        """
+        request_id = self.submit(inputs, max_new_tokens, **stop_kwargs)
+        yield from self._drain(request_id, stop_kwargs)
+
+    def _drain(self, request_id: int, stop_kwargs):
+        top_logprobs = int(stop_kwargs.get("top_logprobs", 0))
+        with_logprobs = bool(stop_kwargs.get("logprobs", False)) or top_logprobs > 0
+        try:
+            while True:
+                if with_logprobs:
+                    tokens, ended = self.poll_logprobs(request_id, top_logprobs)
+                else:
+                    tokens, ended = self.poll(request_id)
+                yield from tokens
+                if ended and not tokens:
+                    return
+                if not tokens:
+                    self.wait(request_id)
+        finally:
+            self.release(request_id)
+
+    def session(self) -> "Qwen2Session":
+        """
+        Open a multi-turn session whose KV cache is kept between turns, so each turn only
+        prefills the tokens added since the previous one.
+        """
+        if self._model is None:
+            raise RuntimeError("Model is not initialized")
+        session_id = int(LIB_LLAISYS.llaisysQwen2SessionCreate(self._model))
+        if session_id < 0:
+            raise RuntimeError("llaisysQwen2SessionCreate failed")
+        return Qwen2Session(self, session_id)
+
+    def score(self, inputs: Sequence[int]) -> List[float]:
+        """
+        Log-probability of every token given the ones before it (len(inputs) - 1 values),
+        computed by chunked prefill without generating or materializing the logits.
+        """
+        return self.score_batch([inputs])[0]
+
+    def score_batch(self, batch: Sequence[Sequence[int]]) -> List[List[float]]:
+        """Score several sequences at once; they are interleaved chunk by chunk on the engine."""
+        if self._model is None:
+            raise RuntimeError("Model is not initialized")
+        request_ids = []
+        try:
+            for inputs in batch:
+                tokens = list(int(t) for t in inputs)
+                if len(tokens) < 2:
+                    raise ValueError("scoring needs at least 2 tokens")
+                in_buf = (ctypes.c_int64 * len(tokens))(*tokens)
+                request_id = int(LIB_LLAISYS.llaisysQwen2ModelSubmitScore(self._model, in_buf, len(tokens)))
+                if request_id < 0:
+                    raise RuntimeError("llaisysQwen2ModelSubmitScore failed")
+                request_ids.append((request_id, len(tokens) - 1))
+            results = []
+            for request_id, n in request_ids:
+                if self.wait(request_id) != QWEN2_REQUEST_FINISHED:
+                    raise RuntimeError(f"scoring request {request_id} failed")
+                out_buf = (ctypes.c_float * n)()
+                if int(LIB_LLAISYS.llaisysQwen2ModelScores(self._model, request_id, out_buf, n)) != n:
+                    raise RuntimeError("llaisysQwen2ModelScores failed")
+                results.append([float(out_buf[i]) for i in range(n)])
+            return results
+        finally:
+            for request_id, _ in request_ids:
+                self.release(request_id)
+
+    def embed(self, batch: Sequence[Sequence[int]], pooling: str = "last") -> List[List[float]]:
+        """
+        Pooled final hidden states (after the final norm), one hidden_size vector per input sequence.
+        pooling is "last" (last token) or "mean" (all tokens). No KV cache is allocated and lm_head is skipped.
+        """
+        if self._model is None:
+            raise RuntimeError("Model is not initialized")
+        poolings = {"last": QWEN2_POOLING_LAST, "mean": QWEN2_POOLING_MEAN}
+        if pooling not in poolings:
+            raise ValueError(f"pooling must be one of {sorted(poolings)}")
+        seqs = [list(int(t) for t in inputs) for inputs in batch]
+        if not seqs or any(len(seq) == 0 for seq in seqs):
+            raise ValueError("batch must be a non-empty list of non-empty token sequences")
+        tokens = [t for seq in seqs for t in seq]
+        in_buf = (ctypes.c_int64 * len(tokens))(*tokens)
+        len_buf = (ctypes.c_size_t * len(seqs))(*[len(seq) for seq in seqs])
+        hs = int(self._meta.hs)
+        out_buf = (ctypes.c_float * (len(seqs) * hs))()
+        ret = int(
+            LIB_LLAISYS.llaisysQwen2ModelEmbed(self._model, in_buf, len_buf, len(seqs), poolings[pooling], out_buf)
+        )
+        if ret < 0:
+            raise RuntimeError("llaisysQwen2ModelEmbed failed")
+        return [[float(out_buf[i * hs + j]) for j in range(hs)] for i in range(len(seqs))]
 
     @staticmethod
     def _parse_weight_name(name: str) -> Optional[Dict[str, Any]]:
@@ -174,7 +441,10 @@ class Qwen2:
         meta.voc = int(cfg["vocab_size"])
         meta.epsilon = float(cfg["rms_norm_eps"])
         meta.theta = float(cfg["rope_theta"])
-        meta.end_token = int(cfg.get("eos_token_id", cfg.get("bos_token_id", 0)))
+        end_token = cfg.get("eos_token_id", cfg.get("bos_token_id", 0))
+        if isinstance(end_token, list):
+            end_token = end_token[0]
+        meta.end_token = int(end_token)
         meta.attention_dropout = float(cfg.get("attention_dropout", 0.0))
         meta.initializer_range = float(cfg.get("initializer_range", 0.0))
         meta.max_window_layers = int(cfg.get("max_window_layers", 0))
@@ -185,6 +455,21 @@ class Qwen2:
         meta.use_sliding_window = int(bool(cfg.get("use_sliding_window", False)))
         return meta
 
+    @staticmethod
+    def _load_eos_token_ids(model_path: Path) -> List[int]:
+        # config.json 与 generation_config.json 中的 eos_token_id 可能是列表，全部作为结束 token
+        ids = []
+        for name in ("generation_config.json", "config.json"):
+            path = model_path / name
+            if not path.exists():
+                continue
+            with path.open("r", encoding="utf-8") as f:
+                eos = json.load(f).get("eos_token_id")
+            for t in eos if isinstance(eos, list) else ([] if eos is None else [eos]):
+                if int(t) not in ids:
+                    ids.append(int(t))
+        return ids if len(ids) > 1 else []
+
     def _create_model(self):
         if self._model:
             return
@@ -245,3 +530,83 @@ class Qwen2:
             if total < 0:
                 raise RuntimeError("llaisysQwen2ModelInferDialog failed")
         return [int(out_buf[i]) for i in range(total)]
+
+
+class Qwen2Session:
+    """A conversation on a Qwen2 model; use Qwen2.session() to open one and close() when done."""
+
+    def __init__(self, model: Qwen2, session_id: int):
+        self._model = model
+        self._id = session_id
+
+    def __enter__(self):
+        return self
+
+    def __exit__(self, *exc):
+        self.close()
+
+    def submit(
+        self,
+        inputs: Sequence[int],
+        max_new_tokens: int = 1,
+        on_token=None,
+        stop_sequences: Sequence[Sequence[int]] = None,
+        eos_token_ids: Sequence[int] = None,
+        max_length: int = None,
+        logprobs: bool = False,
+        top_logprobs: int = 0,
+    ) -> int:
+        """
+        Append inputs (the new turn, may be empty) to the session and queue its generation like
+        Qwen2.submit; returns the request id. Generated tokens stay in the session, and max_length
+        and stop conditions apply to the whole session. Only one turn can be in progress at a time.
+        """
+        if self._id is None:
+            raise RuntimeError("Session is closed")
+        model = self._model
+        tokens = list(int(t) for t in inputs)
+        in_buf = (ctypes.c_int64 * max(1, len(tokens)))(*tokens)
+        callback = model._make_callback(on_token)
+        config, _bufs = model._make_config(
+            max_new_tokens, stop_sequences, eos_token_ids, max_length, logprobs, top_logprobs
+        )
+        request_id = int(
+            LIB_LLAISYS.llaisysQwen2SessionSubmit(
+                model._model, self._id, in_buf, len(tokens), ctypes.byref(config), callback, None
+            )
+        )
+        if request_id < 0:
+            raise RuntimeError("llaisysQwen2SessionSubmit failed")
+        model._callbacks[request_id] = callback
+        return request_id
+
+    def stream(self, inputs: Sequence[int], max_new_tokens: int = 1, **stop_kwargs):
+        """Yield the tokens generated for this turn as Qwen2.stream does."""
+        request_id = self.submit(inputs, max_new_tokens, **stop_kwargs)
+        yield from self._model._drain(request_id, stop_kwargs)
+
+    def generate(self, inputs: Sequence[int], max_new_tokens: int = 1, **stop_kwargs) -> List[int]:
+        """Run one turn and return the tokens generated for it."""
+        return list(self.stream(inputs, max_new_tokens, **stop_kwargs))
+
+    @property
+    def tokens(self) -> List[int]:
+        """All tokens of the session: every turn's inputs and everything generated."""
+        if self._id is None:
+            raise RuntimeError("Session is closed")
+        n = int(LIB_LLAISYS.llaisysQwen2SessionTokens(self._model._model, self._id, None, 0))
+        if n < 0:
+            raise RuntimeError("llaisysQwen2SessionTokens failed")
+        out_buf = (ctypes.c_int64 * max(1, n))()
+        n = int(LIB_LLAISYS.llaisysQwen2SessionTokens(self._model._model, self._id, out_buf, n))
+        return [int(out_buf[i]) for i in range(n)]
+
+    def close(self):
+        """Free the session's KV cache; a turn in progress is cancelled."""
+        if self._id is not None and self._model._model:
+            LIB_LLAISYS.llaisysQwen2SessionDestroy(self._model._model, self._id)
+        self._id = None
+
+    def __del__(self):
+        if getattr(self, "_id", None) is not None:
+            self.close()
@@ -1,6 +1,6 @@
 from .libllaisys import LIB_LLAISYS
 from .tensor import Tensor
-from ctypes import c_float, c_int
+from ctypes import c_float, c_int, c_size_t
 
 
 class Ops:
@@ -12,6 +12,26 @@ class Ops:
     def argmax(max_idx: Tensor, max_val: Tensor, vals: Tensor):
         LIB_LLAISYS.llaisysArgmax(max_idx.lib_tensor(), max_val.lib_tensor(), vals.lib_tensor())
 
+    @staticmethod
+    def bmm(
+        c: Tensor,
+        a: Tensor,
+        b: Tensor,
+        trans_a: bool = False,
+        trans_b: bool = False,
+        alpha: float = 1.0,
+        beta: float = 0.0,
+    ):
+        LIB_LLAISYS.llaisysBmm(
+            c.lib_tensor(),
+            a.lib_tensor(),
+            b.lib_tensor(),
+            c_int(1 if trans_a else 0),
+            c_int(1 if trans_b else 0),
+            c_float(alpha),
+            c_float(beta),
+        )
+
     @staticmethod
     def embedding(out: Tensor, index: Tensor, weight: Tensor):
         LIB_LLAISYS.llaisysEmbedding(
@@ -24,6 +44,34 @@ class Ops:
             out.lib_tensor(), inp.lib_tensor(), weight.lib_tensor(), bias.lib_tensor()
         )
 
+    @staticmethod
+    def linear_topk(out_idx: Tensor, out_val: Tensor, lse: Tensor, inp: Tensor, weight: Tensor):
+        LIB_LLAISYS.llaisysLinearTopk(
+            out_idx.lib_tensor(),
+            out_val.lib_tensor(),
+            lse.lib_tensor() if lse is not None else None,
+            inp.lib_tensor(),
+            weight.lib_tensor(),
+        )
+
+    @staticmethod
+    def linear_logprob(out: Tensor, inp: Tensor, weight: Tensor, target: Tensor):
+        LIB_LLAISYS.llaisysLinearLogprob(
+            out.lib_tensor(), inp.lib_tensor(), weight.lib_tensor(), target.lib_tensor()
+        )
+
+    @staticmethod
+    def paged_kv_scatter(paged_kv: Tensor, k: Tensor, v: Tensor, slot_mapping: Tensor):
+        LIB_LLAISYS.llaisysPagedKVScatter(
+            paged_kv.lib_tensor(), k.lib_tensor(), v.lib_tensor(), slot_mapping.lib_tensor()
+        )
+
+    @staticmethod
+    def paged_kv_gather(k: Tensor, v: Tensor, paged_kv: Tensor, slot_mapping: Tensor):
+        LIB_LLAISYS.llaisysPagedKVGather(
+            k.lib_tensor(), v.lib_tensor(), paged_kv.lib_tensor(), slot_mapping.lib_tensor()
+        )
+
     @staticmethod
     def rearrange(out: Tensor, inp: Tensor):
         LIB_LLAISYS.llaisysRearrange(out.lib_tensor(), inp.lib_tensor())
@@ -41,7 +89,93 @@ class Ops:
         )
 
     @staticmethod
-    def self_attention(attn_val: Tensor, q: Tensor, k: Tensor, v: Tensor, scale: float):
+    def rope_init_table(cos: Tensor, sin: Tensor, theta: float):
+        LIB_LLAISYS.llaisysROPEInitTable(cos.lib_tensor(), sin.lib_tensor(), c_float(theta))
+
+    @staticmethod
+    def rope_table(out: Tensor, inp: Tensor, pos_ids: Tensor, cos: Tensor, sin: Tensor):
+        LIB_LLAISYS.llaisysROPETable(
+            out.lib_tensor(),
+            inp.lib_tensor(),
+            pos_ids.lib_tensor(),
+            cos.lib_tensor(),
+            sin.lib_tensor(),
+        )
+
+    @staticmethod
+    def rope_qk(
+        q_out: Tensor,
+        k_out: Tensor,
+        q: Tensor,
+        k: Tensor,
+        pos_ids: Tensor,
+        cos: Tensor,
+        sin: Tensor,
+    ):
+        LIB_LLAISYS.llaisysROPEQK(
+            q_out.lib_tensor(),
+            k_out.lib_tensor(),
+            q.lib_tensor(),
+            k.lib_tensor(),
+            pos_ids.lib_tensor(),
+            cos.lib_tensor(),
+            sin.lib_tensor(),
+        )
+
+    @staticmethod
+    def rope_append_kv(
+        k_cache: Tensor,
+        v_cache: Tensor,
+        k: Tensor,
+        v: Tensor,
+        pos_ids: Tensor,
+        cos: Tensor,
+        sin: Tensor,
+    ):
+        LIB_LLAISYS.llaisysROPEAppendKV(
+            k_cache.lib_tensor(),
+            v_cache.lib_tensor(),
+            k.lib_tensor(),
+            v.lib_tensor(),
+            pos_ids.lib_tensor(),
+            cos.lib_tensor(),
+            sin.lib_tensor(),
+        )
+
+    @staticmethod
+    def rope_append_kv_paged(
+        paged_kv: Tensor,
+        k: Tensor,
+        v: Tensor,
+        pos_ids: Tensor,
+        cos: Tensor,
+        sin: Tensor,
+        slot_mapping: Tensor,
+    ):
+        LIB_LLAISYS.llaisysROPEAppendKVPaged(
+            paged_kv.lib_tensor(),
+            k.lib_tensor(),
+            v.lib_tensor(),
+            pos_ids.lib_tensor(),
+            cos.lib_tensor(),
+            sin.lib_tensor(),
+            slot_mapping.lib_tensor(),
+        )
+
+    @staticmethod
+    def self_attention(
+        attn_val: Tensor, q: Tensor, k: Tensor, v: Tensor, scale: float, window: int = 0
+    ):
+        if window > 0:
+            LIB_LLAISYS.llaisysSelfAttentionWindowed(
+                attn_val.lib_tensor(),
+                q.lib_tensor(),
+                k.lib_tensor(),
+                v.lib_tensor(),
+                c_float(scale),
+                c_size_t(window),
+            )
+            return
         LIB_LLAISYS.llaisysSelfAttention(
             attn_val.lib_tensor(),
             q.lib_tensor(),
@@ -50,6 +184,36 @@ class Ops:
             c_float(scale),
         )
 
+    @staticmethod
+    def self_attention_quantized(
+        attn_val: Tensor,
+        q: Tensor,
+        k: Tensor,
+        v: Tensor,
+        k_scale: Tensor,
+        v_scale: Tensor,
+        scale: float,
+        window: int = 0,
+    ):
+        LIB_LLAISYS.llaisysSelfAttentionQuantized(
+            attn_val.lib_tensor(),
+            q.lib_tensor(),
+            k.lib_tensor(),
+            v.lib_tensor(),
+            k_scale.lib_tensor(),
+            v_scale.lib_tensor(),
+            c_float(scale),
+            c_size_t(window),
+        )
+
+    @staticmethod
+    def quantize_kv(out: Tensor, scale: Tensor, inp: Tensor):
+        LIB_LLAISYS.llaisysQuantizeKV(out.lib_tensor(), scale.lib_tensor(), inp.lib_tensor())
+
     @staticmethod
     def swiglu(out: Tensor, gate: Tensor, up: Tensor):
         LIB_LLAISYS.llaisysSwiGLU(out.lib_tensor(), gate.lib_tensor(), up.lib_tensor())
+
+    @staticmethod
+    def topk(out_idx: Tensor, out_val: Tensor, vals: Tensor):
+        LIB_LLAISYS.llaisysTopk(out_idx.lib_tensor(), out_val.lib_tensor(), vals.lib_tensor())
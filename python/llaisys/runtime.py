@@ -66,3 +66,16 @@ class RuntimeAPI:
         self._api.contents.memcpy_async(
             dst, src, size, libllaisys.llaisysMemcpyKind_t(kind), stream
         )
+
+
+def set_cpu_isa(isa: str) -> None:
+    """Force the CPU kernel ISA: "scalar", "avx2", "avx512" or "amx"; "auto" restores the best supported one."""
+    if LIB_LLAISYS.llaisysSetCpuIsa(isa.encode()) != 0:
+        raise ValueError(
+            f"unsupported CPU ISA {isa!r} (this CPU supports up to {get_cpu_isa(detected=True)!r})"
+        )
+
+
+def get_cpu_isa(detected: bool = False) -> str:
+    """The CPU kernel ISA in use, or the best one this CPU supports when detected is True."""
+    return LIB_LLAISYS.llaisysGetCpuIsa(1 if detected else 0).decode()
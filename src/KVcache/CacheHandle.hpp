@@ -17,6 +17,27 @@ public:
     virtual void append(size_t layer, llaisys::tensor_t& k, llaisys::tensor_t& v,
                         size_t token_idx = 0) = 0;
     virtual void get(llaisys::tensor_t& k, llaisys::tensor_t& v, size_t layer) = 0;
+    // rope 与写缓存融合：k 为 rope 前的 K，按 pos_ids 查 cos/sin 表旋转后与 v 直接写入缓存存储；
+    // 返回 false 表示该缓存不支持（如量化存储），调用方需先 rope 再 append
+    virtual bool append_rope(size_t layer, llaisys::tensor_t& k, llaisys::tensor_t& v, llaisys::tensor_t pos_ids,
+                             llaisys::tensor_t cos, llaisys::tensor_t sin, size_t token_idx = 0) {
+        (void)layer; (void)k; (void)v; (void)pos_ids; (void)cos; (void)sin; (void)token_idx;
+        return false;
+    }
+    // 量化 KV：get 返回 I8/F8 存储，注意力需配合 get_scales 反量化
+    virtual bool is_quantized() const { return false; }
+    virtual void get_scales(llaisys::tensor_t& k_scale, llaisys::tensor_t& v_scale, size_t layer) {
+        (void)k_scale; (void)v_scale; (void)layer;
+    }
+    // 自行旋转 K 的缓存（StreamingLLM）：append 接收 rope 前的 K，get 返回按缓存内位置旋转后的 K，
+    // 新 token 的 rope 位置由 rope_offset 给出而不是其在对话中的绝对位置
+    virtual bool rotates_keys() const { return false; }
+    virtual size_t rope_offset(size_t layer, size_t seq) const { (void)layer; (void)seq; return 0; }
+    // 单次前向最多写入的 token 数，0 表示不限制（prefill 需要按此分块）
+    virtual size_t max_step_tokens() const { return 0; }
+    // 为 [token_idx, token_idx + seq) 预先分配缓存位置，上传 slot mapping 与注意力元数据，返回设备端 slot mapping；
+    // 之后写缓存只剩 slot mapping 上的设备端 scatter，整步可被 CUDA Graph 捕获。不支持时返回 nullptr
+    virtual llaisys::tensor_t prepare_slots(size_t token_idx, size_t seq) { (void)token_idx; (void)seq; return nullptr; }
     virtual bool is_paged() const { return false; }
     virtual llaisys::tensor_t paged_kv_data(size_t layer) const { (void)layer; return nullptr; }
     virtual llaisys::tensor_t kv_indptr() const { return nullptr; }
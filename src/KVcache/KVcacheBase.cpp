@@ -1,4 +1,5 @@
 #include "KVcacheBase.hpp"
+#include <stdexcept>
 namespace llaisys::KVcache {
 size_t KVcacheBase::seq_len() {
     switch (this->dtype()) {
@@ -32,6 +33,25 @@ size_t KVcacheBase::capacity() {
         break;
     }
 }
+void KVcacheBase::get_scales(llaisys::tensor_t &k_scale, llaisys::tensor_t &v_scale,
+                             size_t layer) {
+    (void)k_scale;
+    (void)v_scale;
+    (void)layer;
+    throw std::runtime_error("KVcache::get_scales: cache is not quantized");
+}
+bool KVcacheBase::append_rope(size_t layer, llaisys::tensor_t &k, llaisys::tensor_t &v,
+                              llaisys::tensor_t pos_ids, llaisys::tensor_t cos, llaisys::tensor_t sin,
+                              size_t token_idx) {
+    (void)layer;
+    (void)k;
+    (void)v;
+    (void)pos_ids;
+    (void)cos;
+    (void)sin;
+    (void)token_idx;
+    return false;
+}
 CacheMeta KVcacheBase::meta() {
     return this->meta_;
 }
@@ -15,6 +15,16 @@ struct CacheMeta {
     size_t head_dim = 128;
     size_t n_kv_heads = 2;
     size_t batch = 1;
+    // KV 存储精度：INVALID 表示与计算精度一致，I8/F8 表示按 (token, head) 量化存储
+    llaisysDataType_t kv_dtype = LLAISYS_DTYPE_INVALID;
+    // 滑动窗口：sliding_window > 0 时，layer >= max_window_layers 的层只保留最近 sliding_window 个 token
+    size_t sliding_window = 0;
+    size_t max_window_layers = 0;
+    // StreamingLLM：保留前 sink_tokens 个 token 与最近 streaming_window 个 token，
+    // K 以 rope 前的形式存储，读取时按缓存内位置重新旋转（rope_theta）
+    size_t sink_tokens = 0;
+    size_t streaming_window = 0;
+    float rope_theta = 10000.0f;
 };
 // KVcache的抽象内存分配器
 struct IKVAllocator {
@@ -58,6 +68,15 @@ public:
     virtual void get(llaisys::tensor_t &k, llaisys::tensor_t &v,
                      size_t layer)
         = 0; // 读取cache
+    // 量化存储时 get 返回 I8/F8 数据，对应的 scale 由 get_scales 给出
+    virtual bool quantized() const { return false; }
+    virtual void get_scales(llaisys::tensor_t &k_scale, llaisys::tensor_t &v_scale,
+                            size_t layer);
+    // rope 与写入融合：k 为 rope 前的 K，按 pos_ids 查 cos/sin 表旋转后与 v 直接写入存储，
+    // 返回 false 表示不支持（调用方先 rope 再 append）
+    virtual bool append_rope(size_t layer, llaisys::tensor_t &k, llaisys::tensor_t &v,
+                             llaisys::tensor_t pos_ids, llaisys::tensor_t cos, llaisys::tensor_t sin,
+                             size_t token_idx = 0);
     llaisys::KVcache::CacheMeta meta();
     llaisysDataType_t dtype();
     llaisysDeviceType_t device();
@@ -1,5 +1,8 @@
 #include "NaiveCache.hpp"
 #include "../../core/llaisys_core.hpp"
+#include "../../ops/ops.hpp"
+#include <algorithm>
+#include <functional>
 
 namespace llaisys::KVcache {
 void NaiveCache::init(llaisys::KVcache::CacheMeta meta_,
@@ -14,22 +17,32 @@ void NaiveCache::init(llaisys::KVcache::CacheMeta meta_,
     this->device_id_ = device_id;
     this->dtype_ = dtype_;
     this->allocator_ = allocator_;
-    // 分配k_cache_和v_cache_
-    std::vector<size_t> cache_shape_{meta_.nlayer, meta_.max_seq,
-                                     meta_.n_kv_heads, meta_.head_dim};
-    /* std::vector<ptrdiff_t> cache_strides_(cache_shape_.size(), 1);
-    for (size_t i = cache_shape_.size(); i-- > 0;) {
-        if (i + 1 < cache_shape_.size()) {
-            cache_strides_[i] = static_cast<ptrdiff_t>(cache_strides_[i + 1] * static_cast<ptrdiff_t>(cache_shape_[i + 1]));
+    this->kv_dtype_ = meta_.kv_dtype == LLAISYS_DTYPE_INVALID ? dtype_ : meta_.kv_dtype;
+    ASSERT(kv_dtype_ == dtype_ || kv_dtype_ == LLAISYS_DTYPE_I8 || kv_dtype_ == LLAISYS_DTYPE_F8,
+           "NaiveCache::init: kv_dtype must equal dtype or be int8/float8");
+    // 窗口不小于最大上下文时等价于全量注意力，不启用环形存储
+    this->window_ = (meta_.sliding_window > 0 && meta_.sliding_window < meta_.max_seq) ? meta_.sliding_window : 0;
+    // 分配每层的k_cache_和v_cache_
+    this->k_cache_.assign(meta_.nlayer, nullptr);
+    this->v_cache_.assign(meta_.nlayer, nullptr);
+    this->k_scale_.assign(meta_.nlayer, nullptr);
+    this->v_scale_.assign(meta_.nlayer, nullptr);
+    for (size_t layer = 0; layer < meta_.nlayer; ++layer) {
+        size_t window = window_of(layer);
+        size_t rows = window > 0 ? 2 * window : meta_.max_seq;
+        std::vector<size_t> cache_shape_{rows, meta_.n_kv_heads, meta_.head_dim};
+        this->k_cache_[layer] = llaisys::Tensor::create(cache_shape_, kv_dtype_, device_, device_id);
+        this->v_cache_[layer] = llaisys::Tensor::create(cache_shape_, kv_dtype_, device_, device_id);
+        if (quantized()) {
+            std::vector<size_t> scale_shape_{rows, meta_.n_kv_heads};
+            this->k_scale_[layer] = llaisys::Tensor::create(scale_shape_, LLAISYS_DTYPE_F32, device_, device_id);
+            this->v_scale_[layer] = llaisys::Tensor::create(scale_shape_, LLAISYS_DTYPE_F32, device_, device_id);
         }
     }
-    llaisys::TensorMeta tensor_meta_{dtype_, cache_shape_, std::move(cache_strides_)}; */
-    this->k_cache_ = llaisys::Tensor::create(cache_shape_, dtype_, device_, device_id);
-    this->v_cache_ = llaisys::Tensor::create(cache_shape_, dtype_, device_, device_id);
     this->k_cur_len_ = std::vector<size_t>(meta_.nlayer, 0);
     this->v_cur_len_ = std::vector<size_t>(meta_.nlayer, 0);
-    // cache statistics (track seq_len in bytes)
-    total_bytes_ = meta_.max_seq * k_cache_->elementSize();
+    // cache statistics (track seq_len in bytes of the compute dtype)
+    total_bytes_ = meta_.max_seq * llaisys::utils::dsize(dtype_);
     used_bytes_ = 0;
 }
 
@@ -46,35 +59,62 @@ void NaiveCache::reserve(size_t max_seq) {
         return;
     }
     meta_.max_seq = max_seq;
-    if (k_cache_) {
-        k_cache_.reset();
-    }
-    if (v_cache_) {
-        v_cache_.reset();
-    }
+    k_cache_.clear();
+    v_cache_.clear();
+    k_scale_.clear();
+    v_scale_.clear();
     init(meta_, device_, device_id_, dtype_, allocator_);
 }
 // 当前上下文长度是否够用
 bool NaiveCache::ensure(size_t seq_len) {
+    // 所有层都是滑动窗口层时显存与长度无关
+    if (window_ > 0 && meta_.max_window_layers == 0) {
+        return true;
+    }
     return seq_len <= this->meta_.max_seq;
 };
-// 更新kv_cache
-void NaiveCache::append(size_t layer, llaisys::tensor_t &k,
-                        llaisys::tensor_t &v,
-                        size_t token_idx) {
-    (void)token_idx;
+// 第 layer 层的窗口长度，0 表示全量存储
+size_t NaiveCache::window_of(size_t layer) const {
+    return layer >= meta_.max_window_layers ? window_ : 0;
+}
+// 把 k/v 的 [src_row, src_row + nrows) 行写入第 layer 层存储的 [row, row + nrows) 行
+void NaiveCache::write_rows(size_t layer, size_t row, llaisys::tensor_t &k, llaisys::tensor_t &v,
+                            size_t src_row, size_t nrows) {
+    auto k_dst = k_cache_[layer]->slice(0, row, row + nrows);
+    auto v_dst = v_cache_[layer]->slice(0, row, row + nrows);
+    auto k_src = k->slice(0, src_row, src_row + nrows);
+    auto v_src = v->slice(0, src_row, src_row + nrows);
+    if (quantized()) {
+        // 量化写入：直接量化到缓存对应的行，scale 同步写入
+        auto k_scale_dst = k_scale_[layer]->slice(0, row, row + nrows);
+        auto v_scale_dst = v_scale_[layer]->slice(0, row, row + nrows);
+        llaisys::ops::quantize_kv(k_dst, k_scale_dst, k_src);
+        llaisys::ops::quantize_kv(v_dst, v_scale_dst, v_src);
+        return;
+    }
+    llaisysMemcpyKind_t memcpy_kind = k_dst->deviceType() == LLAISYS_DEVICE_CPU
+                                          ? LLAISYS_MEMCPY_H2H
+                                          : LLAISYS_MEMCPY_D2D;
+    llaisys::core::context().setDevice(k_dst->deviceType(), k_dst->deviceId());
+    auto &runtime = llaisys::core::context().runtime();
+    size_t bytes = k_src->numel() * k_src->elementSize();
+    runtime.api()->memcpy_async(k_dst->data(), k_src->data(), bytes, memcpy_kind, runtime.stream());
+    runtime.api()->memcpy_async(v_dst->data(), v_src->data(), bytes, memcpy_kind, runtime.stream());
+}
+// 校验 append 的输入
+void NaiveCache::check_append(size_t layer, llaisys::tensor_t &k, llaisys::tensor_t &v) const {
     ASSERT(layer < meta_.nlayer, "NaiveCache::append: layer out of range");
     ASSERT(k != nullptr && v != nullptr, "NaiveCache::append: k/v tensor is null");
-    ASSERT(k_cache_ != nullptr && v_cache_ != nullptr, "NaiveCache::append: cache tensor is null");
-    // 当前层的存储的长度
+    ASSERT(k_cache_[layer] != nullptr && v_cache_[layer] != nullptr, "NaiveCache::append: cache tensor is null");
+    // 当前层已写入的长度
     size_t k_len = k_cur_len_[layer];
     size_t v_len = v_cur_len_[layer];
     ASSERT(k_len == v_len, "NaiveCache::append: k_len and v_len mismatch");
-    ASSERT(ensure(k_len + k->shape()[0]), "NaiveCache::append: Cache memory is not enough");
+    ASSERT(window_of(layer) > 0 || k_len + k->shape()[0] <= meta_.max_seq,
+           "NaiveCache::append: Cache memory is not enough");
     //  在tensor里append数据
     size_t n_kv = meta_.n_kv_heads;
     size_t d = meta_.head_dim;
-    size_t max_seq = meta_.max_seq;
     ASSERT(k->shape().size() == 3 && v->shape().size() == 3,
            "NaiveCache::append: k/v must be [seq,n_kv,head_dim]");
     ASSERT(k->dtype() == this->dtype_ && v->dtype() == this->dtype_,
@@ -84,76 +124,108 @@ void NaiveCache::append(size_t layer, llaisys::tensor_t &k,
     ASSERT(v->shape()[1] == n_kv && v->shape()[2] == d,
            "NaiveCache::append: v shape mismatch");
     ASSERT(k->shape()[0] == v->shape()[0], "NaiveCache::append: k/v seq mismatch");
-    // 该实现按行做线性拷贝，要求输入与缓存都连续。
+    // 该实现按行做线性拷贝，要求输入连续。
     ASSERT(k->isContiguous() && v->isContiguous(), "NaiveCache::append: k/v must be contiguous");
-    ASSERT(k_cache_->isContiguous() && v_cache_->isContiguous(), "NaiveCache::append: cache must be contiguous");
-
-    size_t seq = k->shape()[0];
-    size_t elem_size = k_cache_->elementSize();
-    size_t row_elems = n_kv * d;
-
-    CHECK_SAME_DEVICE(k_cache_, k, v_cache_, v);
-    llaisysMemcpyKind_t memcpy_kind = k_cache_->deviceType() == LLAISYS_DEVICE_CPU
-                                          ? LLAISYS_MEMCPY_H2H
-                                          : LLAISYS_MEMCPY_D2D;
-    llaisys::core::context().setDevice(k_cache_->deviceType(), k_cache_->deviceId());
-    auto &runtime = llaisys::core::context().runtime();
-    auto api = runtime.api();
-    auto stream = runtime.stream();
-
-    std::byte *k_dst = k_cache_->data();
-    std::byte *v_dst = v_cache_->data();
-    const std::byte *k_src = k->data();
-    const std::byte *v_src = v->data();
-
-    for (size_t t = 0; t < seq; ++t) {
-        size_t k_base = ((layer * max_seq + (k_len + t)) * row_elems);
-        size_t v_base = ((layer * max_seq + (v_len + t)) * row_elems);
-        api->memcpy_async(k_dst + k_base * elem_size,
-                          k_src + t * row_elems * elem_size,
-                          row_elems * elem_size,
-                          memcpy_kind,
-                          stream);
-        api->memcpy_async(v_dst + v_base * elem_size,
-                          v_src + t * row_elems * elem_size,
-                          row_elems * elem_size,
-                          memcpy_kind,
-                          stream);
+    CHECK_SAME_DEVICE(k_cache_[layer], k, v_cache_[layer], v);
+}
+// 把本批 seq 个 token 映射到存储行，逐段调用 write(row, src_row, nrows)
+void NaiveCache::for_each_segment(size_t layer, size_t seq,
+                                  const std::function<void(size_t, size_t, size_t)> &write) const {
+    size_t k_len = k_cur_len_[layer];
+    size_t window = window_of(layer);
+    if (window == 0) {
+        write(k_len, 0, seq);
+        return;
     }
-    api->stream_synchronize(stream);
-
+    // 环形写入：超出窗口的前缀写了也会被覆盖，直接跳过；
+    // 每段连续 slot 写两份（slot 与 slot + window）
+    size_t t = seq > window ? seq - window : 0;
+    while (t < seq) {
+        size_t slot = (k_len + t) % window;
+        size_t n = std::min(seq - t, window - slot);
+        write(slot, t, n);
+        write(slot + window, t, n);
+        t += n;
+    }
+}
+// 写入后推进长度并更新统计
+void NaiveCache::advance(size_t layer, size_t seq) {
     k_cur_len_[layer] += seq;
     v_cur_len_[layer] += seq;
     // update cache statistics (track max seq_len across layers)
     size_t cur_len = k_cur_len_[layer];
-    size_t cur_bytes = cur_len * k_cache_->elementSize();
+    size_t cur_bytes = cur_len * llaisys::utils::dsize(dtype_);
     if (cur_bytes > used_bytes_) {
         used_bytes_ = cur_bytes;
     }
 }
-// 返回layer层的k和v,使用slice即可
+// 更新kv_cache
+void NaiveCache::append(size_t layer, llaisys::tensor_t &k,
+                        llaisys::tensor_t &v,
+                        size_t token_idx) {
+    (void)token_idx;
+    check_append(layer, k, v);
+    size_t seq = k->shape()[0];
+    for_each_segment(layer, seq, [&](size_t row, size_t src_row, size_t nrows) {
+        write_rows(layer, row, k, v, src_row, nrows);
+    });
+    advance(layer, seq);
+}
+// rope 与写入融合：K 旋转后直接落到存储行；量化存储返回 false 由调用方走 rope + append
+bool NaiveCache::append_rope(size_t layer, llaisys::tensor_t &k, llaisys::tensor_t &v,
+                             llaisys::tensor_t pos_ids, llaisys::tensor_t cos, llaisys::tensor_t sin,
+                             size_t token_idx) {
+    (void)token_idx;
+    if (quantized()) {
+        return false;
+    }
+    check_append(layer, k, v);
+    size_t seq = k->shape()[0];
+    for_each_segment(layer, seq, [&](size_t row, size_t src_row, size_t nrows) {
+        llaisys::ops::rope_append_kv(k_cache_[layer]->slice(0, row, row + nrows),
+                                     v_cache_[layer]->slice(0, row, row + nrows),
+                                     k->slice(0, src_row, src_row + nrows), v->slice(0, src_row, src_row + nrows),
+                                     pos_ids->slice(0, src_row, src_row + nrows), cos, sin);
+    });
+    advance(layer, seq);
+    return true;
+}
+// 返回layer层的k和v,使用slice即可；滑动窗口层返回最近 window 个 token（按时间顺序）
 void NaiveCache::get(llaisys::tensor_t &k, llaisys::tensor_t &v,
                      size_t layer) {
     ASSERT(layer < meta_.nlayer, "NaiveCache::get: layer out of range");
-    ASSERT(k_cache_ != nullptr && v_cache_ != nullptr, "NaiveCache::get: cache tensor is null");
+    ASSERT(k_cache_[layer] != nullptr && v_cache_[layer] != nullptr, "NaiveCache::get: cache tensor is null");
     size_t k_len = k_cur_len_[layer];
     size_t v_len = v_cur_len_[layer];
     ASSERT(k_len == v_len, "NaiveCache::get: k_len and v_len mismatch");
-    ASSERT(k_len <= meta_.max_seq, "NaiveCache::get: seq length exceeds cache capacity");
-
-    auto k_view = k_cache_->slice(0, layer, layer + 1);
-    auto v_view = v_cache_->slice(0, layer, layer + 1);
-    k_view = k_view->slice(1, 0, k_len);
-    v_view = v_view->slice(1, 0, v_len);
+    size_t window = window_of(layer);
+    ASSERT(window > 0 || k_len <= meta_.max_seq, "NaiveCache::get: seq length exceeds cache capacity");
 
-    std::vector<size_t> out_shape{k_len, meta_.n_kv_heads, meta_.head_dim};
-    k = k_view->reshape(out_shape);
-    v = v_view->reshape(out_shape);
-    CHECK_SAME_DEVICE(k_cache_, k, v_cache_, v);
+    size_t begin = (window > 0 && k_len > window) ? k_len % window : 0;
+    size_t len = window > 0 ? std::min(k_len, window) : k_len;
+    k = k_cache_[layer]->slice(0, begin, begin + len);
+    v = v_cache_[layer]->slice(0, begin, begin + len);
+}
+bool NaiveCache::quantized() const {
+    return kv_dtype_ == LLAISYS_DTYPE_I8 || kv_dtype_ == LLAISYS_DTYPE_F8;
+}
+// 返回layer层的量化scale，行与 get 返回的 k/v 一一对应
+void NaiveCache::get_scales(llaisys::tensor_t &k_scale, llaisys::tensor_t &v_scale,
+                            size_t layer) {
+    ASSERT(quantized(), "NaiveCache::get_scales: cache is not quantized");
+    ASSERT(layer < meta_.nlayer, "NaiveCache::get_scales: layer out of range");
+    size_t k_len = k_cur_len_[layer];
+    size_t window = window_of(layer);
+    size_t begin = (window > 0 && k_len > window) ? k_len % window : 0;
+    size_t len = window > 0 ? std::min(k_len, window) : k_len;
+    k_scale = k_scale_[layer]->slice(0, begin, begin + len);
+    v_scale = v_scale_[layer]->slice(0, begin, begin + len);
 }
 NaiveCache::~NaiveCache() {
-    k_cache_.reset();
-    v_cache_.reset();
+    k_cache_.clear();
+    v_cache_.clear();
+    k_scale_.clear();
+    v_scale_.clear();
     k_cur_len_.clear();
     v_cur_len_.clear();
     allocator_ = nullptr;
@@ -1,14 +1,32 @@
 #pragma once
 #include "../../utils.hpp"
 #include "../KVcacheBase.hpp"
+#include <functional>
 namespace llaisys::KVcache {
 // 只能用一次的最简单KVcache，固定一块内存，用完了就没了
 class NaiveCache : public KVcacheBase {
 private:
+    // 每层已写入的 token 总数（滑动窗口层包含已滑出窗口的 token）
     std::vector<size_t> k_cur_len_;
     std::vector<size_t> v_cur_len_;
-    llaisys::tensor_t k_cache_;
-    llaisys::tensor_t v_cache_;
+    // 每层一块 [rows, n_kv, head_dim] 的存储：全量层 rows = max_seq，
+    // 滑动窗口层 rows = 2 * window，每个 token 同时写入 slot 与 slot + window，
+    // 使最近 window 个 token 始终是一段连续的行
+    std::vector<llaisys::tensor_t> k_cache_;
+    std::vector<llaisys::tensor_t> v_cache_;
+    size_t window_ = 0;
+    // 量化存储：kv_dtype_ 为 I8/F8 时 k/v_cache_ 按该精度存储，scale 形状 [rows, n_kv]
+    llaisysDataType_t kv_dtype_ = LLAISYS_DTYPE_INVALID;
+    std::vector<llaisys::tensor_t> k_scale_;
+    std::vector<llaisys::tensor_t> v_scale_;
+
+    size_t window_of(size_t layer) const;
+    void check_append(size_t layer, llaisys::tensor_t &k, llaisys::tensor_t &v) const;
+    void for_each_segment(size_t layer, size_t seq,
+                          const std::function<void(size_t, size_t, size_t)> &write) const;
+    void advance(size_t layer, size_t seq);
+    void write_rows(size_t layer, size_t row, llaisys::tensor_t &k, llaisys::tensor_t &v,
+                    size_t src_row, size_t nrows);
 
 public:
     ~NaiveCache() override;
@@ -20,12 +38,13 @@ public:
         cache->init(meta_, device_, device_id, dtype_, allocator_);
         LOG_INFO("NaiveCache::create:complete");
 #ifdef LLAISYS_ENABLE_LOG
-        if (cache->k_cache_) {
-            LOG_INFO("NaiveCache::k_cache_ " << cache->k_cache_->info());
+        if (!cache->k_cache_.empty()) {
+            LOG_INFO("NaiveCache::k_cache_[0] " << cache->k_cache_.front()->info());
         }
-        if (cache->v_cache_) {
-            LOG_INFO("NaiveCache::v_cache_ " << cache->v_cache_->info());
+        if (!cache->v_cache_.empty()) {
+            LOG_INFO("NaiveCache::v_cache_[0] " << cache->v_cache_.front()->info());
         }
+        LOG_INFO("NaiveCache::window " << cache->window_);
 #endif
 
         return cache;
@@ -40,7 +59,13 @@ public:
                 llaisys::tensor_t &v,
                 size_t token_idx = 0) override; // K/V_cache[layer]:[seq_len,nkvhead,d]->[seq_len+1,nkvhead,d]
     void get(llaisys::tensor_t &k, llaisys::tensor_t &v,
-             size_t layer) override; // 得到K/V_cache[layer]
+             size_t layer) override; // 得到K/V_cache[layer]，滑动窗口层只返回窗口内的 token
+    bool append_rope(size_t layer, llaisys::tensor_t &k, llaisys::tensor_t &v,
+                     llaisys::tensor_t pos_ids, llaisys::tensor_t cos, llaisys::tensor_t sin,
+                     size_t token_idx = 0) override; // K 旋转后与 V 直接写入存储行
+    bool quantized() const override;
+    void get_scales(llaisys::tensor_t &k_scale, llaisys::tensor_t &v_scale,
+                    size_t layer) override; // 得到量化scale[layer]:[seq_len,nkvhead]
 };
 
 } // namespace llaisys::KVcache
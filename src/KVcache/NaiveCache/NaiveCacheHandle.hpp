@@ -18,10 +18,20 @@ public:
         cache_->append(layer, k, v, token_idx);
     }
 
+    bool append_rope(size_t layer, llaisys::tensor_t& k, llaisys::tensor_t& v, llaisys::tensor_t pos_ids,
+                     llaisys::tensor_t cos, llaisys::tensor_t sin, size_t token_idx = 0) override {
+        return cache_->append_rope(layer, k, v, pos_ids, cos, sin, token_idx);
+    }
+
     void get(llaisys::tensor_t& k, llaisys::tensor_t& v, size_t layer) override {
         cache_->get(k, v, layer);
     }
 
+    bool is_quantized() const override { return cache_->quantized(); }
+    void get_scales(llaisys::tensor_t& k_scale, llaisys::tensor_t& v_scale, size_t layer) override {
+        cache_->get_scales(k_scale, v_scale, layer);
+    }
+
 private:
     KVcache_t cache_;
 };
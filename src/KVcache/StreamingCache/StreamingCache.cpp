@@ -0,0 +1,179 @@
+#include "StreamingCache.hpp"
+#include "../../core/llaisys_core.hpp"
+#include "../../ops/ops.hpp"
+#include <algorithm>
+#include <numeric>
+
+namespace llaisys::KVcache {
+void StreamingCache::init(llaisys::KVcache::CacheMeta meta_,
+                          llaisysDeviceType_t device_, int device_id, llaisysDataType_t dtype_,
+                          llaisys::KVcache::IKVAllocator *allocator_) {
+    ASSERT(meta_.nlayer > 0, "StreamingCache::init: nlayer must be > 0");
+    ASSERT(meta_.n_kv_heads > 0, "StreamingCache::init: n_kv_heads must be > 0");
+    ASSERT(meta_.head_dim > 0, "StreamingCache::init: head_dim must be > 0");
+    ASSERT(meta_.streaming_window > 0, "StreamingCache::init: streaming_window must be > 0");
+    ASSERT(meta_.kv_dtype == LLAISYS_DTYPE_INVALID || meta_.kv_dtype == dtype_,
+           "StreamingCache::init: quantized kv storage is not supported");
+    this->meta_ = meta_;
+    this->device_ = device_;
+    this->device_id_ = device_id;
+    this->dtype_ = dtype_;
+    this->allocator_ = allocator_;
+    this->sinks_ = meta_.sink_tokens;
+    this->window_ = meta_.streaming_window;
+    this->rope_theta_ = meta_.rope_theta;
+
+    size_t n_kv = meta_.n_kv_heads;
+    size_t d = meta_.head_dim;
+    k_sink_.assign(meta_.nlayer, nullptr);
+    v_sink_.assign(meta_.nlayer, nullptr);
+    k_ring_.assign(meta_.nlayer, nullptr);
+    v_ring_.assign(meta_.nlayer, nullptr);
+    for (size_t layer = 0; layer < meta_.nlayer; ++layer) {
+        if (sinks_ > 0) {
+            k_sink_[layer] = llaisys::Tensor::create({sinks_, n_kv, d}, dtype_, device_, device_id);
+            v_sink_[layer] = llaisys::Tensor::create({sinks_, n_kv, d}, dtype_, device_, device_id);
+        }
+        k_ring_[layer] = llaisys::Tensor::create({2 * window_, n_kv, d}, dtype_, device_, device_id);
+        v_ring_[layer] = llaisys::Tensor::create({2 * window_, n_kv, d}, dtype_, device_, device_id);
+    }
+    size_t cap = sinks_ + window_;
+    k_rot_ = llaisys::Tensor::create({cap, n_kv, d}, dtype_, device_, device_id);
+    v_cat_ = llaisys::Tensor::create({cap, n_kv, d}, dtype_, device_, device_id);
+    std::vector<int64_t> pos_host(cap);
+    std::iota(pos_host.begin(), pos_host.end(), int64_t{0});
+    pos_ids_ = llaisys::Tensor::create({cap}, LLAISYS_DTYPE_I64, device_, device_id);
+    pos_ids_->load(pos_host.data());
+    rope_cos_ = llaisys::Tensor::create({cap, d / 2}, LLAISYS_DTYPE_F32, device_, device_id);
+    rope_sin_ = llaisys::Tensor::create({cap, d / 2}, LLAISYS_DTYPE_F32, device_, device_id);
+    ops::rope_init_table(rope_cos_, rope_sin_, rope_theta_);
+
+    len_ = std::vector<size_t>(meta_.nlayer, 0);
+    total_bytes_ = cap * llaisys::utils::dsize(dtype_);
+    used_bytes_ = 0;
+}
+
+void StreamingCache::reset() {
+    std::fill(len_.begin(), len_.end(), size_t{0});
+    used_bytes_ = 0;
+}
+
+// 容量由 sink + 窗口决定，与对话长度无关
+void StreamingCache::reserve(size_t max_seq) {
+    (void)max_seq;
+}
+
+bool StreamingCache::ensure(size_t seq_len) {
+    (void)seq_len;
+    return true;
+}
+
+// 新 token 的缓存内 rope 位置：单 token 写入后再读取，位置不超过 sinks + window - 1；
+// 多 token 分块时先读取已有缓存再拼接本块，位置紧跟在已缓存的 token 之后
+size_t StreamingCache::rope_offset(size_t layer, size_t seq) const {
+    ASSERT(layer < meta_.nlayer, "StreamingCache::rope_offset: layer out of range");
+    size_t cap = sinks_ + window_;
+    size_t len = len_[layer];
+    return seq == 1 ? std::min(len, cap - 1) : std::min(len, cap);
+}
+
+void StreamingCache::copy_rows(llaisys::tensor_t &dst, size_t row, llaisys::tensor_t &src, size_t src_row,
+                               size_t nrows) {
+    llaisysMemcpyKind_t memcpy_kind = dst->deviceType() == LLAISYS_DEVICE_CPU
+                                          ? LLAISYS_MEMCPY_H2H
+                                          : LLAISYS_MEMCPY_D2D;
+    size_t row_bytes = meta_.n_kv_heads * meta_.head_dim * dst->elementSize();
+    auto &runtime = llaisys::core::context().runtime();
+    runtime.api()->memcpy_async(dst->data() + row * row_bytes, src->data() + src_row * row_bytes,
+                                nrows * row_bytes, memcpy_kind, runtime.stream());
+}
+
+void StreamingCache::append(size_t layer, llaisys::tensor_t &k,
+                            llaisys::tensor_t &v,
+                            size_t token_idx) {
+    (void)token_idx;
+    ASSERT(layer < meta_.nlayer, "StreamingCache::append: layer out of range");
+    ASSERT(k != nullptr && v != nullptr, "StreamingCache::append: k/v tensor is null");
+    ASSERT(k->shape().size() == 3 && v->shape().size() == 3,
+           "StreamingCache::append: k/v must be [seq,n_kv,head_dim]");
+    ASSERT(k->dtype() == dtype_ && v->dtype() == dtype_,
+           "StreamingCache::append: k/v dtype mismatch with cache dtype");
+    ASSERT(k->shape()[1] == meta_.n_kv_heads && k->shape()[2] == meta_.head_dim,
+           "StreamingCache::append: k shape mismatch");
+    ASSERT(k->shape() == v->shape(), "StreamingCache::append: k/v shape mismatch");
+    ASSERT(k->isContiguous() && v->isContiguous(), "StreamingCache::append: k/v must be contiguous");
+    CHECK_SAME_DEVICE(k_ring_[layer], k, v_ring_[layer], v);
+    llaisys::core::context().setDevice(device_, device_id_);
+
+    size_t seq = k->shape()[0];
+    size_t len = len_[layer];
+    size_t t = 0;
+    // 前 sinks 个 token 写入 sink 区
+    if (len < sinks_) {
+        size_t n = std::min(seq, sinks_ - len);
+        copy_rows(k_sink_[layer], len, k, 0, n);
+        copy_rows(v_sink_[layer], len, v, 0, n);
+        t = n;
+    }
+    // 其余 token 写入环形区，本批中会被覆盖的前缀直接跳过
+    size_t ring_base = len + t - sinks_;
+    if (seq - t > window_) {
+        ring_base += seq - t - window_;
+        t = seq - window_;
+    }
+    while (t < seq) {
+        size_t slot = ring_base % window_;
+        size_t n = std::min(seq - t, window_ - slot);
+        copy_rows(k_ring_[layer], slot, k, t, n);
+        copy_rows(k_ring_[layer], slot + window_, k, t, n);
+        copy_rows(v_ring_[layer], slot, v, t, n);
+        copy_rows(v_ring_[layer], slot + window_, v, t, n);
+        ring_base += n;
+        t += n;
+    }
+    len_[layer] += seq;
+    size_t cur_bytes = len_[layer] * llaisys::utils::dsize(dtype_);
+    if (cur_bytes > used_bytes_) {
+        used_bytes_ = cur_bytes;
+    }
+}
+
+void StreamingCache::get(llaisys::tensor_t &k, llaisys::tensor_t &v,
+                         size_t layer) {
+    ASSERT(layer < meta_.nlayer, "StreamingCache::get: layer out of range");
+    size_t len = len_[layer];
+    size_t n_sink = std::min(len, sinks_);
+    size_t n_ring = std::min(len - n_sink, window_);
+    size_t begin = (len - n_sink > window_) ? (len - n_sink) % window_ : 0;
+    size_t n = n_sink + n_ring;
+    if (n_sink > 0) {
+        auto k_src = k_sink_[layer]->slice(0, 0, n_sink);
+        ops::rope(k_rot_->slice(0, 0, n_sink), k_src, pos_ids_->slice(0, 0, n_sink), rope_cos_, rope_sin_);
+        ops::rearrange(v_cat_->slice(0, 0, n_sink), v_sink_[layer]->slice(0, 0, n_sink));
+    }
+    if (n_ring > 0) {
+        auto k_src = k_ring_[layer]->slice(0, begin, begin + n_ring);
+        ops::rope(k_rot_->slice(0, n_sink, n), k_src, pos_ids_->slice(0, n_sink, n), rope_cos_, rope_sin_);
+        ops::rearrange(v_cat_->slice(0, n_sink, n), v_ring_[layer]->slice(0, begin, begin + n_ring));
+    }
+    k = k_rot_->slice(0, 0, n);
+    v = v_cat_->slice(0, 0, n);
+}
+
+StreamingCache::~StreamingCache() {
+    k_sink_.clear();
+    v_sink_.clear();
+    k_ring_.clear();
+    v_ring_.clear();
+    k_rot_.reset();
+    v_cat_.reset();
+    pos_ids_.reset();
+    rope_cos_.reset();
+    rope_sin_.reset();
+    len_.clear();
+    allocator_ = nullptr;
+    ptr_ = nullptr;
+    total_bytes_ = 0;
+    used_bytes_ = 0;
+}
+} // namespace llaisys::KVcache
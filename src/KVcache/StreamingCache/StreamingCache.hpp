@@ -0,0 +1,56 @@
+#pragma once
+#include "../../utils.hpp"
+#include "../KVcacheBase.hpp"
+namespace llaisys::KVcache {
+// StreamingLLM 风格的KVcache：每层保留前 sink_tokens 个 token 与最近 streaming_window 个 token，
+// 中间的 token 被淘汰，显存与单步延迟不随对话长度增长
+class StreamingCache : public KVcacheBase {
+private:
+    size_t sinks_ = 0;
+    size_t window_ = 0;
+    float rope_theta_ = 10000.0f;
+    // 每层已写入的 token 总数（包含已淘汰的）
+    std::vector<size_t> len_;
+    // rope 前的 K 与 V：sink 区 [sinks, n_kv, d]，最近窗口为双写环形区 [2 * window, n_kv, d]
+    std::vector<llaisys::tensor_t> k_sink_;
+    std::vector<llaisys::tensor_t> v_sink_;
+    std::vector<llaisys::tensor_t> k_ring_;
+    std::vector<llaisys::tensor_t> v_ring_;
+    // get 的输出缓冲 [sinks + window, n_kv, d]，各层依次复用
+    llaisys::tensor_t k_rot_;
+    llaisys::tensor_t v_cat_;
+    // 缓存内位置 0..sinks+window-1
+    llaisys::tensor_t pos_ids_;
+    // 缓存内位置的 rope 表 [sinks + window, d/2]
+    llaisys::tensor_t rope_cos_;
+    llaisys::tensor_t rope_sin_;
+
+    void copy_rows(llaisys::tensor_t &dst, size_t row, llaisys::tensor_t &src, size_t src_row, size_t nrows);
+
+public:
+    ~StreamingCache() override;
+    void reset() override;
+    static KVcache_t create(llaisys::KVcache::CacheMeta meta_,
+                            llaisysDeviceType_t device_, int device_id, llaisysDataType_t dtype_,
+                            llaisys::KVcache::IKVAllocator *allocator_ = nullptr) {
+        auto cache = std::make_shared<StreamingCache>();
+        cache->init(meta_, device_, device_id, dtype_, allocator_);
+        LOG_INFO("StreamingCache::create:complete sinks=" << cache->sinks_ << " window=" << cache->window_);
+        return cache;
+    }
+
+    void init(llaisys::KVcache::CacheMeta meta_,
+              llaisysDeviceType_t device_, int device_id, llaisysDataType_t dtype_,
+              llaisys::KVcache::IKVAllocator *allocator_) override;
+    void reserve(size_t max_seq) override;
+    bool ensure(size_t seq_len) override;
+    void append(size_t layer, llaisys::tensor_t &k,
+                llaisys::tensor_t &v,
+                size_t token_idx = 0) override; // k 为 rope 前的 K:[seq,nkvhead,d]
+    void get(llaisys::tensor_t &k, llaisys::tensor_t &v,
+             size_t layer) override; // sink + 最近窗口，K 按缓存内位置旋转
+    size_t rope_offset(size_t layer, size_t seq) const;
+    size_t window() const { return window_; }
+};
+
+} // namespace llaisys::KVcache
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "../CacheHandle.hpp"
+#include "StreamingCache.hpp"
+
+namespace llaisys::KVcache {
+
+class StreamingCacheHandle : public CacheHandle {
+public:
+    explicit StreamingCacheHandle(std::shared_ptr<StreamingCache> cache) : cache_(std::move(cache)) {}
+    ~StreamingCacheHandle() override = default;
+
+    void reset() override { cache_->reset(); }
+    size_t seq_len() const override { return cache_->seq_len(); }
+
+    void append(size_t layer, llaisys::tensor_t& k, llaisys::tensor_t& v,
+                size_t token_idx = 0) override {
+        cache_->append(layer, k, v, token_idx);
+    }
+
+    void get(llaisys::tensor_t& k, llaisys::tensor_t& v, size_t layer) override {
+        cache_->get(k, v, layer);
+    }
+
+    bool rotates_keys() const override { return true; }
+    size_t rope_offset(size_t layer, size_t seq) const override { return cache_->rope_offset(layer, seq); }
+    size_t max_step_tokens() const override { return cache_->window(); }
+
+private:
+    std::shared_ptr<StreamingCache> cache_;
+};
+
+} // namespace llaisys::KVcache
@@ -1,6 +1,8 @@
 #include "PagedCache.hpp"
 
 #include "../../core/llaisys_core.hpp"
+#include "../../ops/paged_kv_scatter/op.hpp"
+#include "../../ops/rope_append_kv/op.hpp"
 
 #include <algorithm>
 #include <cstddef>
@@ -24,9 +26,6 @@ PagedCache::~PagedCache() {
     manager_.reset();
     layer_seq_lens_.clear();
     paged_kv_layers_.clear();
-    kv_indptr_.reset();
-    kv_indices_.reset();
-    kv_last_page_len_.reset();
     allocator_ = nullptr;
     ptr_ = nullptr;
     total_bytes_ = 0;
@@ -78,9 +77,12 @@ void PagedCache::rebuild_manager(size_t max_seq) {
             llaisys::Tensor::create(page_shape, dtype_, device_, device_id_));
     }
 
-    kv_indptr_ = llaisys::Tensor::create({2}, LLAISYS_DTYPE_I32, device_, device_id_);
-    kv_last_page_len_ = llaisys::Tensor::create({1}, LLAISYS_DTYPE_I32, device_, device_id_);
-    kv_indices_ = llaisys::Tensor::create({computed_num_blocks_}, LLAISYS_DTYPE_I32, device_, device_id_);
+    metadata_.init(computed_num_blocks_, device_, device_id_);
+    // 两个 slot mapping 都在这里分配：推理线程（如 Engine 的工作线程）上按需分配的缓冲会随该线程的 runtime 失效
+    slot_mapping_ = llaisys::Tensor::create({meta_.max_seq}, LLAISYS_DTYPE_I64, device_, device_id_);
+    slots_host_.clear();
+    gather_slots_ = llaisys::Tensor::create({meta_.max_seq}, LLAISYS_DTYPE_I64, device_, device_id_);
+    gather_slots_host_.clear();
 
     const int64_t one_page_kv_bytes = config_.page_size_bytes_all_layers();
     total_bytes_ =
@@ -98,35 +100,51 @@ void PagedCache::update_used_bytes() {
     used_bytes_ = context_len * static_cast<size_t>(config_.dtype_size);
 }
 
+// 增量更新默认请求的分页元数据，不同步 stream
 void PagedCache::refresh_page_metadata() {
     ASSERT(manager_ != nullptr, "PagedCache::refresh_page_metadata: manager is null");
-    const std::vector<int32_t> row = manager_->get_block_table_row(default_request_id_);
-    const int context_len = manager_->get_context_len(default_request_id_);
-    const int num_pages = static_cast<int>(row.size());
-    const int last_page_len =
-        (context_len == 0) ? 0 : ((context_len - 1) % config_.block_size) + 1;
-
-    std::vector<int32_t> indptr_host{0, num_pages};
-    std::vector<int32_t> last_host{last_page_len};
-    std::vector<int32_t> indices_host(computed_num_blocks_, -1);
-    for (int i = 0; i < num_pages; ++i) {
-        indices_host[static_cast<size_t>(i)] = row[static_cast<size_t>(i)];
+    llaisys::core::context().setDevice(device_, device_id_);
+    metadata_.update(default_request_id_, manager_->block_table(), manager_->get_row_idx(default_request_id_),
+                     manager_->get_context_len(default_request_id_));
+}
+
+// slots 上传到常驻缓冲 buf，host 记录最近一次上传的内容，相同时不重复上传
+tensor_t PagedCache::upload_slots(tensor_t& buf, std::vector<int64_t>& host, const std::vector<int64_t>& slots) {
+    if (buf == nullptr || buf->shape()[0] < slots.size()) {
+        buf = llaisys::Tensor::create({std::max(slots.size(), meta_.max_seq)}, LLAISYS_DTYPE_I64, device_, device_id_);
+        host.clear();
+    }
+    if (slots != host) {
+        host = slots;
+        llaisys::core::context().setDevice(device_, device_id_);
+        auto &runtime = llaisys::core::context().runtime();
+        const llaisysMemcpyKind_t memcpy_kind =
+            (device_ == LLAISYS_DEVICE_CPU) ? LLAISYS_MEMCPY_H2H : LLAISYS_MEMCPY_H2D;
+        runtime.api()->memcpy_async(buf->data(), host.data(), host.size() * sizeof(int64_t), memcpy_kind,
+                                    runtime.stream());
     }
+    return buf->slice(0, 0, slots.size());
+}
 
-    llaisys::core::context().setDevice(device_, device_id_);
-    auto &runtime = llaisys::core::context().runtime();
-    auto api = runtime.api();
-    auto stream = runtime.stream();
-    const llaisysMemcpyKind_t kind =
-        (device_ == LLAISYS_DEVICE_CPU) ? LLAISYS_MEMCPY_H2H : LLAISYS_MEMCPY_H2D;
+// 本步的 slot mapping 上传到常驻的设备缓冲，各层 slot 相同时只上传一次
+tensor_t PagedCache::device_slots(const std::vector<int64_t>& slots) {
+    return upload_slots(slot_mapping_, slots_host_, slots);
+}
 
-    api->memcpy_async(kv_indptr_->data(), indptr_host.data(),
-                      indptr_host.size() * sizeof(int32_t), kind, stream);
-    api->memcpy_async(kv_last_page_len_->data(), last_host.data(),
-                      last_host.size() * sizeof(int32_t), kind, stream);
-    api->memcpy_async(kv_indices_->data(), indices_host.data(),
-                      indices_host.size() * sizeof(int32_t), kind, stream);
-    api->stream_synchronize(stream);
+void PagedCache::read_tokens_from_pages(
+    size_t layer,
+    const std::vector<int64_t>& slots,
+    llaisys::tensor_t& k,
+    llaisys::tensor_t& v) {
+    ASSERT(layer < paged_kv_layers_.size(), "PagedCache::read_tokens_from_pages: layer out of range");
+    const std::vector<size_t> shape{slots.size(), meta_.n_kv_heads, meta_.head_dim};
+    k = llaisys::Tensor::create(shape, dtype_, device_, device_id_);
+    v = llaisys::Tensor::create(shape, dtype_, device_, device_id_);
+    if (slots.empty()) {
+        return;
+    }
+    llaisys::ops::paged_kv_gather(k, v, paged_kv_layers_[layer],
+                                  upload_slots(gather_slots_, gather_slots_host_, slots));
 }
 
 void PagedCache::write_tokens_to_pages(
@@ -135,59 +153,28 @@ void PagedCache::write_tokens_to_pages(
     llaisys::tensor_t& k,
     llaisys::tensor_t& v) {
     ASSERT(layer < paged_kv_layers_.size(), "PagedCache::write_tokens_to_pages: layer out of range");
-    ASSERT(k->isContiguous() && v->isContiguous(), "PagedCache::write_tokens_to_pages: k/v must be contiguous");
-
-    const int seq = static_cast<int>(slots.size());
-    const int num_kv_heads = static_cast<int>(meta_.n_kv_heads);
-    const int head_dim = static_cast<int>(meta_.head_dim);
-    const int page_size = config_.block_size;
-    const size_t elem_bytes = static_cast<size_t>(config_.dtype_size);
+    ASSERT(slots.size() == k->shape()[0], "PagedCache::write_tokens_to_pages: slots/k seq mismatch");
+    if (slots.empty()) {
+        return;
+    }
+    // 一次 scatter 写入所有 (token, head)，不再逐行 memcpy 与同步
+    llaisys::ops::paged_kv_scatter(paged_kv_layers_[layer], k, v, device_slots(slots));
+}
 
-    CHECK_SAME_DEVICE(paged_kv_layers_[layer], k, v);
-    llaisys::core::context().setDevice(device_, device_id_);
-    auto &runtime = llaisys::core::context().runtime();
-    auto api = runtime.api();
-    auto stream = runtime.stream();
-    const llaisysMemcpyKind_t memcpy_kind =
-        (device_ == LLAISYS_DEVICE_CPU) ? LLAISYS_MEMCPY_H2H : LLAISYS_MEMCPY_D2D;
-
-    std::byte* dst_base = paged_kv_layers_[layer]->data();
-    const std::byte* k_src = k->data();
-    const std::byte* v_src = v->data();
-
-    for (int t = 0; t < seq; ++t) {
-        const int64_t slot = slots[static_cast<size_t>(t)];
-        ASSERT(slot >= 0, "PagedCache::write_tokens_to_pages: invalid slot");
-        const int page_idx = static_cast<int>(slot / page_size);
-        const int offset = static_cast<int>(slot % page_size);
-        ASSERT(page_idx >= 0 && static_cast<size_t>(page_idx) < computed_num_blocks_,
-               "PagedCache::write_tokens_to_pages: page index out of range");
-
-        for (int h = 0; h < num_kv_heads; ++h) {
-            const int64_t k_dst_elem =
-                ((((static_cast<int64_t>(page_idx) * 2 + 0) * num_kv_heads + h) * page_size + offset) *
-                 head_dim);
-            const int64_t v_dst_elem =
-                ((((static_cast<int64_t>(page_idx) * 2 + 1) * num_kv_heads + h) * page_size + offset) *
-                 head_dim);
-            const int64_t src_elem =
-                ((static_cast<int64_t>(t) * num_kv_heads + h) * head_dim);
-
-            api->memcpy_async(
-                dst_base + static_cast<size_t>(k_dst_elem) * elem_bytes,
-                k_src + static_cast<size_t>(src_elem) * elem_bytes,
-                static_cast<size_t>(head_dim) * elem_bytes,
-                memcpy_kind,
-                stream);
-            api->memcpy_async(
-                dst_base + static_cast<size_t>(v_dst_elem) * elem_bytes,
-                v_src + static_cast<size_t>(src_elem) * elem_bytes,
-                static_cast<size_t>(head_dim) * elem_bytes,
-                memcpy_kind,
-                stream);
-        }
+void PagedCache::write_tokens_to_pages_rope(
+    size_t layer,
+    const std::vector<int64_t>& slots,
+    llaisys::tensor_t& k,
+    llaisys::tensor_t& v,
+    llaisys::tensor_t pos_ids,
+    llaisys::tensor_t cos,
+    llaisys::tensor_t sin) {
+    ASSERT(layer < paged_kv_layers_.size(), "PagedCache::write_tokens_to_pages_rope: layer out of range");
+    ASSERT(slots.size() == k->shape()[0], "PagedCache::write_tokens_to_pages_rope: slots/k seq mismatch");
+    if (slots.empty()) {
+        return;
     }
-    api->stream_synchronize(stream);
+    llaisys::ops::rope_append_kv_paged(paged_kv_layers_[layer], k, v, pos_ids, cos, sin, device_slots(slots));
 }
 
 void PagedCache::init(
@@ -278,11 +265,15 @@ void PagedCache::append(size_t layer, llaisys::tensor_t& k, llaisys::tensor_t& v
     }
 }
 
+// 默认请求的整段上下文，按位置顺序从页中读出
 void PagedCache::get(llaisys::tensor_t& k, llaisys::tensor_t& v, size_t layer) {
-    (void)k;
-    (void)v;
-    (void)layer;
-    throw std::runtime_error("PagedCache::get is not supported; use pagedAttention interfaces");
+    ASSERT(manager_ != nullptr, "PagedCache::get: manager is null");
+    ASSERT(default_request_id_ >= 0, "PagedCache::get: default request is invalid");
+    std::vector<int> positions(static_cast<size_t>(manager_->get_context_len(default_request_id_)));
+    for (size_t i = 0; i < positions.size(); ++i) {
+        positions[i] = static_cast<int>(i);
+    }
+    read_tokens_from_pages(layer, manager_->get_slot_mapping(default_request_id_, positions), k, v);
 }
 
 int PagedCache::add_request() {
@@ -344,6 +335,11 @@ int PagedCache::get_context_len(int request_id) const {
     return manager_->get_context_len(request_id);
 }
 
+int PagedCache::get_row_idx(int request_id) const {
+    ASSERT(manager_ != nullptr, "PagedCache::get_row_idx(request): manager is null");
+    return manager_->get_row_idx(request_id);
+}
+
 const int32_t* PagedCache::block_table_data() const {
     ASSERT(manager_ != nullptr, "PagedCache::block_table_data: manager is null");
     return manager_->block_table_data();
@@ -360,15 +356,15 @@ tensor_t PagedCache::paged_kv_data(size_t layer) const {
 }
 
 tensor_t PagedCache::kv_indptr() const {
-    return kv_indptr_;
+    return metadata_.indptr();
 }
 
 tensor_t PagedCache::kv_indices() const {
-    return kv_indices_;
+    return metadata_.indices();
 }
 
 tensor_t PagedCache::kv_last_page_len() const {
-    return kv_last_page_len_;
+    return metadata_.last_page_len();
 }
 
 int PagedCache::num_free_blocks() const {
@@ -3,6 +3,7 @@
 #include "../../utils.hpp"
 #include "../KVcacheBase.hpp"
 #include "pagedCache_manager.hpp"
+#include "paged_metadata.hpp"
 #include "../../tensor/tensor.hpp"
 
 #include <memory>
@@ -49,6 +50,7 @@ public:
     int64_t get_slot_for_token(int request_id, int position) const;
     std::vector<int32_t> get_block_table_row(int request_id) const;
     int get_context_len(int request_id) const;
+    int get_row_idx(int request_id) const;
 
     const int32_t* block_table_data() const;
     const ::BlockTable& block_table() const;
@@ -76,6 +78,23 @@ public:
                                const std::vector<int64_t>& slots,
                                llaisys::tensor_t& k,
                                llaisys::tensor_t& v);
+    // k 为 rope 前的 K，按 pos_ids 查表旋转后与 v 一起写入 slots 对应的页内位置
+    void write_tokens_to_pages_rope(size_t layer,
+                                    const std::vector<int64_t>& slots,
+                                    llaisys::tensor_t& k,
+                                    llaisys::tensor_t& v,
+                                    llaisys::tensor_t pos_ids,
+                                    llaisys::tensor_t cos,
+                                    llaisys::tensor_t sin);
+
+    // 按 slots 从页中读出 k/v（新建的 [slots.size(), n_kv_heads, head_dim] 张量），续接 prefill 用它取得已有上下文
+    void read_tokens_from_pages(size_t layer,
+                                const std::vector<int64_t>& slots,
+                                llaisys::tensor_t& k,
+                                llaisys::tensor_t& v);
+
+    // slots 上传到常驻的设备端 slot mapping（内容未变时不重复上传），返回其前 slots.size() 个元素
+    tensor_t device_slots(const std::vector<int64_t>& slots);
 
     llaisysDeviceType_t cache_device() const { return device_; }
     int cache_device_id() const { return device_id_; }
@@ -87,6 +106,7 @@ private:
     void rebuild_manager(size_t max_seq);
     void update_used_bytes();
     void refresh_page_metadata();
+    tensor_t upload_slots(tensor_t& buf, std::vector<int64_t>& host, const std::vector<int64_t>& slots);
 
 private:
     KVCacheConfig config_{};
@@ -95,9 +115,13 @@ private:
     size_t computed_num_blocks_ = 0;
     std::vector<size_t> layer_seq_lens_;
     std::vector<tensor_t> paged_kv_layers_;
-    tensor_t kv_indptr_;
-    tensor_t kv_indices_;
-    tensor_t kv_last_page_len_;
+    PagedMetadata metadata_;
+    // 常驻的设备端 slot mapping 及其最近一次上传的内容
+    tensor_t slot_mapping_;
+    std::vector<int64_t> slots_host_;
+    // 读取整段上下文用的 slot mapping，与写入用的分开，各层交替写入与读取时两者都只上传一次
+    tensor_t gather_slots_;
+    std::vector<int64_t> gather_slots_host_;
 };
 
 } // namespace llaisys::KVcache
@@ -1,7 +1,6 @@
 #include "PagedCacheHandle.hpp"
 #include "../../core/llaisys_core.hpp"
 #include "../../utils.hpp"
-#include <stdexcept>
 
 namespace llaisys::KVcache {
 
@@ -11,13 +10,8 @@ PagedCacheHandle::PagedCacheHandle(std::shared_ptr<PagedCache> paged_cache)
     request_id_ = paged_cache_->add_request();
     context_len_ = 0;
 
-    auto device = paged_cache_->cache_device();
-    auto device_id = paged_cache_->cache_device_id();
-    auto num_blocks = paged_cache_->computed_num_blocks();
-
-    kv_indptr_ = llaisys::Tensor::create({2}, LLAISYS_DTYPE_I32, device, device_id);
-    kv_last_page_len_ = llaisys::Tensor::create({1}, LLAISYS_DTYPE_I32, device, device_id);
-    kv_indices_ = llaisys::Tensor::create({num_blocks}, LLAISYS_DTYPE_I32, device, device_id);
+    metadata_.init(paged_cache_->computed_num_blocks(), paged_cache_->cache_device(),
+                   paged_cache_->cache_device_id());
     refresh_metadata();
 }
 
@@ -33,6 +27,7 @@ void PagedCacheHandle::reset() {
     }
     request_id_ = paged_cache_->add_request();
     context_len_ = 0;
+    context_slots_.clear();
     refresh_metadata();
 }
 
@@ -40,15 +35,8 @@ size_t PagedCacheHandle::seq_len() const {
     return context_len_;
 }
 
-void PagedCacheHandle::append(size_t layer, llaisys::tensor_t& k, llaisys::tensor_t& v,
-                              size_t token_idx) {
-    ASSERT(paged_cache_ != nullptr, "PagedCacheHandle::append: paged_cache is null");
-    ASSERT(request_id_ >= 0, "PagedCacheHandle::append: invalid request_id");
-    ASSERT(k != nullptr && v != nullptr, "PagedCacheHandle::append: k/v is null");
-
-    const int seq = static_cast<int>(k->shape()[0]);
-    if (seq <= 0) return;
-
+// layer 0 负责为本批 token 分配页，各层按对话位置取得相同的 slot
+std::vector<int64_t> PagedCacheHandle::slots_for(size_t layer, int seq, size_t token_idx) {
     const int cur_context = paged_cache_->get_context_len(request_id_);
     const int target_context = static_cast<int>(token_idx) + seq;
     if (layer == 0 && target_context > cur_context) {
@@ -61,7 +49,19 @@ void PagedCacheHandle::append(size_t layer, llaisys::tensor_t& k, llaisys::tenso
     for (int i = 0; i < seq; ++i) {
         positions[static_cast<size_t>(i)] = static_cast<int>(token_idx) + i;
     }
-    auto slots = paged_cache_->get_slot_mapping(request_id_, positions);
+    return paged_cache_->get_slot_mapping(request_id_, positions);
+}
+
+void PagedCacheHandle::append(size_t layer, llaisys::tensor_t& k, llaisys::tensor_t& v,
+                              size_t token_idx) {
+    ASSERT(paged_cache_ != nullptr, "PagedCacheHandle::append: paged_cache is null");
+    ASSERT(request_id_ >= 0, "PagedCacheHandle::append: invalid request_id");
+    ASSERT(k != nullptr && v != nullptr, "PagedCacheHandle::append: k/v is null");
+
+    const int seq = static_cast<int>(k->shape()[0]);
+    if (seq <= 0) return;
+
+    auto slots = slots_for(layer, seq, token_idx);
     paged_cache_->write_tokens_to_pages(layer, slots, k, v);
 
     if (layer == 0) {
@@ -70,9 +70,49 @@ void PagedCacheHandle::append(size_t layer, llaisys::tensor_t& k, llaisys::tenso
     }
 }
 
+bool PagedCacheHandle::append_rope(size_t layer, llaisys::tensor_t& k, llaisys::tensor_t& v,
+                                   llaisys::tensor_t pos_ids, llaisys::tensor_t cos, llaisys::tensor_t sin,
+                                   size_t token_idx) {
+    ASSERT(paged_cache_ != nullptr, "PagedCacheHandle::append_rope: paged_cache is null");
+    ASSERT(request_id_ >= 0, "PagedCacheHandle::append_rope: invalid request_id");
+    ASSERT(k != nullptr && v != nullptr, "PagedCacheHandle::append_rope: k/v is null");
+
+    const int seq = static_cast<int>(k->shape()[0]);
+    if (seq <= 0) return true;
+
+    auto slots = slots_for(layer, seq, token_idx);
+    paged_cache_->write_tokens_to_pages_rope(layer, slots, k, v, pos_ids, cos, sin);
+
+    if (layer == 0) {
+        context_len_ = static_cast<size_t>(paged_cache_->get_context_len(request_id_));
+        refresh_metadata();
+    }
+    return true;
+}
+
+llaisys::tensor_t PagedCacheHandle::prepare_slots(size_t token_idx, size_t seq) {
+    ASSERT(paged_cache_ != nullptr, "PagedCacheHandle::prepare_slots: paged_cache is null");
+    ASSERT(request_id_ >= 0, "PagedCacheHandle::prepare_slots: invalid request_id");
+    if (seq == 0) return nullptr;
+
+    auto slots = slots_for(0, static_cast<int>(seq), token_idx);
+    llaisys::tensor_t device_slots = paged_cache_->device_slots(slots);
+    context_len_ = static_cast<size_t>(paged_cache_->get_context_len(request_id_));
+    refresh_metadata();
+    return device_slots;
+}
+
 void PagedCacheHandle::get(llaisys::tensor_t& k, llaisys::tensor_t& v, size_t layer) {
-    (void)k; (void)v; (void)layer;
-    throw std::runtime_error("PagedCacheHandle::get is not supported; use pagedAttention interfaces");
+    ASSERT(paged_cache_ != nullptr, "PagedCacheHandle::get: paged_cache is null");
+    ASSERT(request_id_ >= 0, "PagedCacheHandle::get: invalid request_id");
+    if (context_slots_.size() != context_len_) {
+        std::vector<int> positions(context_len_);
+        for (size_t i = 0; i < context_len_; ++i) {
+            positions[i] = static_cast<int>(i);
+        }
+        context_slots_ = paged_cache_->get_slot_mapping(request_id_, positions);
+    }
+    paged_cache_->read_tokens_from_pages(layer, context_slots_, k, v);
 }
 
 llaisys::tensor_t PagedCacheHandle::paged_kv_data(size_t layer) const {
@@ -80,54 +120,27 @@ llaisys::tensor_t PagedCacheHandle::paged_kv_data(size_t layer) const {
 }
 
 llaisys::tensor_t PagedCacheHandle::kv_indptr() const {
-    return kv_indptr_;
+    return metadata_.indptr();
 }
 
 llaisys::tensor_t PagedCacheHandle::kv_indices() const {
-    return kv_indices_;
+    return metadata_.indices();
 }
 
 llaisys::tensor_t PagedCacheHandle::kv_last_page_len() const {
-    return kv_last_page_len_;
+    return metadata_.last_page_len();
 }
 
 int PagedCacheHandle::block_size() const {
     return paged_cache_->block_size();
 }
 
+// 只上传新增的 block id 与变化的 indptr / last_page_len，不同步 stream
 void PagedCacheHandle::refresh_metadata() {
     ASSERT(paged_cache_ != nullptr, "PagedCacheHandle::refresh_metadata: paged_cache is null");
-
-    const auto row = paged_cache_->get_block_table_row(request_id_);
-    const int context = paged_cache_->get_context_len(request_id_);
-    const int num_pages = static_cast<int>(row.size());
-    const int bs = paged_cache_->cache_config().block_size;
-    const int last_page_len = (context == 0) ? 0 : ((context - 1) % bs) + 1;
-
-    auto num_blocks = paged_cache_->computed_num_blocks();
-    std::vector<int32_t> indptr_host{0, num_pages};
-    std::vector<int32_t> last_host{last_page_len};
-    std::vector<int32_t> indices_host(num_blocks, -1);
-    for (int i = 0; i < num_pages; ++i) {
-        indices_host[static_cast<size_t>(i)] = row[static_cast<size_t>(i)];
-    }
-
-    auto device = paged_cache_->cache_device();
-    auto device_id = paged_cache_->cache_device_id();
-    llaisys::core::context().setDevice(device, device_id);
-    auto& runtime = llaisys::core::context().runtime();
-    auto api = runtime.api();
-    auto stream = runtime.stream();
-    const llaisysMemcpyKind_t kind =
-        (device == LLAISYS_DEVICE_CPU) ? LLAISYS_MEMCPY_H2H : LLAISYS_MEMCPY_H2D;
-
-    api->memcpy_async(kv_indptr_->data(), indptr_host.data(),
-                      indptr_host.size() * sizeof(int32_t), kind, stream);
-    api->memcpy_async(kv_last_page_len_->data(), last_host.data(),
-                      last_host.size() * sizeof(int32_t), kind, stream);
-    api->memcpy_async(kv_indices_->data(), indices_host.data(),
-                      indices_host.size() * sizeof(int32_t), kind, stream);
-    api->stream_synchronize(stream);
+    llaisys::core::context().setDevice(paged_cache_->cache_device(), paged_cache_->cache_device_id());
+    metadata_.update(request_id_, paged_cache_->block_table(), paged_cache_->get_row_idx(request_id_),
+                     paged_cache_->get_context_len(request_id_));
 }
 
 } // namespace llaisys::KVcache
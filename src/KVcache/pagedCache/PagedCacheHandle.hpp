@@ -15,7 +15,11 @@ public:
 
     void append(size_t layer, llaisys::tensor_t& k, llaisys::tensor_t& v,
                 size_t token_idx = 0) override;
+    bool append_rope(size_t layer, llaisys::tensor_t& k, llaisys::tensor_t& v, llaisys::tensor_t pos_ids,
+                     llaisys::tensor_t cos, llaisys::tensor_t sin, size_t token_idx = 0) override;
+    // 按位置顺序从页中读出已写入的整段上下文 [seq_len, n_kv_heads, head_dim]
     void get(llaisys::tensor_t& k, llaisys::tensor_t& v, size_t layer) override;
+    llaisys::tensor_t prepare_slots(size_t token_idx, size_t seq) override;
 
     bool is_paged() const override { return true; }
     llaisys::tensor_t paged_kv_data(size_t layer) const override;
@@ -26,13 +30,14 @@ public:
 
 private:
     void refresh_metadata();
+    std::vector<int64_t> slots_for(size_t layer, int seq, size_t token_idx);
 
     std::shared_ptr<PagedCache> paged_cache_;
     int request_id_ = -1;
     size_t context_len_ = 0;
-    llaisys::tensor_t kv_indptr_;
-    llaisys::tensor_t kv_indices_;
-    llaisys::tensor_t kv_last_page_len_;
+    PagedMetadata metadata_;
+    // 上下文 [0, context_len_) 的 slot，长度变化时重新计算，各层共用
+    std::vector<int64_t> context_slots_;
 };
 
 } // namespace llaisys::KVcache
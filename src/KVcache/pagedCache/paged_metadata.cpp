@@ -0,0 +1,95 @@
+#include "paged_metadata.hpp"
+
+#include "../../core/llaisys_core.hpp"
+#include "../../utils.hpp"
+
+#include <algorithm>
+
+namespace llaisys::KVcache {
+
+PagedMetadata::~PagedMetadata() {
+    release();
+}
+
+void PagedMetadata::release() {
+    if (host_ != nullptr) {
+        llaisys::core::context().setDevice(device_, device_id_);
+        llaisys::core::context().runtime().api()->free_host(host_);
+        host_ = nullptr;
+    }
+}
+
+void PagedMetadata::init(size_t num_blocks, llaisysDeviceType_t device, int device_id) {
+    release();
+    device_ = device;
+    device_id_ = device_id;
+    num_blocks_ = num_blocks;
+    indptr_ = llaisys::Tensor::create({2}, LLAISYS_DTYPE_I32, device, device_id);
+    last_page_len_ = llaisys::Tensor::create({1}, LLAISYS_DTYPE_I32, device, device_id);
+    indices_ = llaisys::Tensor::create({num_blocks}, LLAISYS_DTYPE_I32, device, device_id);
+
+    llaisys::core::context().setDevice(device_, device_id_);
+    auto &runtime = llaisys::core::context().runtime();
+    size_t host_elems = num_blocks + 2 * kScalarSlots;
+    host_ = static_cast<int32_t *>(runtime.api()->malloc_host(host_elems * sizeof(int32_t)));
+    ASSERT(host_ != nullptr, "PagedMetadata::init: failed to allocate host mirror");
+    // indices 只在初始化时整体写一次 -1，之后按页增量覆盖
+    std::fill(host_, host_ + num_blocks, -1);
+    upload(indices_->data(), host_, num_blocks);
+    next_slot_ = 0;
+    request_id_ = -1;
+    uploaded_pages_ = -1;
+    last_page_len_host_ = -1;
+}
+
+int32_t *PagedMetadata::scalar_slot() {
+    int32_t *slot = host_ + num_blocks_ + 2 * next_slot_;
+    next_slot_ = (next_slot_ + 1) % kScalarSlots;
+    return slot;
+}
+
+void PagedMetadata::upload(std::byte *dst, const int32_t *src, size_t count) {
+    if (count == 0) {
+        return;
+    }
+    auto &runtime = llaisys::core::context().runtime();
+    const llaisysMemcpyKind_t kind = (device_ == LLAISYS_DEVICE_CPU) ? LLAISYS_MEMCPY_H2H : LLAISYS_MEMCPY_H2D;
+    runtime.api()->memcpy_async(dst, src, count * sizeof(int32_t), kind, runtime.stream());
+}
+
+void PagedMetadata::update(int request_id, const ::BlockTable &table, int row_idx, int context_len) {
+    ASSERT(host_ != nullptr, "PagedMetadata::update: not initialized");
+    if (request_id != request_id_) {
+        request_id_ = request_id;
+        uploaded_pages_ = -1;
+    }
+    const int num_pages = table.num_blocks_of(row_idx);
+    ASSERT(num_pages >= 0 && static_cast<size_t>(num_pages) <= num_blocks_,
+           "PagedMetadata::update: page count out of range");
+    const int bs = table.block_size();
+    const int last_page_len = (context_len == 0) ? 0 : ((context_len - 1) % bs) + 1;
+
+    llaisys::core::context().setDevice(device_, device_id_);
+    // 只上传新增页的 block id
+    const int first = std::clamp(uploaded_pages_, 0, num_pages);
+    if (num_pages > first) {
+        const int32_t *row = table.data() + static_cast<size_t>(row_idx) * table.max_num_blocks_per_req();
+        std::copy(row + first, row + num_pages, host_ + first);
+        upload(indices_->data() + first * sizeof(int32_t), host_ + first, static_cast<size_t>(num_pages - first));
+    }
+    if (num_pages != uploaded_pages_) {
+        int32_t *slot = scalar_slot();
+        slot[0] = 0;
+        slot[1] = num_pages;
+        upload(indptr_->data(), slot, 2);
+        uploaded_pages_ = num_pages;
+    }
+    if (last_page_len != last_page_len_host_) {
+        int32_t *slot = scalar_slot();
+        slot[0] = last_page_len;
+        upload(last_page_len_->data(), slot, 1);
+        last_page_len_host_ = last_page_len;
+    }
+}
+
+} // namespace llaisys::KVcache
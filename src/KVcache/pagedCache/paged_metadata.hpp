@@ -0,0 +1,52 @@
+#pragma once
+
+#include "../../tensor/tensor.hpp"
+#include "block_table.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+namespace llaisys::KVcache {
+
+// 分页注意力元数据 kv_indptr / kv_indices / kv_last_page_len 的增量维护：
+// host 侧保留一份 pinned 镜像，请求的 block table 只会追加，每次只上传新增的 block id，
+// indptr 与 last_page_len 变化时才上传，全程不同步 stream
+class PagedMetadata {
+public:
+    PagedMetadata() = default;
+    PagedMetadata(const PagedMetadata &) = delete;
+    PagedMetadata &operator=(const PagedMetadata &) = delete;
+    ~PagedMetadata();
+
+    void init(size_t num_blocks, llaisysDeviceType_t device, int device_id);
+    // request_id 与上次不同（请求被替换）时从第 0 页重新上传
+    void update(int request_id, const ::BlockTable &table, int row_idx, int context_len);
+
+    llaisys::tensor_t indptr() const { return indptr_; }
+    llaisys::tensor_t indices() const { return indices_; }
+    llaisys::tensor_t last_page_len() const { return last_page_len_; }
+
+private:
+    // 标量走环形槽位：异步拷贝执行前 host 源不能被改写，每步最多占用 2 个槽位，
+    // 解码循环每步读回采样结果时已与 stream 同步，环长远大于两次同步之间的用量
+    static constexpr size_t kScalarSlots = 64;
+
+    int32_t *scalar_slot();
+    void upload(std::byte *dst, const int32_t *src, size_t count);
+    void release();
+
+    llaisysDeviceType_t device_ = LLAISYS_DEVICE_CPU;
+    int device_id_ = 0;
+    size_t num_blocks_ = 0;
+    // [num_blocks] 的 indices 镜像 + [kScalarSlots, 2] 的标量槽位
+    int32_t *host_ = nullptr;
+    size_t next_slot_ = 0;
+    int request_id_ = -1;
+    int uploaded_pages_ = 0;
+    int last_page_len_host_ = -1;
+    llaisys::tensor_t indptr_;
+    llaisys::tensor_t indices_;
+    llaisys::tensor_t last_page_len_;
+};
+
+} // namespace llaisys::KVcache
@@ -52,17 +52,22 @@ Context::~Context() {
 void Context::setDevice(llaisysDeviceType_t device_type, int device_id) {
     // If doest not match the current runtime.
     if (_current_runtime == nullptr || _current_runtime->deviceType() != device_type || _current_runtime->deviceId() != device_id) {
-        auto &runtimes = _runtime_map[device_type];
-        CHECK_ARGUMENT((size_t)device_id < runtimes.size() && device_id >= 0, "invalid device id");
+        auto &target = runtime(device_type, device_id);
         if (_current_runtime != nullptr) {
             _current_runtime->_deactivate();
         }
-        if (runtimes[device_id] == nullptr) {
-            runtimes[device_id] = new Runtime(device_type, device_id);
-        }
-        runtimes[device_id]->_activate();
-        _current_runtime = runtimes[device_id];
+        target._activate();
+        _current_runtime = &target;
+    }
+}
+
+Runtime &Context::runtime(llaisysDeviceType_t device_type, int device_id) {
+    auto &runtimes = _runtime_map[device_type];
+    CHECK_ARGUMENT((size_t)device_id < runtimes.size() && device_id >= 0, "invalid device id");
+    if (runtimes[device_id] == nullptr) {
+        runtimes[device_id] = new Runtime(device_type, device_id);
     }
+    return *runtimes[device_id];
 }
 
 Runtime &Context::runtime() {
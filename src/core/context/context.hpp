@@ -29,6 +29,8 @@ public:
 
     void setDevice(llaisysDeviceType_t device_type, int device_id);
     Runtime &runtime();
+    // Runtime of the given device, created on first use. Does not change the current device.
+    Runtime &runtime(llaisysDeviceType_t device_type, int device_id);
 
     friend Context &context();
 };
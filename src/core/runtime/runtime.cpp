@@ -16,9 +16,14 @@ Runtime::~Runtime() {
     if (!_is_active) {
         std::cerr << "Mallicious destruction of inactive runtime." << std::endl;
     }
+    // Tasks still queued on the stream may hold storages of this runtime: drain it before the allocator goes away.
+    try {
+        _api->stream_synchronize(_stream);
+    } catch (...) {
+    }
+    _api->destroy_stream(_stream);
     delete _allocator;
     _allocator = nullptr;
-    _api->destroy_stream(_stream);
     _api = nullptr;
 }
 
@@ -0,0 +1,99 @@
+#include "cpu_all_reduce.hpp"
+#include "cpu_convert.hpp"
+
+#include "../../utils.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace llaisys::device::cpu {
+namespace {
+// 按小块成批转成 f32，按 rank 顺序累加后转回一次，再拷给所有 rank
+template <typename T>
+void reduce_range_(const std::vector<std::byte *> &buffers, size_t begin, size_t end) {
+    constexpr size_t kTile = 512;
+    float acc[kTile], part[kTile];
+    T out[kTile];
+    for (size_t base = begin; base < end; base += kTile) {
+        size_t len = std::min(kTile, end - base);
+        std::fill(acc, acc + len, 0.0f);
+        for (std::byte *buf : buffers) {
+            to_f32(part, reinterpret_cast<const T *>(buf) + base, len);
+            for (size_t l = 0; l < len; ++l) {
+                acc[l] += part[l];
+            }
+        }
+        from_f32(out, acc, len);
+        for (std::byte *buf : buffers) {
+            std::memcpy(reinterpret_cast<T *>(buf) + base, out, len * sizeof(T));
+        }
+    }
+}
+} // namespace
+
+AllReduce::AllReduce(size_t world) : world_(world), buffers_(world, nullptr) {
+    ASSERT(world > 0, "AllReduce: world must be > 0");
+}
+
+void AllReduce::barrier() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (aborted_) {
+        throw std::runtime_error("AllReduce: aborted");
+    }
+    size_t generation = generation_;
+    if (++arrived_ == world_) {
+        arrived_ = 0;
+        ++generation_;
+        cv_.notify_all();
+        return;
+    }
+    cv_.wait(lock, [&] { return generation_ != generation || aborted_; });
+    if (generation_ == generation) {
+        throw std::runtime_error("AllReduce: aborted");
+    }
+}
+
+void AllReduce::abort() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    aborted_ = true;
+    cv_.notify_all();
+}
+
+void AllReduce::reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    aborted_ = false;
+    arrived_ = 0;
+    ++generation_;
+    std::fill(buffers_.begin(), buffers_.end(), nullptr);
+}
+
+void AllReduce::sum(size_t rank, std::byte *data, size_t numel, llaisysDataType_t dtype) {
+    ASSERT(rank < world_, "AllReduce: rank out of range");
+    if (world_ == 1) {
+        return;
+    }
+    buffers_[rank] = data;
+    // 第一次栅栏：所有 rank 的缓冲已登记且其上的写入已完成
+    barrier();
+    // 各 rank 只读写自己负责的区间，区间互不重叠
+    size_t begin = numel * rank / world_;
+    size_t end = numel * (rank + 1) / world_;
+    switch (dtype) {
+    case LLAISYS_DTYPE_F32:
+        reduce_range_<float>(buffers_, begin, end);
+        break;
+    case LLAISYS_DTYPE_BF16:
+        reduce_range_<llaisys::bf16_t>(buffers_, begin, end);
+        break;
+    case LLAISYS_DTYPE_F16:
+        reduce_range_<llaisys::fp16_t>(buffers_, begin, end);
+        break;
+    default:
+        abort();
+        EXCEPTION_UNSUPPORTED_DATATYPE(dtype);
+    }
+    // 第二次栅栏：所有区间写回完成后各 rank 才能继续使用结果或登记下一次的缓冲
+    barrier();
+}
+} // namespace llaisys::device::cpu
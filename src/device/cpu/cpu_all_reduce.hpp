@@ -0,0 +1,39 @@
+#pragma once
+
+#include "llaisys.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace llaisys::device::cpu {
+// 同一进程内 world 个 rank 之间的共享内存 all-reduce（求和）。
+// 各 rank 在自己的 stream 任务里调用 sum：全部到齐后每个 rank 负责一段元素，按 rank 顺序在 float 中累加，
+// 再写回所有 rank 的缓冲，因此各 rank 得到逐位一致的结果
+class AllReduce {
+public:
+    explicit AllReduce(size_t world);
+    AllReduce(const AllReduce &) = delete;
+    AllReduce &operator=(const AllReduce &) = delete;
+
+    size_t world() const { return world_; }
+    // 各 rank 的 data 必须形状、类型一致；返回时所有 rank 的 data 都已是求和结果
+    void sum(size_t rank, std::byte *data, size_t numel, llaisysDataType_t dtype);
+    // 某个 rank 失败后唤醒并让所有等待中与之后的 sum 抛出异常，避免其余 rank 永久阻塞
+    void abort();
+    // 失败的集合通信在所有 rank 上都退出后调用：清除中止状态并开始新一代，之后的 sum 恢复正常
+    void reset();
+
+private:
+    void barrier();
+
+    size_t world_;
+    std::vector<std::byte *> buffers_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    size_t arrived_ = 0;
+    size_t generation_ = 0;
+    bool aborted_ = false;
+};
+} // namespace llaisys::device::cpu
@@ -0,0 +1,169 @@
+// immintrin.h 须在 llaisys.h 之前包含：后者定义的 __C 宏与内建函数的形参同名
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define LLAISYS_CONVERT_X86 1
+#include <immintrin.h>
+#if defined(__GNUC__) && !defined(__clang__)
+// GCC 12 对 AVX-512 内建函数里的 _mm512_undefined_* 误报 maybe-uninitialized
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+#endif
+
+#include "cpu_convert.hpp"
+#include "cpu_isa.hpp"
+
+namespace llaisys::device::cpu {
+namespace {
+void bf16_to_f32_scalar(float *dst, const bf16_t *src, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        dst[i] = llaisys::utils::_bf16_to_f32(src[i]);
+    }
+}
+
+void f32_to_bf16_scalar(bf16_t *dst, const float *src, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        dst[i] = llaisys::utils::_f32_to_bf16(src[i]);
+    }
+}
+
+void f16_to_f32_scalar(float *dst, const fp16_t *src, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        dst[i] = llaisys::utils::_f16_to_f32(src[i]);
+    }
+}
+
+void f32_to_f16_scalar(fp16_t *dst, const float *src, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        dst[i] = llaisys::utils::_f32_to_f16(src[i]);
+    }
+}
+
+#ifdef LLAISYS_CONVERT_X86
+// bf16 -> f32 只是左移 16 位；f32 -> bf16 与标量版本相同地加 0x7FFF + 保留位最低位后右移，
+// 不用 AVX512_BF16 的 vcvtneps2bf16（它把次正规数当作 0，结果会与标量不同）
+__attribute__((target("avx2"))) void bf16_to_f32_avx2(float *dst, const bf16_t *src, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        __m256i w = _mm256_slli_epi32(_mm256_cvtepu16_epi32(h), 16);
+        _mm256_storeu_ps(dst + i, _mm256_castsi256_ps(w));
+    }
+    bf16_to_f32_scalar(dst + i, src + i, n - i);
+}
+
+__attribute__((target("avx2"))) void f32_to_bf16_avx2(bf16_t *dst, const float *src, size_t n) {
+    const __m256i one = _mm256_set1_epi32(1);
+    const __m256i bias = _mm256_set1_epi32(0x7FFF);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i b = _mm256_castps_si256(_mm256_loadu_ps(src + i));
+        __m256i lsb = _mm256_and_si256(_mm256_srli_epi32(b, 16), one);
+        __m256i r = _mm256_srli_epi32(_mm256_add_epi32(b, _mm256_add_epi32(bias, lsb)), 16);
+        __m128i packed = _mm_packus_epi32(_mm256_castsi256_si128(r), _mm256_extracti128_si256(r, 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), packed);
+    }
+    f32_to_bf16_scalar(dst + i, src + i, n - i);
+}
+
+__attribute__((target("avx,f16c"))) void f16_to_f32_f16c(float *dst, const fp16_t *src, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i));
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(h));
+    }
+    f16_to_f32_scalar(dst + i, src + i, n - i);
+}
+
+__attribute__((target("avx,f16c"))) void f32_to_f16_f16c(fp16_t *dst, const float *src, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(dst + i), h);
+    }
+    f32_to_f16_scalar(dst + i, src + i, n - i);
+}
+
+__attribute__((target("avx512f"))) void bf16_to_f32_avx512(float *dst, const bf16_t *src, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256i h = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        __m512i w = _mm512_slli_epi32(_mm512_cvtepu16_epi32(h), 16);
+        _mm512_storeu_ps(dst + i, _mm512_castsi512_ps(w));
+    }
+    bf16_to_f32_scalar(dst + i, src + i, n - i);
+}
+
+__attribute__((target("avx512f"))) void f32_to_bf16_avx512(bf16_t *dst, const float *src, size_t n) {
+    const __m512i one = _mm512_set1_epi32(1);
+    const __m512i bias = _mm512_set1_epi32(0x7FFF);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m512i b = _mm512_castps_si512(_mm512_loadu_ps(src + i));
+        __m512i lsb = _mm512_and_si512(_mm512_srli_epi32(b, 16), one);
+        __m512i r = _mm512_srli_epi32(_mm512_add_epi32(b, _mm512_add_epi32(bias, lsb)), 16);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), _mm512_cvtepi32_epi16(r));
+    }
+    f32_to_bf16_scalar(dst + i, src + i, n - i);
+}
+
+__attribute__((target("avx512f"))) void f16_to_f32_avx512(float *dst, const fp16_t *src, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256i h = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i));
+        _mm512_storeu_ps(dst + i, _mm512_cvtph_ps(h));
+    }
+    f16_to_f32_scalar(dst + i, src + i, n - i);
+}
+
+__attribute__((target("avx512f"))) void f32_to_f16_avx512(fp16_t *dst, const float *src, size_t n) {
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256i h = _mm512_cvtps_ph(_mm512_loadu_ps(src + i), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i), h);
+    }
+    f32_to_f16_scalar(dst + i, src + i, n - i);
+}
+#endif
+
+struct Converters {
+    void (*bf16_to_f32)(float *, const bf16_t *, size_t);
+    void (*f32_to_bf16)(bf16_t *, const float *, size_t);
+    void (*f16_to_f32)(float *, const fp16_t *, size_t);
+    void (*f32_to_f16)(fp16_t *, const float *, size_t);
+};
+
+// 按当前生效的指令集档位选择（见 cpu_isa.hpp）
+const Converters &converters() {
+    static const Converters scalar{bf16_to_f32_scalar, f32_to_bf16_scalar, f16_to_f32_scalar, f32_to_f16_scalar};
+#ifdef LLAISYS_CONVERT_X86
+    static const Converters avx2{bf16_to_f32_avx2, f32_to_bf16_avx2, f16_to_f32_f16c, f32_to_f16_f16c};
+    static const Converters avx512{bf16_to_f32_avx512, f32_to_bf16_avx512, f16_to_f32_avx512, f32_to_f16_avx512};
+    switch (isa()) {
+    case Isa::Amx:
+    case Isa::Avx512:
+        return avx512;
+    case Isa::Avx2:
+        return avx2;
+    default:
+        break;
+    }
+#endif
+    return scalar;
+}
+} // namespace
+
+void bf16_to_f32(float *dst, const bf16_t *src, size_t n) {
+    converters().bf16_to_f32(dst, src, n);
+}
+
+void f32_to_bf16(bf16_t *dst, const float *src, size_t n) {
+    converters().f32_to_bf16(dst, src, n);
+}
+
+void f16_to_f32(float *dst, const fp16_t *src, size_t n) {
+    converters().f16_to_f32(dst, src, n);
+}
+
+void f32_to_f16(fp16_t *dst, const float *src, size_t n) {
+    converters().f32_to_f16(dst, src, n);
+}
+} // namespace llaisys::device::cpu
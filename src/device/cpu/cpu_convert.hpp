@@ -0,0 +1,48 @@
+#pragma once
+
+#include "../../utils.hpp"
+
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+
+namespace llaisys::device::cpu {
+// 半精度与 f32 之间的成批转换。x86 上按当前的指令集档位（cpu_isa.hpp）选择实现：
+// bf16 用 AVX2 / AVX-512F 的整数移位（舍入与标量 utils::cast 逐位一致），fp16 用 F16C；
+// 其余平台或 scalar 档位退回内联的标量转换
+void bf16_to_f32(float *dst, const bf16_t *src, size_t n);
+void f32_to_bf16(bf16_t *dst, const float *src, size_t n);
+void f16_to_f32(float *dst, const fp16_t *src, size_t n);
+void f32_to_f16(fp16_t *dst, const float *src, size_t n);
+
+// 按元素类型分派，T 为 float 时直接拷贝
+template <typename T>
+inline void to_f32(float *dst, const T *src, size_t n) {
+    if constexpr (std::is_same_v<T, float>) {
+        std::memcpy(dst, src, n * sizeof(float));
+    } else if constexpr (std::is_same_v<T, bf16_t>) {
+        bf16_to_f32(dst, src, n);
+    } else if constexpr (std::is_same_v<T, fp16_t>) {
+        f16_to_f32(dst, src, n);
+    } else {
+        for (size_t i = 0; i < n; ++i) {
+            dst[i] = llaisys::utils::cast<float>(src[i]);
+        }
+    }
+}
+
+template <typename T>
+inline void from_f32(T *dst, const float *src, size_t n) {
+    if constexpr (std::is_same_v<T, float>) {
+        std::memcpy(dst, src, n * sizeof(float));
+    } else if constexpr (std::is_same_v<T, bf16_t>) {
+        f32_to_bf16(dst, src, n);
+    } else if constexpr (std::is_same_v<T, fp16_t>) {
+        f32_to_f16(dst, src, n);
+    } else {
+        for (size_t i = 0; i < n; ++i) {
+            dst[i] = llaisys::utils::cast<T>(src[i]);
+        }
+    }
+}
+} // namespace llaisys::device::cpu
@@ -0,0 +1,129 @@
+#include "cpu_isa.hpp"
+
+#include "../../utils.hpp"
+
+#include <atomic>
+#include <cctype>
+#include <cstdlib>
+#include <string>
+#if defined(__linux__) && defined(__x86_64__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace llaisys::device::cpu {
+namespace {
+#if defined(__linux__) && defined(__x86_64__)
+// Linux 默认不给进程 AMX tile 数据的 XSAVE 空间，使用前须申请一次
+bool request_amx_permission() {
+    constexpr long kArchReqXcompPerm = 0x1023;
+    constexpr long kXfeatureXtiledata = 18;
+    return syscall(SYS_arch_prctl, kArchReqXcompPerm, kXfeatureXtiledata) == 0;
+}
+#endif
+
+Isa detect() {
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+    if (!(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma") && __builtin_cpu_supports("f16c"))) {
+        return Isa::Scalar;
+    }
+    if (!(__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") && __builtin_cpu_supports("avx512vl"))) {
+        return Isa::Avx2;
+    }
+#ifdef __linux__
+    if (__builtin_cpu_supports("avx512bf16") && __builtin_cpu_supports("amx-tile") && __builtin_cpu_supports("amx-bf16")
+        && request_amx_permission()) {
+        return Isa::Amx;
+    }
+#endif
+    return Isa::Avx512;
+#else
+    return Isa::Scalar;
+#endif
+}
+
+Isa clamp(Isa requested) {
+    Isa best = detected_isa();
+    if (static_cast<int>(requested) > static_cast<int>(best)) {
+        LOG_WARN("CPU ISA " << isa_name(requested) << " is not supported, using " << isa_name(best));
+        return best;
+    }
+    return requested;
+}
+
+Isa initial_isa() {
+    const char *env = std::getenv("LLAISYS_CPU_ISA");
+    Isa isa = detected_isa();
+    if (env && *env) {
+        Isa requested;
+        if (parse_isa(env, &requested)) {
+            isa = clamp(requested);
+        } else {
+            LOG_WARN("Ignoring unknown LLAISYS_CPU_ISA=" << env);
+        }
+    }
+    LOG_INFO("CPU ISA: " << isa_name(isa) << " (detected " << isa_name(detected_isa()) << ")");
+    return isa;
+}
+
+std::atomic<int> &active() {
+    static std::atomic<int> a{static_cast<int>(initial_isa())};
+    return a;
+}
+} // namespace
+
+Isa detected_isa() {
+    static const Isa detected = detect();
+    return detected;
+}
+
+Isa isa() {
+    return static_cast<Isa>(active().load(std::memory_order_relaxed));
+}
+
+void set_isa(Isa isa) {
+    ASSERT(static_cast<int>(isa) <= static_cast<int>(detected_isa()),
+           "set_isa: " << isa_name(isa) << " is not supported on this CPU (max " << isa_name(detected_isa()) << ")");
+    active().store(static_cast<int>(isa), std::memory_order_relaxed);
+}
+
+void reset_isa() {
+    active().store(static_cast<int>(detected_isa()), std::memory_order_relaxed);
+}
+
+const char *isa_name(Isa isa) {
+    switch (isa) {
+    case Isa::Scalar:
+        return "scalar";
+    case Isa::Avx2:
+        return "avx2";
+    case Isa::Avx512:
+        return "avx512";
+    case Isa::Amx:
+        return "amx";
+    }
+    return "unknown";
+}
+
+bool parse_isa(const char *name, Isa *out) {
+    if (!name) {
+        return false;
+    }
+    std::string s(name);
+    for (auto &c : s) {
+        c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    }
+    if (s == "auto") {
+        *out = detected_isa();
+        return true;
+    }
+    for (Isa isa : {Isa::Scalar, Isa::Avx2, Isa::Avx512, Isa::Amx}) {
+        if (s == isa_name(isa)) {
+            *out = isa;
+            return true;
+        }
+    }
+    return false;
+}
+} // namespace llaisys::device::cpu
@@ -0,0 +1,24 @@
+#pragma once
+
+namespace llaisys::device::cpu {
+// CPU 内核可用的指令集档位，高档位包含低档位
+enum class Isa {
+    Scalar = 0,
+    Avx2 = 1,   // AVX2 + FMA + F16C
+    Avx512 = 2, // AVX-512 F/BW/VL
+    Amx = 3,    // AVX-512 + AVX512_BF16 + AMX-BF16（已向内核申请 tile 数据权限）
+};
+
+// 本机支持的最高档位（CPUID 检测，只做一次）
+Isa detected_isa();
+// 当前生效的档位：默认等于 detected_isa()，可用 LLAISYS_CPU_ISA=scalar|avx2|avx512|amx 或 set_isa 降档。
+// 各内核在每次调用时读取，切换后立即生效
+Isa isa();
+// 强制使用 isa（超过本机支持时抛出异常）
+void set_isa(Isa isa);
+// 恢复为本机支持的最高档位
+void reset_isa();
+const char *isa_name(Isa isa);
+// 解析档位名（大小写不敏感，"auto" 表示 detected_isa()），无法识别时返回 false
+bool parse_isa(const char *name, Isa *out);
+} // namespace llaisys::device::cpu
@@ -0,0 +1,284 @@
+// immintrin.h 须在 llaisys.h 之前包含（见 cpu_convert.cpp）
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define LLAISYS_KERNELS_X86 1
+#include <immintrin.h>
+#if defined(__GNUC__) && !defined(__clang__)
+// 同 cpu_convert.cpp：GCC 12 对 _mm*_undefined_* 误报
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#endif
+#endif
+
+#include "cpu_kernels.hpp"
+#include "cpu_isa.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+namespace llaisys::device::cpu {
+namespace {
+constexpr size_t kLanes = 64;
+
+// dot 与 axpy 的各档位须逐位一致：只在这一段禁止把乘、加合并成 FMA（avx512f 目标隐含 fma）
+#if defined(__clang__)
+#pragma float_control(push)
+#pragma clang fp contract(off)
+#elif defined(__GNUC__)
+#pragma GCC push_options
+#pragma GCC optimize("fp-contract=off")
+#endif
+
+float dot_scalar(const float *a, const float *b, size_t n) {
+    float lanes[kLanes] = {};
+    for (size_t i = 0; i < n; ++i) {
+        lanes[i % kLanes] += a[i] * b[i];
+    }
+    for (size_t w = kLanes / 2; w > 0; w /= 2) {
+        for (size_t j = 0; j < w; ++j) {
+            lanes[j] += lanes[j + w];
+        }
+    }
+    return lanes[0];
+}
+
+void axpy_scalar(float *y, float alpha, const float *x, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        y[i] += alpha * x[i];
+    }
+}
+
+#ifdef LLAISYS_KERNELS_X86
+// 8 路归约的后半段：lane[j] += lane[j + w]，w = 4, 2, 1
+__attribute__((target("avx2"))) inline float reduce8(__m256 v) {
+    __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+    return _mm_cvtss_f32(s);
+}
+
+// 64 路部分和放在 8 个 ymm 中（第 r 个寄存器为 8r .. 8r + 7 路）
+__attribute__((target("avx2"))) float dot_avx2(const float *a, const float *b, size_t n) {
+    __m256 acc[8];
+    for (auto &v : acc) {
+        v = _mm256_setzero_ps();
+    }
+    size_t i = 0;
+    for (; i + kLanes <= n; i += kLanes) {
+        for (size_t r = 0; r < 8; ++r) {
+            __m256 p = _mm256_mul_ps(_mm256_loadu_ps(a + i + 8 * r), _mm256_loadu_ps(b + i + 8 * r));
+            acc[r] = _mm256_add_ps(acc[r], p);
+        }
+    }
+    const __m256i idx = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    for (size_t r = 0; i + 8 * r < n; ++r) {
+        int cnt = static_cast<int>(std::min<size_t>(8, n - i - 8 * r));
+        __m256i mask = _mm256_cmpgt_epi32(_mm256_set1_epi32(cnt), idx);
+        __m256 p = _mm256_mul_ps(_mm256_maskload_ps(a + i + 8 * r, mask), _mm256_maskload_ps(b + i + 8 * r, mask));
+        acc[r] = _mm256_blendv_ps(acc[r], _mm256_add_ps(acc[r], p), _mm256_castsi256_ps(mask));
+    }
+    for (size_t w = 4; w > 0; w /= 2) {
+        for (size_t r = 0; r < w; ++r) {
+            acc[r] = _mm256_add_ps(acc[r], acc[r + w]);
+        }
+    }
+    return reduce8(acc[0]);
+}
+
+__attribute__((target("avx2"))) void axpy_avx2(float *y, float alpha, const float *x, size_t n) {
+    const __m256 a = _mm256_set1_ps(alpha);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(y + i, _mm256_add_ps(_mm256_loadu_ps(y + i), _mm256_mul_ps(a, _mm256_loadu_ps(x + i))));
+    }
+    if (i < n) {
+        __m256i mask = _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>(n - i)),
+                                          _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+        __m256 v = _mm256_add_ps(_mm256_maskload_ps(y + i, mask), _mm256_mul_ps(a, _mm256_maskload_ps(x + i, mask)));
+        _mm256_maskstore_ps(y + i, mask, v);
+    }
+}
+
+// 64 路部分和放在 4 个 zmm 中，尾部用掩码只更新对应的路
+__attribute__((target("avx512f"))) float dot_avx512(const float *a, const float *b, size_t n) {
+    __m512 acc[4];
+    for (auto &v : acc) {
+        v = _mm512_setzero_ps();
+    }
+    size_t i = 0;
+    for (; i + kLanes <= n; i += kLanes) {
+        for (size_t r = 0; r < 4; ++r) {
+            __m512 p = _mm512_mul_ps(_mm512_loadu_ps(a + i + 16 * r), _mm512_loadu_ps(b + i + 16 * r));
+            acc[r] = _mm512_add_ps(acc[r], p);
+        }
+    }
+    for (size_t r = 0; i + 16 * r < n; ++r) {
+        size_t cnt = std::min<size_t>(16, n - i - 16 * r);
+        __mmask16 m = static_cast<__mmask16>(cnt == 16 ? 0xFFFFu : ((1u << cnt) - 1));
+        __m512 p = _mm512_mul_ps(_mm512_maskz_loadu_ps(m, a + i + 16 * r), _mm512_maskz_loadu_ps(m, b + i + 16 * r));
+        acc[r] = _mm512_mask_add_ps(acc[r], m, acc[r], p);
+    }
+    acc[0] = _mm512_add_ps(acc[0], acc[2]);
+    acc[1] = _mm512_add_ps(acc[1], acc[3]);
+    acc[0] = _mm512_add_ps(acc[0], acc[1]);
+    __m256 lo = _mm512_castps512_ps256(acc[0]);
+    __m256 hi = _mm256_castpd_ps(_mm512_extractf64x4_pd(_mm512_castps_pd(acc[0]), 1));
+    return reduce8(_mm256_add_ps(lo, hi));
+}
+
+__attribute__((target("avx512f"))) void axpy_avx512(float *y, float alpha, const float *x, size_t n) {
+    const __m512 a = _mm512_set1_ps(alpha);
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        _mm512_storeu_ps(y + i, _mm512_add_ps(_mm512_loadu_ps(y + i), _mm512_mul_ps(a, _mm512_loadu_ps(x + i))));
+    }
+    if (i < n) {
+        __mmask16 m = static_cast<__mmask16>((1u << (n - i)) - 1);
+        __m512 v = _mm512_add_ps(_mm512_maskz_loadu_ps(m, y + i), _mm512_mul_ps(a, _mm512_maskz_loadu_ps(m, x + i)));
+        _mm512_mask_storeu_ps(y + i, m, v);
+    }
+}
+#endif
+
+#if defined(__clang__)
+#pragma float_control(pop)
+#elif defined(__GNUC__)
+#pragma GCC pop_options
+#endif
+
+size_t argmax_scalar(const float *x, size_t n, float *max_val) {
+    float best = -std::numeric_limits<float>::infinity();
+    size_t idx = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (x[i] > best) {
+            best = x[i];
+            idx = i;
+        }
+    }
+    *max_val = best;
+    return idx;
+}
+
+#ifdef LLAISYS_KERNELS_X86
+// argmax 的 SIMD 版本：每一路只在严格更大时更新（记下本路第一个最大值），
+// 最后在取得最大值的各路中取最小下标，结果与标量版本相同。下标以 int32 记录，超长时分段
+constexpr size_t kArgmaxChunk = size_t(1) << 30;
+
+__attribute__((target("avx2"))) size_t argmax_avx2_chunk(const float *x, size_t n, float *max_val) {
+    __m256 vmax = _mm256_set1_ps(-std::numeric_limits<float>::infinity());
+    __m256i vidx = _mm256_setzero_si256();
+    __m256i cur = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i step = _mm256_set1_epi32(8);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 v = _mm256_loadu_ps(x + i);
+        __m256 gt = _mm256_cmp_ps(v, vmax, _CMP_GT_OQ);
+        vmax = _mm256_blendv_ps(vmax, v, gt);
+        vidx = _mm256_blendv_epi8(vidx, cur, _mm256_castps_si256(gt));
+        cur = _mm256_add_epi32(cur, step);
+    }
+    alignas(32) float vals[8];
+    alignas(32) int32_t idxs[8];
+    _mm256_store_ps(vals, vmax);
+    _mm256_store_si256(reinterpret_cast<__m256i *>(idxs), vidx);
+    float best = vals[0];
+    size_t idx = static_cast<size_t>(idxs[0]);
+    for (size_t l = 1; l < 8; ++l) {
+        if (vals[l] > best || (vals[l] == best && static_cast<size_t>(idxs[l]) < idx)) {
+            best = vals[l];
+            idx = static_cast<size_t>(idxs[l]);
+        }
+    }
+    for (; i < n; ++i) {
+        if (x[i] > best) {
+            best = x[i];
+            idx = i;
+        }
+    }
+    *max_val = best;
+    return idx;
+}
+
+__attribute__((target("avx512f"))) size_t argmax_avx512_chunk(const float *x, size_t n, float *max_val) {
+    const __m512 neg_inf = _mm512_set1_ps(-std::numeric_limits<float>::infinity());
+    __m512 vmax = neg_inf;
+    __m512i vidx = _mm512_setzero_si512();
+    __m512i cur = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    const __m512i step = _mm512_set1_epi32(16);
+    for (size_t i = 0; i < n; i += 16) {
+        __mmask16 m = static_cast<__mmask16>(n - i >= 16 ? 0xFFFFu : ((1u << (n - i)) - 1));
+        __m512 v = _mm512_mask_loadu_ps(neg_inf, m, x + i);
+        __mmask16 gt = _mm512_cmp_ps_mask(v, vmax, _CMP_GT_OQ);
+        vmax = _mm512_mask_mov_ps(vmax, gt, v);
+        vidx = _mm512_mask_mov_epi32(vidx, gt, cur);
+        cur = _mm512_add_epi32(cur, step);
+    }
+    float best = _mm512_reduce_max_ps(vmax);
+    __mmask16 eq = _mm512_cmp_ps_mask(vmax, _mm512_set1_ps(best), _CMP_EQ_OQ);
+    *max_val = best;
+    return static_cast<size_t>(_mm512_mask_reduce_min_epi32(eq, vidx));
+}
+
+template <typename Chunk>
+size_t argmax_chunked(const float *x, size_t n, float *max_val, Chunk chunk) {
+    float best = -std::numeric_limits<float>::infinity();
+    size_t idx = 0;
+    for (size_t begin = 0; begin < n; begin += kArgmaxChunk) {
+        float v;
+        size_t i = begin + chunk(x + begin, std::min(kArgmaxChunk, n - begin), &v);
+        if (v > best) {
+            best = v;
+            idx = i;
+        }
+    }
+    *max_val = best;
+    return idx;
+}
+#endif
+} // namespace
+
+float dot(const float *a, const float *b, size_t n) {
+#ifdef LLAISYS_KERNELS_X86
+    switch (isa()) {
+    case Isa::Amx:
+    case Isa::Avx512:
+        return dot_avx512(a, b, n);
+    case Isa::Avx2:
+        return dot_avx2(a, b, n);
+    default:
+        break;
+    }
+#endif
+    return dot_scalar(a, b, n);
+}
+
+void axpy(float *y, float alpha, const float *x, size_t n) {
+#ifdef LLAISYS_KERNELS_X86
+    switch (isa()) {
+    case Isa::Amx:
+    case Isa::Avx512:
+        return axpy_avx512(y, alpha, x, n);
+    case Isa::Avx2:
+        return axpy_avx2(y, alpha, x, n);
+    default:
+        break;
+    }
+#endif
+    axpy_scalar(y, alpha, x, n);
+}
+
+size_t argmax(const float *x, size_t n, float *max_val) {
+#ifdef LLAISYS_KERNELS_X86
+    switch (isa()) {
+    case Isa::Amx:
+    case Isa::Avx512:
+        return argmax_chunked(x, n, max_val, argmax_avx512_chunk);
+    case Isa::Avx2:
+        return argmax_chunked(x, n, max_val, argmax_avx2_chunk);
+    default:
+        break;
+    }
+#endif
+    return argmax_scalar(x, n, max_val);
+}
+} // namespace llaisys::device::cpu
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstddef>
+
+namespace llaisys::device::cpu {
+// f32 向量内核，按 isa() 在每次调用时选择标量 / AVX2 / AVX-512 实现。
+// 各实现的舍入完全相同：dot 固定按 64 路部分和累加（下标 i 落在第 i % 64 路），再按固定的二分顺序归约，
+// 乘与加分开进行、不用 FMA，因此强制切换档位不会改变结果
+float dot(const float *a, const float *b, size_t n);
+// y[i] += alpha * x[i]
+void axpy(float *y, float alpha, const float *x, size_t n);
+// 第一个最大值的下标，最大值写入 *max_val。NaN 不参与比较，没有大于 -inf 的元素时返回 0（*max_val 为 -inf）
+size_t argmax(const float *x, size_t n, float *max_val);
+} // namespace llaisys::device::cpu
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "../../core/llaisys_core.hpp"
+#include "cpu_stream.hpp"
+
+#include <functional>
+
+namespace llaisys::device::cpu {
+// 把 CPU 算子提交到当前线程 CPU runtime 的 stream 上，与同一 stream 上的异步拷贝按序执行；
+// 不切换线程的当前设备。task 按值持有张量，host 侧提前释放张量不影响尚未执行的算子
+inline void launch(std::function<void()> task) {
+    submit(core::context().runtime(LLAISYS_DEVICE_CPU, 0).stream(), std::move(task));
+}
+} // namespace llaisys::device::cpu
@@ -0,0 +1,207 @@
+#include "cpu_numa.hpp"
+
+#include "cpu_stream.hpp"
+#include "cpu_thread_pool.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <future>
+#include <string>
+#include <thread>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace llaisys::device::cpu {
+namespace {
+bool numa_disabled() {
+    const char *env = std::getenv("LLAISYS_NUMA");
+    if (!env) {
+        return false;
+    }
+    std::string s(env);
+    return s == "0" || s == "off" || s == "false" || s == "no";
+}
+
+// 当前进程允许运行的 cpu；拿不到时返回空，表示不过滤
+std::vector<int> allowed_cpus() {
+    std::vector<int> cpus;
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int c = 0; c < CPU_SETSIZE; ++c) {
+            if (CPU_ISSET(c, &set)) {
+                cpus.push_back(c);
+            }
+        }
+    }
+#endif
+    return cpus;
+}
+
+std::vector<std::vector<int>> detect_nodes() {
+    std::vector<int> allowed = allowed_cpus();
+    std::vector<int> requested = parse_cpu_list(std::getenv("LLAISYS_CPU_AFFINITY"));
+    auto usable = [&](int c) {
+        bool ok = allowed.empty() || std::find(allowed.begin(), allowed.end(), c) != allowed.end();
+        return ok && (requested.empty() || std::find(requested.begin(), requested.end(), c) != requested.end());
+    };
+
+    std::vector<std::vector<int>> nodes;
+#ifdef __linux__
+    // sysfs 中节点编号可能不连续，扫描到一段连续缺失为止
+    for (int node = 0, missing = 0; missing < 8; ++node) {
+        std::ifstream in("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        if (!in) {
+            ++missing;
+            continue;
+        }
+        missing = 0;
+        std::string line;
+        std::getline(in, line);
+        std::vector<int> cpus;
+        for (int c : parse_cpu_list(line.c_str())) {
+            if (usable(c)) {
+                cpus.push_back(c);
+            }
+        }
+        if (!cpus.empty()) {
+            nodes.push_back(std::move(cpus));
+        }
+    }
+#endif
+    if (nodes.size() > 1 && !numa_disabled()) {
+        return nodes;
+    }
+    // 单节点：保持 LLAISYS_CPU_AFFINITY 的原始顺序
+    std::vector<int> all = requested.empty() ? allowed : requested;
+    return {all};
+}
+
+// 启动绑定到 cpus 的线程，绑核完成后 fn 才开始执行，保证首次写入发生在目标节点上
+std::thread spawn_pinned(const std::vector<int> &cpus, std::function<void()> fn) {
+    std::promise<void> pinned;
+    std::shared_future<void> ready = pinned.get_future().share();
+    std::thread t([ready, fn = std::move(fn)] {
+        ready.wait();
+        fn();
+    });
+#ifdef __linux__
+    if (!cpus.empty()) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int c : cpus) {
+            CPU_SET(c, &set);
+        }
+        pthread_setaffinity_np(t.native_handle(), sizeof(set), &set);
+    }
+#else
+    (void)cpus;
+#endif
+    pinned.set_value();
+    return t;
+}
+} // namespace
+
+std::vector<int> parse_cpu_list(const char *list) {
+    std::vector<int> cpus;
+    if (!list || *list == '\0') {
+        return cpus;
+    }
+    std::string s(list);
+    while (!s.empty() && (s.back() == '\n' || s.back() == ' ')) {
+        s.pop_back();
+    }
+    size_t pos = 0;
+    while (pos < s.size()) {
+        size_t comma = s.find(',', pos);
+        std::string item = s.substr(pos, comma == std::string::npos ? std::string::npos : comma - pos);
+        pos = comma == std::string::npos ? s.size() : comma + 1;
+        if (item.empty()) {
+            continue;
+        }
+        char *end = nullptr;
+        long first = std::strtol(item.c_str(), &end, 10);
+        long last = first;
+        if (*end == '-') {
+            const char *rest = end + 1;
+            last = std::strtol(rest, &end, 10);
+            if (end == rest) {
+                return {};
+            }
+        }
+        if (*end != '\0' || first < 0 || last < first) {
+            return {};
+        }
+        for (long c = first; c <= last; ++c) {
+            cpus.push_back(static_cast<int>(c));
+        }
+    }
+    return cpus;
+}
+
+const std::vector<std::vector<int>> &numa_nodes() {
+    static const std::vector<std::vector<int>> nodes = detect_nodes();
+    return nodes;
+}
+
+void pin_current_thread(const std::vector<int> &cpus) {
+#ifdef __linux__
+    if (cpus.empty()) {
+        return;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int c : cpus) {
+        CPU_SET(c, &set);
+    }
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+    (void)cpus;
+#endif
+}
+
+void run_pinned(const std::vector<int> &cpus, const std::function<void()> &fn) {
+    std::exception_ptr error;
+    std::thread t = spawn_pinned(cpus, [&] {
+        try {
+            fn();
+        } catch (...) {
+            error = std::current_exception();
+        }
+    });
+    t.join();
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+void first_touch_rows(std::byte *dst, const std::byte *src, size_t rows, size_t row_bytes) {
+    // 源数据可能仍在 stream 上写入
+    synchronize_streams();
+    ThreadPool &pool = ThreadPool::instance();
+    if (pool.num_nodes() <= 1) {
+        std::memcpy(dst, src, rows * row_bytes);
+        return;
+    }
+    std::vector<size_t> bounds = pool.split_rows(rows);
+    std::vector<std::thread> copiers;
+    for (size_t node = 0; node < pool.num_nodes(); ++node) {
+        size_t begin = bounds[node];
+        size_t end = bounds[node + 1];
+        if (begin < end) {
+            copiers.push_back(spawn_pinned(pool.node_cpus(node), [=] {
+                std::memcpy(dst + begin * row_bytes, src + begin * row_bytes, (end - begin) * row_bytes);
+            }));
+        }
+    }
+    for (auto &t : copiers) {
+        t.join();
+    }
+}
+} // namespace llaisys::device::cpu
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <vector>
+
+namespace llaisys::device::cpu {
+// 解析 "0-3,8,10-11" 形式的核列表，格式错误时返回空
+std::vector<int> parse_cpu_list(const char *list);
+// 可用的 NUMA 节点及各自的 cpu，已按进程亲和性与 LLAISYS_CPU_AFFINITY 过滤并去掉空节点；
+// 非 Linux、单节点或 LLAISYS_NUMA=0 时合并为一个节点
+const std::vector<std::vector<int>> &numa_nodes();
+// 把调用线程绑定到 cpus（空表示不限制）
+void pin_current_thread(const std::vector<int> &cpus);
+// 在绑定到 cpus 的临时线程上执行 fn 并等待结束，异常原样抛回
+void run_pinned(const std::vector<int> &cpus, const std::function<void()> &fn);
+// 把 rows 行数据从 src 拷到尚未触碰过的 dst：按线程池的节点划分（ThreadPool::split_rows）分段，
+// 每段由绑定到对应节点的线程首次写入，使物理页落在该节点上
+void first_touch_rows(std::byte *dst, const std::byte *src, size_t rows, size_t row_bytes);
+} // namespace llaisys::device::cpu
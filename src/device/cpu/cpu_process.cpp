@@ -0,0 +1,149 @@
+#include "cpu_process.hpp"
+
+#include "cpu_stream.hpp"
+#include "cpu_thread_pool.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#ifdef __linux__
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace llaisys::device::cpu {
+#ifdef __linux__
+namespace {
+[[noreturn]] void fail(const std::string &what) {
+    throw std::runtime_error(what + ": " + std::strerror(errno));
+}
+} // namespace
+
+std::pair<int, int> socket_pair() {
+    int fds[2];
+    if (::socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds) != 0) {
+        fail("socketpair");
+    }
+    return {fds[0], fds[1]};
+}
+
+void close_fd(int fd) {
+    if (fd >= 0) {
+        ::close(fd);
+    }
+}
+
+void send_all(int fd, const void *data, size_t size) {
+    const char *p = static_cast<const char *>(data);
+    while (size > 0) {
+        // MSG_NOSIGNAL：对端已退出时返回 EPIPE 而不是让本进程收到 SIGPIPE
+        ssize_t n = ::send(fd, p, size, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            fail("send");
+        }
+        p += n;
+        size -= static_cast<size_t>(n);
+    }
+}
+
+bool recv_all(int fd, void *data, size_t size) {
+    char *p = static_cast<char *>(data);
+    size_t got = 0;
+    while (got < size) {
+        ssize_t n = ::recv(fd, p + got, size - got, 0);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            fail("recv");
+        }
+        if (n == 0) {
+            if (got == 0) {
+                return false;
+            }
+            throw std::runtime_error("recv: peer closed in the middle of a message");
+        }
+        got += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+int fork_worker(const std::vector<int> &close_fds, const std::function<void()> &body) {
+    // fork 时其他线程必须都停在不持锁的位置：stream 上没有任务，线程池工作线程在等待新任务
+    synchronize_streams();
+    pid_t pid = ::fork();
+    if (pid < 0) {
+        fail("fork");
+    }
+    if (pid > 0) {
+        return static_cast<int>(pid);
+    }
+    for (int fd : close_fds) {
+        close_fd(fd);
+    }
+    ThreadPool::reset_after_fork();
+    reset_streams_after_fork();
+    int code = 0;
+    // 调用线程的 thread_local 上下文引用父进程的 stream，换一个新线程执行
+    std::thread worker([&] {
+        try {
+            body();
+        } catch (const std::exception &e) {
+            std::cerr << "[llaisys] worker process " << ::getpid() << " failed: " << e.what() << std::endl;
+            code = 1;
+        } catch (...) {
+            code = 1;
+        }
+    });
+    worker.join();
+    std::cerr.flush();
+    ::_exit(code);
+}
+
+int wait_worker(int pid) {
+    int status = 0;
+    while (::waitpid(static_cast<pid_t>(pid), &status, 0) < 0) {
+        if (errno != EINTR) {
+            return -1;
+        }
+    }
+    return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+#else
+std::pair<int, int> socket_pair() {
+    throw std::runtime_error("socket_pair: worker processes require Linux");
+}
+
+void close_fd(int fd) {
+    (void)fd;
+}
+
+void send_all(int fd, const void *data, size_t size) {
+    (void)fd, (void)data, (void)size;
+    throw std::runtime_error("send_all: worker processes require Linux");
+}
+
+bool recv_all(int fd, void *data, size_t size) {
+    (void)fd, (void)data, (void)size;
+    throw std::runtime_error("recv_all: worker processes require Linux");
+}
+
+int fork_worker(const std::vector<int> &close_fds, const std::function<void()> &body) {
+    (void)close_fds, (void)body;
+    throw std::runtime_error("fork_worker: worker processes require Linux");
+}
+
+int wait_worker(int pid) {
+    (void)pid;
+    return -1;
+}
+#endif
+} // namespace llaisys::device::cpu
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace llaisys::device::cpu {
+// 本机工作进程与进程间字节流，仅 Linux 可用（其他平台调用时抛出异常）
+
+// 创建一对相连的 AF_UNIX 流式 socket（带 CLOEXEC），返回两端的 fd
+std::pair<int, int> socket_pair();
+void close_fd(int fd);
+// 写满 / 读满 size 字节；对端关闭时 send_all 抛出异常，recv_all 在未读到任何字节时返回 false、读到一半时抛出异常
+void send_all(int fd, const void *data, size_t size);
+bool recv_all(int fd, void *data, size_t size);
+
+// fork 一个工作进程执行 body，返回子进程 pid。调用前会等待所有 CPU stream 空闲。
+// 子进程中先关闭 close_fds，重建线程池与 stream 登记表，再在新线程（全新的 core 上下文）上执行 body，
+// 结束后直接 _exit：继承来的对象一律不析构。body 抛出异常时退出码为 1
+int fork_worker(const std::vector<int> &close_fds, const std::function<void()> &body);
+// 等待工作进程退出，返回其退出码（被信号终止时返回 -1）
+int wait_worker(int pid);
+} // namespace llaisys::device::cpu
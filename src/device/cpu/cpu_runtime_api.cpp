@@ -1,11 +1,68 @@
 #include "../runtime_api.hpp"
+#include "cpu_stream.hpp"
 
+#include <cstdint>
 #include <cstdlib>
 #include <cstring>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 namespace llaisys::device::cpu {
 
 namespace runtime_api {
+namespace {
+// 经 malloc_device / malloc_host 分配的内存区间。异步拷贝按 CUDA 语义区分：
+// 源为登记过的内存时在 stream 上按序拷贝；源为可分页内存时调用时先暂存，调用方随后可改写源；
+// 目的为可分页内存时等待 stream 完成后同步拷贝
+struct Allocations {
+    std::mutex mutex;
+    std::map<std::uintptr_t, size_t> ranges;
+
+    void add(void *ptr, size_t size) {
+        std::lock_guard<std::mutex> lock(mutex);
+        ranges[reinterpret_cast<std::uintptr_t>(ptr)] = size;
+    }
+    void remove(void *ptr) {
+        std::lock_guard<std::mutex> lock(mutex);
+        ranges.erase(reinterpret_cast<std::uintptr_t>(ptr));
+    }
+    bool contains(const void *ptr) {
+        auto p = reinterpret_cast<std::uintptr_t>(ptr);
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = ranges.upper_bound(p);
+        if (it == ranges.begin()) {
+            return false;
+        }
+        --it;
+        return p < it->first + it->second;
+    }
+};
+
+Allocations &allocations() {
+    static Allocations a;
+    return a;
+}
+
+void *allocate(size_t size) {
+    void *ptr = std::malloc(size);
+    if (ptr != nullptr) {
+        allocations().add(ptr, size);
+    }
+    return ptr;
+}
+
+// 与 cudaFree 的隐式同步等价：仍有 stream 任务可能访问该内存时，延迟到这些任务执行完再释放
+void release(void *ptr) {
+    if (ptr == nullptr) {
+        return;
+    }
+    allocations().remove(ptr);
+    cpu::retain_until_drained(std::shared_ptr<void>(ptr, [](void *p) { std::free(p); }));
+}
+} // namespace
+
 int getDeviceCount() {
     return 1;
 }
@@ -15,42 +72,62 @@ void setDevice(int) {
 }
 
 void deviceSynchronize() {
-    // do nothing
+    cpu::synchronize_streams();
 }
 
 llaisysStream_t createStream() {
-    return (llaisysStream_t)0; // null stream
+    return reinterpret_cast<llaisysStream_t>(cpu::create_stream());
 }
 
 void destroyStream(llaisysStream_t stream) {
-    // do nothing
+    if (stream != nullptr) {
+        cpu::destroy_stream(reinterpret_cast<cpu::Stream *>(stream));
+    }
 }
 void streamSynchronize(llaisysStream_t stream) {
-    // do nothing
+    if (stream != nullptr) {
+        reinterpret_cast<cpu::Stream *>(stream)->synchronize();
+    }
 }
 
 void *mallocDevice(size_t size) {
-    return std::malloc(size);
+    return allocate(size);
 }
 
 void freeDevice(void *ptr) {
-    std::free(ptr);
+    release(ptr);
 }
 
 void *mallocHost(size_t size) {
-    return mallocDevice(size);
+    return allocate(size);
 }
 
 void freeHost(void *ptr) {
-    freeDevice(ptr);
+    release(ptr);
 }
 
+// 同步拷贝与所有 stream 同步，语义同 legacy 默认 stream 上的 cudaMemcpy
 void memcpySync(void *dst, const void *src, size_t size, llaisysMemcpyKind_t kind) {
+    cpu::synchronize_streams();
     std::memcpy(dst, src, size);
 }
 
 void memcpyAsync(void *dst, const void *src, size_t size, llaisysMemcpyKind_t kind, llaisysStream_t stream) {
-    memcpySync(dst, src, size, kind);
+    if (stream == nullptr) {
+        return memcpySync(dst, src, size, kind);
+    }
+    if (!allocations().contains(dst)) {
+        reinterpret_cast<cpu::Stream *>(stream)->synchronize();
+        std::memcpy(dst, src, size);
+        return;
+    }
+    if (!allocations().contains(src)) {
+        auto staged = std::make_shared<std::vector<std::byte>>(static_cast<const std::byte *>(src),
+                                                               static_cast<const std::byte *>(src) + size);
+        cpu::submit(stream, [dst, staged] { std::memcpy(dst, staged->data(), staged->size()); });
+        return;
+    }
+    cpu::submit(stream, [dst, src, size] { std::memcpy(dst, src, size); });
 }
 
 static const LlaisysRuntimeAPI RUNTIME_API = {
@@ -0,0 +1,159 @@
+#include "cpu_stream.hpp"
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace llaisys::device::cpu {
+namespace {
+// 当前线程若为某个 stream 的执行线程则指向它，避免任务内同步自身造成死锁
+thread_local Stream *executing = nullptr;
+
+struct Registry {
+    std::mutex mutex;
+    std::unordered_map<Stream *, std::shared_ptr<Stream>> streams;
+
+    std::vector<std::shared_ptr<Stream>> snapshot() {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<std::shared_ptr<Stream>> out;
+        out.reserve(streams.size());
+        for (auto &entry : streams) {
+            out.push_back(entry.second);
+        }
+        return out;
+    }
+};
+
+Registry *forked_registry = nullptr;
+
+Registry &registry() {
+    if (forked_registry != nullptr) {
+        return *forked_registry;
+    }
+    static Registry r;
+    return r;
+}
+} // namespace
+
+Stream::Stream() : thread_([this] { loop(); }) {}
+
+Stream::~Stream() {
+    try {
+        synchronize();
+    } catch (...) {
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    has_work_.notify_all();
+    thread_.join();
+}
+
+void Stream::loop() {
+    executing = this;
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            has_work_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+            if (tasks_.empty()) {
+                return;
+            }
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        try {
+            task();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!error_) {
+                error_ = std::current_exception();
+            }
+        }
+        // 先释放任务持有的张量，再标记完成
+        task = nullptr;
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (--inflight_ == 0) {
+            drained_.notify_all();
+        }
+    }
+}
+
+void Stream::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push_back(std::move(task));
+        ++inflight_;
+    }
+    has_work_.notify_one();
+}
+
+void Stream::synchronize() {
+    if (executing == this) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(mutex_);
+    drained_.wait(lock, [this] { return inflight_ == 0; });
+    if (error_) {
+        std::exception_ptr error = error_;
+        error_ = nullptr;
+        std::rethrow_exception(error);
+    }
+}
+
+bool Stream::idle() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return inflight_ == 0;
+}
+
+Stream *create_stream() {
+    auto stream = std::make_shared<Stream>();
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    registry().streams[stream.get()] = stream;
+    return stream.get();
+}
+
+void destroy_stream(Stream *stream) {
+    std::shared_ptr<Stream> owned;
+    {
+        std::lock_guard<std::mutex> lock(registry().mutex);
+        auto it = registry().streams.find(stream);
+        if (it == registry().streams.end()) {
+            return;
+        }
+        owned = std::move(it->second);
+        registry().streams.erase(it);
+    }
+}
+
+void submit(llaisysStream_t stream, std::function<void()> task) {
+    if (stream == nullptr) {
+        task();
+        return;
+    }
+    reinterpret_cast<Stream *>(stream)->submit(std::move(task));
+}
+
+void reset_streams_after_fork() {
+    // 继承来的 stream 的执行线程在子进程中不存在，弃置整个登记表（不析构，避免 join 不存在的线程）
+    forked_registry = new Registry();
+}
+
+void synchronize_streams() {
+    for (auto &stream : registry().snapshot()) {
+        stream->synchronize();
+    }
+}
+
+bool retain_until_drained(const std::shared_ptr<void> &holder) {
+    bool pending = false;
+    for (auto &stream : registry().snapshot()) {
+        if (!stream->idle()) {
+            stream->submit([holder] {});
+            pending = true;
+        }
+    }
+    return pending;
+}
+} // namespace llaisys::device::cpu
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "llaisys.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace llaisys::device::cpu {
+// CPU stream：有序任务队列，由一个专属线程按提交顺序执行。
+// 任务中抛出的异常保存下来，在下一次同步时重新抛出
+class Stream {
+public:
+    Stream();
+    Stream(const Stream &) = delete;
+    Stream &operator=(const Stream &) = delete;
+    // 析构前执行完所有已提交的任务
+    ~Stream();
+
+    void submit(std::function<void()> task);
+    void synchronize();
+    bool idle();
+
+private:
+    void loop();
+
+    std::mutex mutex_;
+    std::condition_variable has_work_;
+    std::condition_variable drained_;
+    std::deque<std::function<void()>> tasks_;
+    size_t inflight_ = 0;
+    bool stop_ = false;
+    std::exception_ptr error_;
+    std::thread thread_;
+};
+
+Stream *create_stream();
+void destroy_stream(Stream *stream);
+// 把 task 提交到 stream 上按序执行；空 stream 表示立即在调用线程执行
+void submit(llaisysStream_t stream, std::function<void()> task);
+// 等待所有 CPU stream 上已提交的任务完成
+void synchronize_streams();
+// 只能在 fork 出的子进程中调用：忘掉父进程登记的所有 stream
+void reset_streams_after_fork();
+// 在所有忙碌的 stream 上排入一个持有 holder 的空任务，使其在这些 stream 执行到当前位置后才释放；
+// 返回是否有 stream 忙碌
+bool retain_until_drained(const std::shared_ptr<void> &holder);
+} // namespace llaisys::device::cpu
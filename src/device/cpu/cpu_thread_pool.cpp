@@ -0,0 +1,262 @@
+#include "cpu_thread_pool.hpp"
+
+#include "cpu_numa.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <exception>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace llaisys::device::cpu {
+namespace {
+thread_local bool in_pool = false;
+thread_local int home_node = -1;
+
+size_t parse_num_threads(const char *env, size_t fallback) {
+    if (!env || *env == '\0') {
+        return fallback;
+    }
+    char *end = nullptr;
+    unsigned long long v = std::strtoull(env, &end, 10);
+    if (end == env || *end != '\0' || v == 0) {
+        return fallback;
+    }
+    return static_cast<size_t>(v);
+}
+
+void pin_thread(std::thread &t, int cpu) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(t.native_handle(), sizeof(set), &set);
+#else
+    (void)t;
+    (void)cpu;
+#endif
+}
+} // namespace
+
+struct ThreadPool::Job {
+    const std::function<void(size_t, size_t)> *fn;
+    std::atomic<size_t> remaining{0};
+    std::mutex mutex;
+    std::condition_variable done;
+    std::exception_ptr error;
+};
+
+// fork 出的子进程中替代原实例的线程池
+static ThreadPool *forked_pool = nullptr;
+
+ThreadPool &ThreadPool::instance() {
+    if (forked_pool != nullptr) {
+        return *forked_pool;
+    }
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::reset_after_fork() {
+    // 原实例的工作线程在子进程中不存在，其队列与锁也不能再用，直接弃置
+    forked_pool = new ThreadPool();
+}
+
+ThreadPool::ThreadPool() {
+    const auto &nodes = numa_nodes();
+    std::vector<int> requested = parse_cpu_list(std::getenv("LLAISYS_CPU_AFFINITY"));
+    // 多节点时总是绑核；单节点时仅在显式指定 LLAISYS_CPU_AFFINITY 时绑核
+    if (nodes.size() > 1) {
+        node_cpus_ = nodes;
+    } else {
+        node_cpus_ = {requested};
+    }
+    std::vector<int> flat;
+    std::vector<size_t> flat_node;
+    for (size_t node = 0; node < node_cpus_.size(); ++node) {
+        for (int c : node_cpus_[node]) {
+            flat.push_back(c);
+            flat_node.push_back(node);
+        }
+    }
+    size_t hw = std::max<size_t>(1, std::thread::hardware_concurrency());
+    size_t n = parse_num_threads(std::getenv("LLAISYS_NUM_THREADS"), flat.empty() ? hw : flat.size());
+    node_workers_.resize(node_cpus_.size());
+    queues_.reserve(n - 1);
+    workers_.reserve(n - 1);
+    for (size_t i = 0; i + 1 < n; ++i) {
+        queues_.push_back(std::make_unique<Queue>());
+    }
+    for (size_t i = 0; i + 1 < n; ++i) {
+        workers_.emplace_back([this, i] { worker_loop(i); });
+        if (flat.empty()) {
+            node_workers_[0].push_back(i);
+            continue;
+        }
+        // 参与者 p（0 为调用线程）均匀映射到核列表上，线程数少于核数时各节点按核数成比例分得线程
+        size_t p = i + 1;
+        size_t slot = n <= flat.size() ? p * flat.size() / n : p % flat.size();
+        pin_thread(workers_.back(), flat[slot]);
+        node_workers_[flat_node[slot]].push_back(i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto &t : workers_) {
+        t.join();
+    }
+}
+
+bool ThreadPool::take(size_t home, Chunk &chunk) {
+    const size_t n = queues_.size();
+    for (size_t k = 0; k < n; ++k) {
+        Queue &q = *queues_[(home + k) % n];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        if (q.chunks.empty()) {
+            continue;
+        }
+        if (k == 0) {
+            chunk = q.chunks.front();
+            q.chunks.pop_front();
+        } else {
+            chunk = q.chunks.back();
+            q.chunks.pop_back();
+        }
+        queued_.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::run(const Chunk &chunk) {
+    Job &job = *chunk.job;
+    std::exception_ptr error;
+    try {
+        (*job.fn)(chunk.begin, chunk.end);
+    } catch (...) {
+        error = std::current_exception();
+    }
+    // 计数在锁内递减：调用方只能在本线程释放锁之后看到 0 并销毁 job
+    std::lock_guard<std::mutex> lock(job.mutex);
+    if (error && !job.error) {
+        job.error = error;
+    }
+    if (job.remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        job.done.notify_all();
+    }
+}
+
+void ThreadPool::worker_loop(size_t index) {
+    in_pool = true;
+    Chunk chunk{};
+    while (true) {
+        if (take(index, chunk)) {
+            run(chunk);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(wake_mutex_);
+        wake_.wait(lock, [this] { return stop_ || queued_.load(std::memory_order_relaxed) > 0; });
+        if (stop_) {
+            return;
+        }
+    }
+}
+
+std::vector<size_t> ThreadPool::split_rows(size_t rows) const {
+    std::vector<size_t> bounds(num_nodes() + 1, 0);
+    size_t total = size();
+    size_t acc = 0;
+    for (size_t node = 0; node < num_nodes(); ++node) {
+        acc += node_threads(node);
+        bounds[node + 1] = rows * acc / total;
+    }
+    bounds.back() = rows;
+    return bounds;
+}
+
+void ThreadPool::set_home_node(int node) {
+    home_node = node;
+}
+
+void ThreadPool::parallel_for(size_t begin, size_t end, size_t grain,
+                              const std::function<void(size_t, size_t)> &fn) {
+    parallel_for_nodes({begin, end}, grain, fn);
+}
+
+void ThreadPool::parallel_for_nodes(const std::vector<size_t> &bounds, size_t grain,
+                                    const std::function<void(size_t, size_t)> &fn) {
+    if (bounds.size() < 2 || bounds.front() >= bounds.back()) {
+        return;
+    }
+    grain = std::max<size_t>(grain, 1);
+    if (in_pool || workers_.empty() || bounds.back() - bounds.front() <= grain) {
+        fn(bounds.front(), bounds.back());
+        return;
+    }
+    // 调用线程指定了节点时整个区间交给该节点；段数与节点数一致时按节点投递；
+    // 否则整个区间视为一段，投递到所有队列
+    const bool pinned = num_nodes() > 1 && home_node >= 0;
+    const bool by_node = num_nodes() > 1 && !pinned && bounds.size() == num_nodes() + 1;
+    const std::vector<size_t> segments = by_node ? bounds : std::vector<size_t>{bounds.front(), bounds.back()};
+    const size_t first = next_queue_.fetch_add(1, std::memory_order_relaxed);
+
+    Job job;
+    job.fn = &fn;
+    std::vector<Chunk> chunks;
+    std::vector<size_t> targets;
+    for (size_t seg = 0; seg + 1 < segments.size(); ++seg) {
+        const size_t b0 = segments[seg];
+        const size_t b1 = segments[seg + 1];
+        if (b0 >= b1) {
+            continue;
+        }
+        const size_t node = pinned ? static_cast<size_t>(home_node) % num_nodes() : seg;
+        const std::vector<size_t> *home =
+            (by_node || pinned) && !node_workers_[node].empty() ? &node_workers_[node] : nullptr;
+        // 块数取线程数的若干倍，便于负载不均时窃取
+        const size_t threads = home ? node_threads(node) : size();
+        const size_t nchunks = std::min((b1 - b0 + grain - 1) / grain, threads * 4);
+        const size_t step = (b1 - b0 + nchunks - 1) / nchunks;
+        for (size_t b = b0; b < b1; b += step) {
+            size_t k = first + chunks.size();
+            targets.push_back(home ? (*home)[k % home->size()] : k % queues_.size());
+            chunks.push_back({&job, b, std::min(b1, b + step)});
+        }
+    }
+    job.remaining.store(chunks.size(), std::memory_order_relaxed);
+    // 第一块由调用线程执行（按节点投递时为节点 0 的首块），其余放入目标工作线程队列
+    for (size_t i = 1; i < chunks.size(); ++i) {
+        Queue &q = *queues_[targets[i]];
+        std::lock_guard<std::mutex> lock(q.mutex);
+        q.chunks.push_back(chunks[i]);
+    }
+    queued_.fetch_add(chunks.size() - 1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(wake_mutex_);
+    }
+    wake_.notify_all();
+
+    in_pool = true;
+    run(chunks[0]);
+    // 等待期间帮忙执行队列中的块（可能属于其他调用方）
+    Chunk chunk{};
+    while (job.remaining.load(std::memory_order_acquire) > 0 && take(first % queues_.size(), chunk)) {
+        run(chunk);
+    }
+    in_pool = false;
+    {
+        std::unique_lock<std::mutex> lock(job.mutex);
+        job.done.wait(lock, [&job] { return job.remaining.load(std::memory_order_acquire) == 0; });
+    }
+    if (job.error) {
+        std::rethrow_exception(job.error);
+    }
+}
+} // namespace llaisys::device::cpu
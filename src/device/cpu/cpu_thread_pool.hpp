@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace llaisys::device::cpu {
+// 进程级 work-stealing 线程池，所有 CPU 算子通过 parallel_for 使用。
+// LLAISYS_NUM_THREADS 指定线程数（含调用线程，默认为可用核数），
+// LLAISYS_CPU_AFFINITY 为核列表（如 "0-15,32-47"），工作线程依次绑定到列表中的核。
+// 多 NUMA 节点时线程按各节点核数成比例分组，每组绑定在本节点的核上（调用线程计入节点 0）
+class ThreadPool {
+public:
+    static ThreadPool &instance();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+    ~ThreadPool();
+
+    // 参与计算的线程数（工作线程 + 调用线程）
+    size_t size() const { return workers_.size() + 1; }
+    // 把 [begin, end) 切成不小于 grain 的块并行执行 fn(chunk_begin, chunk_end)，返回前所有块已完成；
+    // 调用线程也参与执行。在池内线程中再次调用时直接串行执行
+    void parallel_for(size_t begin, size_t end, size_t grain, const std::function<void(size_t, size_t)> &fn);
+
+    size_t num_nodes() const { return node_cpus_.size(); }
+    const std::vector<int> &node_cpus(size_t node) const { return node_cpus_[node]; }
+    // 节点 node 上参与计算的线程数
+    size_t node_threads(size_t node) const { return node_workers_[node].size() + (node == 0 ? 1 : 0); }
+    // 把 [0, rows) 按各节点线程数成比例切成 num_nodes() 段，返回 num_nodes() + 1 个边界。
+    // 权重按此划分做 first-touch，算子按同一划分调度，使各节点只读本地分片
+    std::vector<size_t> split_rows(size_t rows) const;
+    // 与 parallel_for 相同，但 [bounds[i], bounds[i+1]) 内的块优先交给节点 i 的线程
+    void parallel_for_nodes(const std::vector<size_t> &bounds, size_t grain,
+                            const std::function<void(size_t, size_t)> &fn);
+    // 把调用线程此后发起的并行循环都交给节点 node 的工作线程（张量并行的各 rank 只用本节点的核），
+    // 负数表示取消
+    static void set_home_node(int node);
+    // 只能在 fork 出的子进程中（此时只有一个线程）调用：弃用继承来的实例，之后 instance() 返回新建的线程池
+    static void reset_after_fork();
+
+private:
+    struct Job;
+    struct Chunk {
+        Job *job;
+        size_t begin;
+        size_t end;
+    };
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Chunk> chunks;
+    };
+
+    ThreadPool();
+    void worker_loop(size_t index);
+    // 先取自己队列的队首，取不到时从其他队列队尾窃取
+    bool take(size_t home, Chunk &chunk);
+    void run(const Chunk &chunk);
+
+    std::vector<std::thread> workers_;
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::vector<int>> node_cpus_;
+    // 各节点的工作线程下标
+    std::vector<std::vector<size_t>> node_workers_;
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    std::atomic<size_t> queued_{0};
+    std::atomic<size_t> next_queue_{0};
+    bool stop_ = false;
+};
+
+inline void parallel_for(size_t begin, size_t end, size_t grain, const std::function<void(size_t, size_t)> &fn) {
+    ThreadPool::instance().parallel_for(begin, end, grain, fn);
+}
+
+// 对按 split_rows 做过 first-touch 的权重行并行，各节点处理自己的分片
+inline void parallel_for_rows(size_t rows, size_t grain, const std::function<void(size_t, size_t)> &fn) {
+    ThreadPool &pool = ThreadPool::instance();
+    pool.parallel_for_nodes(pool.split_rows(rows), grain, fn);
+}
+} // namespace llaisys::device::cpu
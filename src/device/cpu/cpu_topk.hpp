@@ -0,0 +1,62 @@
+#pragma once
+
+#include "cpu_kernels.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace llaisys::device::cpu {
+// top-k 的候选：值大者优先，值相同时下标小者优先，NaN 按 -inf 处理
+struct TopkEntry {
+    float key;
+    size_t idx;
+};
+
+inline bool topk_better(const TopkEntry &a, const TopkEntry &b) {
+    return a.key > b.key || (a.key == b.key && a.idx < b.idx);
+}
+
+// 以大小为 k 的堆维护最好的 k 个候选，堆顶为其中最差者。元素须按下标递增的顺序分块提交：
+// 堆满后先用 SIMD argmax 求整块的最大值，不超过堆顶的块整块跳过（后面的元素下标更大，相等也不会入选）
+class TopkHeap {
+public:
+    explicit TopkHeap(size_t k) : k_(k) { heap_.reserve(k); }
+
+    // x[l] 的下标为 offset + l；tile_max 为块内最大值（由调用方已求出时传入，否则传 NaN）
+    void push(const float *x, size_t n, size_t offset, float tile_max = std::numeric_limits<float>::quiet_NaN()) {
+        if (heap_.size() == k_) {
+            if (std::isnan(tile_max)) {
+                argmax(x, n, &tile_max);
+            }
+            if (!(tile_max > heap_.front().key)) {
+                return;
+            }
+        }
+        for (size_t l = 0; l < n; l++) {
+            TopkEntry e{std::isnan(x[l]) ? -std::numeric_limits<float>::infinity() : x[l], offset + l};
+            if (heap_.size() < k_) {
+                heap_.push_back(e);
+                std::push_heap(heap_.begin(), heap_.end(), topk_better);
+            } else if (topk_better(e, heap_.front())) {
+                std::pop_heap(heap_.begin(), heap_.end(), topk_better);
+                heap_.back() = e;
+                std::push_heap(heap_.begin(), heap_.end(), topk_better);
+            }
+        }
+    }
+
+    const std::vector<TopkEntry> &entries() const { return heap_; }
+
+private:
+    size_t k_;
+    std::vector<TopkEntry> heap_;
+};
+
+// 把各块的候选合并到 merged 后调用：前 k 个按顺序排好（k 不超过候选数）
+inline void topk_sort(std::vector<TopkEntry> &merged, size_t k) {
+    std::partial_sort(merged.begin(), merged.begin() + static_cast<std::ptrdiff_t>(k), merged.end(), topk_better);
+}
+} // namespace llaisys::device::cpu
@@ -1,22 +1,184 @@
 #include "Decoder.hpp"
 #include "../../core/llaisys_core.hpp"
+#include <algorithm>
 #include <cmath>
-#ifdef ENABLE_NVIDIA_API
-#include <cuda_runtime.h>
-#endif
 namespace llaisys::Qwen2 {
+namespace {
+// 沿 seq 维拼接 a 与 b，a 为空时直接返回 b
+tensor_t concat_seq(const tensor_t& a, const tensor_t& b) {
+    if (a->shape()[0] == 0) {
+        return b;
+    }
+    std::vector<size_t> shape = b->shape();
+    shape[0] += a->shape()[0];
+    tensor_t out = Tensor::create(shape, b->dtype(), b->deviceType(), b->deviceId());
+    ops::rearrange(out->slice(0, 0, a->shape()[0]), a);
+    ops::rearrange(out->slice(0, a->shape()[0], shape[0]), b);
+    return out;
+}
+
+// 滑动窗口层的多 token 注意力：窗口内历史 + 本批 key，量化缓存时本批先按同样方式量化
+void windowed_attention(tensor_t& attn_val, tensor_t& q, tensor_t& k, tensor_t& v,
+                        llaisys::KVcache::CacheHandle_t& cache, size_t layer, float scale, size_t window) {
+    tensor_t k_prev;
+    tensor_t v_prev;
+    cache->get(k_prev, v_prev, layer);
+    if (!cache->is_quantized()) {
+        ops::self_attention(attn_val, q, concat_seq(k_prev, k), concat_seq(v_prev, v), scale, window);
+        return;
+    }
+    tensor_t k_scale_prev;
+    tensor_t v_scale_prev;
+    cache->get_scales(k_scale_prev, v_scale_prev, layer);
+    std::vector<size_t> scale_shape{k->shape()[0], k->shape()[1]};
+    tensor_t k_q = Tensor::create(k->shape(), k_prev->dtype(), k->deviceType(), k->deviceId());
+    tensor_t v_q = Tensor::create(v->shape(), v_prev->dtype(), v->deviceType(), v->deviceId());
+    tensor_t k_scale = Tensor::create(scale_shape, LLAISYS_DTYPE_F32, k->deviceType(), k->deviceId());
+    tensor_t v_scale = Tensor::create(scale_shape, LLAISYS_DTYPE_F32, v->deviceType(), v->deviceId());
+    ops::quantize_kv(k_q, k_scale, k);
+    ops::quantize_kv(v_q, v_scale, v);
+    ops::self_attention_quantized(attn_val, q, concat_seq(k_prev, k_q), concat_seq(v_prev, v_q),
+                                  concat_seq(k_scale_prev, k_scale), concat_seq(v_scale_prev, v_scale), scale,
+                                  window);
+}
+
+// StreamingLLM 缓存：写入 rope 前的 K，读取时得到按缓存内位置旋转后的 K。
+// 单 token 先写后读（写入时已淘汰最旧的 token）；多 token 分块先读取已有缓存与本块拼接，再写入
+void streaming_attention(tensor_t& attn_val, tensor_t& q, tensor_t& k_rope, tensor_t& k, tensor_t& v,
+                         llaisys::KVcache::CacheHandle_t& cache, size_t layer, float scale) {
+    tensor_t k_attn;
+    tensor_t v_attn;
+    if (q->shape()[0] == 1) {
+        cache->append(layer, k, v);
+        cache->get(k_attn, v_attn, layer);
+        ops::self_attention(attn_val, q, k_attn, v_attn, scale);
+        return;
+    }
+    cache->get(k_attn, v_attn, layer);
+    ops::self_attention(attn_val, q, concat_seq(k_attn, k_rope), concat_seq(v_attn, v), scale);
+    cache->append(layer, k, v);
+}
+// 带 KV 缓存的 rope 与注意力：本批 K/V 写入缓存后与历史一起参与注意力
+void cached_attention(tensor_t& attn_val, tensor_t& q_3d, tensor_t& k_3d, tensor_t& v_3d,
+                      llaisys::KVcache::CacheHandle_t& cache, const rotary_table& rope_table, float rope_theta,
+                      tensor_t pos_ids, size_t token_pos, size_t layer, float scale, size_t window) {
+    const size_t seq_len = q_3d->shape()[0];
+    const llaisysDataType_t dtype = q_3d->dtype();
+    const llaisysDeviceType_t device_type = q_3d->deviceType();
+    const int device_id = q_3d->deviceId();
+    const std::vector<size_t> &ghq_k_shape = k_3d->shape();
+    // rope
+    tensor_t q_rope = llaisys::Tensor::create(q_3d->shape(), dtype, device_type, device_id);
+    tensor_t k_rope;
+    // 自行旋转 K 的缓存按缓存内位置做 rope，而不是 token 在对话中的位置；
+    // pos_ids 由模型每步准备一次，各层共用
+    size_t rope_pos = cache->rotates_keys() ? cache->rope_offset(layer, seq_len) : token_pos;
+    ASSERT(pos_ids->shape()[0] == seq_len, "qwen2_decoder: pos_ids length mismatch");
+    bool use_table = rope_table.cos != nullptr && rope_pos + seq_len <= rope_table.cos->shape()[0];
+    bool paged_decode = cache->is_paged() && seq_len == 1 && device_type == LLAISYS_DEVICE_NVIDIA;
+    // 分页缓存从头 prefill 时注意力只需本块的 K/V；对话中途的续接块先写入页，再读出整段上下文做注意力
+    bool paged_first_chunk = cache->is_paged() && !paged_decode && token_pos == 0;
+    bool windowed_prefill = window > 0 && seq_len > 1 && !cache->is_paged();
+    // 注意力只从缓存读取 K 时，K 旋转后直接写进缓存，不再经过 k_rope
+    bool kv_written = use_table && !cache->rotates_keys() && !windowed_prefill && !paged_first_chunk &&
+                      cache->append_rope(layer, k_3d, v_3d, pos_ids, rope_table.cos, rope_table.sin, token_pos);
+    // 位置落在表内时查表旋转，超出表长（如流式会话）时退回现算
+    if (kv_written) {
+        ops::rope(q_rope, q_3d, pos_ids, rope_table.cos, rope_table.sin);
+    } else {
+        k_rope = llaisys::Tensor::create(ghq_k_shape, dtype, device_type, device_id);
+        if (use_table) {
+            ops::rope_qk(q_rope, k_rope, q_3d, k_3d, pos_ids, rope_table.cos, rope_table.sin);
+        } else {
+            ops::rope(q_rope, q_3d, pos_ids, rope_theta);
+            ops::rope(k_rope, k_3d, pos_ids, rope_theta);
+        }
+        LOG_TENSOR_META_AT("k_rope:", k_rope);
+    }
+    LOG_TENSOR_META_AT("q_rope:", q_rope);
+    // GQA
+    if (cache->rotates_keys()) {
+        streaming_attention(attn_val, q_rope, k_rope, k_3d, v_3d, cache, layer, scale);
+    } else if (windowed_prefill) {
+        // 滑动窗口层一次写入多个 token 时，环形存储会覆盖本批前部 query 仍可见的 key，
+        // 因此先取出窗口内的历史与本批拼接做注意力，再写入缓存
+        windowed_attention(attn_val, q_rope, k_rope, v_3d, cache, layer, scale, window);
+        cache->append(layer, k_rope, v_3d, token_pos);
+    } else {
+        if (!kv_written) {
+            cache->append(layer, k_rope, v_3d, token_pos);
+        }
+        if (paged_decode) {
+            ops::self_attention_paged(attn_val, q_rope, cache->paged_kv_data(layer), cache->kv_indptr(),
+                                      cache->kv_indices(), cache->kv_last_page_len(), cache->block_size(),
+                                      scale);
+        } else {
+            tensor_t k_attn;
+            tensor_t v_attn;
+            if (paged_first_chunk) {
+                k_attn = k_rope;
+                v_attn = v_3d;
+            } else {
+                cache->get(k_attn, v_attn, layer);
+                LOG_TENSOR_META_AT("k_attn:", k_attn);
+                LOG_TENSOR_META_AT("v_attn:", v_attn);
+            }
+            if (!cache->is_paged() && cache->is_quantized()) {
+                tensor_t k_scale;
+                tensor_t v_scale;
+                cache->get_scales(k_scale, v_scale, layer);
+                ops::self_attention_quantized(attn_val, q_rope, k_attn, v_attn, k_scale, v_scale, scale, window);
+            } else {
+                ops::self_attention(attn_val, q_rope, k_attn, v_attn, scale, window);
+            }
+        }
+    }
+}
+
+// 无缓存的打包前向（文本向量）：各序列首尾相接，pos_ids 在每个序列内从 0 开始；
+// q/k/v 整批做 rope，注意力按序列切片分别计算，不跨序列
+void packed_attention(tensor_t& attn_val, tensor_t& q_3d, tensor_t& k_3d, tensor_t& v_3d, tensor_t pos_ids,
+                      const rotary_table& rope_table, float rope_theta, const std::vector<size_t>& seq_lens,
+                      float scale, size_t window) {
+    const llaisysDataType_t dtype = q_3d->dtype();
+    const llaisysDeviceType_t device_type = q_3d->deviceType();
+    const int device_id = q_3d->deviceId();
+    tensor_t q_rope = llaisys::Tensor::create(q_3d->shape(), dtype, device_type, device_id);
+    tensor_t k_rope = llaisys::Tensor::create(k_3d->shape(), dtype, device_type, device_id);
+    const size_t max_len = seq_lens.empty() ? 0 : *std::max_element(seq_lens.begin(), seq_lens.end());
+    if (rope_table.cos != nullptr && max_len <= rope_table.cos->shape()[0]) {
+        ops::rope_qk(q_rope, k_rope, q_3d, k_3d, pos_ids, rope_table.cos, rope_table.sin);
+    } else {
+        ops::rope(q_rope, q_3d, pos_ids, rope_theta);
+        ops::rope(k_rope, k_3d, pos_ids, rope_theta);
+    }
+    size_t begin = 0;
+    for (size_t len : seq_lens) {
+        const size_t end = begin + len;
+        ops::self_attention(attn_val->slice(0, begin, end), q_rope->slice(0, begin, end), k_rope->slice(0, begin, end),
+                            v_3d->slice(0, begin, end), scale, window);
+        begin = end;
+    }
+    ASSERT(begin == q_3d->shape()[0], "packed_attention: seq_lens do not add up to the batch");
+}
+} // namespace
 
 tensor_t qwen2_decoder(tensor_t& hidden_states, const layer_weights& weights, llaisys::KVcache::CacheHandle_t cache,
-                       const llaisys::model::meta_data& meta_data, size_t token_pos, size_t layer, int device_id) {
+                       const llaisys::model::meta_data& meta_data, const rotary_table& rope_table, tensor_t pos_ids,
+                       size_t token_pos, size_t layer, int device_id, const tensor_parallel_rank* tp,
+                       const std::vector<size_t>* seq_lens) {
     LOG_INFO("qwen2_decoder::begin:token_pos:" << token_pos);
     LOG_INFO("qwen2_decoder::begin:nlayer: " << layer);
     LOG_TENSOR_META_AT("qwen2_decoder::begin:hidden_states", hidden_states);
     // step1：shape检查
     size_t hidden_size = meta_data.hidden_size;                 // 1536
-    size_t num_attention_heads = meta_data.num_attention_heads; // 12
-    size_t num_key_value_heads = meta_data.num_key_value_heads; // 2
+    size_t world = tp ? tp->world : 1;
+    size_t head_dim = hidden_size / meta_data.num_attention_heads; // 128
+    // 张量并行时只计算本 rank 的头与中间维
+    size_t num_attention_heads = meta_data.num_attention_heads / world; // 12
+    size_t num_key_value_heads = meta_data.num_key_value_heads / world; // 2
     size_t seq_len = hidden_states->shape()[0];
-    size_t head_dim = hidden_size / num_attention_heads; // 128
+    size_t q_dim = num_attention_heads * head_dim;
     size_t kv_dim = num_key_value_heads * head_dim;      // 256
     ASSERT(hidden_states->shape()[1] == hidden_size, "qwen2_decoder: hidden_size mismatch");
     // 读取权重指针
@@ -43,7 +205,7 @@ tensor_t qwen2_decoder(tensor_t& hidden_states, const layer_weights& weights, ll
     ops::rms_norm(input_normed_states, hidden_states, input_lm_weight->weights(), rms_norm_eps);
     LOG_TENSOR_META_AT("input_normed_states:", input_normed_states);
     // Q,K,V投影,调用Linear算子
-    std::vector<size_t> Q_shape{seq_len, hidden_size};
+    std::vector<size_t> Q_shape{seq_len, q_dim};
     std::vector<size_t> K_shape{seq_len, kv_dim};
     std::vector<size_t> V_shape{seq_len, kv_dim};
     tensor_t q = llaisys::Tensor::create(Q_shape, dtype, device_type, device_id);
@@ -61,56 +223,26 @@ tensor_t qwen2_decoder(tensor_t& hidden_states, const layer_weights& weights, ll
     tensor_t q_3d = q->reshape(ghq_q_shape);
     tensor_t k_3d = k->reshape(ghq_k_shape);
     tensor_t v_3d = v->reshape(ghq_v_shape);
-    // rope
-    tensor_t q_rope = llaisys::Tensor::create(ghq_q_shape, dtype, device_type, device_id);
-    tensor_t k_rope = llaisys::Tensor::create(ghq_k_shape, dtype, device_type, device_id);
-    std::vector<int64_t> pos_ids_host(seq_len);
-    for (size_t i = 0; i < seq_len; ++i) {
-        pos_ids_host[i] = static_cast<int64_t>(token_pos + i);
-    }
-    tensor_t pos_ids = llaisys::Tensor::create({seq_len}, LLAISYS_DTYPE_I64, device_type, device_id);
-    llaisys::core::context().setDevice(device_type, device_id);
-    auto& runtime = llaisys::core::context().runtime();
-    llaisysMemcpyKind_t pos_kind = (device_type == LLAISYS_DEVICE_CPU) ? LLAISYS_MEMCPY_H2H : LLAISYS_MEMCPY_H2D;
-    runtime.api()->memcpy_async(pos_ids->data(), pos_ids_host.data(), seq_len * sizeof(int64_t), pos_kind,
-                                runtime.stream());
-    runtime.api()->stream_synchronize(runtime.stream());
-    ops::rope(q_rope, q_3d, pos_ids, rope_theta);
-    ops::rope(k_rope, k_3d, pos_ids, rope_theta);
-    LOG_TENSOR_META_AT("q_rope:", q_rope);
-    LOG_TENSOR_META_AT("k_rope:", k_rope);
-    runtime.api()->stream_synchronize(runtime.stream());
-    cache->append(layer, k_rope, v_3d, token_pos);
-    // GQA
-    tensor_t attn_val = Tensor::create(q_rope->shape(), dtype, device_type, device_id);
+    size_t window = llaisys::model::layer_sliding_window(meta_data, layer);
     float scale = 1 / sqrt(static_cast<float>(head_dim));
-    if (cache->is_paged() && seq_len == 1 && device_type == LLAISYS_DEVICE_NVIDIA) {
-#ifdef ENABLE_NVIDIA_API
-        cudaDeviceSynchronize();
-#endif
-        ops::self_attention_paged(attn_val, q_rope, cache->paged_kv_data(layer), cache->kv_indptr(),
-                                  cache->kv_indices(), cache->kv_last_page_len(), cache->block_size(),
-                                  scale);
+    tensor_t attn_val = Tensor::create(ghq_q_shape, dtype, device_type, device_id);
+    if (cache == nullptr) {
+        ASSERT(seq_lens != nullptr, "qwen2_decoder: seq_lens is required without a cache");
+        packed_attention(attn_val, q_3d, k_3d, v_3d, pos_ids, rope_table, rope_theta, *seq_lens, scale, window);
     } else {
-        tensor_t k_attn;
-        tensor_t v_attn;
-        if (cache->is_paged()) {
-            k_attn = k_rope;
-            v_attn = v_3d;
-        } else {
-            cache->get(k_attn, v_attn, layer);
-            LOG_TENSOR_META_AT("k_attn:", k_attn);
-            LOG_TENSOR_META_AT("v_attn:", v_attn);
-        }
-        ops::self_attention(attn_val, q_rope, k_attn, v_attn, scale);
+        cached_attention(attn_val, q_3d, k_3d, v_3d, cache, rope_table, rope_theta, pos_ids, token_pos, layer, scale,
+                         window);
     }
     LOG_TENSOR_META_AT("attn_val", attn_val);
-    tensor_t attn_val_2d = attn_val->reshape({seq_len, hidden_size});
+    tensor_t attn_val_2d = attn_val->reshape({seq_len, q_dim});
     LOG_TENSOR_META_AT("attn_val_2d", attn_val_2d);
     tensor_t attn_output = Tensor::create({seq_len, hidden_size}, dtype, device_type, device_id);
     LOG_TENSOR_META_AT("attn_output", attn_output);
     LOG_TENSOR_META_AT("Wo:", Wo->weights());
     ops::linear(attn_output, attn_val_2d, Wo->weights(), nullptr);
+    if (tp) {
+        tp->all_reduce(attn_output);
+    }
     LOG_TENSOR_META_AT("attn_output", attn_output);
     // 残差连接
     tensor_t self_attn_output = Tensor::create({seq_len, hidden_size}, dtype, device_type, device_id);
@@ -120,7 +252,7 @@ tensor_t qwen2_decoder(tensor_t& hidden_states, const layer_weights& weights, ll
     tensor_t post_attn_normed = Tensor::create({seq_len, hidden_size}, dtype, device_type, device_id);
     ops::rms_norm(post_attn_normed, self_attn_output, post_attn_weight->weights(), rms_norm_eps);
     LOG_TENSOR_META_AT("post_attn_normed", post_attn_normed);
-    size_t intermediate_size = meta_data.intermediate_size;
+    size_t intermediate_size = meta_data.intermediate_size / world;
     tensor_t gate_proj = Tensor::create({seq_len, intermediate_size}, dtype, device_type, device_id);
     tensor_t up_proj = Tensor::create({seq_len, intermediate_size}, dtype, device_type, device_id);
     ops::linear(gate_proj, post_attn_normed, gate->weights(), nullptr);
@@ -131,6 +263,9 @@ tensor_t qwen2_decoder(tensor_t& hidden_states, const layer_weights& weights, ll
 
     tensor_t mlp_out = Tensor::create({seq_len, hidden_size}, dtype, device_type, device_id);
     ops::linear(mlp_out, mlp_hidden, down->weights(), nullptr);
+    if (tp) {
+        tp->all_reduce(mlp_out);
+    }
 
     tensor_t output = Tensor::create({seq_len, hidden_size}, dtype, device_type, device_id);
 
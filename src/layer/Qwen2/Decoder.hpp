@@ -1,3 +1,4 @@
+#pragma once
 #include "../../KVcache/CacheHandle.hpp"
 #include "../../model/model_utils.hpp"
 #include "../../ops/ops.hpp"
@@ -5,16 +6,37 @@
 #include "../../weights/Qwen2/qwen2_weights.hpp"
 #include <cstddef>
 #include <cstdint>
+#include <functional>
 #include <memory>
 #include <vector>
 
 namespace llaisys::Qwen2 {
+// 预计算的 rope cos/sin 表 [max_pos, head_dim/2]，模型加载时构建一次；为空时退回现算
+struct rotary_table {
+    tensor_t cos;
+    tensor_t sin;
+};
+
+// 张量并行时本 rank 的切分：q/k/v/gate/up 按输出行切、o/down 按输入列切，本 rank 只有 1/world 的
+// 注意力头、KV 头与 MLP 中间维；o 与 down 的输出是部分和，经 all_reduce 跨 rank 求和后各 rank 一致
+struct tensor_parallel_rank {
+    size_t rank = 0;
+    size_t world = 1;
+    std::function<void(tensor_t)> all_reduce;
+};
+
+// cache 为空时是无缓存的打包前向：hidden_states 为多个序列首尾相接，seq_lens 给出各序列长度，
+// pos_ids 在每个序列内从 0 开始，注意力不跨序列，token_pos 不使用
 tensor_t qwen2_decoder(
     tensor_t &hidden_states,
     const llaisys::Qwen2::layer_weights &weights,
     llaisys::KVcache::CacheHandle_t cache,
     const llaisys::model::meta_data &meta_data,
+    const rotary_table &rope_table,
+    tensor_t pos_ids,
     size_t token_pos,
     size_t layer,
-    int device_id = 0);
+    int device_id = 0,
+    const tensor_parallel_rank *tp = nullptr,
+    const std::vector<size_t> *seq_lens = nullptr);
 }
\ No newline at end of file
@@ -4,13 +4,18 @@
 
 #include "../ops/add/op.hpp"
 #include "../ops/argmax/op.hpp"
+#include "../ops/bmm/op.hpp"
 #include "../ops/embedding/op.hpp"
+#include "../ops/kv_quant/op.hpp"
 #include "../ops/linear/op.hpp"
+#include "../ops/paged_kv_scatter/op.hpp"
 #include "../ops/rearrange/op.hpp"
 #include "../ops/rms_norm/op.hpp"
 #include "../ops/rope/op.hpp"
+#include "../ops/rope_append_kv/op.hpp"
 #include "../ops/self_attention/op.hpp"
 #include "../ops/swiglu/op.hpp"
+#include "../ops/topk/op.hpp"
 
 __C {
     void llaisysAdd(llaisysTensor_t c, llaisysTensor_t a, llaisysTensor_t b) {
@@ -19,25 +24,75 @@ __C {
     void llaisysArgmax(llaisysTensor_t max_idx, llaisysTensor_t max_val, llaisysTensor_t vals) {
         llaisys::ops::argmax(max_idx->tensor, max_val->tensor, vals->tensor);
     }
+    void llaisysBmm(llaisysTensor_t c, llaisysTensor_t a, llaisysTensor_t b, int trans_a, int trans_b, float alpha, float beta) {
+        llaisys::ops::bmm(c->tensor, a->tensor, b->tensor, trans_a != 0, trans_b != 0, alpha, beta);
+    }
     void llaisysEmbedding(llaisysTensor_t out, llaisysTensor_t index, llaisysTensor_t weight) {
         llaisys::ops::embedding(out->tensor, index->tensor, weight->tensor);
     }
     void llaisysLinear(llaisysTensor_t out, llaisysTensor_t in, llaisysTensor_t weight, llaisysTensor_t bias) {
         llaisys::ops::linear(out->tensor, in->tensor, weight->tensor, bias->tensor);
     }
+    void llaisysLinearTopk(llaisysTensor_t out_idx, llaisysTensor_t out_val, llaisysTensor_t lse, llaisysTensor_t in, llaisysTensor_t weight) {
+        llaisys::ops::linear_topk(out_idx->tensor, out_val->tensor, lse ? lse->tensor : nullptr, in->tensor, weight->tensor);
+    }
+    void llaisysLinearLogprob(llaisysTensor_t out, llaisysTensor_t in, llaisysTensor_t weight, llaisysTensor_t target) {
+        llaisys::ops::linear_logprob(out->tensor, in->tensor, weight->tensor, target->tensor);
+    }
     void llaisysRearrange(llaisysTensor_t out, llaisysTensor_t in) {
         llaisys::ops::rearrange(out->tensor, in->tensor);
     }
+    void llaisysPagedKVScatter(llaisysTensor_t paged_kv, llaisysTensor_t k, llaisysTensor_t v, llaisysTensor_t slot_mapping) {
+        llaisys::ops::paged_kv_scatter(paged_kv->tensor, k->tensor, v->tensor, slot_mapping->tensor);
+    }
+    void llaisysPagedKVGather(llaisysTensor_t k, llaisysTensor_t v, llaisysTensor_t paged_kv, llaisysTensor_t slot_mapping) {
+        llaisys::ops::paged_kv_gather(k->tensor, v->tensor, paged_kv->tensor, slot_mapping->tensor);
+    }
     void llaisysRmsNorm(llaisysTensor_t out, llaisysTensor_t in, llaisysTensor_t weight, float eps) {
         llaisys::ops::rms_norm(out->tensor, in->tensor, weight->tensor, eps);
     }
     void llaisysROPE(llaisysTensor_t out, llaisysTensor_t in, llaisysTensor_t pos_ids, float theta) {
         llaisys::ops::rope(out->tensor, in->tensor, pos_ids->tensor, theta);
     }
+    void llaisysROPEInitTable(llaisysTensor_t cos, llaisysTensor_t sin, float theta) {
+        llaisys::ops::rope_init_table(cos->tensor, sin->tensor, theta);
+    }
+    void llaisysROPETable(llaisysTensor_t out, llaisysTensor_t in, llaisysTensor_t pos_ids, llaisysTensor_t cos, llaisysTensor_t sin) {
+        llaisys::ops::rope(out->tensor, in->tensor, pos_ids->tensor, cos->tensor, sin->tensor);
+    }
+    void llaisysROPEQK(llaisysTensor_t q_out, llaisysTensor_t k_out, llaisysTensor_t q, llaisysTensor_t k,
+                       llaisysTensor_t pos_ids, llaisysTensor_t cos, llaisysTensor_t sin) {
+        llaisys::ops::rope_qk(q_out->tensor, k_out->tensor, q->tensor, k->tensor, pos_ids->tensor, cos->tensor, sin->tensor);
+    }
+    void llaisysROPEAppendKV(llaisysTensor_t k_cache, llaisysTensor_t v_cache, llaisysTensor_t k, llaisysTensor_t v,
+                             llaisysTensor_t pos_ids, llaisysTensor_t cos, llaisysTensor_t sin) {
+        llaisys::ops::rope_append_kv(k_cache->tensor, v_cache->tensor, k->tensor, v->tensor,
+                                     pos_ids->tensor, cos->tensor, sin->tensor);
+    }
+    void llaisysROPEAppendKVPaged(llaisysTensor_t paged_kv, llaisysTensor_t k, llaisysTensor_t v, llaisysTensor_t pos_ids,
+                                  llaisysTensor_t cos, llaisysTensor_t sin, llaisysTensor_t slot_mapping) {
+        llaisys::ops::rope_append_kv_paged(paged_kv->tensor, k->tensor, v->tensor, pos_ids->tensor,
+                                           cos->tensor, sin->tensor, slot_mapping->tensor);
+    }
     void llaisysSelfAttention(llaisysTensor_t attn_val, llaisysTensor_t q, llaisysTensor_t k, llaisysTensor_t v, float scale) {
         llaisys::ops::self_attention(attn_val->tensor, q->tensor, k->tensor, v->tensor, scale);
     }
+    void llaisysSelfAttentionWindowed(llaisysTensor_t attn_val, llaisysTensor_t q, llaisysTensor_t k, llaisysTensor_t v,
+                                      float scale, size_t window) {
+        llaisys::ops::self_attention(attn_val->tensor, q->tensor, k->tensor, v->tensor, scale, window);
+    }
+    void llaisysSelfAttentionQuantized(llaisysTensor_t attn_val, llaisysTensor_t q, llaisysTensor_t k, llaisysTensor_t v,
+                                       llaisysTensor_t k_scale, llaisysTensor_t v_scale, float scale, size_t window) {
+        llaisys::ops::self_attention_quantized(attn_val->tensor, q->tensor, k->tensor, v->tensor,
+                                               k_scale->tensor, v_scale->tensor, scale, window);
+    }
+    void llaisysQuantizeKV(llaisysTensor_t out, llaisysTensor_t scale, llaisysTensor_t in) {
+        llaisys::ops::quantize_kv(out->tensor, scale->tensor, in->tensor);
+    }
     void llaisysSwiGLU(llaisysTensor_t out, llaisysTensor_t gate, llaisysTensor_t up) {
         llaisys::ops::swiglu(out->tensor, gate->tensor, up->tensor);
     }
+    void llaisysTopk(llaisysTensor_t out_idx, llaisysTensor_t out_val, llaisysTensor_t vals) {
+        llaisys::ops::topk(out_idx->tensor, out_val->tensor, vals->tensor);
+    }
 }
@@ -1,9 +1,14 @@
 
 #include "llaisys/models/qwen2.h"
 #include "../model/Qwen2/model_qwen2.hpp"
+#include "../model/engine.hpp"
 #include "../model/model_utils.hpp"
 #include "llaisys_tensor.hpp"
+#include <algorithm>
 #include <cstring>
+#include <exception>
+#include <memory>
+#include <mutex>
 #include <vector>
 
 extern "C" {
@@ -25,6 +30,9 @@ struct LlaisysQwen2Model {
     std::vector<llaisysTensor_t> mlp_gate_w;
     std::vector<llaisysTensor_t> mlp_up_w;
     std::vector<llaisysTensor_t> mlp_down_w;
+    // 后台推理引擎：首次推理时创建，同步与异步接口都经由它执行
+    std::mutex engine_mutex;
+    std::unique_ptr<llaisys::model::Engine> engine;
 };
 
 struct LlaisysWeightBuffer {
@@ -152,6 +160,9 @@ __export void llaisysQwen2ModelDestroy(struct LlaisysQwen2Model* model) {
     if (!model) {
         return;
     }
+    if (model->engine) {
+        model->engine->shutdown();
+    }
     clear_weights(model);
     if (model->qwen2_model) {
         auto impl = std::dynamic_pointer_cast<llaisys::model::Model_Qwen2>(model->qwen2_model);
@@ -160,6 +171,8 @@ __export void llaisysQwen2ModelDestroy(struct LlaisysQwen2Model* model) {
         }
         model->qwen2_model.reset();
     }
+    // 引擎最后释放：模型在其工作线程上分配的缓冲要在工作线程退出前归还
+    model->engine.reset();
     delete model;
 }
 
@@ -246,31 +259,61 @@ __export struct LlaisysQwen2Weights* llaisysQwen2ModelWeights(struct LlaisysQwen
     return &model->c_weights;
 }
 
+static llaisys::model::Engine* engine_of(LlaisysQwen2Model* model) {
+    std::lock_guard<std::mutex> lock(model->engine_mutex);
+    if (!model->engine) {
+        model->engine = std::make_unique<llaisys::model::Engine>(model->qwen2_model);
+    }
+    return model->engine.get();
+}
+
+static bool is_terminal(llaisys::model::RequestStatus status) {
+    return status == llaisys::model::RequestStatus::Finished || status == llaisys::model::RequestStatus::Cancelled ||
+           status == llaisys::model::RequestStatus::Failed;
+}
+
+// 提交请求并阻塞到它结束，返回输入与生成的全部 token；失败时返回空
+static std::vector<int64_t> run_request(LlaisysQwen2Model* model, std::vector<int64_t> tokens, size_t max_steps) {
+    auto engine = engine_of(model);
+    uint64_t id = engine->submit(std::move(tokens), max_steps);
+    auto status = engine->wait(id);
+    while (!is_terminal(status)) {
+        // 同步调用只需要最终结果，逐 token 的输出直接丢弃
+        int64_t drained[64];
+        while (engine->poll(id, drained, 64) > 0) {
+        }
+        status = engine->wait(id);
+    }
+    std::vector<int64_t> outputs;
+    if (status != llaisys::model::RequestStatus::Failed) {
+        outputs = engine->tokens(id);
+    }
+    engine->release(id);
+    return outputs;
+}
+
 __export int64_t llaisysQwen2ModelInfer(struct LlaisysQwen2Model* model, int64_t* token_ids, size_t ntoken) {
     if (!model || !model->qwen2_model || !token_ids || ntoken == 0) {
         return -1;
     }
-    auto impl = std::dynamic_pointer_cast<llaisys::model::Model_Qwen2>(model->qwen2_model);
-    if (!impl) {
+    std::vector<int64_t> tokens(token_ids, token_ids + ntoken);
+    auto outputs = run_request(model, tokens, 1);
+    if (outputs.size() <= ntoken) {
         return -1;
     }
-    std::vector<int64_t> tokens(token_ids, token_ids + ntoken);
-    auto session = impl->createSession(tokens);
-    auto outputs = impl->inferStep(session);
-    return outputs.next_token;
+    return outputs[ntoken];
 }
 
 __export int64_t llaisysQwen2ModelInferDialog(struct LlaisysQwen2Model* model, int64_t* token_ids, size_t ntoken,
                                               size_t max_steps, int64_t* out_tokens, size_t out_ntoken) {
-    if (!model || !model->qwen2_model || !token_ids || ntoken == 0) {
+    if (!model || !model->qwen2_model || !token_ids || ntoken == 0 || max_steps == 0) {
         return -1;
     }
-    auto impl = std::dynamic_pointer_cast<llaisys::model::Model_Qwen2>(model->qwen2_model);
-    if (!impl) {
+    std::vector<int64_t> tokens(token_ids, token_ids + ntoken);
+    auto outputs = run_request(model, tokens, max_steps);
+    if (outputs.empty()) {
         return -1;
     }
-    std::vector<int64_t> tokens(token_ids, token_ids + ntoken);
-    auto outputs = impl->inferDialog(tokens, max_steps);
     const size_t total = outputs.size();
     if (!out_tokens || out_ntoken == 0) {
         return static_cast<int64_t>(total);
@@ -279,4 +322,267 @@ __export int64_t llaisysQwen2ModelInferDialog(struct LlaisysQwen2Model* model, i
     std::memcpy(out_tokens, outputs.data(), to_copy * sizeof(int64_t));
     return static_cast<int64_t>(total);
 }
-}
\ No newline at end of file
+
+static llaisys::model::TokenCallback wrap_callback(llaisysQwen2TokenCallback callback, void* user_data) {
+    if (!callback) {
+        return {};
+    }
+    return [callback, user_data](uint64_t id, int64_t token, bool finished) {
+        return callback(static_cast<int64_t>(id), token, finished ? 1 : 0, user_data) == 0;
+    };
+}
+
+static int64_t submit_request(LlaisysQwen2Model* model, int64_t* token_ids, size_t ntoken,
+                              llaisys::model::GenerationConfig gen, llaisysQwen2TokenCallback callback,
+                              void* user_data) {
+    auto on_token = wrap_callback(callback, user_data);
+    try {
+        std::vector<int64_t> tokens(token_ids, token_ids + ntoken);
+        return static_cast<int64_t>(engine_of(model)->submit(std::move(tokens), std::move(gen), std::move(on_token)));
+    } catch (const std::exception&) {
+        return -1;
+    }
+}
+
+__export int64_t llaisysQwen2ModelSubmit(struct LlaisysQwen2Model* model, int64_t* token_ids, size_t ntoken,
+                                         size_t max_new_tokens, llaisysQwen2TokenCallback callback,
+                                         void* user_data) {
+    if (!model || !model->qwen2_model || (!token_ids && ntoken > 0) || max_new_tokens == 0) {
+        return -1;
+    }
+    llaisys::model::GenerationConfig gen;
+    gen.max_new_tokens = max_new_tokens;
+    return submit_request(model, token_ids, ntoken, std::move(gen), callback, user_data);
+}
+
+// 检查并转换 C 的生成配置，配置无效时返回 false
+static bool to_generation_config(LlaisysQwen2Model* model, const LlaisysQwen2GenerationConfig* config,
+                                 llaisys::model::GenerationConfig& gen) {
+    if (!config || config->max_new_tokens == 0 || (!config->eos_token_ids && config->n_eos_token_ids > 0) ||
+        (config->n_stop_sequences > 0 && (!config->stop_tokens || !config->stop_lengths)) ||
+        config->top_logprobs > model->qwen2_model->config().vocab_size) {
+        return false;
+    }
+    gen.max_new_tokens = config->max_new_tokens;
+    gen.max_length = config->max_length;
+    gen.eos_token_ids.assign(config->eos_token_ids, config->eos_token_ids + config->n_eos_token_ids);
+    const int64_t* stop = config->stop_tokens;
+    for (size_t i = 0; i < config->n_stop_sequences; ++i) {
+        gen.stop_sequences.emplace_back(stop, stop + config->stop_lengths[i]);
+        stop += config->stop_lengths[i];
+    }
+    gen.logprobs = config->logprobs != 0;
+    gen.top_logprobs = config->top_logprobs;
+    return true;
+}
+
+__export int64_t llaisysQwen2ModelSubmitWithConfig(struct LlaisysQwen2Model* model, int64_t* token_ids,
+                                                   size_t ntoken, const LlaisysQwen2GenerationConfig* config,
+                                                   llaisysQwen2TokenCallback callback, void* user_data) {
+    if (!model || !model->qwen2_model || (!token_ids && ntoken > 0)) {
+        return -1;
+    }
+    llaisys::model::GenerationConfig gen;
+    if (!to_generation_config(model, config, gen)) {
+        return -1;
+    }
+    return submit_request(model, token_ids, ntoken, std::move(gen), callback, user_data);
+}
+
+__export int64_t llaisysQwen2ModelPoll(struct LlaisysQwen2Model* model, int64_t request_id, int64_t* out_tokens,
+                                       size_t out_ntoken, llaisysQwen2RequestStatus_t* status) {
+    if (!model || !model->qwen2_model || request_id <= 0 || (!out_tokens && out_ntoken > 0)) {
+        return -1;
+    }
+    try {
+        llaisys::model::RequestStatus s;
+        size_t n = engine_of(model)->poll(static_cast<uint64_t>(request_id), out_tokens, out_ntoken, &s);
+        if (status) {
+            *status = static_cast<llaisysQwen2RequestStatus_t>(s);
+        }
+        return static_cast<int64_t>(n);
+    } catch (const std::exception&) {
+        return -1;
+    }
+}
+
+__export int64_t llaisysQwen2ModelPollLogprobs(struct LlaisysQwen2Model* model, int64_t request_id,
+                                               int64_t* out_tokens, float* out_logprobs, int64_t* out_top_tokens,
+                                               float* out_top_logprobs, size_t out_ntop, size_t out_ntoken,
+                                               llaisysQwen2RequestStatus_t* status) {
+    if (!model || !model->qwen2_model || request_id <= 0 || (!out_tokens && out_ntoken > 0)) {
+        return -1;
+    }
+    try {
+        llaisys::model::RequestStatus s;
+        size_t n = engine_of(model)->poll(static_cast<uint64_t>(request_id), out_tokens, out_ntoken, &s, out_logprobs,
+                                          out_top_tokens, out_top_logprobs, out_ntop);
+        if (status) {
+            *status = static_cast<llaisysQwen2RequestStatus_t>(s);
+        }
+        return static_cast<int64_t>(n);
+    } catch (const std::exception&) {
+        return -1;
+    }
+}
+
+__export int llaisysQwen2ModelWait(struct LlaisysQwen2Model* model, int64_t request_id, int64_t timeout_ms) {
+    if (!model || !model->qwen2_model || request_id <= 0) {
+        return -1;
+    }
+    try {
+        return static_cast<int>(engine_of(model)->wait(static_cast<uint64_t>(request_id), timeout_ms));
+    } catch (const std::exception&) {
+        return -1;
+    }
+}
+
+__export int llaisysQwen2ModelCancel(struct LlaisysQwen2Model* model, int64_t request_id) {
+    if (!model || !model->qwen2_model || request_id <= 0) {
+        return -1;
+    }
+    try {
+        return engine_of(model)->cancel(static_cast<uint64_t>(request_id)) ? 1 : 0;
+    } catch (const std::exception&) {
+        return -1;
+    }
+}
+
+__export int64_t llaisysQwen2ModelSubmitScore(struct LlaisysQwen2Model* model, int64_t* token_ids, size_t ntoken) {
+    if (!model || !model->qwen2_model || !token_ids || ntoken < 2) {
+        return -1;
+    }
+    try {
+        std::vector<int64_t> tokens(token_ids, token_ids + ntoken);
+        return static_cast<int64_t>(engine_of(model)->submit_score(std::move(tokens)));
+    } catch (const std::exception&) {
+        return -1;
+    }
+}
+
+__export int64_t llaisysQwen2ModelScores(struct LlaisysQwen2Model* model, int64_t request_id, float* out_logprobs,
+                                         size_t out_n) {
+    if (!model || !model->qwen2_model || request_id <= 0 || (!out_logprobs && out_n > 0)) {
+        return -1;
+    }
+    try {
+        auto scores = engine_of(model)->scores(static_cast<uint64_t>(request_id));
+        std::copy_n(scores.begin(), std::min(scores.size(), out_n), out_logprobs);
+        return static_cast<int64_t>(scores.size());
+    } catch (const std::exception&) {
+        return -1;
+    }
+}
+
+__export int64_t llaisysQwen2ModelScore(struct LlaisysQwen2Model* model, int64_t* token_ids, size_t ntoken,
+                                        float* out_logprobs) {
+    if (!out_logprobs) {
+        return -1;
+    }
+    int64_t id = llaisysQwen2ModelSubmitScore(model, token_ids, ntoken);
+    if (id < 0) {
+        return -1;
+    }
+    auto engine = engine_of(model);
+    int64_t n = -1;
+    try {
+        if (engine->wait(static_cast<uint64_t>(id)) == llaisys::model::RequestStatus::Finished) {
+            n = llaisysQwen2ModelScores(model, id, out_logprobs, ntoken - 1);
+        }
+    } catch (const std::exception&) {
+        return -1;
+    }
+    engine->release(static_cast<uint64_t>(id));
+    return n;
+}
+
+__export int llaisysQwen2ModelEmbed(struct LlaisysQwen2Model* model, int64_t* token_ids, size_t* lengths, size_t nseq,
+                                   llaisysQwen2Pooling_t pooling, float* out_embeddings) {
+    if (!model || !model->qwen2_model || !token_ids || !lengths || nseq == 0 || !out_embeddings ||
+        (pooling != LLAISYS_QWEN2_POOLING_LAST && pooling != LLAISYS_QWEN2_POOLING_MEAN)) {
+        return -1;
+    }
+    std::vector<std::vector<int64_t>> inputs;
+    const int64_t* ids = token_ids;
+    for (size_t i = 0; i < nseq; ++i) {
+        if (lengths[i] == 0) {
+            return -1;
+        }
+        inputs.emplace_back(ids, ids + lengths[i]);
+        ids += lengths[i];
+    }
+    auto engine = engine_of(model);
+    int ret = -1;
+    uint64_t id = 0;
+    try {
+        id = engine->submit_embed(std::move(inputs), static_cast<llaisys::model::Pooling>(pooling));
+        if (engine->wait(id) == llaisys::model::RequestStatus::Finished) {
+            auto embeddings = engine->embeddings(id);
+            std::copy(embeddings.begin(), embeddings.end(), out_embeddings);
+            ret = 0;
+        }
+    } catch (const std::exception&) {
+        return -1;
+    }
+    engine->release(id);
+    return ret;
+}
+
+__export void llaisysQwen2ModelRelease(struct LlaisysQwen2Model* model, int64_t request_id) {
+    if (!model || !model->qwen2_model || request_id <= 0) {
+        return;
+    }
+    engine_of(model)->release(static_cast<uint64_t>(request_id));
+}
+
+__export int64_t llaisysQwen2SessionCreate(struct LlaisysQwen2Model* model) {
+    if (!model || !model->qwen2_model) {
+        return -1;
+    }
+    try {
+        return static_cast<int64_t>(engine_of(model)->open_session());
+    } catch (const std::exception&) {
+        return -1;
+    }
+}
+
+__export int64_t llaisysQwen2SessionSubmit(struct LlaisysQwen2Model* model, int64_t session_id, int64_t* token_ids,
+                                           size_t ntoken, const LlaisysQwen2GenerationConfig* config,
+                                           llaisysQwen2TokenCallback callback, void* user_data) {
+    if (!model || !model->qwen2_model || session_id <= 0 || (!token_ids && ntoken > 0)) {
+        return -1;
+    }
+    llaisys::model::GenerationConfig gen;
+    if (!to_generation_config(model, config, gen)) {
+        return -1;
+    }
+    try {
+        std::vector<int64_t> tokens(token_ids, token_ids + ntoken);
+        return static_cast<int64_t>(engine_of(model)->submit_turn(static_cast<uint64_t>(session_id), std::move(tokens),
+                                                                  std::move(gen), wrap_callback(callback, user_data)));
+    } catch (const std::exception&) {
+        return -1;
+    }
+}
+
+__export int64_t llaisysQwen2SessionTokens(struct LlaisysQwen2Model* model, int64_t session_id, int64_t* out_tokens,
+                                           size_t out_ntoken) {
+    if (!model || !model->qwen2_model || session_id <= 0 || (!out_tokens && out_ntoken > 0)) {
+        return -1;
+    }
+    try {
+        auto tokens = engine_of(model)->session_tokens(static_cast<uint64_t>(session_id));
+        std::copy_n(tokens.begin(), std::min(tokens.size(), out_ntoken), out_tokens);
+        return static_cast<int64_t>(tokens.size());
+    } catch (const std::exception&) {
+        return -1;
+    }
+}
+
+__export void llaisysQwen2SessionDestroy(struct LlaisysQwen2Model* model, int64_t session_id) {
+    if (!model || !model->qwen2_model || session_id <= 0) {
+        return;
+    }
+    engine_of(model)->close_session(static_cast<uint64_t>(session_id));
+}
+}
@@ -1,5 +1,6 @@
 #include "llaisys/runtime.h"
 #include "../core/context/context.hpp"
+#include "../device/cpu/cpu_isa.hpp"
 #include "../device/runtime_api.hpp"
 
 // Llaisys API for setting context runtime.
@@ -10,4 +11,21 @@ __C void llaisysSetContextRuntime(llaisysDeviceType_t device_type, int device_id
 // Llaisys API for getting the runtime APIs
 __C const LlaisysRuntimeAPI *llaisysGetRuntimeAPI(llaisysDeviceType_t device_type) {
     return llaisys::device::getRuntimeAPI(device_type);
-}
\ No newline at end of file
+}
+
+// Llaisys API for selecting the CPU kernel ISA
+__C int llaisysSetCpuIsa(const char *isa) {
+    llaisys::device::cpu::Isa value;
+    if (!llaisys::device::cpu::parse_isa(isa, &value)
+        || static_cast<int>(value) > static_cast<int>(llaisys::device::cpu::detected_isa())) {
+        return -1;
+    }
+    llaisys::device::cpu::set_isa(value);
+    return 0;
+}
+
+// Llaisys API for querying the CPU kernel ISA
+__C const char *llaisysGetCpuIsa(int detected) {
+    return llaisys::device::cpu::isa_name(detected ? llaisys::device::cpu::detected_isa()
+                                                   : llaisys::device::cpu::isa());
+}
@@ -0,0 +1,160 @@
+#include "data_parallel.hpp"
+#include "model_qwen2.hpp"
+#include "../../core/llaisys_core.hpp"
+#include "../../device/cpu/cpu_launch.hpp"
+#include "../../device/cpu/cpu_numa.hpp"
+#include "../../device/cpu/cpu_stream.hpp"
+#include "../../device/cpu/cpu_thread_pool.hpp"
+#include "../../utils.hpp"
+#include <algorithm>
+#include <future>
+#include <limits>
+
+namespace llaisys::model {
+struct DataParallelGroup::Replica {
+    size_t node = 0;
+    std::shared_ptr<Model_Qwen2> model;
+    std::vector<std::weak_ptr<ModelSession>> sessions;
+    // 驱动线程：持有本副本的 core 上下文（runtime 与 stream），按提交顺序执行推理
+    std::unique_ptr<llaisys::device::cpu::Stream> driver;
+
+    size_t live() {
+        sessions.erase(std::remove_if(sessions.begin(), sessions.end(),
+                                      [](const std::weak_ptr<ModelSession> &s) { return s.expired(); }),
+                       sessions.end());
+        return sessions.size();
+    }
+};
+
+namespace {
+// 在 driver 上执行 fn 并等待结束，异常原样抛回（不经 stream 的错误状态，避免抛给其他等待者）
+template <typename Fn>
+auto run_on(llaisys::device::cpu::Stream &driver, Fn &&fn) -> decltype(fn()) {
+    std::packaged_task<decltype(fn())()> task(std::forward<Fn>(fn));
+    auto result = task.get_future();
+    driver.submit([&task] { task(); });
+    return result.get();
+}
+} // namespace
+
+DataParallelGroup::DataParallelGroup(const Model_Qwen2 &source, size_t replicas) {
+    ASSERT(replicas > 1, "DataParallelGroup: replicas must be > 1");
+    // 共享的 rope 表可能仍在本线程的 stream 上写入，副本会在各自的 stream 上读取
+    llaisys::device::cpu::synchronize_streams();
+    auto &pool = llaisys::device::cpu::ThreadPool::instance();
+    const bool multi_node = pool.num_nodes() > 1;
+    for (size_t r = 0; r < replicas; ++r) {
+        auto replica = std::make_unique<Replica>();
+        replica->node = r % pool.num_nodes();
+        replica->driver = std::make_unique<llaisys::device::cpu::Stream>();
+        size_t node = replica->node;
+        replica->model = run_on(*replica->driver, [&source, node, multi_node] {
+            llaisys::core::context().setDevice(LLAISYS_DEVICE_CPU, 0);
+            if (multi_node) {
+                // 驱动线程与其 stream 的执行线程都绑定到本副本的节点
+                auto bind = [node] {
+                    auto &p = llaisys::device::cpu::ThreadPool::instance();
+                    llaisys::device::cpu::pin_current_thread(p.node_cpus(node));
+                    llaisys::device::cpu::ThreadPool::set_home_node(static_cast<int>(node));
+                };
+                bind();
+                llaisys::device::cpu::launch(bind);
+            }
+            auto model = source.replica();
+            auto &rt = llaisys::core::context().runtime();
+            rt.api()->stream_synchronize(rt.stream());
+            return model;
+        });
+        replicas_.push_back(std::move(replica));
+    }
+    LOG_INFO("DataParallelGroup: replicas=" << replicas << " nodes=" << pool.num_nodes());
+}
+
+DataParallelGroup::~DataParallelGroup() {
+    // 副本的缓冲分配在驱动线程的上下文里，须在驱动线程退出前释放
+    for (auto &replica : replicas_) {
+        run_on(*replica->driver, [&replica] {
+            replica->model.reset();
+            auto &rt = llaisys::core::context().runtime();
+            rt.api()->stream_synchronize(rt.stream());
+        });
+    }
+    replicas_.clear();
+}
+
+std::vector<size_t> DataParallelGroup::load() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<size_t> out;
+    for (auto &replica : replicas_) {
+        out.push_back(replica->live());
+    }
+    return out;
+}
+
+size_t DataParallelGroup::maxSessions() const {
+    size_t total = 0;
+    for (const auto &replica : replicas_) {
+        const size_t limit = replica->model->maxSessions();
+        if (limit == 0) {
+            return 0;
+        }
+        total += limit;
+    }
+    return total;
+}
+
+size_t DataParallelGroup::least_loaded() {
+    // 会话数最少的副本，相同时取编号小的
+    size_t best = 0;
+    size_t best_load = std::numeric_limits<size_t>::max();
+    for (size_t r = 0; r < replicas_.size(); ++r) {
+        size_t live = replicas_[r]->live();
+        if (live < best_load) {
+            best = r;
+            best_load = live;
+        }
+    }
+    return best;
+}
+
+session_t DataParallelGroup::createSession(std::vector<int64_t> tokens) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const size_t best = least_loaded();
+    Replica &replica = *replicas_[best];
+    // 会话的 KV 缓存在调用线程上分配（只创建张量、不提交任务），与单副本时的归属一致
+    auto session = std::make_shared<data_parallel_session>(replica.model->createSession(std::move(tokens)), best);
+    replica.sessions.push_back(session);
+    return session;
+}
+
+void DataParallelGroup::resetSession(ModelSession &session) {
+    auto *dp = dynamic_cast<data_parallel_session *>(&session);
+    ASSERT(dp != nullptr && dp->replica() < replicas_.size(), "DataParallelGroup: not a data parallel session");
+    Replica &replica = *replicas_[dp->replica()];
+    // 与 createSession 相同，新的缓存在调用线程上分配
+    replica.model->resetSession(*dp->inner());
+}
+
+InferenceOutputs DataParallelGroup::inferStep(session_t session, const InferenceOptions &options) {
+    auto dp = std::dynamic_pointer_cast<data_parallel_session>(session);
+    ASSERT(dp != nullptr && dp->replica() < replicas_.size(), "DataParallelGroup: not a data parallel session");
+    Replica &replica = *replicas_[dp->replica()];
+    return run_on(*replica.driver, [&] { return replica.model->inferStep(dp->inner(), options); });
+}
+
+std::vector<float> DataParallelGroup::embed(const std::vector<std::vector<int64_t>> &inputs, Pooling pooling) {
+    Replica *replica;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        replica = replicas_[least_loaded()].get();
+    }
+    return run_on(*replica->driver, [&] { return replica->model->embed(inputs, pooling); });
+}
+
+std::vector<float> DataParallelGroup::scoreStep(session_t session, size_t begin) {
+    auto dp = std::dynamic_pointer_cast<data_parallel_session>(session);
+    ASSERT(dp != nullptr && dp->replica() < replicas_.size(), "DataParallelGroup: not a data parallel session");
+    Replica &replica = *replicas_[dp->replica()];
+    return run_on(*replica.driver, [&] { return replica.model->scoreStep(dp->inner(), begin); });
+}
+} // namespace llaisys::model
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "../model_base.hpp"
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace llaisys::model {
+class Model_Qwen2;
+
+// 数据并行会话：包装副本上的会话，并记住它所在的副本
+class data_parallel_session : public ModelSession {
+public:
+    data_parallel_session(session_t inner, size_t replica) : inner_(std::move(inner)), replica_(replica) {}
+    const std::vector<int64_t> &tokens() const override { return inner_->tokens(); }
+    void append(int64_t next_token) override { inner_->append(next_token); }
+    size_t seq_len() const override { return inner_->seq_len(); }
+    size_t token_pos() const override { return inner_->token_pos(); }
+    void set_token_pos(size_t pos) override { inner_->set_token_pos(pos); }
+    CacheHandle_t cache() const override { return inner_->cache(); }
+
+    const session_t &inner() const { return inner_; }
+    size_t replica() const { return replica_; }
+
+private:
+    session_t inner_;
+    size_t replica_;
+};
+
+// 同一进程内的数据并行：replicas 个推理副本共用一份只读权重（Weights_t 引用计数共享）与 rope 表，
+// 各自持有 KV 缓存、id 缓冲与 decode 执行计划，并各有一个常驻驱动线程（副本的运行状态都分配在它的 core 上下文里）。
+// 会话创建时分给当前会话数最少的副本，之后每一步都提交到该副本的驱动线程上执行：
+// 同一副本上的请求按提交顺序串行，不同副本上的会话可以由多个调用线程同时推进。
+// 多 NUMA 节点时副本 r 的驱动线程绑定在节点 r % 节点数 上，其并行循环只用该节点的工作线程
+class DataParallelGroup {
+public:
+    // source 为已加载权重的模型
+    DataParallelGroup(const Model_Qwen2 &source, size_t replicas);
+    DataParallelGroup(const DataParallelGroup &) = delete;
+    DataParallelGroup &operator=(const DataParallelGroup &) = delete;
+    ~DataParallelGroup();
+
+    size_t replicas() const { return replicas_.size(); }
+    // 各副本上仍存活的会话数
+    std::vector<size_t> load();
+    // 各副本会话数上限之和，有副本不限时为 0。会话总是分给会话数最少的副本，各副本都用满之前不会有副本超出
+    size_t maxSessions() const;
+    session_t createSession(std::vector<int64_t> tokens);
+    void resetSession(ModelSession &session);
+    InferenceOutputs inferStep(session_t session, const InferenceOptions &options);
+    std::vector<float> scoreStep(session_t session, size_t begin);
+    // 交给当前会话数最少的副本执行
+    std::vector<float> embed(const std::vector<std::vector<int64_t>> &inputs, Pooling pooling);
+
+private:
+    struct Replica;
+    // 会话数最少的副本编号，调用时持有 mutex_
+    size_t least_loaded();
+
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<Replica>> replicas_;
+};
+} // namespace llaisys::model
@@ -0,0 +1,270 @@
+#include "decode_plan.hpp"
+#include "../../core/llaisys_core.hpp"
+#include "../../device/cpu/cpu_launch.hpp"
+#include "../../ops/add/cpu/add_cpu.hpp"
+#include "../../ops/embedding/cpu/embedding_cpu.hpp"
+#include "../../ops/linear/cpu/linear_cpu.hpp"
+#include "../../ops/ops.hpp"
+#include "../../ops/rms_norm/cpu/rms_norm_cpu.hpp"
+#include "../../ops/rope/cpu/rope_cpu.hpp"
+#include "../../ops/swiglu/cpu/swiglu_cpu.hpp"
+#include "../../utils.hpp"
+#ifdef ENABLE_NVIDIA_API
+#include "../../ops/add/nvidia/add_nvidia.cuh"
+#include "../../ops/embedding/nvidia/embedding_nvidia.cuh"
+#include "../../ops/linear/nvidia/linear_nvidia.cuh"
+#include "../../ops/rms_norm/nvidia/rms_norm_nvidia.cuh"
+#include "../../ops/rope/nvidia/rope_nvidia.cuh"
+#include "../../ops/swiglu/nvidia/swiglu_nvidia.cuh"
+#include <cuda_runtime.h>
+#endif
+#include <cmath>
+
+namespace llaisys::model {
+namespace {
+// 计划内的张量形状在构建时已确定，逐元素/矩阵类算子直接调用设备内核，跳过 ops:: 层每次调用的检查与分发
+struct Kernels {
+    void (*embedding)(tensor_t, tensor_t, tensor_t);
+    void (*rms_norm)(tensor_t, tensor_t, tensor_t, float);
+    void (*linear)(tensor_t, tensor_t, tensor_t, tensor_t);
+    void (*add)(tensor_t, tensor_t, tensor_t);
+    void (*swiglu)(tensor_t, tensor_t, tensor_t);
+    void (*rope)(tensor_t, tensor_t, tensor_t, tensor_t, tensor_t);
+};
+
+void cpu_add(tensor_t c, tensor_t a, tensor_t b) {
+    ops::cpu::add(c->data(), a->data(), b->data(), c->dtype(), c->numel());
+}
+
+// CPU 内核同样提交到 CPU stream，与注意力闭包中经 ops:: 提交的算子保持顺序
+template <auto Fn, typename... Args>
+void cpu_launch(Args... args) {
+    device::cpu::launch([=] { Fn(args...); });
+}
+
+Kernels resolve_kernels(llaisysDeviceType_t device_type) {
+    switch (device_type) {
+    case LLAISYS_DEVICE_CPU:
+        return {&cpu_launch<&ops::cpu::embedding, tensor_t, tensor_t, tensor_t>,
+                &cpu_launch<&ops::cpu::rms_norm, tensor_t, tensor_t, tensor_t, float>,
+                &cpu_launch<&ops::cpu::linear, tensor_t, tensor_t, tensor_t, tensor_t>,
+                &cpu_launch<&cpu_add, tensor_t, tensor_t, tensor_t>,
+                &cpu_launch<&ops::cpu::swiglu, tensor_t, tensor_t, tensor_t>,
+                &cpu_launch<static_cast<void (*)(tensor_t, tensor_t, tensor_t, tensor_t, tensor_t)>(&ops::cpu::rope),
+                            tensor_t, tensor_t, tensor_t, tensor_t, tensor_t>};
+#ifdef ENABLE_NVIDIA_API
+    case LLAISYS_DEVICE_NVIDIA:
+        return {&ops::nvidia::embedding, &ops::nvidia::rms_norm, &ops::nvidia::linear,
+                &ops::nvidia::add,       &ops::nvidia::swiglu,   &ops::nvidia::rope};
+#endif
+    default:
+        EXCEPTION_UNSUPPORTED_DEVICE;
+    }
+}
+
+#ifdef ENABLE_NVIDIA_API
+inline void check_cuda(cudaError_t err, const char *msg) {
+    ASSERT(err == cudaSuccess, msg);
+}
+#endif
+} // namespace
+
+DecodePlan::DecodePlan(const meta_data &config, const llaisys::Qwen2::qwen2_weights &weights,
+                       const llaisys::Qwen2::rotary_table &rope_table, llaisysDeviceType_t device_type,
+                       int device_id, bool use_graph)
+    : config_(config),
+      weights_(weights),
+      rope_table_(rope_table),
+      device_type_(device_type),
+      device_id_(device_id),
+      use_graph_(use_graph && device_type == LLAISYS_DEVICE_NVIDIA) {
+    ASSERT(rope_table_.cos != nullptr && rope_table_.sin != nullptr, "DecodePlan: rope table is required");
+    ASSERT(weights_.layers.size() == config_.num_hidden_layers, "DecodePlan: layers size mismatch");
+    size_t hidden_size = config_.hidden_size;
+    size_t nh = config_.num_attention_heads;
+    size_t nkvh = config_.num_key_value_heads;
+    size_t head_dim = hidden_size / nh;
+    size_t di = config_.intermediate_size;
+    llaisysDataType_t dtype = config_.torch_type;
+    auto create = [&](const std::vector<size_t> &shape) {
+        return Tensor::create(shape, dtype, device_type_, device_id_);
+    };
+    token_ids_ = Tensor::create({1}, LLAISYS_DTYPE_I64, device_type_, device_id_);
+    pos_ids_ = Tensor::create({1}, LLAISYS_DTYPE_I64, device_type_, device_id_);
+    hidden_ = create({1, hidden_size});
+    normed_ = create({1, hidden_size});
+    q_ = create({1, hidden_size});
+    k_ = create({1, nkvh * head_dim});
+    v_ = create({1, nkvh * head_dim});
+    q_3d_ = q_->reshape({1, nh, head_dim});
+    k_3d_ = k_->reshape({1, nkvh, head_dim});
+    v_3d_ = v_->reshape({1, nkvh, head_dim});
+    q_rope_ = create({1, nh, head_dim});
+    k_rope_ = create({1, nkvh, head_dim});
+    attn_val_ = create({1, nh, head_dim});
+    attn_out_ = create({1, hidden_size});
+    residual_ = create({1, hidden_size});
+    gate_ = create({1, di});
+    up_ = create({1, di});
+    act_ = create({1, di});
+    mlp_out_ = create({1, hidden_size});
+    build();
+}
+
+DecodePlan::~DecodePlan() {
+    release_graph();
+}
+
+bool DecodePlan::supports(const llaisys::KVcache::CacheHandle &cache, size_t token_pos) const {
+    if (cache.rotates_keys() || token_pos >= rope_table_.cos->shape()[0]) {
+        return false;
+    }
+    // 分页 decode 注意力只有 NVIDIA 实现
+    return !cache.is_paged() || device_type_ == LLAISYS_DEVICE_NVIDIA;
+}
+
+// 展开整步：embedding -> 各层 decoder -> final norm，输出头（lm_head 与采样）与读回留在计划外
+void DecodePlan::build() {
+    const Kernels kn = resolve_kernels(device_type_);
+    const float eps = config_.rms_norm_eps;
+    steps_.clear();
+    steps_.push_back([f = kn.embedding, out = hidden_, ids = token_ids_, w = weights_.embed_tokens->weights()] {
+        f(out, ids, w);
+    });
+    auto rms_norm = [&](tensor_t out, tensor_t in, Weights_t w) {
+        steps_.push_back([f = kn.rms_norm, out, in, w = w->weights(), eps] { f(out, in, w, eps); });
+    };
+    auto linear = [&](tensor_t out, tensor_t in, Weights_t w, Weights_t b) {
+        steps_.push_back([f = kn.linear, out, in, w = w->weights(), b = b ? b->weights() : nullptr] {
+            f(out, in, w, b);
+        });
+    };
+    auto add = [&](tensor_t c, tensor_t a, tensor_t b) {
+        steps_.push_back([f = kn.add, c, a, b] { f(c, a, b); });
+    };
+    tensor_t attn_val_2d = attn_val_->reshape({1, config_.hidden_size});
+    for (size_t i = 0; i < config_.num_hidden_layers; ++i) {
+        const auto &layer = weights_.layers[i];
+        rms_norm(normed_, hidden_, layer.input_layernorm.weight);
+        linear(q_, normed_, layer.attention.q, layer.attention.bias_q);
+        linear(k_, normed_, layer.attention.k, layer.attention.bias_k);
+        linear(v_, normed_, layer.attention.v, layer.attention.bias_v);
+        // 注意力依赖本步的缓存句柄，执行时再取缓存张量
+        steps_.push_back([this, i] { attention(i); });
+        linear(attn_out_, attn_val_2d, layer.attention.o, nullptr);
+        add(residual_, hidden_, attn_out_);
+        rms_norm(normed_, residual_, layer.post_attention_layernorm.weight);
+        linear(gate_, normed_, layer.mlp.gate, nullptr);
+        linear(up_, normed_, layer.mlp.up, nullptr);
+        steps_.push_back([f = kn.swiglu, out = act_, gate = gate_, up = up_] { f(out, gate, up); });
+        linear(mlp_out_, act_, layer.mlp.down, nullptr);
+        add(hidden_, residual_, mlp_out_);
+    }
+    rms_norm(normed_, hidden_, weights_.final_norm);
+    rope_q_ = kn.rope;
+}
+
+// 与 qwen2_decoder 的单 token 路径一致：分页缓存按预先准备好的 slot 直接写页并做分页注意力，
+// 其余缓存先尝试 rope 与写缓存融合，不支持（量化存储）时旋转后再写入
+void DecodePlan::attention(size_t layer) {
+    auto &cache = cache_;
+    tensor_t cos = rope_table_.cos;
+    tensor_t sin = rope_table_.sin;
+    float scale = 1 / std::sqrt(static_cast<float>(config_.hidden_size / config_.num_attention_heads));
+    if (slots_ != nullptr) {
+        ops::rope_append_kv_paged(cache->paged_kv_data(layer), k_3d_, v_3d_, pos_ids_, cos, sin, slots_);
+        rope_q_(q_rope_, q_3d_, pos_ids_, cos, sin);
+        ops::self_attention_paged(attn_val_, q_rope_, cache->paged_kv_data(layer), cache->kv_indptr(),
+                                  cache->kv_indices(), cache->kv_last_page_len(), cache->block_size(), scale);
+        return;
+    }
+    if (cache->append_rope(layer, k_3d_, v_3d_, pos_ids_, cos, sin, token_pos_)) {
+        rope_q_(q_rope_, q_3d_, pos_ids_, cos, sin);
+    } else {
+        ops::rope_qk(q_rope_, k_rope_, q_3d_, k_3d_, pos_ids_, cos, sin);
+        cache->append(layer, k_rope_, v_3d_, token_pos_);
+    }
+    tensor_t k_attn;
+    tensor_t v_attn;
+    cache->get(k_attn, v_attn, layer);
+    size_t window = layer_sliding_window(config_, layer);
+    if (cache->is_quantized()) {
+        tensor_t k_scale;
+        tensor_t v_scale;
+        cache->get_scales(k_scale, v_scale, layer);
+        ops::self_attention_quantized(attn_val_, q_rope_, k_attn, v_attn, k_scale, v_scale, scale, window);
+    } else {
+        ops::self_attention(attn_val_, q_rope_, k_attn, v_attn, scale, window);
+    }
+}
+
+tensor_t DecodePlan::run(llaisys::KVcache::CacheHandle_t cache, int64_t token, size_t token_pos) {
+    ASSERT(cache != nullptr, "DecodePlan::run: cache handle is null");
+    ASSERT(supports(*cache, token_pos), "DecodePlan::run: unsupported cache or position");
+    llaisys::core::context().setDevice(device_type_, device_id_);
+    auto &rt = llaisys::core::context().runtime();
+    llaisysMemcpyKind_t kind = (device_type_ == LLAISYS_DEVICE_CPU) ? LLAISYS_MEMCPY_H2H : LLAISYS_MEMCPY_H2D;
+    ids_host_[0] = token;
+    ids_host_[1] = static_cast<int64_t>(token_pos);
+    rt.api()->memcpy_async(token_ids_->data(), &ids_host_[0], sizeof(int64_t), kind, rt.stream());
+    rt.api()->memcpy_async(pos_ids_->data(), &ids_host_[1], sizeof(int64_t), kind, rt.stream());
+
+    cache_ = std::move(cache);
+    token_pos_ = token_pos;
+    // 分页缓存在 host 侧一次性分配位置并上传元数据，之后整步只剩设备端工作
+    slots_ = cache_->is_paged() ? cache_->prepare_slots(token_pos, 1) : nullptr;
+    if (use_graph_ && slots_ != nullptr) {
+        launch();
+    } else {
+        for (auto &step : steps_) {
+            step();
+        }
+    }
+    cache_.reset();
+    slots_.reset();
+    return normed_;
+}
+
+// 回放 CUDA Graph：内核参数在捕获时固定，缓存侧设备指针不变时直接回放，否则重新捕获
+void DecodePlan::launch() {
+#ifdef ENABLE_NVIDIA_API
+    std::vector<const void *> key{slots_->data(), cache_->kv_indptr()->data(), cache_->kv_indices()->data(),
+                                  cache_->kv_last_page_len()->data()};
+    for (size_t i = 0; i < config_.num_hidden_layers; ++i) {
+        key.push_back(cache_->paged_kv_data(i)->data());
+    }
+    auto stream = reinterpret_cast<cudaStream_t>(llaisys::core::context().runtime().stream());
+    if (graph_exec_ == nullptr || key != graph_key_) {
+        release_graph();
+        cudaGraph_t graph = nullptr;
+        check_cuda(cudaStreamBeginCapture(stream, cudaStreamCaptureModeThreadLocal),
+                   "DecodePlan: cudaStreamBeginCapture failed");
+        for (auto &step : steps_) {
+            step();
+        }
+        check_cuda(cudaStreamEndCapture(stream, &graph), "DecodePlan: cudaStreamEndCapture failed");
+        cudaGraphExec_t exec = nullptr;
+        check_cuda(cudaGraphInstantiateWithFlags(&exec, graph, 0), "DecodePlan: cudaGraphInstantiate failed");
+        cudaGraphDestroy(graph);
+        graph_exec_ = exec;
+        graph_key_ = std::move(key);
+    }
+    check_cuda(cudaGraphLaunch(static_cast<cudaGraphExec_t>(graph_exec_), stream),
+               "DecodePlan: cudaGraphLaunch failed");
+#else
+    for (auto &step : steps_) {
+        step();
+    }
+#endif
+}
+
+void DecodePlan::release_graph() {
+#ifdef ENABLE_NVIDIA_API
+    if (graph_exec_ != nullptr) {
+        cudaGraphExecDestroy(static_cast<cudaGraphExec_t>(graph_exec_));
+    }
+#endif
+    graph_exec_ = nullptr;
+    graph_key_.clear();
+}
+} // namespace llaisys::model
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "../../KVcache/CacheHandle.hpp"
+#include "../../layer/Qwen2/Decoder.hpp"
+#include "../model_utils.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace llaisys::model {
+// 单 token 解码步的执行计划：
+// 构建时按 seq_len=1 预先分配全部中间激活（各层复用同一组缓冲），并把整步展开为一串参数已绑定、
+// 内核已按设备解析好的闭包；之后每步只更新 token id、位置与缓存元数据，再顺序执行这串闭包。
+// NVIDIA + 分页缓存时整串闭包只含设备端工作，捕获为 CUDA Graph 后每步一次 launch 回放
+class DecodePlan {
+public:
+    DecodePlan(const meta_data &config, const llaisys::Qwen2::qwen2_weights &weights,
+               const llaisys::Qwen2::rotary_table &rope_table, llaisysDeviceType_t device_type, int device_id,
+               bool use_graph);
+    DecodePlan(const DecodePlan &) = delete;
+    DecodePlan &operator=(const DecodePlan &) = delete;
+    ~DecodePlan();
+
+    // 流式缓存（自行旋转 K）与超出 rope 表的位置走普通路径
+    bool supports(const llaisys::KVcache::CacheHandle &cache, size_t token_pos) const;
+    // 以 token 为输入执行一步解码，返回 final norm 之后的 [1, hidden] 隐状态（计划内的常驻缓冲，下一步会被覆盖），
+    // lm_head 与采样由模型的输出头完成
+    tensor_t run(llaisys::KVcache::CacheHandle_t cache, int64_t token, size_t token_pos);
+
+private:
+    void build();
+    void attention(size_t layer);
+    void launch();
+    void release_graph();
+
+    meta_data config_;
+    llaisys::Qwen2::qwen2_weights weights_;
+    llaisys::Qwen2::rotary_table rope_table_;
+    llaisysDeviceType_t device_type_;
+    int device_id_;
+    bool use_graph_;
+
+    // 预分配的激活缓冲
+    tensor_t token_ids_;
+    tensor_t pos_ids_;
+    tensor_t hidden_;
+    tensor_t normed_;
+    tensor_t q_, k_, v_;
+    tensor_t q_3d_, k_3d_, v_3d_;
+    tensor_t q_rope_, k_rope_;
+    tensor_t attn_val_;
+    tensor_t attn_out_;
+    tensor_t residual_;
+    tensor_t gate_, up_, act_;
+    tensor_t mlp_out_;
+    int64_t ids_host_[2] = {0, 0};
+
+    // 每步变化的状态，闭包执行时读取
+    llaisys::KVcache::CacheHandle_t cache_;
+    size_t token_pos_ = 0;
+    tensor_t slots_;
+
+    std::vector<std::function<void()>> steps_;
+    // 注意力闭包中 q 的查表 rope 同样直接调用设备内核
+    void (*rope_q_)(tensor_t, tensor_t, tensor_t, tensor_t, tensor_t) = nullptr;
+    // 已实例化的 CUDA Graph 及其捕获时引用的缓存侧设备指针，指针变化（换会话/缓存重建）时重新捕获
+    void *graph_exec_ = nullptr;
+    std::vector<const void *> graph_key_;
+};
+} // namespace llaisys::model
@@ -1,14 +1,19 @@
 #include "model_qwen2.hpp"
 #include "../../KVcache/NaiveCache/NaiveCache.hpp"
 #include "../../KVcache/NaiveCache/NaiveCacheHandle.hpp"
+#include "../../KVcache/StreamingCache/StreamingCache.hpp"
+#include "../../KVcache/StreamingCache/StreamingCacheHandle.hpp"
 #include "../../KVcache/pagedCache/PagedCache.hpp"
 #include "../../KVcache/pagedCache/PagedCacheHandle.hpp"
 #include "../../ops/ops.hpp"
 #include "../../utils.hpp"
 #include "../../core/llaisys_core.hpp"
+#include "../../device/cpu/cpu_numa.hpp"
+#include "../../device/cpu/cpu_thread_pool.hpp"
 #include "naive_session.hpp"
 #include <algorithm>
 #include <cctype>
+#include <cstddef>
 #include <cstdlib>
 #include <string>
 
@@ -31,15 +36,76 @@ bool parse_env_bool(const char *env, bool fallback) {
     return fallback;
 }
 
+size_t parse_env_size(const char *env, size_t fallback) {
+    if (!env || *env == '\0') {
+        return fallback;
+    }
+    char *end = nullptr;
+    unsigned long long v = std::strtoull(env, &end, 10);
+    if (end == env || *end != '\0') {
+        return fallback;
+    }
+    return static_cast<size_t>(v);
+}
+
 bool should_use_paged_attention(const llaisys::model::meta_data &meta_data,
                                 llaisysDeviceType_t device_type) {
     if (device_type != LLAISYS_DEVICE_NVIDIA) {
-        return false;
+        // 其他设备没有分页 decode 内核（每步从页中读出整段上下文），只在环境变量显式开启时使用
+        return parse_env_bool(std::getenv("LLAISYS_USE_PAGED_ATTENTION"), false);
     }
     bool enabled = meta_data.use_paged_attention;
     enabled = parse_env_bool(std::getenv("LLAISYS_USE_PAGED_ATTENTION"), enabled);
     return enabled;
 }
+
+// LLAISYS_KV_CACHE_DTYPE=int8|fp8|auto 覆盖配置中的 kv_cache_dtype
+llaisysDataType_t resolve_kv_cache_dtype(const llaisys::model::meta_data &meta_data) {
+    const char *env = std::getenv("LLAISYS_KV_CACHE_DTYPE");
+    if (!env) {
+        return meta_data.kv_cache_dtype;
+    }
+    return parse_kv_cache_dtype(env);
+}
+
+// 最后一层不在窗口内则没有任何层使用滑动窗口
+bool has_sliding_window(const llaisys::model::meta_data &meta_data) {
+    return meta_data.num_hidden_layers > 0
+        && layer_sliding_window(meta_data, meta_data.num_hidden_layers - 1) > 0;
+}
+
+// 二维连续的 CPU 权重按行 first-touch 到各 NUMA 节点；其余情形返回空，由调用方走普通拷贝
+tensor_t first_touch_to_cpu(const std::string &name, const tensor_t &src) {
+    if (src->deviceType() != LLAISYS_DEVICE_CPU || src->ndim() != 2 || !src->isContiguous()) {
+        return nullptr;
+    }
+    // 只有 linear 按行分节点读取；embedding 按 token 随机取行，不做切分
+    if (name.find("proj.weight") == std::string::npos && name != "lm_head.weight") {
+        return nullptr;
+    }
+    auto dst = Tensor::create(src->shape(), src->dtype(), LLAISYS_DEVICE_CPU, 0);
+    size_t row_bytes = src->shape()[1] * src->elementSize();
+    llaisys::device::cpu::first_touch_rows(dst->data(), src->data(), src->shape()[0], row_bytes);
+    return dst;
+}
+
+// 打分时每次 prefill 的位置数：lm_head 只对这一块计算，CPU 上 logits 按词表分块不写出，
+// GPU 上临时 logits 为 [kScoreChunk, vocab]，内存占用与文档长度无关
+constexpr size_t kScoreChunk = 256;
+
+// 读回 host 的模型 dtype 数值中第 i 个转成 f32
+float to_f32_at(const std::byte *data, llaisysDataType_t dtype, size_t i) {
+    switch (dtype) {
+    case LLAISYS_DTYPE_F32:
+        return reinterpret_cast<const float *>(data)[i];
+    case LLAISYS_DTYPE_BF16:
+        return llaisys::utils::cast<float>(reinterpret_cast<const llaisys::bf16_t *>(data)[i]);
+    case LLAISYS_DTYPE_F16:
+        return llaisys::utils::cast<float>(reinterpret_cast<const llaisys::fp16_t *>(data)[i]);
+    default:
+        EXCEPTION_UNSUPPORTED_DATATYPE(dtype);
+    }
+}
 } // namespace
 
 void Model_Qwen2::initCache() {
@@ -53,10 +119,47 @@ void Model_Qwen2::initCache() {
         head_dim,
         _config.num_key_value_heads,
         1};
-    const bool enable_paged = should_use_paged_attention(_config, _device.device_type);
+    _config.kv_cache_dtype = resolve_kv_cache_dtype(_config);
+    // LLAISYS_STREAMING_WINDOW / LLAISYS_ATTENTION_SINKS 覆盖配置中的 StreamingLLM 参数
+    _config.streaming_window = parse_env_size(std::getenv("LLAISYS_STREAMING_WINDOW"), _config.streaming_window);
+    _config.attention_sink_tokens =
+        parse_env_size(std::getenv("LLAISYS_ATTENTION_SINKS"), _config.attention_sink_tokens);
+    if (_config.streaming_window > 0 && _config.kv_cache_dtype != LLAISYS_DTYPE_INVALID) {
+        LOG_INFO("Model_Qwen2::initCache: streaming cache keeps kv in compute dtype, kv_cache_dtype ignored");
+        _config.kv_cache_dtype = LLAISYS_DTYPE_INVALID;
+    }
+    if ((tp_ || _parallel.pipeline_parallel > 1) && _config.streaming_window > 0) {
+        // StreamingLLM 缓存读取时会同步上传位置，与各 rank 间的 all-reduce 交错会互相等待；
+        // 流水线各级的缓存分处不同进程，也无法共用按缓存内位置重新旋转的 rope 偏移
+        LOG_INFO("Model_Qwen2::initCache: tensor/pipeline parallel enabled, streaming window disabled");
+        _config.streaming_window = 0;
+    }
+    bool enable_paged = should_use_paged_attention(_config, _device.device_type);
+    if (enable_paged && _config.streaming_window > 0) {
+        // 分页缓存不支持淘汰中间 token，StreamingLLM 使用独立的 sink + 环形存储
+        LOG_INFO("Model_Qwen2::initCache: streaming window enabled, paged attention disabled");
+        enable_paged = false;
+    }
+    if (enable_paged && _config.kv_cache_dtype != LLAISYS_DTYPE_INVALID) {
+        // FlashInfer 的分页 decode 内核只接受 fp16/bf16 页，量化 KV 走 NaiveCache + 量化注意力
+        LOG_INFO("Model_Qwen2::initCache: quantized kv cache requested, paged attention disabled");
+        enable_paged = false;
+    }
+    if (enable_paged && has_sliding_window(_config)) {
+        // 分页缓存的 block table 由所有层共享，无法只对窗口层回收块，滑动窗口走 NaiveCache 环形存储
+        LOG_INFO("Model_Qwen2::initCache: sliding window enabled, paged attention disabled");
+        enable_paged = false;
+    }
+    if (enable_paged && (tp_ || _parallel.pipeline_parallel > 1)) {
+        // 张量并行与流水线并行的缓存句柄按 rank / 级划分，不经过分页缓存
+        LOG_INFO("Model_Qwen2::initCache: tensor/pipeline parallel enabled, paged attention disabled");
+        enable_paged = false;
+    }
     if (enable_paged) {
-        // batch must account for the default request in PagedCache + at least 1 session handle
-        cache_meta.batch = std::max(cache_meta.batch, static_cast<size_t>(2));
+        // LLAISYS_MAX_NUM_SEQS 覆盖 max_num_seqs；block table 另留一行给单对话路径的默认请求
+        _config.max_num_seqs =
+            std::max<size_t>(1, parse_env_size(std::getenv("LLAISYS_MAX_NUM_SEQS"), _config.max_num_seqs));
+        cache_meta.batch = _config.max_num_seqs + 1;
         _kv_cache = llaisys::KVcache::PagedCache::create(
             cache_meta, _device.device_type, device_id, _config.torch_type, nullptr);
         LOG_INFO("Model_Qwen2::initCache: use PagedCache (paged attention enabled)");
@@ -76,6 +179,9 @@ CacheHandle_t Model_Qwen2::allocateCache() {
             return std::make_shared<llaisys::KVcache::PagedCacheHandle>(paged);
         }
     }
+    if (pp_) {
+        return pp_->allocateCache();
+    }
     llaisys::KVcache::CacheMeta cache_meta{
         _config.num_hidden_layers,
         _config.hidden_size,
@@ -84,6 +190,32 @@ CacheHandle_t Model_Qwen2::allocateCache() {
         head_dim,
         _config.num_key_value_heads,
         1};
+    if (_config.streaming_window > 0) {
+        cache_meta.sink_tokens = _config.attention_sink_tokens;
+        cache_meta.streaming_window = _config.streaming_window;
+        cache_meta.rope_theta = static_cast<float>(_config.rope_theta);
+        auto streaming = std::static_pointer_cast<llaisys::KVcache::StreamingCache>(
+            llaisys::KVcache::StreamingCache::create(cache_meta, _device.device_type, device_id, _config.torch_type,
+                                                     nullptr));
+        return std::make_shared<llaisys::KVcache::StreamingCacheHandle>(streaming);
+    }
+    cache_meta.kv_dtype = _config.kv_cache_dtype;
+    if (has_sliding_window(_config)) {
+        cache_meta.sliding_window = _config.sliding_window;
+        cache_meta.max_window_layers = _config.max_window_layers;
+    }
+    if (tp_) {
+        // 每个 rank 只缓存自己的 KV 头
+        cache_meta.nhead /= tp_->world();
+        cache_meta.n_kv_heads /= tp_->world();
+        std::vector<CacheHandle_t> ranks;
+        for (size_t r = 0; r < tp_->world(); ++r) {
+            auto naive = llaisys::KVcache::NaiveCache::create(
+                cache_meta, _device.device_type, device_id, _config.torch_type, nullptr);
+            ranks.push_back(std::make_shared<llaisys::KVcache::NaiveCacheHandle>(naive));
+        }
+        return std::make_shared<TensorParallelCacheHandle>(std::move(ranks));
+    }
     auto naive = llaisys::KVcache::NaiveCache::create(
         cache_meta, _device.device_type, device_id, _config.torch_type, nullptr);
     return std::make_shared<llaisys::KVcache::NaiveCacheHandle>(naive);
@@ -92,15 +224,49 @@ CacheHandle_t Model_Qwen2::allocateCache() {
 // 加载权重，根据运行时的不同设备来把权重加载到不同文件上
 void Model_Qwen2::loadWeights(WeightsMap& weights) {
     int target_device_id = _device.device_ids.empty() ? 0 : _device.device_ids.front();
+    // LLAISYS_TENSOR_PARALLEL 覆盖 ParallelSpec::tensor_parallel；0 与 1 都表示不切分
+    _parallel.tensor_parallel = parse_env_size(std::getenv("LLAISYS_TENSOR_PARALLEL"), _parallel.tensor_parallel);
+    const bool tensor_parallel = _parallel.tensor_parallel > 1;
+    // LLAISYS_PIPELINE_PARALLEL 覆盖 ParallelSpec::pipeline_parallel；0 与 1 都表示不切分
+    _parallel.pipeline_parallel = parse_env_size(std::getenv("LLAISYS_PIPELINE_PARALLEL"), _parallel.pipeline_parallel);
+    const bool pipeline_parallel = _parallel.pipeline_parallel > 1;
+    // LLAISYS_DATA_PARALLEL 覆盖 ParallelSpec::data_parallel；0 与 1 都表示单副本
+    _parallel.data_parallel = parse_env_size(std::getenv("LLAISYS_DATA_PARALLEL"), _parallel.data_parallel);
+    const bool data_parallel = _parallel.data_parallel > 1;
+
+    // 多 NUMA 节点时，投影权重按线程池的节点划分切分输出行，由绑定到各节点的线程 first-touch，
+    // linear 按同一划分调度，使各 socket 只读本地分片
+    auto &pool = llaisys::device::cpu::ThreadPool::instance();
+    const bool numa_sharded = this->_device.device_type == LLAISYS_DEVICE_CPU && pool.num_nodes() > 1;
+    if (this->_device.device_type == LLAISYS_DEVICE_CPU) {
+        this->_device.numa_nodes = pool.num_nodes();
+        this->_device.threads_per_node.clear();
+        for (size_t node = 0; node < pool.num_nodes(); ++node) {
+            this->_device.threads_per_node.push_back(pool.node_threads(node));
+        }
+    }
+    if (numa_sharded) {
+        LOG_INFO("Model_Qwen2::loadWeights: projection weights sharded across " << pool.num_nodes() << " NUMA nodes");
+    }
 
     auto load_no_parallel_to_device = [&](llaisysDeviceType_t target_device_type) {
         WeightsMap loaded;
         loaded.reserve(weights.size());
         for (auto& entry : weights) {
+            // 张量并行时 decoder 层权重只以分片形式存在于各 rank，流水线并行时由各级直接引用源权重
+            if ((tensor_parallel || pipeline_parallel) && entry.first.rfind("model.layers.", 0) == 0) {
+                continue;
+            }
             ASSERT(entry.second != nullptr, "Model_Qwen2::loadWeights: null weight pointer for " + entry.first);
             const auto& src_tensor = entry.second->weights();
             ASSERT(src_tensor != nullptr, "Model_Qwen2::loadWeights: null tensor for " + entry.first);
-            auto dst_tensor = src_tensor->to(target_device_type, target_device_id);
+            tensor_t dst_tensor;
+            if (target_device_type == LLAISYS_DEVICE_CPU && numa_sharded) {
+                dst_tensor = first_touch_to_cpu(entry.first, src_tensor);
+            }
+            if (!dst_tensor) {
+                dst_tensor = src_tensor->to(target_device_type, target_device_id);
+            }
             loaded[entry.first] = std::make_shared<llaisys::Weights>(entry.first, dst_tensor);
         }
         this->weights_ = std::move(loaded);
@@ -108,11 +274,12 @@ void Model_Qwen2::loadWeights(WeightsMap& weights) {
 
     switch (this->_device.device_type) {
     case LLAISYS_DEVICE_CPU:
-        if (this->_parallel.tensor_parallel == 0 && this->_parallel.pipeline_parallel == 0 &&
-            this->_parallel.data_parallel == 0) {
-            load_no_parallel_to_device(LLAISYS_DEVICE_CPU);
-        } else {
-            throw "Parallel is not supported yet";
+        ASSERT(static_cast<int>(tensor_parallel) + static_cast<int>(pipeline_parallel) +
+                       static_cast<int>(data_parallel) <= 1,
+               "Model_Qwen2::loadWeights: tensor, pipeline and data parallel cannot be combined");
+        load_no_parallel_to_device(LLAISYS_DEVICE_CPU);
+        if (tensor_parallel) {
+            tp_ = std::make_unique<TensorParallelGroup>(_config, weights, _parallel.tensor_parallel);
         }
         break;
     case LLAISYS_DEVICE_NVIDIA:
@@ -127,7 +294,21 @@ void Model_Qwen2::loadWeights(WeightsMap& weights) {
         EXCEPTION_UNSUPPORTED_DEVICE;
     }
     parseWeight();
+    initRopeTable();
     initCache();
+    if (pipeline_parallel) {
+        // 各级在 fork 时拿到的配置需已解析完 KV 精度等运行参数，因此在 initCache 之后创建
+        size_t micro_batch = parse_env_size(std::getenv("LLAISYS_PIPELINE_MICRO_BATCH"), 32);
+        pp_ = std::make_unique<PipelineParallelGroup>(_config, weights, rope_table_, _parallel.pipeline_parallel,
+                                                      micro_batch);
+        _device.rank = 0;
+        _device.world_size = static_cast<int>(pp_->stages());
+    }
+    if (data_parallel) {
+        // 本模型只作为分发器，副本共用 weights_ 与 rope 表
+        dp_ = std::make_unique<DataParallelGroup>(*this, _parallel.data_parallel);
+    }
+    initDecodePlan();
     this->show();
     LOG_INFO("Model_Qwen2::loadWeights: complete");
 }
@@ -145,6 +326,9 @@ void Model_Qwen2::unloadWeights() {
 }
 
 session_t Model_Qwen2::createSession(std::vector<int64_t> tokens) {
+    if (dp_) {
+        return dp_->createSession(std::move(tokens));
+    }
     auto handle = allocateCache();
     auto session = std::make_shared<naive_session>();
     session->init(tokens, handle);
@@ -152,6 +336,10 @@ session_t Model_Qwen2::createSession(std::vector<int64_t> tokens) {
 }
 
 void Model_Qwen2::resetSession(ModelSession& session) {
+    if (dp_) {
+        dp_->resetSession(session);
+        return;
+    }
     auto* naive = dynamic_cast<naive_session*>(&session);
     if (!naive) {
         return;
@@ -162,18 +350,45 @@ void Model_Qwen2::resetSession(ModelSession& session) {
 }
 
 void Model_Qwen2::destroy() {
+    dp_.reset();
     _kv_cache.reset();
     unloadWeights();
     qwen2_weights.embed_tokens.reset();
     qwen2_weights.final_norm.reset();
     qwen2_weights.lm_head.reset();
     qwen2_weights.layers.clear();
+    decode_plan_.reset();
+    tp_.reset();
+    pp_.reset();
+    rope_table_ = {};
+    token_ids_buf_.reset();
+    pos_ids_buf_.reset();
     bos_token_id = -1;
     eos_token_id = -1;
 }
 
-InferenceOutputs Model_Qwen2::inferStep(session_t session) {
+size_t Model_Qwen2::maxSessions() const {
+    if (dp_) {
+        return dp_->maxSessions();
+    }
+    return std::dynamic_pointer_cast<llaisys::KVcache::PagedCache>(_kv_cache) ? _config.max_num_seqs : 0;
+}
+
+void Model_Qwen2::releaseThreadState() {
+    // 数据并行时推理都在副本的驱动线程上执行，本模型的缓冲不会被调用线程分配
+    if (dp_) {
+        return;
+    }
+    token_ids_buf_.reset();
+    pos_ids_buf_.reset();
+    ones_.reset();
+}
+
+InferenceOutputs Model_Qwen2::inferStep(session_t session, const InferenceOptions& options) {
     LOG_INFO("Model_Qwen2::inferStep:begin");
+    if (dp_) {
+        return dp_->inferStep(session, options);
+    }
     LOG_INFO("Model_Qwen2::inferStep:session" << session->seq_len());
     ASSERT(session != nullptr, "Model_Qwen2::inferStep: session is null");
     auto cache_handle = session->cache();
@@ -184,88 +399,261 @@ InferenceOutputs Model_Qwen2::inferStep(session_t session) {
     ASSERT(qwen2_weights.embed_tokens != nullptr, "Model_Qwen2::inferStep: embed_tokens weight is null");
     ASSERT(qwen2_weights.final_norm != nullptr, "Model_Qwen2::inferStep: final_norm weight is null");
     ASSERT(qwen2_weights.lm_head != nullptr, "Model_Qwen2::inferStep: lm_head weight is null");
-    ASSERT(qwen2_weights.layers.size() == _config.num_hidden_layers, "Model_Qwen2::inferStep: layers size mismatch");
+    ASSERT(tp_ || pp_ || qwen2_weights.layers.size() == _config.num_hidden_layers,
+           "Model_Qwen2::inferStep: layers size mismatch");
 
     int device_id = _device.device_ids.empty() ? 0 : _device.device_ids.front();
-    size_t token_pos = 0;
+    // 会话里已写入缓存的 token 不再前向：首轮 prefill 整段，多轮会话续接时只 prefill 新追加的部分
+    size_t token_pos = session->token_pos();
+    ASSERT(token_pos < tokens.size(), "Model_Qwen2::inferStep: no new token to process");
     tensor_t hidden_states;
-    if (cache_handle->seq_len() == 0) {
-        // prefill: process full sequence
-        token_pos = 0;
-        hidden_states = inferInit(session);
+    // final norm 之后、送入输出头的 [rows, hidden]
+    tensor_t normed;
+    if (token_pos == 0 || tokens.size() - token_pos > 1) {
+        // prefill
+        size_t chunk = cache_handle->max_step_tokens();
+        if (chunk > 0 && tokens.size() - token_pos > chunk) {
+            // 缓存限制单步写入量时分块 prefill，除最后一块外只写缓存、不算 logits
+            LOG_INFO("Model::Qwen2:chunked prefill: chunk=" << chunk);
+            for (; token_pos + chunk < tokens.size(); token_pos += chunk) {
+                forwardTokens(tokens.data() + token_pos, chunk, cache_handle, token_pos);
+            }
+        }
+        hidden_states = forwardTokens(tokens.data() + token_pos, tokens.size() - token_pos, cache_handle, token_pos);
     } else {
         // decode: only process last token
-        token_pos = tokens.size() - 1;
-        std::vector<int64_t> last_token{tokens.back()};
-        std::vector<size_t> token_shape{1};
-        tensor_t token_ids = Tensor::create(token_shape, LLAISYS_DTYPE_I64, _device.device_type, device_id);
-        llaisys::core::context().setDevice(_device.device_type, device_id);
-        auto& rt = llaisys::core::context().runtime();
-        llaisysMemcpyKind_t tk_kind =
-            (_device.device_type == LLAISYS_DEVICE_CPU) ? LLAISYS_MEMCPY_H2H : LLAISYS_MEMCPY_H2D;
-        rt.api()->memcpy_async(token_ids->data(), last_token.data(), sizeof(int64_t), tk_kind, rt.stream());
-        rt.api()->stream_synchronize(rt.stream());
-        std::vector<size_t> out_shape{1, _config.hidden_size};
-        hidden_states = Tensor::create(out_shape, _config.torch_type, _device.device_type, device_id);
-        ops::embedding(hidden_states, token_ids, qwen2_weights.embed_tokens->weights());
+        if (decode_plan_ && decode_plan_->supports(*cache_handle, token_pos)) {
+            normed = decode_plan_->run(cache_handle, tokens.back(), token_pos);
+        } else {
+            hidden_states = forwardTokens(&tokens.back(), 1, cache_handle, token_pos);
+        }
     }
     if (token_pos == 0) {
         LOG_INFO("Model::Qwen2:prefill: begin");
     }
-    for (size_t i = 0; i < _config.num_hidden_layers; ++i) {
-        const auto& layer = qwen2_weights.layers[i];
-        ASSERT(layer.input_layernorm.weight != nullptr, "Model_Qwen2::inferStep: input_layernorm weight is null");
-        ASSERT(layer.post_attention_layernorm.weight != nullptr,
-               "Model_Qwen2::inferStep: post_attention_layernorm weight is null");
-        ASSERT(layer.attention.q != nullptr && layer.attention.k != nullptr && layer.attention.v != nullptr &&
-                   layer.attention.o != nullptr,
-               "Model_Qwen2::inferStep: attention weights are null");
-        ASSERT(layer.attention.bias_q != nullptr && layer.attention.bias_k != nullptr &&
-                   layer.attention.bias_v != nullptr,
-               "Model_Qwen2::inferStep: attention bias weights are null");
-        ASSERT(layer.mlp.gate != nullptr && layer.mlp.up != nullptr && layer.mlp.down != nullptr,
-               "Model_Qwen2::inferStep: mlp weights are null");
-        hidden_states = llaisys::Qwen2::qwen2_decoder(hidden_states, qwen2_weights.layers[i], cache_handle,
-                                                      _config, token_pos, i, device_id);
+    if (normed == nullptr) {
+        // 只有需要完整 logits 时才对每一行做 final norm，否则只归一化最后一行
+        const size_t rows = hidden_states->shape()[0];
+        if (!options.return_logits) {
+            hidden_states = hidden_states->slice(0, rows - 1, rows);
+        }
+        normed = Tensor::create(hidden_states->shape(), _config.torch_type, _device.device_type, device_id);
+        ops::rms_norm(normed, hidden_states, qwen2_weights.final_norm->weights(), _config.rms_norm_eps);
     }
 
-    tensor_t normed = Tensor::create(hidden_states->shape(), _config.torch_type, _device.device_type, device_id);
-    ops::rms_norm(normed, hidden_states, qwen2_weights.final_norm->weights(), _config.rms_norm_eps);
-
-    std::vector<size_t> logits_shape{hidden_states->shape()[0], _config.vocab_size};
-    tensor_t logits = Tensor::create(logits_shape, _config.torch_type, _device.device_type, device_id);
-    ops::linear(logits, normed, qwen2_weights.lm_head->weights(), nullptr);
+    InferenceOutputs outputs;
+    // 要求 log-prob 时输出头同时给出前 k 个候选与 logsumexp，log-prob = logit - lse
+    const bool want_logprobs = options.logprobs || options.top_logprobs > 0;
+    ASSERT(options.top_logprobs <= _config.vocab_size, "Model_Qwen2::inferStep: top_logprobs exceeds vocab size");
+    const size_t k = std::max<size_t>(1, options.top_logprobs);
+    tensor_t next_idx = Tensor::create({1, k}, LLAISYS_DTYPE_I64, _device.device_type, device_id);
+    tensor_t next_val;
+    tensor_t lse;
+    if (options.return_logits) {
+        std::vector<size_t> logits_shape{normed->shape()[0], _config.vocab_size};
+        outputs.logits = Tensor::create(logits_shape, _config.torch_type, _device.device_type, device_id);
+        ops::linear(outputs.logits, normed, qwen2_weights.lm_head->weights(), nullptr);
+    }
+    if (options.return_logits && !want_logprobs) {
+        const size_t seq_len = outputs.logits->shape()[0];
+        tensor_t last_row = outputs.logits->slice(0, seq_len - 1, seq_len)->reshape({_config.vocab_size});
+        tensor_t max_val = Tensor::create({1}, _config.torch_type, _device.device_type, device_id);
+        ops::argmax(next_idx->reshape({1}), max_val, last_row);
+    } else {
+        // 输出头：lm_head 按词表分块计算、逐块保留前 k 个，不分配 [1, vocab] 的 logits
+        const size_t rows = normed->shape()[0];
+        tensor_t last = normed->slice(0, rows - 1, rows);
+        next_val = Tensor::create({1, k}, _config.torch_type, _device.device_type, device_id);
+        if (want_logprobs) {
+            lse = Tensor::create({1}, LLAISYS_DTYPE_F32, _device.device_type, device_id);
+        }
+        ops::linear_topk(next_idx, next_val, lse, last, qwen2_weights.lm_head->weights());
+    }
 
-    const size_t seq_len = logits->shape()[0];
-    tensor_t last_row = logits->slice(0, seq_len - 1, seq_len)->reshape({_config.vocab_size});
-    tensor_t max_idx = Tensor::create({1}, LLAISYS_DTYPE_I64, _device.device_type, device_id);
-    tensor_t max_val = Tensor::create({1}, _config.torch_type, _device.device_type, device_id);
-    ops::argmax(max_idx, max_val, last_row);
+    // 整个前向只在读回采样结果时与本线程的 stream 同步一次；不用 memcpy_sync，
+    // 以免等待其他线程（数据并行的其他副本）的 stream
+    std::vector<int64_t> top_idx(k);
+    std::vector<std::byte> top_val(want_logprobs ? k * next_val->elementSize() : 0);
+    float log_z = 0.0f;
+    llaisysMemcpyKind_t kind = next_idx->deviceType() == LLAISYS_DEVICE_CPU ? LLAISYS_MEMCPY_H2H : LLAISYS_MEMCPY_D2H;
+    llaisys::core::context().setDevice(next_idx->deviceType(), next_idx->deviceId());
+    auto& rt = llaisys::core::context().runtime();
+    rt.api()->memcpy_async(top_idx.data(), next_idx->data(), (want_logprobs ? k : 1) * sizeof(int64_t), kind, rt.stream());
+    if (want_logprobs) {
+        rt.api()->memcpy_async(top_val.data(), next_val->data(), top_val.size(), kind, rt.stream());
+        rt.api()->memcpy_async(&log_z, lse->data(), sizeof(float), kind, rt.stream());
+    }
+    rt.api()->stream_synchronize(rt.stream());
+    const int64_t next_token = top_idx[0];
 
-    int64_t next_token = 0;
-    llaisysMemcpyKind_t kind = max_idx->deviceType() == LLAISYS_DEVICE_CPU ? LLAISYS_MEMCPY_H2H : LLAISYS_MEMCPY_D2H;
-    llaisys::core::context().setDevice(max_idx->deviceType(), max_idx->deviceId());
-    llaisys::core::context().runtime().api()->memcpy_sync(&next_token, max_idx->data(), sizeof(int64_t), kind);
+    if (want_logprobs) {
+        std::vector<float> top_lp(k);
+        for (size_t i = 0; i < k; ++i) {
+            top_lp[i] = to_f32_at(top_val.data(), next_val->dtype(), i) - log_z;
+        }
+        outputs.logprob = top_lp[0];
+        if (options.top_logprobs > 0) {
+            outputs.top_tokens = std::move(top_idx);
+            outputs.top_logprobs = std::move(top_lp);
+        }
+    }
 
+    session->set_token_pos(tokens.size());
     session->append(next_token);
 
-    InferenceOutputs outputs;
     outputs.next_token = next_token;
-    outputs.logits = logits;
     return outputs;
 }
 
+std::vector<float> Model_Qwen2::scoreStep(session_t session, size_t begin) {
+    if (dp_) {
+        return dp_->scoreStep(session, begin);
+    }
+    ASSERT(session != nullptr, "Model_Qwen2::scoreStep: session is null");
+    auto cache_handle = session->cache();
+    ASSERT(cache_handle != nullptr, "Model_Qwen2::scoreStep: cache handle is null");
+    ASSERT(qwen2_weights.final_norm != nullptr && qwen2_weights.lm_head != nullptr,
+           "Model_Qwen2::scoreStep: output head weights are null");
+    const auto& tokens = session->tokens();
+    // 最后一个 token 没有要预测的目标，不必进入前向
+    if (tokens.size() < 2 || begin + 1 >= tokens.size()) {
+        return {};
+    }
+    size_t chunk = kScoreChunk;
+    if (cache_handle->max_step_tokens() > 0) {
+        chunk = std::min(chunk, cache_handle->max_step_tokens());
+    }
+    const size_t n = std::min(chunk, tokens.size() - 1 - begin);
+    int device_id = _device.device_ids.empty() ? 0 : _device.device_ids.front();
+
+    tensor_t hidden_states = forwardTokens(tokens.data() + begin, n, cache_handle, begin);
+    tensor_t normed = Tensor::create(hidden_states->shape(), _config.torch_type, _device.device_type, device_id);
+    ops::rms_norm(normed, hidden_states, qwen2_weights.final_norm->weights(), _config.rms_norm_eps);
+    // embedding 已在同一 stream 上排在前面，id 缓冲可以直接复用
+    tensor_t targets = uploadIds(token_ids_buf_, tokens.data() + begin + 1, n);
+    tensor_t logprobs = Tensor::create({n}, LLAISYS_DTYPE_F32, _device.device_type, device_id);
+    ops::linear_logprob(logprobs, normed, qwen2_weights.lm_head->weights(), targets);
+
+    std::vector<float> out(n);
+    llaisysMemcpyKind_t kind = logprobs->deviceType() == LLAISYS_DEVICE_CPU ? LLAISYS_MEMCPY_H2H : LLAISYS_MEMCPY_D2H;
+    llaisys::core::context().setDevice(logprobs->deviceType(), logprobs->deviceId());
+    auto& rt = llaisys::core::context().runtime();
+    rt.api()->memcpy_async(out.data(), logprobs->data(), n * sizeof(float), kind, rt.stream());
+    rt.api()->stream_synchronize(rt.stream());
+    return out;
+}
+
+std::vector<float> Model_Qwen2::score(const std::vector<int64_t>& tokens) {
+    auto session = createSession(tokens);
+    std::vector<float> out;
+    while (true) {
+        auto chunk = scoreStep(session, out.size());
+        if (chunk.empty()) {
+            break;
+        }
+        out.insert(out.end(), chunk.begin(), chunk.end());
+    }
+    return out;
+}
+
+std::vector<float> Model_Qwen2::embed(const std::vector<std::vector<int64_t>>& inputs, Pooling pooling) {
+    if (dp_) {
+        return dp_->embed(inputs, pooling);
+    }
+    ASSERT(!tp_ && !pp_, "Model_Qwen2::embed: tensor / pipeline parallel models do not support embeddings");
+    ASSERT(!inputs.empty(), "Model_Qwen2::embed: inputs is empty");
+    ASSERT(qwen2_weights.final_norm != nullptr, "Model_Qwen2::embed: final_norm weight is null");
+    int device_id = _device.device_ids.empty() ? 0 : _device.device_ids.front();
+    const size_t hidden_size = _config.hidden_size;
+
+    // 各序列首尾相接，位置在每个序列内从 0 开始
+    std::vector<int64_t> packed;
+    std::vector<size_t> seq_lens;
+    pos_ids_host_.clear();
+    for (const auto& seq : inputs) {
+        ASSERT(!seq.empty(), "Model_Qwen2::embed: empty input sequence");
+        packed.insert(packed.end(), seq.begin(), seq.end());
+        seq_lens.push_back(seq.size());
+        for (size_t i = 0; i < seq.size(); ++i) {
+            pos_ids_host_.push_back(static_cast<int64_t>(i));
+        }
+    }
+    const size_t max_len = *std::max_element(seq_lens.begin(), seq_lens.end());
+    tensor_t hidden_states = embedTokens(packed.data(), packed.size());
+    tensor_t pos_ids = uploadIds(pos_ids_buf_, pos_ids_host_.data(), pos_ids_host_.size());
+    for (size_t i = 0; i < _config.num_hidden_layers; ++i) {
+        hidden_states = llaisys::Qwen2::qwen2_decoder(hidden_states, qwen2_weights.layers[i], nullptr, _config,
+                                                      rope_table_, pos_ids, 0, i, device_id, nullptr, &seq_lens);
+    }
+    tensor_t normed = Tensor::create(hidden_states->shape(), _config.torch_type, _device.device_type, device_id);
+    ops::rms_norm(normed, hidden_states, qwen2_weights.final_norm->weights(), _config.rms_norm_eps);
+
+    // 池化在设备上完成，只把 [batch, hidden] 拷回；平均池化为 (1/len) · 1ᵀ · rows，f32 累加
+    tensor_t pooled = Tensor::create({inputs.size(), hidden_size}, _config.torch_type, _device.device_type, device_id);
+    if (pooling == Pooling::Mean && (ones_ == nullptr || ones_->shape()[2] < max_len)) {
+        ones_ = Tensor::create({1, 1, max_len}, _config.torch_type, _device.device_type, device_id);
+        std::vector<std::byte> host(max_len * ones_->elementSize());
+        for (size_t i = 0; i < max_len; ++i) {
+            switch (_config.torch_type) {
+            case LLAISYS_DTYPE_F32:
+                reinterpret_cast<float*>(host.data())[i] = 1.0f;
+                break;
+            case LLAISYS_DTYPE_BF16:
+                reinterpret_cast<llaisys::bf16_t*>(host.data())[i] = llaisys::utils::cast<llaisys::bf16_t>(1.0f);
+                break;
+            case LLAISYS_DTYPE_F16:
+                reinterpret_cast<llaisys::fp16_t*>(host.data())[i] = llaisys::utils::cast<llaisys::fp16_t>(1.0f);
+                break;
+            default:
+                EXCEPTION_UNSUPPORTED_DATATYPE(_config.torch_type);
+            }
+        }
+        ones_->load(host.data());
+    }
+    size_t begin = 0;
+    for (size_t b = 0; b < inputs.size(); ++b) {
+        const size_t end = begin + seq_lens[b];
+        tensor_t dst = pooled->slice(0, b, b + 1);
+        if (pooling == Pooling::Mean) {
+            ops::bmm(dst->reshape({1, 1, hidden_size}), ones_->slice(2, 0, seq_lens[b]),
+                     normed->slice(0, begin, end)->reshape({1, seq_lens[b], hidden_size}), false, false,
+                     1.0f / static_cast<float>(seq_lens[b]), 0.0f);
+        } else {
+            ops::rearrange(dst, normed->slice(0, end - 1, end));
+        }
+        begin = end;
+    }
+
+    std::vector<std::byte> host(pooled->numel() * pooled->elementSize());
+    llaisysMemcpyKind_t kind = pooled->deviceType() == LLAISYS_DEVICE_CPU ? LLAISYS_MEMCPY_H2H : LLAISYS_MEMCPY_D2H;
+    llaisys::core::context().setDevice(pooled->deviceType(), pooled->deviceId());
+    auto& rt = llaisys::core::context().runtime();
+    rt.api()->memcpy_async(host.data(), pooled->data(), host.size(), kind, rt.stream());
+    rt.api()->stream_synchronize(rt.stream());
+    std::vector<float> out(pooled->numel());
+    for (size_t i = 0; i < out.size(); ++i) {
+        out[i] = to_f32_at(host.data(), pooled->dtype(), i);
+    }
+    return out;
+}
+
 std::vector<int64_t> Model_Qwen2::inferDialog(std::vector<int64_t>& tokens, size_t max_steps) {
+    GenerationConfig gen;
+    gen.max_new_tokens = max_steps;
+    return inferDialog(tokens, gen);
+}
+
+std::vector<int64_t> Model_Qwen2::inferDialog(std::vector<int64_t>& tokens, const GenerationConfig& gen) {
     LOG_INFO("Model_Qwen2::inferDialog:begin");
-    ASSERT(max_steps > 0, "Model_Qwen2::inferDialog: max_steps must be > 0");
+    ASSERT(gen.max_new_tokens > 0, "Model_Qwen2::inferDialog: max_new_tokens must be > 0");
     if (tokens.empty()) {
         tokens.push_back(bos_token_id);
     }
     auto session = createSession(tokens);
-    for (size_t i = 0; i < max_steps; ++i) {
+    for (size_t i = 0; i < gen.max_new_tokens; ++i) {
         auto outputs = inferStep(session);
         LOG_INFO("step=" << i << " next=" << outputs.next_token << " eos=" << eos_token_id);
-        if (outputs.next_token == eos_token_id) {
+        if (check_stop(gen, _config, session->tokens(), i + 1) != StopReason::None) {
             break;
         }
     }
@@ -274,29 +662,111 @@ std::vector<int64_t> Model_Qwen2::inferDialog(std::vector<int64_t>& tokens, size
     return std::vector<int64_t>(session->tokens());
 }
 
-// input_embedding阶段
-tensor_t Model_Qwen2::inferInit(session_t session) {
-    ASSERT(session != nullptr, "Model_Qwen2::inferInit: session is null");
-    const auto& tokens = session->tokens();
-    ASSERT(!tokens.empty(), "Model_Qwen2::inferInit: tokens is empty");
-    ASSERT(qwen2_weights.embed_tokens != nullptr, "Model_Qwen2::inferInit: embed_tokens weight is null");
+// 把 n 个 token id 拷到设备上并查 embedding 表，返回 [n, hidden_size]
+tensor_t Model_Qwen2::embedTokens(const int64_t* ids, size_t n) {
+    ASSERT(qwen2_weights.embed_tokens != nullptr, "Model_Qwen2::embedTokens: embed_tokens weight is null");
+    int device_id = _device.device_ids.empty() ? 0 : _device.device_ids.front();
+    tensor_t token_ids = uploadIds(token_ids_buf_, ids, n);
+
+    std::vector<size_t> out_shape{n, _config.hidden_size};
+    tensor_t hidden_states = Tensor::create(out_shape, _config.torch_type, _device.device_type, device_id);
+    ops::embedding(hidden_states, token_ids, qwen2_weights.embed_tokens->weights());
+    return hidden_states;
+}
 
+// 把 n 个 id 异步拷到常驻缓冲 buf 的前 n 个位置；host 源为可分页内存时 H2D 拷贝在调用时即完成暂存，
+// 同一 stream 上的后续读写按序执行，因此不需要同步
+tensor_t Model_Qwen2::uploadIds(tensor_t& buf, const int64_t* ids, size_t n) {
     int device_id = _device.device_ids.empty() ? 0 : _device.device_ids.front();
-    std::vector<size_t> token_shape{tokens.size()};
-    tensor_t token_ids = Tensor::create(token_shape, LLAISYS_DTYPE_I64, _device.device_type, device_id);
+    if (buf == nullptr || buf->shape()[0] < n) {
+        size_t cap = std::max(n, buf == nullptr ? size_t{1} : 2 * buf->shape()[0]);
+        buf = Tensor::create({cap}, LLAISYS_DTYPE_I64, _device.device_type, device_id);
+    }
     llaisys::core::context().setDevice(_device.device_type, device_id);
     auto& rt = llaisys::core::context().runtime();
-    llaisysMemcpyKind_t tk_kind = (_device.device_type == LLAISYS_DEVICE_CPU) ? LLAISYS_MEMCPY_H2H : LLAISYS_MEMCPY_H2D;
-    rt.api()->memcpy_async(token_ids->data(), tokens.data(), tokens.size() * sizeof(int64_t), tk_kind, rt.stream());
-    rt.api()->stream_synchronize(rt.stream());
+    llaisysMemcpyKind_t kind = (_device.device_type == LLAISYS_DEVICE_CPU) ? LLAISYS_MEMCPY_H2H : LLAISYS_MEMCPY_H2D;
+    rt.api()->memcpy_async(buf->data(), ids, n * sizeof(int64_t), kind, rt.stream());
+    return buf->slice(0, 0, n);
+}
 
-    std::vector<size_t> out_shape{tokens.size(), _config.hidden_size};
-    tensor_t hidden_states = Tensor::create(out_shape, _config.torch_type, _device.device_type, device_id);
-    ops::embedding(hidden_states, token_ids, qwen2_weights.embed_tokens->weights());
-    LOG_TENSOR_DEBUG("Model_Qwen2::inferInit::hidden_states", hidden_states);
-    LOG_INFO("Model_Qwen2::inferInit: complete");
+// 依次经过所有 decoder 层，token_pos 为 hidden_states 第一行在对话中的位置
+tensor_t Model_Qwen2::forwardLayers(tensor_t hidden_states, CacheHandle_t cache, size_t token_pos) {
+    int device_id = _device.device_ids.empty() ? 0 : _device.device_ids.front();
+    // 位置 id 每步只准备一次；自行旋转 K 的缓存各层长度一致，用第 0 层的缓存内位置
+    size_t seq_len = hidden_states->shape()[0];
+    size_t rope_pos = cache->rotates_keys() ? cache->rope_offset(0, seq_len) : token_pos;
+    pos_ids_host_.resize(seq_len);
+    for (size_t i = 0; i < seq_len; ++i) {
+        pos_ids_host_[i] = static_cast<int64_t>(rope_pos + i);
+    }
+    if (tp_) {
+        return tp_->forward(hidden_states, cache, rope_table_, pos_ids_host_, token_pos);
+    }
+    if (pp_) {
+        return pp_->forward(hidden_states, cache, pos_ids_host_, token_pos);
+    }
+    tensor_t pos_ids = uploadIds(pos_ids_buf_, pos_ids_host_.data(), seq_len);
+    for (size_t i = 0; i < _config.num_hidden_layers; ++i) {
+        const auto& layer = qwen2_weights.layers[i];
+        ASSERT(layer.input_layernorm.weight != nullptr, "Model_Qwen2::inferStep: input_layernorm weight is null");
+        ASSERT(layer.post_attention_layernorm.weight != nullptr,
+               "Model_Qwen2::inferStep: post_attention_layernorm weight is null");
+        ASSERT(layer.attention.q != nullptr && layer.attention.k != nullptr && layer.attention.v != nullptr &&
+                   layer.attention.o != nullptr,
+               "Model_Qwen2::inferStep: attention weights are null");
+        ASSERT(layer.attention.bias_q != nullptr && layer.attention.bias_k != nullptr &&
+                   layer.attention.bias_v != nullptr,
+               "Model_Qwen2::inferStep: attention bias weights are null");
+        ASSERT(layer.mlp.gate != nullptr && layer.mlp.up != nullptr && layer.mlp.down != nullptr,
+               "Model_Qwen2::inferStep: mlp weights are null");
+        hidden_states = llaisys::Qwen2::qwen2_decoder(hidden_states, qwen2_weights.layers[i], cache, _config,
+                                                      rope_table_, pos_ids, token_pos, i, device_id);
+    }
     return hidden_states;
 }
+// embedding + 所有 decoder 层，token_pos 为 ids[0] 在对话中的位置；
+// 从对话中途开始的多 token 前向由各缓存在注意力中读取已有上下文（分页缓存从页中读出）
+tensor_t Model_Qwen2::forwardTokens(const int64_t* ids, size_t n, CacheHandle_t cache, size_t token_pos) {
+    return forwardLayers(embedTokens(ids, n), cache, token_pos);
+}
+// LLAISYS_COMPILED_STEP=0 关闭 decode 执行计划，LLAISYS_CUDA_GRAPH=0 只关闭其中的 CUDA Graph 回放
+void Model_Qwen2::initDecodePlan() {
+    decode_plan_.reset();
+    // 张量并行的各 rank 与流水线的各级逐层执行，不使用单设备执行计划
+    if (!parse_env_bool(std::getenv("LLAISYS_COMPILED_STEP"), true) || rope_table_.cos == nullptr || tp_ || pp_ ||
+        dp_) {
+        return;
+    }
+    int device_id = _device.device_ids.empty() ? 0 : _device.device_ids.front();
+    bool use_graph = parse_env_bool(std::getenv("LLAISYS_CUDA_GRAPH"), true);
+    decode_plan_ = std::make_unique<DecodePlan>(_config, qwen2_weights, rope_table_, _device.device_type, device_id,
+                                                use_graph);
+}
+
+// rope 表覆盖 [0, max_position_embeddings)，放在权重所在设备上，各层共用
+void Model_Qwen2::initRopeTable() {
+    int device_id = _device.device_ids.empty() ? 0 : _device.device_ids.front();
+    size_t head_dim = _config.hidden_size / _config.num_attention_heads;
+    size_t max_pos = _config.max_position_embeddings;
+    if (max_pos == 0 || head_dim % 2 != 0) {
+        rope_table_ = {};
+        return;
+    }
+    rope_table_.cos = Tensor::create({max_pos, head_dim / 2}, LLAISYS_DTYPE_F32, _device.device_type, device_id);
+    rope_table_.sin = Tensor::create({max_pos, head_dim / 2}, LLAISYS_DTYPE_F32, _device.device_type, device_id);
+    ops::rope_init_table(rope_table_.cos, rope_table_.sin, static_cast<float>(_config.rope_theta));
+}
+
+std::shared_ptr<Model_Qwen2> Model_Qwen2::replica() const {
+    auto model = std::make_shared<Model_Qwen2>(_config, _device, ParallelSpec{});
+    model->weights_ = weights_;
+    model->parseWeight();
+    model->rope_table_ = rope_table_;
+    model->initCache();
+    model->initDecodePlan();
+    return model;
+}
+
 // 解析权重
 void Model_Qwen2::parseWeight() {
     auto get_weight = [this](const std::string& name) -> Weights_t {
@@ -310,6 +780,9 @@ void Model_Qwen2::parseWeight() {
     qwen2_weights.lm_head = get_weight("lm_head.weight");
 
     qwen2_weights.layers.clear();
+    if (tp_ || _parallel.pipeline_parallel > 1) {
+        return;
+    }
     qwen2_weights.layers.resize(_config.num_hidden_layers);
     for (size_t i = 0; i < _config.num_hidden_layers; ++i) {
         auto& layer = qwen2_weights.layers[i];
@@ -345,7 +818,10 @@ void Model_Qwen2::show() {
                           << " sliding_window=" << _config.sliding_window << " max_window_layers="
                           << _config.max_window_layers << " tie_word_embeddings=" << _config.tie_word_embeddings);
     LOG_INFO("  bos=" << _config.bos_token_id << " eos=" << _config.eos_token_id
-                      << " dtype=" << static_cast<int>(_config.torch_type));
+                      << " dtype=" << static_cast<int>(_config.torch_type)
+                      << " kv_cache_dtype=" << static_cast<int>(_config.kv_cache_dtype)
+                      << " attention_sinks=" << _config.attention_sink_tokens
+                      << " streaming_window=" << _config.streaming_window);
     LOG_INFO("  device_type=" << static_cast<int>(_device.device_type) << " device_ids=" << _device.device_ids.size()
                               << " rank=" << _device.rank << " world_size=" << _device.world_size);
     LOG_INFO("  parallel tp=" << _parallel.tensor_parallel << " pp=" << _parallel.pipeline_parallel
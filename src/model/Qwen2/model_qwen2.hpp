@@ -1,4 +1,8 @@
 #include "../../layer/Qwen2/Decoder.hpp"
+#include "data_parallel.hpp"
+#include "decode_plan.hpp"
+#include "pipeline_parallel.hpp"
+#include "tensor_parallel.hpp"
 #include "src/model/model_base.hpp"
 namespace llaisys::model {
 // 新的模型继承自ModelBase
@@ -16,19 +20,49 @@ public:
     void initCache() override;
     CacheHandle_t allocateCache() override;
 
-    InferenceOutputs inferStep(session_t session) override;
+    InferenceOutputs inferStep(session_t session, const InferenceOptions &options = {}) override;
+    std::vector<float> scoreStep(session_t session, size_t begin) override;
+    // 整段打分：逐块调用 scoreStep，返回 tokens.size() - 1 个 log-prob
+    std::vector<float> score(const std::vector<int64_t> &tokens);
+    std::vector<float> embed(const std::vector<std::vector<int64_t>> &inputs, Pooling pooling) override;
     std::vector<int64_t> inferDialog(std::vector<int64_t> &tokens,
                                      size_t max_steps = 128);
+    std::vector<int64_t> inferDialog(std::vector<int64_t> &tokens, const GenerationConfig &gen);
     void destroy();
+    void releaseThreadState() override;
+    // 分页缓存的行数减去默认请求；数据并行时为各副本之和
+    size_t maxSessions() const override;
     void show() override;
     const llaisys::Qwen2::qwen2_weights &weights() const { return qwen2_weights; }
+    // 数据并行副本：直接引用本模型已加载的权重与 rope 表，只新建 KV 缓存、id 缓冲与执行计划
+    std::shared_ptr<Model_Qwen2> replica() const;
     static model_t create(WeightsMap &weights, const meta_data &meta_data,
                           const DeviceSpec &device, const ParallelSpec &parallel);
 
 private:
     WeightsMap weights_;
-    tensor_t inferInit(session_t session);
+    tensor_t embedTokens(const int64_t *ids, size_t n);
+    tensor_t forwardLayers(tensor_t hidden_states, CacheHandle_t cache, size_t token_pos);
+    tensor_t forwardTokens(const int64_t *ids, size_t n, CacheHandle_t cache, size_t token_pos);
     llaisys::Qwen2::qwen2_weights qwen2_weights;
+    llaisys::Qwen2::rotary_table rope_table_;
+    void initRopeTable();
+    // 每步的 token id 与位置 id 放在常驻的设备缓冲里，按需扩容，上传后不同步
+    tensor_t token_ids_buf_;
+    tensor_t pos_ids_buf_;
+    std::vector<int64_t> pos_ids_host_;
+    // 平均池化用的全 1 行向量 [1, 1, len]，按需加长
+    tensor_t ones_;
+    tensor_t uploadIds(tensor_t &buf, const int64_t *ids, size_t n);
+    // 单 token 解码的预编译执行计划，为空时 decode 走逐层 qwen2_decoder
+    std::unique_ptr<DecodePlan> decode_plan_;
+    void initDecodePlan();
+    // CPU 张量并行（tensor_parallel > 1）：decoder 层在各 rank 上执行，模型只保留 embedding、final norm 与 lm_head
+    std::unique_ptr<TensorParallelGroup> tp_;
+    // CPU 流水线并行（pipeline_parallel > 1）：decoder 层分段交给本进程与各工作进程
+    std::unique_ptr<PipelineParallelGroup> pp_;
+    // 数据并行（data_parallel > 1）：本模型只分发会话，推理由共用权重的各副本执行
+    std::unique_ptr<DataParallelGroup> dp_;
     void parseWeight();
     int64_t bos_token_id;
     int64_t eos_token_id;
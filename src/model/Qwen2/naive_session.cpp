@@ -11,7 +11,6 @@ void naive_session::init(std::vector<int64_t>& tokens, CacheHandle_t handle) {
 void naive_session::append(int64_t next_token) {
     tokens_.push_back(next_token);
     seq_len_ = tokens_.size();
-    token_pos_ = seq_len_;
 }
 const std::vector<int64_t> &naive_session::tokens() const {
     return tokens_;
@@ -9,6 +9,7 @@ public:
     const std::vector<int64_t>& tokens() const override;
     size_t seq_len() const override;
     size_t token_pos() const override;
+    void set_token_pos(size_t pos) override { token_pos_ = pos; }
     CacheHandle_t cache() const override { return cache_; }
     void append(int64_t next_token) override;
 
@@ -0,0 +1,436 @@
+#include "pipeline_parallel.hpp"
+#include "../../KVcache/NaiveCache/NaiveCache.hpp"
+#include "../../KVcache/NaiveCache/NaiveCacheHandle.hpp"
+#include "../../core/llaisys_core.hpp"
+#include "../../device/cpu/cpu_process.hpp"
+#include "../../utils.hpp"
+#include <algorithm>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+namespace llaisys::model {
+struct PipelineChannel {
+    std::mutex mutex;
+    int out_fd = -1;
+    int in_fd = -1;
+    // 任一端读写失败后置位，之后的前向直接报错
+    bool broken = false;
+
+    // 在环上发送不需要回复的控制消息；最后一级不再转发，本进程不会收到
+    void control(uint32_t command, uint64_t cache_id);
+};
+
+namespace {
+enum Command : uint32_t {
+    kForward = 1,
+    kError = 2,
+    kReset = 3,
+    kRelease = 4,
+    kShutdown = 5,
+};
+
+// kForward 之后依次是 rows 个 int64 位置与 rows 行 hidden；kError 之后是 rows 字节的错误信息
+struct MessageHeader {
+    uint32_t command = 0;
+    uint32_t dtype = 0;
+    uint64_t cache_id = 0;
+    uint64_t rows = 0;
+    uint64_t token_pos = 0;
+};
+
+// [first, first + count) 层的局部配置：层号从 0 重新编号，滑动窗口的起始层随之平移
+meta_data stage_config(const meta_data &config, size_t first, size_t count) {
+    meta_data out = config;
+    out.num_hidden_layers = count;
+    out.max_window_layers = config.max_window_layers > first ? config.max_window_layers - first : 0;
+    return out;
+}
+
+CacheHandle_t create_stage_cache(const meta_data &config) {
+    size_t head_dim = config.hidden_size / config.num_attention_heads;
+    llaisys::KVcache::CacheMeta cache_meta{
+        config.num_hidden_layers,
+        config.hidden_size,
+        config.max_position_embeddings,
+        config.num_attention_heads,
+        head_dim,
+        config.num_key_value_heads,
+        1};
+    cache_meta.kv_dtype = config.kv_cache_dtype;
+    if (layer_sliding_window(config, config.num_hidden_layers - 1) > 0) {
+        cache_meta.sliding_window = config.sliding_window;
+        cache_meta.max_window_layers = config.max_window_layers;
+    }
+    auto naive = llaisys::KVcache::NaiveCache::create(cache_meta, LLAISYS_DEVICE_CPU, 0, config.torch_type, nullptr);
+    return std::make_shared<llaisys::KVcache::NaiveCacheHandle>(naive);
+}
+
+llaisys::Qwen2::layer_weights parse_layer(const WeightsMap &weights, size_t layer) {
+    auto get = [&](const std::string &name) {
+        auto it = weights.find(name);
+        ASSERT(it != weights.end() && it->second != nullptr, "PipelineParallel: missing weight " + name);
+        ASSERT(it->second->weights()->deviceType() == LLAISYS_DEVICE_CPU,
+               "PipelineParallel: source weights must be CPU tensors");
+        return it->second;
+    };
+    llaisys::Qwen2::layer_weights out;
+    const std::string prefix = "model.layers." + std::to_string(layer) + ".";
+    out.input_layernorm.weight = get(prefix + "input_layernorm.weight");
+    out.post_attention_layernorm.weight = get(prefix + "post_attention_layernorm.weight");
+    out.attention.q = get(prefix + "self_attn.q_proj.weight");
+    out.attention.k = get(prefix + "self_attn.k_proj.weight");
+    out.attention.v = get(prefix + "self_attn.v_proj.weight");
+    out.attention.o = get(prefix + "self_attn.o_proj.weight");
+    out.attention.bias_q = get(prefix + "self_attn.q_proj.bias");
+    out.attention.bias_k = get(prefix + "self_attn.k_proj.bias");
+    out.attention.bias_v = get(prefix + "self_attn.v_proj.bias");
+    out.mlp.gate = get(prefix + "mlp.gate_proj.weight");
+    out.mlp.up = get(prefix + "mlp.up_proj.weight");
+    out.mlp.down = get(prefix + "mlp.down_proj.weight");
+    return out;
+}
+
+// 在调用线程的 stream 上依次执行 layers，返回时输出已写完
+tensor_t run_layers(const meta_data &config, const std::vector<llaisys::Qwen2::layer_weights> &layers,
+                    const llaisys::Qwen2::rotary_table &rope_table, CacheHandle_t cache, tensor_t hidden,
+                    const int64_t *pos_ids, size_t token_pos) {
+    llaisys::core::context().setDevice(LLAISYS_DEVICE_CPU, 0);
+    auto &rt = llaisys::core::context().runtime();
+    size_t rows = hidden->shape()[0];
+    tensor_t pos = Tensor::create({rows}, LLAISYS_DTYPE_I64, LLAISYS_DEVICE_CPU, 0);
+    rt.api()->memcpy_async(pos->data(), pos_ids, rows * sizeof(int64_t), LLAISYS_MEMCPY_H2H, rt.stream());
+    for (size_t i = 0; i < layers.size(); ++i) {
+        hidden = llaisys::Qwen2::qwen2_decoder(hidden, layers[i], cache, config, rope_table, pos, token_pos, i);
+    }
+    rt.api()->stream_synchronize(rt.stream());
+    return hidden;
+}
+
+std::string describe(std::exception_ptr error) {
+    try {
+        std::rethrow_exception(error);
+    } catch (const std::exception &e) {
+        return e.what();
+    } catch (const char *e) {
+        return e;
+    } catch (...) {
+        return "unknown error";
+    }
+}
+
+void send_error(int fd, uint64_t cache_id, const std::string &message) {
+    MessageHeader header;
+    header.command = kError;
+    header.cache_id = cache_id;
+    header.rows = message.size();
+    llaisys::device::cpu::send_all(fd, &header, sizeof(header));
+    llaisys::device::cpu::send_all(fd, message.data(), message.size());
+}
+
+// 工作进程的主循环：从上一级读消息，执行本级的层后交给下一级，直到上一级关闭或收到 kShutdown。
+// 计算失败时以一条 kError 代替该微批的输出，使本进程收到的消息数不变
+void serve_stage(const meta_data &config, const std::vector<llaisys::Qwen2::layer_weights> &layers,
+                 const llaisys::Qwen2::rotary_table &rope_table, int in_fd, int out_fd, bool last) {
+    using llaisys::device::cpu::recv_all;
+    using llaisys::device::cpu::send_all;
+    llaisys::core::context().setDevice(LLAISYS_DEVICE_CPU, 0);
+    std::unordered_map<uint64_t, CacheHandle_t> caches;
+    std::vector<int64_t> pos_ids;
+    MessageHeader header;
+    while (recv_all(in_fd, &header, sizeof(header))) {
+        switch (header.command) {
+        case kForward: {
+            size_t rows = header.rows;
+            auto dtype = static_cast<llaisysDataType_t>(header.dtype);
+            pos_ids.resize(rows);
+            tensor_t hidden = Tensor::create({rows, config.hidden_size}, dtype, LLAISYS_DEVICE_CPU, 0);
+            size_t bytes = hidden->numel() * hidden->elementSize();
+            if (!recv_all(in_fd, pos_ids.data(), rows * sizeof(int64_t)) || !recv_all(in_fd, hidden->data(), bytes)) {
+                return;
+            }
+            std::exception_ptr error;
+            try {
+                auto &cache = caches[header.cache_id];
+                if (cache == nullptr) {
+                    cache = create_stage_cache(config);
+                }
+                hidden = run_layers(config, layers, rope_table, cache, hidden, pos_ids.data(), header.token_pos);
+            } catch (...) {
+                error = std::current_exception();
+            }
+            if (error) {
+                send_error(out_fd, header.cache_id, describe(error));
+                break;
+            }
+            send_all(out_fd, &header, sizeof(header));
+            send_all(out_fd, pos_ids.data(), rows * sizeof(int64_t));
+            send_all(out_fd, hidden->data(), bytes);
+            break;
+        }
+        case kError: {
+            std::string message(header.rows, '\0');
+            if (!recv_all(in_fd, message.data(), message.size())) {
+                return;
+            }
+            send_all(out_fd, &header, sizeof(header));
+            send_all(out_fd, message.data(), message.size());
+            break;
+        }
+        case kReset:
+        case kRelease: {
+            auto it = caches.find(header.cache_id);
+            if (it != caches.end()) {
+                if (header.command == kReset) {
+                    it->second->reset();
+                } else {
+                    caches.erase(it);
+                }
+            }
+            if (!last) {
+                send_all(out_fd, &header, sizeof(header));
+            }
+            break;
+        }
+        case kShutdown:
+            if (!last) {
+                send_all(out_fd, &header, sizeof(header));
+            }
+            return;
+        default:
+            throw std::runtime_error("PipelineParallel: unknown command " + std::to_string(header.command));
+        }
+    }
+}
+} // namespace
+
+void PipelineChannel::control(uint32_t command, uint64_t cache_id) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (broken) {
+        return;
+    }
+    MessageHeader header;
+    header.command = command;
+    header.cache_id = cache_id;
+    try {
+        llaisys::device::cpu::send_all(out_fd, &header, sizeof(header));
+    } catch (...) {
+        broken = true;
+    }
+}
+
+PipelineCacheHandle::~PipelineCacheHandle() {
+    if (auto channel = channel_.lock()) {
+        channel->control(kRelease, id_);
+    }
+}
+
+void PipelineCacheHandle::reset() {
+    local_->reset();
+    if (auto channel = channel_.lock()) {
+        channel->control(kReset, id_);
+    }
+}
+
+void PipelineCacheHandle::append(size_t layer, llaisys::tensor_t &k, llaisys::tensor_t &v, size_t token_idx) {
+    (void)layer; (void)k; (void)v; (void)token_idx;
+    ASSERT(false, "PipelineCacheHandle: append must go through the stage cache");
+}
+
+void PipelineCacheHandle::get(llaisys::tensor_t &k, llaisys::tensor_t &v, size_t layer) {
+    (void)k; (void)v; (void)layer;
+    ASSERT(false, "PipelineCacheHandle: get must go through the stage cache");
+}
+
+PipelineParallelGroup::PipelineParallelGroup(const meta_data &config, const WeightsMap &weights,
+                                             const llaisys::Qwen2::rotary_table &rope_table, size_t stages,
+                                             size_t micro_batch)
+    : config_(config), rope_table_(rope_table), micro_batch_(std::max<size_t>(1, micro_batch)),
+      channel_(std::make_shared<PipelineChannel>()) {
+    const size_t nlayer = config.num_hidden_layers;
+    ASSERT(stages > 1 && stages <= nlayer, "PipelineParallelGroup: stages must be in [2, num_hidden_layers]");
+    // 各级层数尽量均衡
+    for (size_t s = 0; s <= stages; ++s) {
+        bounds_.push_back(nlayer * s / stages);
+    }
+    auto layers_of = [&](size_t stage) {
+        std::vector<llaisys::Qwen2::layer_weights> out;
+        for (size_t i = bounds_[stage]; i < bounds_[stage + 1]; ++i) {
+            out.push_back(parse_layer(weights, i));
+        }
+        return out;
+    };
+    layers_ = layers_of(0);
+    stage_config_ = stage_config(config, bounds_[0], bounds_[1] - bounds_[0]);
+
+    // links[s]：第 s 级的输出（first）连到第 s+1 级的输入（second），最后一条连回本进程
+    std::vector<std::pair<int, int>> links;
+    std::vector<int> fds;
+    try {
+        for (size_t s = 0; s < stages; ++s) {
+            links.push_back(llaisys::device::cpu::socket_pair());
+            fds.push_back(links.back().first);
+            fds.push_back(links.back().second);
+        }
+        for (size_t s = 1; s < stages; ++s) {
+            int in_fd = links[s - 1].second;
+            int out_fd = links[s].first;
+            std::vector<int> close_fds;
+            for (int fd : fds) {
+                if (fd != in_fd && fd != out_fd) {
+                    close_fds.push_back(fd);
+                }
+            }
+            const bool last = s + 1 == stages;
+            meta_data cfg = stage_config(config, bounds_[s], bounds_[s + 1] - bounds_[s]);
+            std::vector<llaisys::Qwen2::layer_weights> layers = layers_of(s);
+            pids_.push_back(llaisys::device::cpu::fork_worker(close_fds, [&] {
+                serve_stage(cfg, layers, rope_table, in_fd, out_fd, last);
+            }));
+        }
+    } catch (...) {
+        // 已启动的工作进程在输入端关闭后依次退出
+        for (int fd : fds) {
+            llaisys::device::cpu::close_fd(fd);
+        }
+        for (int pid : pids_) {
+            llaisys::device::cpu::wait_worker(pid);
+        }
+        throw;
+    }
+    channel_->out_fd = links.front().first;
+    channel_->in_fd = links.back().second;
+    for (int fd : fds) {
+        if (fd != channel_->out_fd && fd != channel_->in_fd) {
+            llaisys::device::cpu::close_fd(fd);
+        }
+    }
+    for (size_t s = 0; s < stages; ++s) {
+        LOG_INFO("PipelineParallelGroup: stage " << s << " layers [" << bounds_[s] << ", " << bounds_[s + 1] << ")"
+                                                 << (s == 0 ? " in process" : " pid=" + std::to_string(pids_[s - 1])));
+    }
+}
+
+PipelineParallelGroup::~PipelineParallelGroup() {
+    shutdown();
+}
+
+void PipelineParallelGroup::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(channel_->mutex);
+        if (!channel_->broken) {
+            MessageHeader header;
+            header.command = kShutdown;
+            try {
+                llaisys::device::cpu::send_all(channel_->out_fd, &header, sizeof(header));
+            } catch (...) {
+            }
+        }
+        channel_->broken = true;
+        llaisys::device::cpu::close_fd(channel_->out_fd);
+        llaisys::device::cpu::close_fd(channel_->in_fd);
+        channel_->out_fd = -1;
+        channel_->in_fd = -1;
+    }
+    for (int pid : pids_) {
+        llaisys::device::cpu::wait_worker(pid);
+    }
+    pids_.clear();
+}
+
+CacheHandle_t PipelineParallelGroup::allocateCache() {
+    return std::make_shared<PipelineCacheHandle>(next_cache_id_++, create_stage_cache(stage_config_), channel_);
+}
+
+tensor_t PipelineParallelGroup::forward(tensor_t hidden_states, CacheHandle_t cache,
+                                        const std::vector<int64_t> &pos_ids, size_t token_pos) {
+    using llaisys::device::cpu::recv_all;
+    using llaisys::device::cpu::send_all;
+    auto handle = std::dynamic_pointer_cast<PipelineCacheHandle>(cache);
+    ASSERT(handle != nullptr, "PipelineParallelGroup: cache is not a pipeline parallel handle");
+    const size_t rows = hidden_states->shape()[0];
+    ASSERT(pos_ids.size() == rows, "PipelineParallelGroup: pos_ids length mismatch");
+    std::lock_guard<std::mutex> lock(channel_->mutex);
+    ASSERT(!channel_->broken, "PipelineParallelGroup: a pipeline stage has exited");
+
+    const size_t row_bytes = hidden_states->shape()[1] * hidden_states->elementSize();
+    const size_t batches = (rows + micro_batch_ - 1) / micro_batch_;
+    tensor_t out = Tensor::create(hidden_states->shape(), hidden_states->dtype(), LLAISYS_DEVICE_CPU, 0);
+    std::string stage_error;
+    std::exception_ptr link_error;
+    // 最后一级的输出由单独的线程接收，避免本进程发送时与之互相阻塞在 socket 缓冲上
+    std::thread receiver([&] {
+        try {
+            std::vector<int64_t> pos(micro_batch_);
+            for (size_t i = 0; i < batches; ++i) {
+                MessageHeader header;
+                if (!recv_all(channel_->in_fd, &header, sizeof(header))) {
+                    throw std::runtime_error("PipelineParallelGroup: last stage closed the pipeline");
+                }
+                if (header.command == kError) {
+                    std::string message(header.rows, '\0');
+                    recv_all(channel_->in_fd, message.data(), message.size());
+                    if (stage_error.empty()) {
+                        stage_error = message;
+                    }
+                    continue;
+                }
+                // 微批按发送顺序返回
+                size_t begin = i * micro_batch_;
+                ASSERT(header.command == kForward && header.rows == std::min(micro_batch_, rows - begin),
+                       "PipelineParallelGroup: unexpected message from last stage");
+                recv_all(channel_->in_fd, pos.data(), header.rows * sizeof(int64_t));
+                recv_all(channel_->in_fd, out->data() + begin * row_bytes, header.rows * row_bytes);
+            }
+        } catch (...) {
+            link_error = std::current_exception();
+        }
+    });
+    std::string local_error;
+    std::exception_ptr send_failure;
+    try {
+        for (size_t i = 0; i < batches; ++i) {
+            size_t begin = i * micro_batch_;
+            size_t end = std::min(rows, begin + micro_batch_);
+            tensor_t hidden;
+            if (local_error.empty()) {
+                try {
+                    hidden = run_layers(stage_config_, layers_, rope_table_, handle->local(),
+                                        hidden_states->slice(0, begin, end), pos_ids.data() + begin, token_pos + begin);
+                } catch (...) {
+                    local_error = describe(std::current_exception());
+                }
+            }
+            // 本级失败后其余微批也以 kError 送出，接收线程才能收齐
+            if (!local_error.empty()) {
+                send_error(channel_->out_fd, handle->id(), local_error);
+                continue;
+            }
+            MessageHeader header;
+            header.command = kForward;
+            header.dtype = static_cast<uint32_t>(hidden->dtype());
+            header.cache_id = handle->id();
+            header.rows = end - begin;
+            header.token_pos = token_pos + begin;
+            send_all(channel_->out_fd, &header, sizeof(header));
+            send_all(channel_->out_fd, pos_ids.data() + begin, header.rows * sizeof(int64_t));
+            send_all(channel_->out_fd, hidden->data(), header.rows * row_bytes);
+        }
+    } catch (...) {
+        // 发送失败说明有工作进程已退出，其下游随之退出，接收线程会读到连接关闭
+        send_failure = std::current_exception();
+    }
+    receiver.join();
+    if (send_failure || link_error) {
+        channel_->broken = true;
+        std::rethrow_exception(send_failure ? send_failure : link_error);
+    }
+    if (!stage_error.empty()) {
+        throw std::runtime_error("PipelineParallelGroup: stage failed: " + stage_error);
+    }
+    return out;
+}
+} // namespace llaisys::model
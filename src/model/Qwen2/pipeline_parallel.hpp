@@ -0,0 +1,76 @@
+#pragma once
+
+#include "../../KVcache/CacheHandle.hpp"
+#include "../../layer/Qwen2/Decoder.hpp"
+#include "../model_base.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace llaisys::model {
+// 与各级工作进程相连的 socket：发往第 1 级、收自最后一级，读写都在 mutex 下进行
+struct PipelineChannel;
+
+// 流水线并行会话的缓存句柄：本进程（第 0 级）各层的缓存，外加各工作进程中按 id 对应的缓存。
+// 工作进程在第一次前向时创建该 id 的缓存，句柄 reset / 析构时通知它们重置 / 释放
+class PipelineCacheHandle : public llaisys::KVcache::CacheHandle {
+public:
+    PipelineCacheHandle(uint64_t id, CacheHandle_t local, std::weak_ptr<PipelineChannel> channel)
+        : id_(id), local_(std::move(local)), channel_(std::move(channel)) {}
+    ~PipelineCacheHandle() override;
+
+    void reset() override;
+    size_t seq_len() const override { return local_->seq_len(); }
+    void append(size_t layer, llaisys::tensor_t &k, llaisys::tensor_t &v, size_t token_idx = 0) override;
+    void get(llaisys::tensor_t &k, llaisys::tensor_t &v, size_t layer) override;
+    size_t max_step_tokens() const override { return local_->max_step_tokens(); }
+
+    uint64_t id() const { return id_; }
+    const CacheHandle_t &local() const { return local_; }
+
+private:
+    uint64_t id_;
+    CacheHandle_t local_;
+    std::weak_ptr<PipelineChannel> channel_;
+};
+
+// CPU 上的流水线并行：decoder 层按顺序切成 stages 段连续的层，第 0 段在本进程执行，
+// 其余各段各由一个 fork 出的工作进程持有（权重与 KV 缓存都只在该进程内使用）。
+// 各级首尾相连成环：本进程 -> 第 1 级 -> ... -> 最后一级 -> 本进程，逐级传递 hidden states。
+// 一次前向把 token 切成 micro_batch 行的微批依次送入流水线，第 s 级处理第 i 批时第 s+1 级处理第 i-1 批；
+// 单 token 的 decode 只有一个微批，各级依次执行
+class PipelineParallelGroup {
+public:
+    // weights 为完整的源权重（CPU），rope_table 由各级共用；构造时 fork 出 stages - 1 个工作进程
+    PipelineParallelGroup(const meta_data &config, const WeightsMap &weights,
+                          const llaisys::Qwen2::rotary_table &rope_table, size_t stages, size_t micro_batch);
+    PipelineParallelGroup(const PipelineParallelGroup &) = delete;
+    PipelineParallelGroup &operator=(const PipelineParallelGroup &) = delete;
+    // 通知各工作进程退出并等待它们结束
+    ~PipelineParallelGroup();
+
+    size_t stages() const { return bounds_.size() - 1; }
+    // 第 stage 级负责的层为 [first_layer(stage), first_layer(stage + 1))
+    size_t first_layer(size_t stage) const { return bounds_[stage]; }
+    CacheHandle_t allocateCache();
+    // hidden_states 为 [seq, hidden] 的层输入，pos_ids 为各 token 的 rope 位置；返回最后一层的输出
+    tensor_t forward(tensor_t hidden_states, CacheHandle_t cache, const std::vector<int64_t> &pos_ids,
+                     size_t token_pos);
+
+private:
+    void shutdown();
+
+    meta_data config_;
+    // 第 0 级的局部配置与层权重（层号从 0 重新编号）
+    meta_data stage_config_;
+    std::vector<llaisys::Qwen2::layer_weights> layers_;
+    llaisys::Qwen2::rotary_table rope_table_;
+    size_t micro_batch_;
+    std::vector<size_t> bounds_;
+    std::vector<int> pids_;
+    std::shared_ptr<PipelineChannel> channel_;
+    std::atomic<uint64_t> next_cache_id_{1};
+};
+} // namespace llaisys::model
@@ -0,0 +1,231 @@
+#include "tensor_parallel.hpp"
+#include "../../core/llaisys_core.hpp"
+#include "../../device/cpu/cpu_launch.hpp"
+#include "../../device/cpu/cpu_numa.hpp"
+#include "../../device/cpu/cpu_stream.hpp"
+#include "../../device/cpu/cpu_thread_pool.hpp"
+#include "../../ops/ops.hpp"
+#include "../../utils.hpp"
+#include <cstring>
+#include <exception>
+#include <string>
+
+namespace llaisys::model {
+namespace {
+// 从连续的 CPU 源张量沿 dim 切出第 part 份（共 parts 份），由绑定到 cpus 的线程写入新张量
+tensor_t shard(const tensor_t &src, size_t dim, size_t parts, size_t part, const std::vector<int> &cpus) {
+    ASSERT(src->deviceType() == LLAISYS_DEVICE_CPU && src->isContiguous(),
+           "TensorParallel: source weights must be contiguous CPU tensors");
+    std::vector<size_t> shape = src->shape();
+    ASSERT(dim < shape.size() && shape[dim] % parts == 0, "TensorParallel: weight is not divisible by world size");
+    size_t len = shape[dim] / parts;
+    size_t outer = 1;
+    size_t inner = src->elementSize();
+    for (size_t i = 0; i < dim; ++i) {
+        outer *= shape[i];
+    }
+    for (size_t i = dim + 1; i < shape.size(); ++i) {
+        inner *= shape[i];
+    }
+    size_t src_stride = shape[dim] * inner;
+    size_t offset = part * len * inner;
+    shape[dim] = len;
+    tensor_t dst = Tensor::create(shape, src->dtype(), LLAISYS_DEVICE_CPU, 0);
+    std::byte *out = dst->data();
+    const std::byte *in = src->data();
+    llaisys::device::cpu::run_pinned(cpus, [&] {
+        for (size_t i = 0; i < outer; ++i) {
+            std::memcpy(out + i * len * inner, in + i * src_stride + offset, len * inner);
+        }
+    });
+    return dst;
+}
+} // namespace
+
+struct TensorParallelGroup::Rank {
+    size_t index = 0;
+    size_t node = 0;
+    std::vector<llaisys::Qwen2::layer_weights> layers;
+    llaisys::Qwen2::tensor_parallel_rank tp;
+    // 驱动线程：持有本 rank 的 core 上下文（runtime 与 stream），按序执行每次前向
+    std::unique_ptr<llaisys::device::cpu::Stream> driver;
+};
+
+void TensorParallelCacheHandle::reset() {
+    for (auto &r : ranks_) {
+        r->reset();
+    }
+}
+
+void TensorParallelCacheHandle::append(size_t layer, llaisys::tensor_t &k, llaisys::tensor_t &v, size_t token_idx) {
+    (void)layer; (void)k; (void)v; (void)token_idx;
+    ASSERT(false, "TensorParallelCacheHandle: append must go through a rank handle");
+}
+
+void TensorParallelCacheHandle::get(llaisys::tensor_t &k, llaisys::tensor_t &v, size_t layer) {
+    (void)k; (void)v; (void)layer;
+    ASSERT(false, "TensorParallelCacheHandle: get must go through a rank handle");
+}
+
+TensorParallelGroup::TensorParallelGroup(const meta_data &config, const WeightsMap &weights, size_t world)
+    : config_(config), all_reduce_(std::make_unique<llaisys::device::cpu::AllReduce>(world)) {
+    ASSERT(world > 1, "TensorParallelGroup: world must be > 1");
+    ASSERT(config.num_attention_heads % world == 0 && config.num_key_value_heads % world == 0 &&
+               config.intermediate_size % world == 0,
+           "TensorParallelGroup: heads and intermediate_size must be divisible by tensor_parallel");
+    auto get = [&](const std::string &name) {
+        auto it = weights.find(name);
+        ASSERT(it != weights.end() && it->second != nullptr, "TensorParallelGroup: missing weight " + name);
+        return it->second->weights();
+    };
+    // 源权重可能仍在 stream 上写入
+    llaisys::device::cpu::synchronize_streams();
+    auto &pool = llaisys::device::cpu::ThreadPool::instance();
+    for (size_t r = 0; r < world; ++r) {
+        auto rank = std::make_unique<Rank>();
+        rank->index = r;
+        rank->node = r % pool.num_nodes();
+        const auto &cpus = pool.node_cpus(rank->node);
+        auto take = [&](const std::string &name, size_t dim, size_t parts) {
+            return std::make_shared<llaisys::Weights>(name, shard(get(name), dim, parts, parts > 1 ? r : 0, cpus));
+        };
+        rank->layers.resize(config.num_hidden_layers);
+        for (size_t i = 0; i < config.num_hidden_layers; ++i) {
+            auto &layer = rank->layers[i];
+            const std::string prefix = "model.layers." + std::to_string(i) + ".";
+            // norm 各 rank 各持一份本地副本；q/k/v/gate/up 切输出行，o/down 切输入列
+            layer.input_layernorm.weight = take(prefix + "input_layernorm.weight", 0, 1);
+            layer.post_attention_layernorm.weight = take(prefix + "post_attention_layernorm.weight", 0, 1);
+            layer.attention.q = take(prefix + "self_attn.q_proj.weight", 0, world);
+            layer.attention.k = take(prefix + "self_attn.k_proj.weight", 0, world);
+            layer.attention.v = take(prefix + "self_attn.v_proj.weight", 0, world);
+            layer.attention.o = take(prefix + "self_attn.o_proj.weight", 1, world);
+            layer.attention.bias_q = take(prefix + "self_attn.q_proj.bias", 0, world);
+            layer.attention.bias_k = take(prefix + "self_attn.k_proj.bias", 0, world);
+            layer.attention.bias_v = take(prefix + "self_attn.v_proj.bias", 0, world);
+            layer.mlp.gate = take(prefix + "mlp.gate_proj.weight", 0, world);
+            layer.mlp.up = take(prefix + "mlp.up_proj.weight", 0, world);
+            layer.mlp.down = take(prefix + "mlp.down_proj.weight", 1, world);
+        }
+        rank->tp.rank = r;
+        rank->tp.world = world;
+        llaisys::device::cpu::AllReduce *all_reduce = all_reduce_.get();
+        // all-reduce 作为任务排在本 rank 的 stream 上，与前面的 linear 按序执行
+        rank->tp.all_reduce = [all_reduce, r](tensor_t t) {
+            llaisys::device::cpu::launch([all_reduce, r, t] { all_reduce->sum(r, t->data(), t->numel(), t->dtype()); });
+        };
+        rank->driver = std::make_unique<llaisys::device::cpu::Stream>();
+        ranks_.push_back(std::move(rank));
+    }
+    // 驱动线程与其 stream 的执行线程都绑定到本 rank 的节点，算子的并行循环只用该节点的工作线程
+    const bool multi_node = pool.num_nodes() > 1;
+    for (auto &rank : ranks_) {
+        size_t node = rank->node;
+        rank->driver->submit([node, multi_node] {
+            llaisys::core::context().setDevice(LLAISYS_DEVICE_CPU, 0);
+            if (!multi_node) {
+                return;
+            }
+            auto bind = [node] {
+                auto &p = llaisys::device::cpu::ThreadPool::instance();
+                llaisys::device::cpu::pin_current_thread(p.node_cpus(node));
+                llaisys::device::cpu::ThreadPool::set_home_node(static_cast<int>(node));
+            };
+            bind();
+            llaisys::device::cpu::launch(bind);
+        });
+    }
+    for (auto &rank : ranks_) {
+        rank->driver->synchronize();
+    }
+    LOG_INFO("TensorParallelGroup: world=" << world << " nodes=" << pool.num_nodes());
+}
+
+TensorParallelGroup::~TensorParallelGroup() {
+    // 驱动线程退出时销毁各自的 core 上下文，先让 stream 上的任务执行完
+    for (auto &rank : ranks_) {
+        rank->driver->submit([] {
+            auto &rt = llaisys::core::context().runtime();
+            rt.api()->stream_synchronize(rt.stream());
+        });
+    }
+    ranks_.clear();
+}
+
+size_t TensorParallelGroup::node_of(size_t rank) const {
+    return ranks_[rank]->node;
+}
+
+tensor_t TensorParallelGroup::runRank(Rank &rank, tensor_t hidden_states, CacheHandle_t cache,
+                                      const llaisys::Qwen2::rotary_table &rope_table,
+                                      const std::vector<int64_t> &pos_ids, size_t token_pos) {
+    llaisys::core::context().setDevice(LLAISYS_DEVICE_CPU, 0);
+    auto &rt = llaisys::core::context().runtime();
+    size_t seq_len = hidden_states->shape()[0];
+    // 残差流在各 rank 上各有一份
+    tensor_t hidden = Tensor::create(hidden_states->shape(), hidden_states->dtype(), LLAISYS_DEVICE_CPU, 0);
+    ops::rearrange(hidden, hidden_states);
+    tensor_t pos = Tensor::create({seq_len}, LLAISYS_DTYPE_I64, LLAISYS_DEVICE_CPU, 0);
+    rt.api()->memcpy_async(pos->data(), pos_ids.data(), seq_len * sizeof(int64_t), LLAISYS_MEMCPY_H2H, rt.stream());
+    for (size_t i = 0; i < config_.num_hidden_layers; ++i) {
+        hidden = llaisys::Qwen2::qwen2_decoder(hidden, rank.layers[i], cache, config_, rope_table, pos, token_pos, i,
+                                               0, &rank.tp);
+    }
+    rt.api()->stream_synchronize(rt.stream());
+    return hidden;
+}
+
+tensor_t TensorParallelGroup::forward(tensor_t hidden_states, CacheHandle_t cache,
+                                      const llaisys::Qwen2::rotary_table &rope_table,
+                                      const std::vector<int64_t> &pos_ids, size_t token_pos) {
+    auto handle = std::dynamic_pointer_cast<TensorParallelCacheHandle>(cache);
+    ASSERT(handle != nullptr && handle->world() == world(), "TensorParallelGroup: cache is not a tensor parallel handle");
+    ASSERT(pos_ids.size() == hidden_states->shape()[0], "TensorParallelGroup: pos_ids length mismatch");
+    // 调用方 stream 上产出 hidden_states 的算子完成后各 rank 才能读取
+    auto &rt = llaisys::core::context().runtime();
+    rt.api()->stream_synchronize(rt.stream());
+
+    std::vector<tensor_t> outputs(world());
+    for (size_t r = 0; r < world(); ++r) {
+        Rank *rank = ranks_[r].get();
+        CacheHandle_t rank_cache = handle->rank(r);
+        rank->driver->submit([&, rank, rank_cache, r] {
+            try {
+                outputs[r] = runRank(*rank, hidden_states, rank_cache, rope_table, pos_ids, token_pos);
+            } catch (...) {
+                // 本 rank 提前退出时其余 rank 会卡在 all-reduce 上
+                all_reduce_->abort();
+                throw;
+            }
+        });
+    }
+    std::exception_ptr error;
+    for (auto &rank : ranks_) {
+        try {
+            rank->driver->synchronize();
+        } catch (...) {
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    }
+    if (error) {
+        // 各 rank 的 stream 上可能还排着本步的 all-reduce，全部执行完（被中止的会直接抛出）后才能清除中止状态
+        for (auto &rank : ranks_) {
+            rank->driver->submit([] {
+                auto &rt = llaisys::core::context().runtime();
+                rt.api()->stream_synchronize(rt.stream());
+            });
+        }
+        for (auto &rank : ranks_) {
+            try {
+                rank->driver->synchronize();
+            } catch (...) {
+            }
+        }
+        all_reduce_->reset();
+        std::rethrow_exception(error);
+    }
+    return outputs[0];
+}
+} // namespace llaisys::model
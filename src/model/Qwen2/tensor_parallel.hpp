@@ -0,0 +1,61 @@
+#pragma once
+
+#include "../../KVcache/CacheHandle.hpp"
+#include "../../device/cpu/cpu_all_reduce.hpp"
+#include "../../layer/Qwen2/Decoder.hpp"
+#include "../model_base.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace llaisys::model {
+// 张量并行会话的缓存句柄：持有每个 rank 的缓存（各含 1/world 的 KV 头），
+// 对模型只暴露序列长度等公共状态，K/V 读写由各 rank 直接作用在自己的句柄上
+class TensorParallelCacheHandle : public llaisys::KVcache::CacheHandle {
+public:
+    explicit TensorParallelCacheHandle(std::vector<CacheHandle_t> ranks) : ranks_(std::move(ranks)) {}
+
+    void reset() override;
+    size_t seq_len() const override { return ranks_.front()->seq_len(); }
+    void append(size_t layer, llaisys::tensor_t &k, llaisys::tensor_t &v, size_t token_idx = 0) override;
+    void get(llaisys::tensor_t &k, llaisys::tensor_t &v, size_t layer) override;
+    size_t max_step_tokens() const override { return ranks_.front()->max_step_tokens(); }
+
+    size_t world() const { return ranks_.size(); }
+    const CacheHandle_t &rank(size_t r) const { return ranks_[r]; }
+
+private:
+    std::vector<CacheHandle_t> ranks_;
+};
+
+// CPU 上的 Megatron 式张量并行：world 个 rank 各有一个常驻驱动线程，rank r 的计算绑定在
+// NUMA 节点 r % 节点数 上，只持有本 rank 的权重分片（由该节点的线程 first-touch）。
+// embedding、final norm 与 lm_head 留在模型上；每次前向各 rank 在自己的 stream 上跑完全部 decoder 层，
+// o/down 之后经共享内存 all-reduce 同步，返回 rank 0 的输出
+class TensorParallelGroup {
+public:
+    // weights 为完整的源权重（CPU），按 rank 切出 decoder 层的分片
+    TensorParallelGroup(const meta_data &config, const WeightsMap &weights, size_t world);
+    TensorParallelGroup(const TensorParallelGroup &) = delete;
+    TensorParallelGroup &operator=(const TensorParallelGroup &) = delete;
+    ~TensorParallelGroup();
+
+    size_t world() const { return ranks_.size(); }
+    // rank r 所在的 NUMA 节点
+    size_t node_of(size_t rank) const;
+    // hidden_states 为 [seq, hidden] 的层输入，pos_ids 为各 token 的 rope 位置；返回最后一层的输出
+    tensor_t forward(tensor_t hidden_states, CacheHandle_t cache, const llaisys::Qwen2::rotary_table &rope_table,
+                     const std::vector<int64_t> &pos_ids, size_t token_pos);
+
+private:
+    struct Rank;
+    tensor_t runRank(Rank &rank, tensor_t hidden_states, CacheHandle_t cache,
+                     const llaisys::Qwen2::rotary_table &rope_table, const std::vector<int64_t> &pos_ids,
+                     size_t token_pos);
+
+    meta_data config_;
+    std::unique_ptr<llaisys::device::cpu::AllReduce> all_reduce_;
+    std::vector<std::unique_ptr<Rank>> ranks_;
+};
+} // namespace llaisys::model
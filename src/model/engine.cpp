@@ -0,0 +1,609 @@
+#include "engine.hpp"
+#include "../core/llaisys_core.hpp"
+#include "../utils.hpp"
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <limits>
+
+namespace llaisys::model {
+struct Engine::Request {
+    // 生成、打分（结果放在 logprobs 中）或文本向量
+    enum class Kind {
+        Generate,
+        Score,
+        Embed,
+    };
+    uint64_t id = 0;
+    std::vector<int64_t> prompt;
+    GenerationConfig gen;
+    Kind kind = Kind::Generate;
+    // 文本向量请求的输入与结果；embedded 为已处理的序列数
+    std::vector<std::vector<int64_t>> inputs;
+    Pooling pooling = Pooling::Last;
+    std::vector<float> embeddings;
+    size_t embedded = 0;
+    TokenCallback callback;
+    session_t session;
+    // 多轮会话中的一轮：prompt 为本轮新加入的 token，会话由 conversation 持有
+    conversation_t conversation;
+    std::vector<int64_t> generated;
+    // gen.logprobs / gen.top_logprobs 开启时与 generated 一一对应；top 按 top_logprobs 个一组
+    std::vector<float> logprobs;
+    std::vector<int64_t> top_tokens;
+    std::vector<float> top_logprobs;
+    // 已被 poll 取走的 token 数
+    size_t read = 0;
+    RequestStatus status = RequestStatus::Pending;
+    StopReason stop_reason = StopReason::None;
+    bool stepping = false;
+    bool cancel_requested = false;
+    bool released = false;
+    // 已为本请求的会话占用一个会话名额（多轮会话的名额记在 Conversation 上）
+    bool holds_slot = false;
+};
+
+struct Engine::Conversation {
+    // 各轮的输入与生成的 token，与会话中的 token 一致，调用方读取时不必碰会话
+    std::vector<int64_t> tokens;
+    session_t session;
+    // 正在进行的一轮
+    request_t turn;
+    bool failed = false;
+    // 已 close_session：进行中的一轮结束时释放会话
+    bool closed = false;
+    // 会话占用一个会话名额，直到会话关闭
+    bool holds_slot = false;
+};
+
+Engine::Engine(model_t model)
+    : model_(std::move(model)),
+      bos_token_id_(static_cast<int64_t>(model_->config().bos_token_id)),
+      max_sessions_(model_->maxSessions()) {
+    const size_t workers = std::max<size_t>(1, model_->parallelSpec().data_parallel);
+    for (size_t i = 0; i < workers; ++i) {
+        workers_.emplace_back([this] { work(); });
+    }
+    LOG_INFO("Engine: workers=" << workers);
+}
+
+Engine::~Engine() {
+    shutdown();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    ready_cv_.notify_all();
+    for (auto &worker : workers_) {
+        worker.join();
+    }
+    model_.reset();
+}
+
+void Engine::shutdown() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    closed_ = true;
+    ready_.clear();
+    // 关闭时不再回调：调用方此时通常正在销毁回调引用的对象。
+    // 已 release 的请求在 finish 中从 requests_ 删除，先取出再逐个处理
+    std::vector<request_t> pending;
+    pending.reserve(requests_.size());
+    for (auto &entry : requests_) {
+        pending.push_back(entry.second);
+    }
+    for (auto &request : pending) {
+        request->callback = nullptr;
+        request->cancel_requested = true;
+        if (!request->stepping && !terminal(*request)) {
+            finish(*request, RequestStatus::Cancelled);
+        }
+    }
+    changed_cv_.wait(lock, [this] { return stepping_ == 0; });
+    for (auto &entry : conversations_) {
+        retire(std::move(entry.second->session), entry.second->holds_slot);
+    }
+    requests_.clear();
+    conversations_.clear();
+}
+
+uint64_t Engine::submit(std::vector<int64_t> tokens, size_t max_new_tokens, TokenCallback callback) {
+    GenerationConfig gen;
+    gen.max_new_tokens = max_new_tokens;
+    return submit(std::move(tokens), std::move(gen), std::move(callback));
+}
+
+uint64_t Engine::submit(std::vector<int64_t> tokens, GenerationConfig gen, TokenCallback callback) {
+    ASSERT(gen.max_new_tokens > 0, "Engine::submit: max_new_tokens must be > 0");
+    if (tokens.empty()) {
+        tokens.push_back(bos_token_id_);
+    }
+    auto request = std::make_shared<Request>();
+    request->prompt = std::move(tokens);
+    request->gen = std::move(gen);
+    request->callback = std::move(callback);
+    return enqueue(request);
+}
+
+uint64_t Engine::enqueue(const request_t &request) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ASSERT(!closed_, "Engine: engine is shut down");
+        request->id = next_id_++;
+        requests_.emplace(request->id, request);
+        ready_.push_back(request);
+    }
+    ready_cv_.notify_one();
+    return request->id;
+}
+
+uint64_t Engine::submit_score(std::vector<int64_t> tokens) {
+    ASSERT(tokens.size() >= 2, "Engine::submit_score: need at least 2 tokens");
+    auto request = std::make_shared<Request>();
+    request->prompt = std::move(tokens);
+    request->kind = Request::Kind::Score;
+    return enqueue(request);
+}
+
+std::vector<float> Engine::scores(uint64_t id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto request = find(id);
+    ASSERT(request->kind == Request::Kind::Score, "Engine::scores: request " << id << " is not a scoring request");
+    return request->logprobs;
+}
+
+uint64_t Engine::submit_embed(std::vector<std::vector<int64_t>> inputs, Pooling pooling) {
+    ASSERT(!inputs.empty(), "Engine::submit_embed: inputs is empty");
+    for (const auto &seq : inputs) {
+        ASSERT(!seq.empty(), "Engine::submit_embed: empty input sequence");
+    }
+    auto request = std::make_shared<Request>();
+    request->kind = Request::Kind::Embed;
+    request->inputs = std::move(inputs);
+    request->pooling = pooling;
+    return enqueue(request);
+}
+
+std::vector<float> Engine::embeddings(uint64_t id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto request = find(id);
+    ASSERT(request->kind == Request::Kind::Embed,
+           "Engine::embeddings: request " << id << " is not an embedding request");
+    return request->embeddings;
+}
+
+uint64_t Engine::open_session() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ASSERT(!closed_, "Engine: engine is shut down");
+    // 打开的多轮会话各自长期占用一个名额，超出上限时第一轮永远等不到缓存，直接拒绝
+    ASSERT(max_sessions_ == 0 || conversations_.size() < max_sessions_,
+           "Engine::open_session: the KV cache holds at most " << max_sessions_
+                                                                << " sessions, close a session first");
+    const uint64_t id = next_session_id_++;
+    conversations_.emplace(id, std::make_shared<Conversation>());
+    return id;
+}
+
+uint64_t Engine::submit_turn(uint64_t session_id, std::vector<int64_t> tokens, GenerationConfig gen,
+                             TokenCallback callback) {
+    ASSERT(gen.max_new_tokens > 0, "Engine::submit_turn: max_new_tokens must be > 0");
+    auto request = std::make_shared<Request>();
+    request->gen = std::move(gen);
+    request->callback = std::move(callback);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ASSERT(!closed_, "Engine: engine is shut down");
+        auto conversation = find_session(session_id);
+        ASSERT(!conversation->failed, "Engine::submit_turn: session " << session_id << " failed earlier");
+        ASSERT(conversation->turn == nullptr, "Engine::submit_turn: session " << session_id << " has a turn in progress");
+        if (conversation->tokens.empty() && tokens.empty()) {
+            tokens.push_back(bos_token_id_);
+        }
+        conversation->tokens.insert(conversation->tokens.end(), tokens.begin(), tokens.end());
+        conversation->turn = request;
+        request->prompt = std::move(tokens);
+        request->conversation = conversation;
+        request->id = next_id_++;
+        requests_.emplace(request->id, request);
+        ready_.push_back(request);
+    }
+    ready_cv_.notify_one();
+    return request->id;
+}
+
+std::vector<int64_t> Engine::session_tokens(uint64_t session_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return find_session(session_id)->tokens;
+}
+
+void Engine::close_session(uint64_t session_id) {
+    request_t turn;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = conversations_.find(session_id);
+        if (it == conversations_.end()) {
+            return;
+        }
+        // 没有进行中的一轮时立即交给工作线程释放，否则在这一轮结束时
+        turn = it->second->turn;
+        if (turn) {
+            it->second->closed = true;
+        } else {
+            retire(std::move(it->second->session), it->second->holds_slot);
+            it->second->holds_slot = false;
+        }
+        conversations_.erase(it);
+    }
+    if (turn) {
+        cancel(turn->id);
+    }
+}
+
+Engine::conversation_t Engine::find_session(uint64_t id) {
+    auto it = conversations_.find(id);
+    ASSERT(it != conversations_.end(), "Engine: unknown session id " << id);
+    return it->second;
+}
+
+Engine::request_t Engine::find(uint64_t id) {
+    auto it = requests_.find(id);
+    ASSERT(it != requests_.end(), "Engine: unknown request id " << id);
+    return it->second;
+}
+
+bool Engine::terminal(const Request &request) const {
+    return request.status == RequestStatus::Finished || request.status == RequestStatus::Cancelled ||
+           request.status == RequestStatus::Failed;
+}
+
+void Engine::finish(Request &request, RequestStatus status) {
+    request.status = status;
+    retire(std::move(request.session), request.holds_slot);
+    request.holds_slot = false;
+    if (request.conversation) {
+        // 取消的一轮已生成的 token 都在会话里，之后可以继续；失败时缓存状态未知
+        request.conversation->failed = status == RequestStatus::Failed;
+        if (request.conversation->closed) {
+            retire(std::move(request.conversation->session), request.conversation->holds_slot);
+            request.conversation->holds_slot = false;
+        }
+        request.conversation->turn.reset();
+        request.conversation.reset();
+    }
+    if (request.released) {
+        requests_.erase(request.id);
+    }
+}
+
+void Engine::retire(session_t session, bool slot) {
+    if (!session && !slot) {
+        return;
+    }
+    if (session) {
+        retired_.push_back(std::move(session));
+    }
+    if (slot) {
+        // 会话创建失败时没有会话，名额同样要归还
+        ++retired_slots_;
+    }
+    ready_cv_.notify_one();
+}
+
+Engine::request_t Engine::take_ready() {
+    for (auto it = ready_.begin(); it != ready_.end(); ++it) {
+        Request &request = **it;
+        const bool has_slot = request.kind == Request::Kind::Embed || request.holds_slot ||
+                              (request.conversation && request.conversation->holds_slot);
+        if (!has_slot) {
+            if (max_sessions_ > 0 && live_sessions_ >= max_sessions_) {
+                continue;
+            }
+            ++live_sessions_;
+            (request.conversation ? request.conversation->holds_slot : request.holds_slot) = true;
+        }
+        request_t taken = *it;
+        ready_.erase(it);
+        return taken;
+    }
+    return nullptr;
+}
+
+size_t Engine::poll(uint64_t id, int64_t *out, size_t capacity, RequestStatus *status, float *logprobs,
+                    int64_t *top_tokens, float *top_logprobs, size_t top_capacity) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto request = find(id);
+    size_t n = std::min(capacity, request->generated.size() - request->read);
+    if (n > 0) {
+        const auto read = static_cast<std::ptrdiff_t>(request->read);
+        std::copy_n(request->generated.begin() + read, n, out);
+        if (logprobs && !request->logprobs.empty()) {
+            std::copy_n(request->logprobs.begin() + read, n, logprobs);
+        }
+        // 按调用方缓冲的宽度逐 token 拷贝，请求的 top_logprobs 与之不同时不会越界
+        const size_t top = request->gen.top_logprobs;
+        const size_t take = std::min(top, top_capacity);
+        for (size_t i = 0; i < n && top_capacity > 0; ++i) {
+            const size_t src = (request->read + i) * top;
+            if (top_tokens) {
+                std::copy_n(request->top_tokens.begin() + static_cast<std::ptrdiff_t>(src), take,
+                            top_tokens + i * top_capacity);
+                std::fill_n(top_tokens + i * top_capacity + take, top_capacity - take, int64_t{-1});
+            }
+            if (top_logprobs) {
+                std::copy_n(request->top_logprobs.begin() + static_cast<std::ptrdiff_t>(src), take,
+                            top_logprobs + i * top_capacity);
+                std::fill_n(top_logprobs + i * top_capacity + take, top_capacity - take,
+                            -std::numeric_limits<float>::infinity());
+            }
+        }
+        request->read += n;
+    }
+    if (status) {
+        *status = request->status;
+    }
+    return n;
+}
+
+bool Engine::cancel(uint64_t id) {
+    TokenCallback callback;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto request = find(id);
+        if (terminal(*request)) {
+            return false;
+        }
+        request->cancel_requested = true;
+        if (request->stepping) {
+            // 工作线程在这一步结束后释放
+            return true;
+        }
+        ready_.erase(std::remove(ready_.begin(), ready_.end(), request), ready_.end());
+        callback = std::move(request->callback);
+        finish(*request, RequestStatus::Cancelled);
+    }
+    changed_cv_.notify_all();
+    if (callback) {
+        callback(id, -1, true);
+    }
+    return true;
+}
+
+RequestStatus Engine::wait(uint64_t id, int64_t timeout_ms) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto request = find(id);
+    auto ready = [&] { return request->read < request->generated.size() || terminal(*request); };
+    if (timeout_ms < 0) {
+        changed_cv_.wait(lock, ready);
+    } else {
+        changed_cv_.wait_for(lock, std::chrono::milliseconds(timeout_ms), ready);
+    }
+    return request->status;
+}
+
+std::vector<int64_t> Engine::tokens(uint64_t id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto request = find(id);
+    std::vector<int64_t> out(request->prompt);
+    out.insert(out.end(), request->generated.begin(), request->generated.end());
+    return out;
+}
+
+StopReason Engine::stop_reason(uint64_t id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return find(id)->stop_reason;
+}
+
+void Engine::release(uint64_t id) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = requests_.find(id);
+        if (it == requests_.end()) {
+            return;
+        }
+        if (terminal(*it->second)) {
+            requests_.erase(it);
+            return;
+        }
+        it->second->released = true;
+    }
+    cancel(id);
+}
+
+void Engine::work() {
+    const auto &device = model_->deviceSpec();
+    llaisys::core::context().setDevice(device.device_type, device.device_ids.empty() ? 0 : device.device_ids.front());
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        request_t request;
+        ready_cv_.wait(lock, [&] {
+            return stop_ || !retired_.empty() || retired_slots_ > 0 || (request = take_ready()) != nullptr;
+        });
+        if (!retired_.empty() || retired_slots_ > 0) {
+            std::vector<session_t> retired;
+            retired.swap(retired_);
+            const size_t slots = retired_slots_;
+            retired_slots_ = 0;
+            lock.unlock();
+            retired.clear();
+            lock.lock();
+            // 会话释放后名额才可再用：分页缓存的行在会话析构时归还
+            live_sessions_ -= slots;
+            if (slots > 0) {
+                ready_cv_.notify_all();
+            }
+            continue;
+        }
+        if (stop_) {
+            break;
+        }
+        request->status = RequestStatus::Running;
+        request->stepping = true;
+        ++stepping_;
+        lock.unlock();
+
+        if (request->kind == Request::Kind::Score) {
+            score_step(request, lock);
+            continue;
+        }
+        if (request->kind == Request::Kind::Embed) {
+            embed_step(request, lock);
+            continue;
+        }
+
+        // 会话在首次执行时创建，prefill 与之后的 decode 都在工作线程上进行
+        InferenceOutputs outputs;
+        bool failed = false;
+        StopReason reason = StopReason::None;
+        try {
+            if (!request->session && request->conversation) {
+                // 有一轮在进行时 conversation 的 token 只由工作线程改动。把会话补齐到 conversation 的 token
+                // （包括之前未开始就被取消的轮次加入的），补上的部分在这一步作为续接的 prefill 处理
+                auto &conversation = *request->conversation;
+                if (!conversation.session) {
+                    conversation.session = model_->createSession(conversation.tokens);
+                }
+                for (size_t i = conversation.session->tokens().size(); i < conversation.tokens.size(); ++i) {
+                    conversation.session->append(conversation.tokens[i]);
+                }
+                request->session = conversation.session;
+            } else if (!request->session) {
+                request->session = model_->createSession(request->prompt);
+            }
+            InferenceOptions options;
+            options.logprobs = request->gen.logprobs;
+            options.top_logprobs = request->gen.top_logprobs;
+            outputs = model_->inferStep(request->session, options);
+            reason = check_stop(request->gen, model_->config(), request->session->tokens(),
+                                request->generated.size() + 1);
+        } catch (const std::exception &e) {
+            LOG_INFO("Engine: request " << request->id << " failed: " << e.what());
+            failed = true;
+        }
+
+        lock.lock();
+        const int64_t token = failed ? -1 : outputs.next_token;
+        if (!failed) {
+            request->generated.push_back(token);
+            if (request->conversation) {
+                request->conversation->tokens.push_back(token);
+            }
+            if (request->gen.logprobs || request->gen.top_logprobs > 0) {
+                request->logprobs.push_back(outputs.logprob);
+                request->top_tokens.insert(request->top_tokens.end(), outputs.top_tokens.begin(),
+                                           outputs.top_tokens.end());
+                request->top_logprobs.insert(request->top_logprobs.end(), outputs.top_logprobs.begin(),
+                                             outputs.top_logprobs.end());
+            }
+        }
+        TokenCallback callback = request->callback;
+        const bool finished = reason != StopReason::None;
+        lock.unlock();
+        changed_cv_.notify_all();
+
+        // 回调在把请求放回队列之前执行，同一请求的回调因此不会并发且按 token 顺序进行
+        bool keep = true;
+        if (callback) {
+            try {
+                keep = callback(request->id, token, failed || finished);
+            } catch (...) {
+                keep = false;
+            }
+        }
+
+        lock.lock();
+        TokenCallback end_callback;
+        if (failed) {
+            finish(*request, RequestStatus::Failed);
+        } else if (finished) {
+            request->stop_reason = reason;
+            finish(*request, RequestStatus::Finished);
+        } else if (!keep || request->cancel_requested) {
+            finish(*request, RequestStatus::Cancelled);
+            if (keep) {
+                // 由 cancel() 取消：补发结束回调
+                end_callback = request->callback;
+            }
+        } else {
+            ready_.push_back(request);
+            ready_cv_.notify_one();
+        }
+        if (end_callback) {
+            lock.unlock();
+            end_callback(request->id, -1, true);
+            lock.lock();
+        }
+        request->stepping = false;
+        --stepping_;
+        changed_cv_.notify_all();
+    }
+    // 模型在本线程上分配的缓冲须在线程的 core 上下文销毁前释放；持锁执行，各工作线程依次释放
+    model_->releaseThreadState();
+}
+
+void Engine::score_step(const request_t &request, std::unique_lock<std::mutex> &lock) {
+    std::vector<float> chunk;
+    bool failed = false;
+    try {
+        if (!request->session) {
+            request->session = model_->createSession(request->prompt);
+        }
+        chunk = model_->scoreStep(request->session, request->logprobs.size());
+    } catch (const std::exception &e) {
+        LOG_INFO("Engine: request " << request->id << " failed: " << e.what());
+        failed = true;
+    }
+
+    lock.lock();
+    request->logprobs.insert(request->logprobs.end(), chunk.begin(), chunk.end());
+    if (failed) {
+        finish(*request, RequestStatus::Failed);
+    } else if (request->logprobs.size() + 1 >= request->prompt.size() || chunk.empty()) {
+        finish(*request, RequestStatus::Finished);
+    } else if (request->cancel_requested) {
+        finish(*request, RequestStatus::Cancelled);
+    } else {
+        ready_.push_back(request);
+        ready_cv_.notify_one();
+    }
+    request->stepping = false;
+    --stepping_;
+    changed_cv_.notify_all();
+}
+
+void Engine::embed_step(const request_t &request, std::unique_lock<std::mutex> &lock) {
+    // inputs 只由工作线程读取，调用方提交后不再改动
+    size_t end = request->embedded;
+    size_t packed_tokens = 0;
+    while (end < request->inputs.size() &&
+           (end == request->embedded || packed_tokens + request->inputs[end].size() <= kEmbedPackTokens)) {
+        packed_tokens += request->inputs[end].size();
+        ++end;
+    }
+    std::vector<float> pooled;
+    bool failed = false;
+    try {
+        std::vector<std::vector<int64_t>> pack(request->inputs.begin() + static_cast<std::ptrdiff_t>(request->embedded),
+                                               request->inputs.begin() + static_cast<std::ptrdiff_t>(end));
+        pooled = model_->embed(pack, request->pooling);
+    } catch (const std::exception &e) {
+        LOG_INFO("Engine: request " << request->id << " failed: " << e.what());
+        failed = true;
+    }
+
+    lock.lock();
+    request->embeddings.insert(request->embeddings.end(), pooled.begin(), pooled.end());
+    request->embedded = end;
+    if (failed) {
+        finish(*request, RequestStatus::Failed);
+    } else if (request->embedded == request->inputs.size()) {
+        finish(*request, RequestStatus::Finished);
+    } else if (request->cancel_requested) {
+        finish(*request, RequestStatus::Cancelled);
+    } else {
+        ready_.push_back(request);
+        ready_cv_.notify_one();
+    }
+    request->stepping = false;
+    --stepping_;
+    changed_cv_.notify_all();
+}
+} // namespace llaisys::model
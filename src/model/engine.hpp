@@ -0,0 +1,136 @@
+/*
+后台推理引擎：把生成请求排队交给常驻的工作线程执行，调用方提交后立即返回，
+之后通过回调或轮询逐个取得生成的 token，也可以随时取消。
+*/
+#pragma once
+
+#include "model_base.hpp"
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace llaisys::model {
+enum class RequestStatus {
+    Pending = 0,
+    Running = 1,
+    Finished = 2,
+    Cancelled = 3,
+    Failed = 4,
+};
+
+// 每生成一个 token 在工作线程上回调一次，finished 表示这是最后一个；
+// 请求被取消或失败而没有新 token 时以 token = -1、finished = true 回调一次。返回 false 取消请求
+using TokenCallback = std::function<bool(uint64_t request_id, int64_t token, bool finished)>;
+
+// 工作线程按轮转方式推进所有进行中的请求：每轮每个请求只执行一步（首轮为 prefill），
+// 新请求不必等前面的请求生成完毕就能拿到首个 token。
+// 工作线程数为 1，数据并行时与副本数相同（各副本的推理可以同时进行）。
+// 会话（KV 缓存）与模型在推理中分配的缓冲都属于工作线程的上下文，须在工作线程退出前释放：
+// 在调用线程上结束的请求（取消、释放、关闭会话、shutdown）只把会话交给工作线程，由工作线程释放。
+// 模型限制了同时存活的会话数时（ModelBase::maxSessions，如分页缓存的行数），需要新会话的请求在队列中等到
+// 有会话释放再开始；打开的多轮会话一直占用名额，直到关闭
+class Engine {
+public:
+    explicit Engine(model_t model);
+    Engine(const Engine &) = delete;
+    Engine &operator=(const Engine &) = delete;
+    ~Engine();
+
+    // tokens 为空时以 bos 开始；每步之后按 gen 检查 eos、停止序列与长度上限，结束即释放会话。返回请求 id
+    uint64_t submit(std::vector<int64_t> tokens, GenerationConfig gen, TokenCallback callback = {});
+    uint64_t submit(std::vector<int64_t> tokens, size_t max_new_tokens, TokenCallback callback = {});
+    // 打分请求：不生成 token，每轮按 ModelBase::scoreStep 处理一块位置，与生成请求轮流执行；
+    // 算完 tokens.size() - 1 个 log-prob 后以 Finished 结束。tokens 至少 2 个
+    uint64_t submit_score(std::vector<int64_t> tokens);
+    // 打分请求已算出的 log-prob
+    std::vector<float> scores(uint64_t id);
+    // 文本向量请求：每轮把若干个序列打包（合计不超过 kEmbedPackTokens 个 token，单个更长的序列独占一轮）
+    // 交给 ModelBase::embed，全部算完后以 Finished 结束。不创建会话、不分配 KV 缓存
+    uint64_t submit_embed(std::vector<std::vector<int64_t>> inputs, Pooling pooling);
+    // 文本向量请求已算出的结果，每个序列 hidden_size 个 f32
+    std::vector<float> embeddings(uint64_t id);
+    // 多轮会话：KV 缓存在各轮之间保留，返回会话 id。会话在第一轮执行时才在工作线程上分配缓存。
+    // 打开的会话数已达到模型的会话数上限时抛出异常
+    uint64_t open_session();
+    // 把 tokens 接在会话末尾并生成一轮，返回请求 id。只 prefill 上一轮之后新加入的 token，
+    // 生成的 token 留在会话中、下一轮不必重复提交；tokens 可以为空（空会话以 bos 开始）。
+    // gen 的长度上限与停止条件按整个会话检查；同一会话同时只能有一轮在进行，失败过的会话不能再使用
+    uint64_t submit_turn(uint64_t session_id, std::vector<int64_t> tokens, GenerationConfig gen,
+                         TokenCallback callback = {});
+    // 会话中各轮的输入与生成的全部 token
+    std::vector<int64_t> session_tokens(uint64_t session_id);
+    // 释放会话的 KV 缓存；有一轮正在进行时先取消，在这一步结束后释放
+    void close_session(uint64_t session_id);
+    // 取出尚未取走的 token（最多 capacity 个），返回取出的个数。
+    // 请求开启了 gen.logprobs / gen.top_logprobs 时可同时取出每个 token 的 log-prob（logprobs，capacity 个），
+    // 以及每个 token 的候选（top_tokens / top_logprobs，capacity * top_capacity 个，每个 token 最多取 top_capacity 个，
+    // 多出的位置填 -1 / -inf）；不需要的传空
+    size_t poll(uint64_t id, int64_t *out, size_t capacity, RequestStatus *status = nullptr, float *logprobs = nullptr,
+                int64_t *top_tokens = nullptr, float *top_logprobs = nullptr, size_t top_capacity = 0);
+    // 请求未在执行时立即释放其 KV 缓存，正在执行时在当前这一步结束后释放。请求已结束时返回 false
+    bool cancel(uint64_t id);
+    // 等到有未取走的 token 或请求结束；timeout_ms < 0 表示不限时
+    RequestStatus wait(uint64_t id, int64_t timeout_ms = -1);
+    // 输入 token 与已生成的全部 token
+    std::vector<int64_t> tokens(uint64_t id);
+    // 请求正常结束的原因，未结束、取消或失败时为 None
+    StopReason stop_reason(uint64_t id);
+    // 丢弃请求记录；未结束的请求先取消，结束后自动丢弃
+    void release(uint64_t id);
+    // 取消所有请求并等待正在执行的一步结束，之后不再接受新请求
+    void shutdown();
+
+private:
+    struct Request;
+    using request_t = std::shared_ptr<Request>;
+    struct Conversation;
+    using conversation_t = std::shared_ptr<Conversation>;
+
+    void work();
+    // 执行打分 / 文本向量请求的一步并决定其去留；调用时 lock 未加锁，返回时已加锁
+    void score_step(const request_t &request, std::unique_lock<std::mutex> &lock);
+    void embed_step(const request_t &request, std::unique_lock<std::mutex> &lock);
+    uint64_t enqueue(const request_t &request);
+
+    static constexpr size_t kEmbedPackTokens = 2048;
+    request_t find(uint64_t id);
+    conversation_t find_session(uint64_t id);
+    // 以 status 结束请求并把会话交给工作线程释放，调用时持有 mutex_
+    void finish(Request &request, RequestStatus status);
+    // 会话放入 retired_ 并唤醒一个工作线程，slot 表示同时归还它占用的会话名额，调用时持有 mutex_
+    void retire(session_t session, bool slot);
+    // 从 ready_ 取出第一个可以执行的请求：需要新会话而名额已满的请求留在队列中。调用时持有 mutex_
+    request_t take_ready();
+    bool terminal(const Request &request) const;
+
+    model_t model_;
+    int64_t bos_token_id_;
+    // 同时存活的会话数上限（0 为不限）与已占用的名额，名额在会话释放后才归还
+    size_t max_sessions_;
+    size_t live_sessions_ = 0;
+
+    std::mutex mutex_;
+    // ready_cv_：有请求可以执行；changed_cv_：请求有新 token 或状态变化
+    std::condition_variable ready_cv_;
+    std::condition_variable changed_cv_;
+    std::unordered_map<uint64_t, request_t> requests_;
+    std::deque<request_t> ready_;
+    std::unordered_map<uint64_t, conversation_t> conversations_;
+    // 待工作线程释放的会话：释放 KV 缓存要用分配它的工作线程的上下文
+    std::vector<session_t> retired_;
+    size_t retired_slots_ = 0;
+    uint64_t next_id_ = 1;
+    uint64_t next_session_id_ = 1;
+    size_t stepping_ = 0;
+    bool closed_ = false;
+    bool stop_ = false;
+    std::vector<std::thread> workers_;
+};
+} // namespace llaisys::model
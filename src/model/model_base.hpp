@@ -28,6 +28,9 @@ struct DeviceSpec {
     std::vector<int> device_ids;
     int rank = 0;
     int world_size = 1;
+    // CPU 推理实际使用的 NUMA 节点与各节点计算线程数（加载权重时由运行时填写）
+    size_t numa_nodes = 1;
+    std::vector<size_t> threads_per_node;
 };
 // 并行规格：预留张量/流水/数据并行配置
 struct ParallelSpec {
@@ -35,10 +38,29 @@ struct ParallelSpec {
     size_t pipeline_parallel = 0;
     size_t data_parallel = 0;
 };
-// 一次推理请求输出：next_token 是本次生成的 token_id
+// 单步推理的选项：默认输出头只对最后一行做 final norm，并在 lm_head 的分块中直接选出 next_token，
+// 不生成 [seq, vocab] 的 logits；return_logits 为 true 时才计算完整 logits 并放入 InferenceOutputs::logits。
+// logprobs / top_logprobs 在同一输出头中顺带求 logsumexp 与前 top_logprobs 个候选，只把这几个数读回 host
+struct InferenceOptions {
+    bool return_logits = false;
+    bool logprobs = false;
+    size_t top_logprobs = 0;
+};
+// 一次推理请求输出：next_token 是本次生成的 token_id，logits 只在 InferenceOptions::return_logits 时给出；
+// logprob 为 next_token 的 log-softmax（要求 logprobs 或 top_logprobs 时），
+// top_tokens / top_logprobs 为概率最大的 top_logprobs 个候选，按概率从大到小
 struct InferenceOutputs {
     int64_t next_token = -1;
     tensor_t logits;
+    float logprob = 0.0f;
+    std::vector<int64_t> top_tokens;
+    std::vector<float> top_logprobs;
+};
+
+// 文本向量的池化方式：取每个序列最后一个 token，或对全部 token 求平均（均在 final norm 之后）
+enum class Pooling {
+    Last = 0,
+    Mean = 1,
 };
 
 // 权重映射：键为权重指针
@@ -51,7 +73,10 @@ public:
     virtual const std::vector<int64_t> &tokens() const = 0;
     virtual void append(int64_t next_token) = 0;
     virtual size_t seq_len() const = 0;
+    // 已写入 KV 缓存的 token 数：inferStep 只前向 tokens() 中此位置之后的部分，
+    // 因此在两次推理之间 append 的多个 token 会在下一步作为续接的 prefill 一起处理
     virtual size_t token_pos() const = 0;
+    virtual void set_token_pos(size_t pos) = 0;
     virtual CacheHandle_t cache() const = 0;
 };
 using session_t = std::shared_ptr<ModelSession>;
@@ -89,7 +114,19 @@ public:
     KVcache_t kv_cache() const { return _kv_cache; }
 
     // 推理入口：单轮推理（生成一个 token）
-    virtual InferenceOutputs inferStep(session_t session) = 0;
+    virtual InferenceOutputs inferStep(session_t session, const InferenceOptions &options = {}) = 0;
+    // 打分入口：对 session 的 token 序列分块 prefill，不生成 token，也不写出 [seq, vocab] 的 logits。
+    // 一次处理从 begin（之前各次返回的个数之和）起的一块位置，返回每个位置上下一个 token 的 log-prob，
+    // 即 log p(tokens[begin + i + 1] | tokens[0..begin + i])；tokens.size() - 1 个位置全部处理完后返回空
+    virtual std::vector<float> scoreStep(session_t session, size_t begin) = 0;
+    // 文本向量：inputs 的各序列首尾相接打包成一次前向，注意力不跨序列；不分配 KV 缓存、不经过 lm_head。
+    // 返回各序列池化后的隐状态，f32 [inputs.size(), hidden_size] 按行排列
+    virtual std::vector<float> embed(const std::vector<std::vector<int64_t>> &inputs, Pooling pooling) = 0;
+    // 释放推理时在当前线程上按需分配的缓冲（下次推理时重新分配）。
+    // 长期推理的线程（如 Engine 的工作线程）退出前调用：缓冲归属于线程的 core 上下文，不能在上下文销毁后才释放
+    virtual void releaseThreadState() {}
+    // 可同时存活的会话数上限，0 表示不限（只受内存限制）。Engine 据此让需要新会话的请求排队等待
+    virtual size_t maxSessions() const { return 0; }
     // 调试功能，打印模型信息
     virtual void show() = 0;
 
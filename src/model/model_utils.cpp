@@ -1,5 +1,6 @@
 #include "model_utils.hpp"
 
+#include <algorithm>
 #include <cctype>
 #include <fstream>
 #include <optional>
@@ -175,6 +176,66 @@ std::optional<std::string> get_architecture(const std::string &s) {
 }
 } // namespace
 namespace llaisys::model {
+llaisysDataType_t parse_kv_cache_dtype(const std::string &name) {
+    std::string lower = name;
+    for (auto &ch : lower) {
+        ch = static_cast<char>(std::tolower(static_cast<unsigned char>(ch)));
+    }
+    if (lower == "auto" || lower.empty()) {
+        return LLAISYS_DTYPE_INVALID;
+    }
+    if (lower == "int8" || lower == "i8") {
+        return LLAISYS_DTYPE_I8;
+    }
+    if (lower == "fp8" || lower == "f8" || lower == "fp8_e4m3" || lower == "float8_e4m3fn") {
+        return LLAISYS_DTYPE_F8;
+    }
+    // 拼写错误不能悄悄退回全精度缓存
+    throw std::runtime_error("unsupported kv_cache_dtype: " + name);
+}
+
+size_t layer_sliding_window(const meta_data &meta, size_t layer) {
+    if (!meta.use_sliding_window || meta.sliding_window == 0 || layer < meta.max_window_layers) {
+        return 0;
+    }
+    if (meta.sliding_window >= meta.max_position_embeddings) {
+        return 0;
+    }
+    return meta.sliding_window;
+}
+
+StopReason check_stop(const GenerationConfig &gen, const meta_data &meta, const std::vector<int64_t> &tokens,
+                      size_t generated) {
+    if (generated == 0) {
+        return StopReason::None;
+    }
+    const int64_t last = tokens.back();
+    if (gen.eos_token_ids.empty()) {
+        if (last == static_cast<int64_t>(meta.eos_token_id)) {
+            return StopReason::Eos;
+        }
+    } else if (std::find(gen.eos_token_ids.begin(), gen.eos_token_ids.end(), last) != gen.eos_token_ids.end()) {
+        return StopReason::Eos;
+    }
+    for (const auto &stop : gen.stop_sequences) {
+        if (!stop.empty() && stop.size() <= generated &&
+            std::equal(stop.rbegin(), stop.rend(), tokens.rbegin())) {
+            return StopReason::StopSequence;
+        }
+    }
+    if (generated >= gen.max_new_tokens) {
+        return StopReason::MaxNewTokens;
+    }
+    size_t max_length = gen.max_length;
+    if (meta.streaming_window == 0 && (max_length == 0 || max_length > meta.max_position_embeddings)) {
+        max_length = meta.max_position_embeddings;
+    }
+    if (max_length > 0 && tokens.size() >= max_length) {
+        return StopReason::MaxLength;
+    }
+    return StopReason::None;
+}
+
 llaisys::model::meta_data Model_Config::get_meta_data() const {
     return meta_data;
 }
@@ -246,6 +307,11 @@ void Model_Config::read_from_config(const std::string &config_path)
     meta_data.use_paged_attention =
         get_optional_bool(config_json, "use_paged_attention", true);
     meta_data.vocab_size = get_required_size_t(config_json, "vocab_size");
+    if (const auto kv_dtype = get_optional_string(config_json, "kv_cache_dtype")) {
+        meta_data.kv_cache_dtype = parse_kv_cache_dtype(*kv_dtype);
+    }
+    meta_data.attention_sink_tokens = get_optional_size_t(config_json, "attention_sink_tokens", size_t{4});
+    meta_data.streaming_window = get_optional_size_t(config_json, "streaming_window", size_t{0});
 }
 
 void Weight_buffer::add(const std::string &name, const Weights_t &weights) {
@@ -8,6 +8,7 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 namespace llaisys::model {
 typedef enum {
     LLAISYS_SILU = 0
@@ -41,7 +42,44 @@ struct meta_data {
     bool use_sliding_window;
     bool use_paged_attention = true;
     size_t vocab_size;
+    // KV-cache 存储精度：INVALID 表示与 torch_type 一致，I8/F8 表示量化存储
+    llaisysDataType_t kv_cache_dtype = LLAISYS_DTYPE_INVALID;
+    // StreamingLLM 注意力汇聚：streaming_window > 0 时每层只保留前 attention_sink_tokens 个 token
+    // 与最近 streaming_window 个 token，会话长度不再受 max_position_embeddings 限制
+    size_t attention_sink_tokens = 4;
+    size_t streaming_window = 0;
+    // 分页缓存可同时存活的会话数（不含单对话路径的默认请求），每个会话按 max_position_embeddings 预留页
+    size_t max_num_seqs = 4;
 };
+// 解析 kv_cache_dtype 配置（"auto"/"int8"/"fp8"），"auto" 返回 LLAISYS_DTYPE_INVALID（不量化），无法识别时抛出异常
+llaisysDataType_t parse_kv_cache_dtype(const std::string &name);
+// 第 layer 层的滑动窗口长度：use_sliding_window 且 layer >= max_window_layers 时为 sliding_window，
+// 否则（或窗口不小于最大上下文）返回 0 表示全量注意力
+size_t layer_sliding_window(const meta_data &meta, size_t layer);
+// 生成参数：每步生成后在 C++ 侧检查是否结束，命中的 eos / 停止序列保留在输出中
+struct GenerationConfig {
+    size_t max_new_tokens = 128;
+    // 输入加生成的总 token 数上限，0 表示只受模型上下文长度限制
+    size_t max_length = 0;
+    // 任一 id 出现即结束，为空时使用模型的 eos_token_id
+    std::vector<int64_t> eos_token_ids;
+    // 生成的 token 以其中任一序列结尾时结束（只匹配生成部分，不跨到输入）
+    std::vector<std::vector<int64_t>> stop_sequences;
+    // 每个生成的 token 附带其 log-prob，以及概率最大的 top_logprobs 个候选（top_logprobs > 0 时同样给出 log-prob）
+    bool logprobs = false;
+    size_t top_logprobs = 0;
+};
+enum class StopReason {
+    None = 0,
+    Eos,
+    StopSequence,
+    MaxNewTokens,
+    MaxLength,
+};
+// tokens 为输入加已生成的 token，其中最后 generated 个是生成的；
+// 未开启 streaming_window 时总长度不超过 max_position_embeddings
+StopReason check_stop(const GenerationConfig &gen, const meta_data &meta, const std::vector<int64_t> &tokens,
+                      size_t generated);
 // 从config解析模型参数
 class Model_Config {
 private:
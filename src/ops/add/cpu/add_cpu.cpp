@@ -1,18 +1,33 @@
 #include "add_cpu.hpp"
 
+#include "../../../device/cpu/cpu_convert.hpp"
+#include "../../../device/cpu/cpu_thread_pool.hpp"
 #include "../../../utils.hpp"
 
+#include <algorithm>
 #include <cmath>
 
 template <typename T>
 void add_(T *c, const T *a, const T *b, size_t numel) {
-    for (size_t i = 0; i < numel; i++) {
+    llaisys::device::cpu::parallel_for(0, numel, 1 << 14, [&](size_t begin, size_t end) {
         if constexpr (std::is_same_v<T, llaisys::bf16_t> || std::is_same_v<T, llaisys::fp16_t>) {
-            c[i] = llaisys::utils::cast<T>(llaisys::utils::cast<float>(a[i]) + llaisys::utils::cast<float>(b[i]));
+            constexpr size_t kTile = 256;
+            float x[kTile], y[kTile];
+            for (size_t base = begin; base < end; base += kTile) {
+                size_t len = std::min(kTile, end - base);
+                llaisys::device::cpu::to_f32(x, a + base, len);
+                llaisys::device::cpu::to_f32(y, b + base, len);
+                for (size_t l = 0; l < len; l++) {
+                    x[l] += y[l];
+                }
+                llaisys::device::cpu::from_f32(c + base, x, len);
+            }
         } else {
-            c[i] = a[i] + b[i];
+            for (size_t i = begin; i < end; i++) {
+                c[i] = a[i] + b[i];
+            }
         }
-    }
+    });
 }
 
 namespace llaisys::ops::cpu {
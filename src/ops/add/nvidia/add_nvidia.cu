@@ -53,7 +53,6 @@ void add_(tensor_t c, tensor_t a, tensor_t b) {
     auto &runtime = llaisys::core::context().runtime();
     auto stream = reinterpret_cast<cudaStream_t>(runtime.stream());
     add_kernel<T><<<num_blocks, block_size, 0, stream>>>(c_ptr, a_ptr, b_ptr, c->numel());
-    runtime.api()->stream_synchronize(runtime.stream());
 }
 
 void add_fp16(tensor_t c, tensor_t a, tensor_t b) {
@@ -65,7 +64,6 @@ void add_fp16(tensor_t c, tensor_t a, tensor_t b) {
     auto &runtime = llaisys::core::context().runtime();
     auto stream = reinterpret_cast<cudaStream_t>(runtime.stream());
     add_kernel_fp16<<<num_blocks, block_size, 0, stream>>>(c_ptr, a_ptr, b_ptr, c->numel());
-    runtime.api()->stream_synchronize(runtime.stream());
 }
 
 void add_bf16(tensor_t c, tensor_t a, tensor_t b) {
@@ -77,7 +75,6 @@ void add_bf16(tensor_t c, tensor_t a, tensor_t b) {
     auto &runtime = llaisys::core::context().runtime();
     auto stream = reinterpret_cast<cudaStream_t>(runtime.stream());
     add_kernel_bf16<<<num_blocks, block_size, 0, stream>>>(c_ptr, a_ptr, b_ptr, c->numel());
-    runtime.api()->stream_synchronize(runtime.stream());
 }
 void add_cublas_fp16(tensor_t c, tensor_t a, tensor_t b) {
     CHECK_SAME_DEVICE(c, a, b);
@@ -106,8 +103,6 @@ void add_cublas_fp16(tensor_t c, tensor_t a, tensor_t b) {
                           c_ptr, CUDA_R_16F, 1,
                           CUDA_R_32F);
     ASSERT(status == CUBLAS_STATUS_SUCCESS, "add_cublas_fp16: cublasAxpyEx failed");
-    auto api = runtime.api();
-    api->stream_synchronize(stream);
 }
 void add_cublas_fp32(tensor_t c, tensor_t a, tensor_t b) {
     CHECK_SAME_DEVICE(c, a, b);
@@ -136,8 +131,6 @@ void add_cublas_fp32(tensor_t c, tensor_t a, tensor_t b) {
                           c_ptr, CUDA_R_32F, 1,
                           CUDA_R_32F);
     ASSERT(status == CUBLAS_STATUS_SUCCESS, "add_cublas_fp32: cublasAxpyEx failed");
-    auto api = runtime.api();
-    api->stream_synchronize(stream);
 }
 void add_cublas_bf16(tensor_t c, tensor_t a, tensor_t b) {
     CHECK_SAME_DEVICE(c, a, b);
@@ -166,8 +159,6 @@ void add_cublas_bf16(tensor_t c, tensor_t a, tensor_t b) {
                           c_ptr, CUDA_R_16BF, 1,
                           CUDA_R_32F);
     ASSERT(status == CUBLAS_STATUS_SUCCESS, "add_cublas_bf16: cublasAxpyEx failed");
-    auto api = runtime.api();
-    api->stream_synchronize(stream);
 }
 // 不拷贝的版本：直接在 b 上做 b = alpha*a + b，然后 swap c 和 b 的存储
 // 调用后 b 的原始数据被破坏，c 持有结果
@@ -192,9 +183,6 @@ void add_cublas_bf16_nocpy(tensor_t c, tensor_t a, tensor_t b) {
                           CUDA_R_32F);
     ASSERT(status == CUBLAS_STATUS_SUCCESS, "add_cublas_bf16_nocpy: cublasAxpyEx failed");
 
-    auto api = runtime.api();
-    api->stream_synchronize(stream);
-
     c->swapStorage(*b);
 }
 void add_cublas_fp32_nocpy(tensor_t c, tensor_t a, tensor_t b) {
@@ -218,9 +206,6 @@ void add_cublas_fp32_nocpy(tensor_t c, tensor_t a, tensor_t b) {
                           CUDA_R_32F);
     ASSERT(status == CUBLAS_STATUS_SUCCESS, "add_cublas_bf16_nocpy: cublasAxpyEx failed");
 
-    auto api = runtime.api();
-    api->stream_synchronize(stream);
-
     c->swapStorage(*b);
 }
 void add_cublas_fp16_nocpy(tensor_t c, tensor_t a, tensor_t b) {
@@ -244,9 +229,6 @@ void add_cublas_fp16_nocpy(tensor_t c, tensor_t a, tensor_t b) {
                           CUDA_R_32F);
     ASSERT(status == CUBLAS_STATUS_SUCCESS, "add_cublas_fp16_nocpy: cublasAxpyEx failed");
 
-    auto api = runtime.api();
-    api->stream_synchronize(stream);
-
     c->swapStorage(*b);
 }
 // 模板分发接口
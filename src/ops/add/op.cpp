@@ -1,4 +1,5 @@
 #include "op.hpp"
+#include "../../device/cpu/cpu_launch.hpp"
 
 #include "../../utils.hpp"
 
@@ -16,7 +17,9 @@ void add(tensor_t c, tensor_t a, tensor_t b) {
     ASSERT(c->isContiguous() && a->isContiguous() && b->isContiguous(), "Add: all tensors must be contiguous.");
 
     if (c->deviceType() == LLAISYS_DEVICE_CPU) {
-        return cpu::add(c->data(), a->data(), b->data(), c->dtype(), c->numel());
+        return device::cpu::launch([=] {
+            cpu::add(c->data(), a->data(), b->data(), c->dtype(), c->numel());
+        });
     }
 #ifdef ENABLE_NVIDIA_API
     if (c->deviceType() == LLAISYS_DEVICE_NVIDIA) {
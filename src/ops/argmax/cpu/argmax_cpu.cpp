@@ -1,52 +1,106 @@
 #include "argmax_cpu.hpp"
 
+#include "../../../device/cpu/cpu_convert.hpp"
+#include "../../../device/cpu/cpu_kernels.hpp"
+#include "../../../device/cpu/cpu_thread_pool.hpp"
 #include "../../../utils.hpp"
 
-#include <cmath>
-// 模板化argmax
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace {
+// 每次转换 kTile 个元素到 f32 再交给 SIMD 内核；一行至少 kMinBlock 个元素才拆给多个线程
+constexpr size_t kTile = 1024;
+constexpr size_t kMinBlock = 16384;
+
+struct Best {
+    size_t idx;
+    float val;
+};
+
 template <typename T>
-void argmax_(size_t *max_idx, T *max_val, const T *vals, size_t numel, size_t stride) {
-    ASSERT(numel > 0 && stride > 0, "Argmax: numel and stride must be greater than 0");
-    *max_val = vals[0];
-    *max_idx = 0;
-    for (size_t i = stride; i < numel; i += stride) {
-        if constexpr (std::is_same_v<T, llaisys::bf16_t>
-                      || std::is_same_v<T, llaisys::fp16_t>) {
-            if (llaisys::utils::cast<float>(vals[i]) > llaisys::utils::cast<float>(*max_val)) {
-                *max_val = vals[i];
-                *max_idx = i;
+const float *tile_f32(float *buf, const T *src, size_t n, ptrdiff_t stride) {
+    if constexpr (std::is_same_v<T, float>) {
+        if (stride == 1) {
+            return src;
+        }
+    }
+    if (stride == 1) {
+        llaisys::device::cpu::to_f32(buf, src, n);
+    } else {
+        for (size_t l = 0; l < n; l++) {
+            buf[l] = llaisys::utils::cast<float>(src[static_cast<ptrdiff_t>(l) * stride]);
+        }
+    }
+    return buf;
+}
+
+// 每行切成 blocks 块，rows × blocks 个块并行求局部最大值，再按块序合并；
+// 只在严格更大时替换，保持取第一个最大值的语义
+template <typename T>
+void argmax_(int64_t *max_idx, T *max_val, const T *vals, size_t rows, size_t n,
+             ptrdiff_t row_stride, ptrdiff_t col_stride) {
+    const size_t threads = llaisys::device::cpu::ThreadPool::instance().size();
+    const size_t blocks = std::clamp<size_t>((threads + rows - 1) / rows, 1, std::max<size_t>(1, n / kMinBlock));
+    const size_t step = (n + blocks - 1) / blocks;
+    std::vector<Best> partial(rows * blocks);
+    llaisys::device::cpu::parallel_for(0, rows * blocks, 1, [&](size_t begin, size_t end) {
+        std::vector<float> buf(kTile);
+        for (size_t task = begin; task < end; task++) {
+            const T *row = vals + static_cast<ptrdiff_t>(task / blocks) * row_stride;
+            const size_t first = (task % blocks) * step;
+            const size_t last = std::min(n, first + step);
+            Best best{first, -std::numeric_limits<float>::infinity()};
+            for (size_t t = first; t < last; t += kTile) {
+                const size_t len = std::min(kTile, last - t);
+                float v;
+                size_t i = llaisys::device::cpu::argmax(
+                    tile_f32(buf.data(), row + static_cast<ptrdiff_t>(t) * col_stride, len, col_stride), len, &v);
+                if (v > best.val) {
+                    best = {t + i, v};
+                }
             }
-        } else {
-            if (vals[i] > *max_val) {
-                *max_val = vals[i];
-                *max_idx = i;
+            partial[task] = best;
+        }
+    });
+    for (size_t r = 0; r < rows; r++) {
+        Best best = partial[r * blocks];
+        for (size_t b = 1; b < blocks; b++) {
+            if (partial[r * blocks + b].val > best.val) {
+                best = partial[r * blocks + b];
             }
         }
+        max_idx[r] = static_cast<int64_t>(best.idx);
+        max_val[r] = vals[static_cast<ptrdiff_t>(r) * row_stride + static_cast<ptrdiff_t>(best.idx) * col_stride];
     }
 }
+} // namespace
+
 namespace llaisys::ops::cpu {
 void argmax(std::byte *max_idx, std::byte *max_val, const std::byte *vals,
-            size_t numel, size_t stride, llaisysDataType_t type) {
+            size_t rows, size_t n, ptrdiff_t row_stride, ptrdiff_t col_stride, llaisysDataType_t type) {
     switch (type) {
-
     case LLAISYS_DTYPE_F32:
-        return argmax_(reinterpret_cast<size_t *>(max_idx),
+        return argmax_(reinterpret_cast<int64_t *>(max_idx),
                        reinterpret_cast<float *>(max_val),
                        reinterpret_cast<const float *>(vals),
-                       numel, stride);
+                       rows, n, row_stride, col_stride);
     case LLAISYS_DTYPE_BF16:
-        return argmax_(reinterpret_cast<size_t *>(max_idx),
+        return argmax_(reinterpret_cast<int64_t *>(max_idx),
                        reinterpret_cast<llaisys::bf16_t *>(max_val),
                        reinterpret_cast<const llaisys::bf16_t *>(vals),
-                       numel, stride);
+                       rows, n, row_stride, col_stride);
     case LLAISYS_DTYPE_F16:
-        return argmax_(reinterpret_cast<size_t *>(max_idx),
+        return argmax_(reinterpret_cast<int64_t *>(max_idx),
                        reinterpret_cast<llaisys::fp16_t *>(max_val),
                        reinterpret_cast<const llaisys::fp16_t *>(vals),
-                       numel, stride);
+                       rows, n, row_stride, col_stride);
     default:
         EXCEPTION_UNSUPPORTED_DATATYPE(type);
     }
 }
 
-} // namespace llaisys::ops::cpu
\ No newline at end of file
+} // namespace llaisys::ops::cpu
@@ -4,6 +4,8 @@
 #include <cstddef>
 
 namespace llaisys::ops::cpu {
+// vals 为 rows 行、每行 n 个元素（行步长 row_stride、列步长 col_stride），
+// 第 r 行第一个最大值的下标（行内逻辑下标）和值分别写入 max_idx[r]、max_val[r]
 void argmax(std::byte *max_idx, std::byte *max_val, const std::byte *vals,
-            size_t numel, size_t stride, llaisysDataType_t type);
-}
\ No newline at end of file
+            size_t rows, size_t n, ptrdiff_t row_stride, ptrdiff_t col_stride, llaisysDataType_t type);
+}
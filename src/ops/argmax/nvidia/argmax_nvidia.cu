@@ -2,10 +2,13 @@
 
 #include "../../../core/llaisys_core.hpp"
 #include "../../../utils.hpp"
-#include <thrust/device_vector.h>
-#include <thrust/execution_policy.h>
-#include <thrust/extrema.h>
+
+#include <cstdint>
+#include <math_constants.h>
+
 namespace llaisys::ops::nvidia {
+namespace {
+constexpr int kThreads = 256;
 
 template <typename T>
 __device__ float to_float_val(T val);
@@ -19,104 +22,92 @@ __device__ float to_float_val<__half>(__half val) { return __half2float(val); }
 template <>
 __device__ float to_float_val<__nv_bfloat16>(__nv_bfloat16 val) { return __bfloat162float(val); }
 
-// 单 block 归约：每个线程先用 stride 循环找到自己负责的局部最大值，
-// 然后在 shared memory 中做树形归约得到全局 argmax
-template <typename T>
-__global__ void argmax_kernel(size_t *max_idx, T *max_val, const T *vals, size_t numel) {
-    extern __shared__ char smem[];
-    float *s_val = reinterpret_cast<float *>(smem);
-    size_t *s_idx = reinterpret_cast<size_t *>(smem + blockDim.x * sizeof(float));
-
-    unsigned int tid = threadIdx.x;
+// (值大, 下标小) 者优先：归约顺序不影响结果，与 CPU 一样取第一个最大值。
+// NaN 按 -inf 处理，没有大于 -inf 的元素时结果为下标 0
+__device__ __forceinline__ bool better(float v, int64_t i, float best_v, int64_t best_i) {
+    return v > best_v || (v == best_v && i < best_i);
+}
 
-    float local_max = to_float_val(vals[0]);
-    size_t local_idx = 0;
-    for (size_t i = tid; i < numel; i += blockDim.x) {
-        float v = to_float_val(vals[i]);
-        if (v > local_max) {
-            local_max = v;
-            local_idx = i;
+// 每个 block 处理一行：线程按步长扫描得到局部最大值，再在 warp 内、warp 间归约
+template <typename T>
+__global__ void argmax_kernel(int64_t *max_idx, T *max_val, const T *vals, size_t n,
+                              ptrdiff_t row_stride, ptrdiff_t col_stride) {
+    __shared__ float s_val[32];
+    __shared__ int64_t s_idx[32];
+    const T *row = vals + static_cast<ptrdiff_t>(blockIdx.x) * row_stride;
+
+    float best_v = -CUDART_INF_F;
+    int64_t best_i = 0;
+    for (size_t i = threadIdx.x; i < n; i += blockDim.x) {
+        float v = to_float_val(row[static_cast<ptrdiff_t>(i) * col_stride]);
+        v = isnan(v) ? -CUDART_INF_F : v;
+        if (better(v, static_cast<int64_t>(i), best_v, best_i)) {
+            best_v = v;
+            best_i = static_cast<int64_t>(i);
         }
     }
-
-    s_val[tid] = local_max;
-    s_idx[tid] = local_idx;
+    for (int offset = 16; offset > 0; offset >>= 1) {
+        float v = __shfl_down_sync(0xffffffff, best_v, offset);
+        int64_t i = __shfl_down_sync(0xffffffff, best_i, offset);
+        if (better(v, i, best_v, best_i)) {
+            best_v = v;
+            best_i = i;
+        }
+    }
+    const int lane = threadIdx.x & 31;
+    const int wid = threadIdx.x >> 5;
+    if (lane == 0) {
+        s_val[wid] = best_v;
+        s_idx[wid] = best_i;
+    }
     __syncthreads();
-
-    for (unsigned int s = blockDim.x / 2; s > 0; s >>= 1) {
-        if (tid < s) {
-            if (s_val[tid + s] > s_val[tid]) {
-                s_val[tid] = s_val[tid + s];
-                s_idx[tid] = s_idx[tid + s];
+    if (wid == 0) {
+        const int warps = (blockDim.x + 31) / 32;
+        best_v = lane < warps ? s_val[lane] : -CUDART_INF_F;
+        best_i = lane < warps ? s_idx[lane] : INT64_MAX;
+        for (int offset = 16; offset > 0; offset >>= 1) {
+            float v = __shfl_down_sync(0xffffffff, best_v, offset);
+            int64_t i = __shfl_down_sync(0xffffffff, best_i, offset);
+            if (better(v, i, best_v, best_i)) {
+                best_v = v;
+                best_i = i;
             }
         }
-        __syncthreads();
-    }
-
-    if (tid == 0) {
-        *max_val = vals[s_idx[0]];
-        *max_idx = s_idx[0];
+        if (lane == 0) {
+            max_idx[blockIdx.x] = best_i;
+            max_val[blockIdx.x] = row[static_cast<ptrdiff_t>(best_i) * col_stride];
+        }
     }
 }
 
 template <typename T>
-void argmax_thrust(tensor_t max_idx, tensor_t max_val, tensor_t vals){
-    ASSERT(vals->numel() > 0, "Argmax: vals must contain at least one element");
-    auto &runtime = llaisys::core::context().runtime();
-    auto stream = reinterpret_cast<cudaStream_t>(runtime.stream());
-
-    auto *vals_ptr = reinterpret_cast<const T *>(vals->data());
-    auto *max_val_ptr = reinterpret_cast<T *>(max_val->data());
-    auto *max_idx_ptr = reinterpret_cast<size_t *>(max_idx->data());
-
-    auto begin = thrust::device_pointer_cast(vals_ptr);
-    auto end = begin + vals->numel();
-
-    auto max_it = thrust::max_element(thrust::cuda::par.on(stream), begin, end);
-    size_t idx = static_cast<size_t>(max_it - begin);
-
-    runtime.api()->memcpy_async(
-        max_val_ptr,
-        thrust::raw_pointer_cast(max_it),
-        sizeof(T),
-        LLAISYS_MEMCPY_D2D,
-        runtime.stream());
-    // idx is a host stack variable; use sync copy to avoid async lifetime hazards.
-    runtime.api()->memcpy_sync(
-        max_idx_ptr,
-        &idx,
-        sizeof(size_t),
-        LLAISYS_MEMCPY_H2D);
+void argmax_rows(tensor_t max_idx, tensor_t max_val, tensor_t vals, cudaStream_t stream) {
+    const size_t rows = vals->ndim() == 2 ? vals->shape()[0] : 1;
+    const ptrdiff_t row_stride = vals->ndim() == 2 ? vals->strides()[0] : 0;
+    argmax_kernel<T><<<static_cast<unsigned int>(rows), kThreads, 0, stream>>>(
+        reinterpret_cast<int64_t *>(max_idx->data()),
+        reinterpret_cast<T *>(max_val->data()),
+        reinterpret_cast<const T *>(vals->data()),
+        vals->shape().back(),
+        row_stride,
+        vals->strides().back());
 }
+} // namespace
+
+// 形状检查在 ops::argmax 中完成；结果直接写在设备上，不需要与主机同步
 void argmax(tensor_t max_idx, tensor_t max_val, tensor_t vals) {
-    CHECK_SAME_DEVICE(max_idx, max_val, vals);
-    CHECK_SAME_DTYPE(max_val->dtype(), vals->dtype());
-    ASSERT(max_idx->ndim() == 1 && max_val->ndim() == 1 && vals->ndim() == 1,
-           "Argmax: max_idx, max_val and vals must be 1D tensors");
-    ASSERT(max_idx->shape()[0] == 1 && max_val->shape()[0] == 1,
-           "Argmax: max_idx and max_val must be 1D tensors with a single element");
-    ASSERT(max_idx->dtype() == LLAISYS_DTYPE_I64,
-           "Argmax: Data Type of max_idx must be LLAISYS_DTYPE_I64");
-    ASSERT(max_idx->deviceId() == max_val->deviceId() && max_idx->deviceId() == vals->deviceId(),
-           "Argmax: device_id of max_idx, max_val and vals must be the same");
     llaisys::core::context().setDevice(LLAISYS_DEVICE_NVIDIA, max_idx->deviceId());
+    auto stream = reinterpret_cast<cudaStream_t>(llaisys::core::context().runtime().stream());
 
     switch (vals->dtype()) {
     case LLAISYS_DTYPE_F32:
-        argmax_thrust<float>(max_idx, max_val, vals);
-        break;
+        return argmax_rows<float>(max_idx, max_val, vals, stream);
     case LLAISYS_DTYPE_BF16:
-        argmax_thrust<__nv_bfloat16>(max_idx, max_val, vals);
-        break;
+        return argmax_rows<__nv_bfloat16>(max_idx, max_val, vals, stream);
     case LLAISYS_DTYPE_F16:
-        argmax_thrust<__half>(max_idx, max_val, vals);
-        break;
+        return argmax_rows<__half>(max_idx, max_val, vals, stream);
     default:
         EXCEPTION_UNSUPPORTED_DATATYPE(vals->dtype());
     }
-
-    auto &runtime = llaisys::core::context().runtime();
-    auto stream = runtime.stream();
-    runtime.api()->stream_synchronize(stream);
 }
 } // namespace llaisys::ops::nvidia
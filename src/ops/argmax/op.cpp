@@ -1,4 +1,5 @@
 #include "op.hpp"
+#include "../../device/cpu/cpu_launch.hpp"
 
 #include "cpu/argmax_cpu.hpp"
 #ifdef ENABLE_NVIDIA_API
@@ -9,21 +10,33 @@ namespace llaisys::ops {
 void argmax(tensor_t max_idx, tensor_t max_val, tensor_t vals) {
     CHECK_SAME_DEVICE(max_idx, max_val, vals);
     CHECK_SAME_DTYPE(max_val->dtype(), vals->dtype());
-    ASSERT(max_idx->ndim() == 1 && max_val->ndim() == 1 && vals->ndim() == 1,
-           "Argmax: max_idx, max_val and vals must be 1D tensors");
-    ASSERT(max_idx->shape()[0] == 1 && max_val->shape()[0] == 1,
-           "Argmax: max_idx and max_val must be 1D tensors with a single element");
-    // std::cout << "dtype of max_idx is" << max_idx->dtype() << std::endl;
+    // vals 为 [n]（max_idx、max_val 为 [1]）或按行求最大值的 [rows, n]（max_idx、max_val 为 [rows]）
+    ASSERT(vals->ndim() == 1 || vals->ndim() == 2, "Argmax: vals must be a 1D or 2D tensor");
+    const size_t rows = vals->ndim() == 2 ? vals->shape()[0] : 1;
+    const size_t n = vals->shape().back();
+    ASSERT(n > 0, "Argmax: vals must contain at least one element per row");
+    ASSERT(max_idx->ndim() == 1 && max_val->ndim() == 1,
+           "Argmax: max_idx and max_val must be 1D tensors");
+    ASSERT(max_idx->shape()[0] == rows && max_val->shape()[0] == rows,
+           "Argmax: max_idx and max_val must have one element per row of vals");
+    ASSERT(max_idx->isContiguous() && max_val->isContiguous(),
+           "Argmax: max_idx and max_val must be contiguous");
     ASSERT(max_idx->dtype() == LLAISYS_DTYPE_I64,
            "Argmax:Data Type of max_idx must be LLAISYS_DTYPE_I64");
 
     if (vals->deviceType() == LLAISYS_DEVICE_CPU) {
-        return cpu::argmax(max_idx->data(),
-                           max_val->data(),
-                           vals->data(),
-                           vals->numel(),
-                           static_cast<size_t>(vals->strides()[0]),
-                           vals->dtype());
+        const ptrdiff_t row_stride = vals->ndim() == 2 ? vals->strides()[0] : 0;
+        const ptrdiff_t col_stride = vals->strides().back();
+        return device::cpu::launch([=] {
+            cpu::argmax(max_idx->data(),
+                        max_val->data(),
+                        vals->data(),
+                        rows,
+                        n,
+                        row_stride,
+                        col_stride,
+                        vals->dtype());
+        });
     }
 #ifdef ENABLE_NVIDIA_API
     if (vals->deviceType() == LLAISYS_DEVICE_NVIDIA) {
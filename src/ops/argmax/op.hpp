@@ -3,5 +3,7 @@
 #include "../../tensor/tensor.hpp"
 
 namespace llaisys::ops {
+// vals 为 [n] 时 max_idx、max_val 为 [1]；vals 为 [rows, n] 时按行求，max_idx、max_val 为 [rows]。
+// 下标为行内的逻辑下标（I64），相同的最大值取第一个，NaN 不参与比较
 void argmax(tensor_t max_idx, tensor_t max_val, tensor_t vals);
 }
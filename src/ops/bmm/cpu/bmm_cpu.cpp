@@ -0,0 +1,139 @@
+#include "bmm_cpu.hpp"
+#include "../../../device/cpu/cpu_convert.hpp"
+#include "../../../device/cpu/cpu_kernels.hpp"
+#include "../../../device/cpu/cpu_thread_pool.hpp"
+#include "../../../utils.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace {
+// 每个任务计算 c 的 kRowBlock 行；每次取 kColBlock 行 op(b) 供这些行复用，使其留在缓存中
+constexpr size_t kRowBlock = 16;
+constexpr size_t kColBlock = 64;
+constexpr size_t kGrainMacs = 1 << 15;
+
+// (batch, row, col) 三个方向的步长，col 为 k 方向（op(a) 的列、op(b)ᵀ 的列）或 c 的列
+using strides3 = std::array<ptrdiff_t, 3>;
+
+template <typename T>
+const T *at(const T *base, const strides3 &s, size_t batch, size_t row) {
+    return base + static_cast<ptrdiff_t>(batch) * s[0] + static_cast<ptrdiff_t>(row) * s[1];
+}
+
+// 长度为 n、步长为 stride 的一行以 f32 连续形式给出：f32 且连续时直接返回原数据，否则转换到 buf
+template <typename T>
+const float *row_f32(float *buf, const T *src, size_t n, ptrdiff_t stride) {
+    if constexpr (std::is_same_v<T, float>) {
+        if (stride == 1) {
+            return src;
+        }
+    }
+    if (stride == 1) {
+        llaisys::device::cpu::to_f32(buf, src, n);
+    } else {
+        for (size_t l = 0; l < n; l++) {
+            buf[l] = llaisys::utils::cast<float>(src[static_cast<ptrdiff_t>(l) * stride]);
+        }
+    }
+    return buf;
+}
+
+// as：op(a) 的 (batch, i, l) 步长；bs：op(b)ᵀ 的 (batch, j, l) 步长；cs：c 的 (batch, i, j) 步长
+template <typename T>
+void bmm_(T *c, const T *a, const T *b, size_t batch, size_t group, size_t m, size_t n, size_t k,
+          const strides3 &as, const strides3 &bs, const strides3 &cs, float alpha, float beta) {
+    const size_t b_batches = batch / group;
+    // op(b) 的每一行（j 固定、沿 k）先整理成连续的 f32，同一 kv batch 的 group 个 batch 共用
+    const bool direct_b = std::is_same_v<T, float> && bs[2] == 1;
+    std::vector<float> packed_b(direct_b ? 0 : b_batches * n * k);
+    if (!direct_b) {
+        llaisys::device::cpu::parallel_for(0, b_batches * n, std::max<size_t>(1, 8192 / std::max<size_t>(k, 1)),
+                                           [&](size_t begin, size_t end) {
+            for (size_t r = begin; r < end; r++) {
+                float *dst = packed_b.data() + r * k;
+                const float *row = row_f32(dst, at(b, bs, r / n, r % n), k, bs[2]);
+                if (row != dst) {
+                    std::copy_n(row, k, dst);
+                }
+            }
+        });
+    }
+    auto b_row = [&](size_t bb, size_t j) -> const float * {
+        if (direct_b) {
+            return reinterpret_cast<const float *>(at(b, bs, bb, j));
+        }
+        return packed_b.data() + (bb * n + j) * k;
+    };
+
+    const size_t m_blocks = (m + kRowBlock - 1) / kRowBlock;
+    llaisys::device::cpu::parallel_for(0, batch * m_blocks, std::max<size_t>(1, kGrainMacs / std::max<size_t>(kRowBlock * n * k, 1)),
+                                       [&](size_t begin, size_t end) {
+        std::vector<float> a_buf(kRowBlock * k);
+        std::array<const float *, kRowBlock> a_rows{};
+        for (size_t task = begin; task < end; task++) {
+            const size_t bi = task / m_blocks;
+            const size_t i0 = (task % m_blocks) * kRowBlock;
+            const size_t rows = std::min(kRowBlock, m - i0);
+            const size_t bb = bi / group;
+            for (size_t r = 0; r < rows; r++) {
+                a_rows[r] = row_f32(a_buf.data() + r * k, at(a, as, bi, i0 + r), k, as[2]);
+            }
+            for (size_t j0 = 0; j0 < n; j0 += kColBlock) {
+                const size_t j1 = std::min(n, j0 + kColBlock);
+                for (size_t r = 0; r < rows; r++) {
+                    T *c_row = c + static_cast<ptrdiff_t>(bi) * cs[0] + static_cast<ptrdiff_t>(i0 + r) * cs[1];
+                    for (size_t j = j0; j < j1; j++) {
+                        T *dst = c_row + static_cast<ptrdiff_t>(j) * cs[2];
+                        float v = alpha * llaisys::device::cpu::dot(a_rows[r], b_row(bb, j), k);
+                        if (beta != 0.0f) {
+                            v += beta * llaisys::utils::cast<float>(*dst);
+                        }
+                        *dst = llaisys::utils::cast<T>(v);
+                    }
+                }
+            }
+        }
+    });
+}
+} // namespace
+
+namespace llaisys::ops::cpu {
+void bmm(tensor_t c, tensor_t a, tensor_t b, bool trans_a, bool trans_b, float alpha, float beta) {
+    const auto &sa = a->strides();
+    const auto &sb = b->strides();
+    const auto &sc = c->strides();
+    const size_t batch = c->shape()[0];
+    const size_t m = c->shape()[1];
+    const size_t n = c->shape()[2];
+    const size_t k = trans_a ? a->shape()[1] : a->shape()[2];
+    const size_t group = batch / b->shape()[0];
+    // 转置只是交换行、列两个方向的步长
+    const strides3 as = {sa[0], trans_a ? sa[2] : sa[1], trans_a ? sa[1] : sa[2]};
+    const strides3 bs = {sb[0], trans_b ? sb[1] : sb[2], trans_b ? sb[2] : sb[1]};
+    const strides3 cs = {sc[0], sc[1], sc[2]};
+
+    switch (c->dtype()) {
+    case LLAISYS_DTYPE_F32:
+        return bmm_(reinterpret_cast<float *>(c->data()),
+                    reinterpret_cast<const float *>(a->data()),
+                    reinterpret_cast<const float *>(b->data()),
+                    batch, group, m, n, k, as, bs, cs, alpha, beta);
+    case LLAISYS_DTYPE_BF16:
+        return bmm_(reinterpret_cast<llaisys::bf16_t *>(c->data()),
+                    reinterpret_cast<const llaisys::bf16_t *>(a->data()),
+                    reinterpret_cast<const llaisys::bf16_t *>(b->data()),
+                    batch, group, m, n, k, as, bs, cs, alpha, beta);
+    case LLAISYS_DTYPE_F16:
+        return bmm_(reinterpret_cast<llaisys::fp16_t *>(c->data()),
+                    reinterpret_cast<const llaisys::fp16_t *>(a->data()),
+                    reinterpret_cast<const llaisys::fp16_t *>(b->data()),
+                    batch, group, m, n, k, as, bs, cs, alpha, beta);
+    default:
+        EXCEPTION_UNSUPPORTED_DATATYPE(c->dtype());
+    }
+}
+} // namespace llaisys::ops::cpu
@@ -0,0 +1,7 @@
+#pragma once
+
+#include "../../../tensor/tensor.hpp"
+
+namespace llaisys::ops::cpu {
+void bmm(tensor_t c, tensor_t a, tensor_t b, bool trans_a, bool trans_b, float alpha, float beta);
+}
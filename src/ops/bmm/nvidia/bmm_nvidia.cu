@@ -0,0 +1,69 @@
+#include "bmm_nvidia.cuh"
+
+#include "../../../core/llaisys_core.hpp"
+#include "../../../device/nvidia/nvidia_resource.cuh"
+#include "../../../utils.hpp"
+
+#include <cublas_v2.h>
+#include <cuda_runtime.h>
+
+namespace llaisys::ops::nvidia {
+namespace {
+cudaDataType_t cuda_type(llaisysDataType_t dtype) {
+    switch (dtype) {
+    case LLAISYS_DTYPE_F32:
+        return CUDA_R_32F;
+    case LLAISYS_DTYPE_F16:
+        return CUDA_R_16F;
+    case LLAISYS_DTYPE_BF16:
+        return CUDA_R_16BF;
+    default:
+        EXCEPTION_UNSUPPORTED_DATATYPE(dtype);
+    }
+}
+} // namespace
+
+// 行主序的 c = op(a) · op(b) 等价于列主序的 cᵀ = op(b)ᵀ · op(a)ᵀ：三者按列主序看作 [列, 行]、ld 为行步长。
+// b 的 batch 被 group 个相邻的 a batch 共用：按 batch 内偏移 g 分成 group 次 strided batched GEMM
+void bmm(tensor_t c, tensor_t a, tensor_t b, bool trans_a, bool trans_b, float alpha, float beta) {
+    llaisys::core::context().setDevice(LLAISYS_DEVICE_NVIDIA, c->deviceId());
+    ASSERT(a->strides()[2] == 1 && b->strides()[2] == 1 && c->strides()[2] == 1,
+           "Bmm(NVIDIA): the last dimension of a, b and c must be contiguous");
+    auto &runtime = llaisys::core::context().runtime();
+    auto &res = llaisys::device::nvidia::getResource(c->deviceId());
+    res.setStream(runtime.stream());
+    cublasHandle_t handle = res.opContext().cublas_handle;
+    cublasStatus_t status = cublasSetPointerMode(handle, CUBLAS_POINTER_MODE_HOST);
+    ASSERT(status == CUBLAS_STATUS_SUCCESS, "Bmm(NVIDIA): cublasSetPointerMode failed");
+
+    const cudaDataType_t type = cuda_type(c->dtype());
+    const size_t elem = c->elementSize();
+    const int m = static_cast<int>(c->shape()[1]);
+    const int n = static_cast<int>(c->shape()[2]);
+    const int k = static_cast<int>(trans_a ? a->shape()[1] : a->shape()[2]);
+    const size_t b_batches = b->shape()[0];
+    const size_t group = c->shape()[0] / b_batches;
+    const auto &sa = a->strides();
+    const auto &sb = b->strides();
+    const auto &sc = c->strides();
+
+    for (size_t g = 0; g < group; ++g) {
+        const auto *a_ptr = reinterpret_cast<const char *>(a->data()) + static_cast<ptrdiff_t>(g) * sa[0] * elem;
+        auto *c_ptr = reinterpret_cast<char *>(c->data()) + static_cast<ptrdiff_t>(g) * sc[0] * elem;
+        status = cublasGemmStridedBatchedEx(
+            handle,
+            trans_b ? CUBLAS_OP_T : CUBLAS_OP_N,
+            trans_a ? CUBLAS_OP_T : CUBLAS_OP_N,
+            n, m, k,
+            &alpha,
+            b->data(), type, static_cast<int>(sb[1]), static_cast<long long>(sb[0]),
+            a_ptr, type, static_cast<int>(sa[1]), static_cast<long long>(sa[0] * group),
+            &beta,
+            c_ptr, type, static_cast<int>(sc[1]), static_cast<long long>(sc[0] * group),
+            static_cast<int>(b_batches),
+            CUBLAS_COMPUTE_32F,
+            CUBLAS_GEMM_DEFAULT);
+        ASSERT(status == CUBLAS_STATUS_SUCCESS, "Bmm(NVIDIA): cublasGemmStridedBatchedEx failed");
+    }
+}
+} // namespace llaisys::ops::nvidia
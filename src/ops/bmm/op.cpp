@@ -0,0 +1,32 @@
+#include "op.hpp"
+#include "../../device/cpu/cpu_launch.hpp"
+#include "./cpu/bmm_cpu.hpp"
+#ifdef ENABLE_NVIDIA_API
+#include "./nvidia/bmm_nvidia.cuh"
+#endif
+
+namespace llaisys::ops {
+void bmm(tensor_t c, tensor_t a, tensor_t b, bool trans_a, bool trans_b, float alpha, float beta) {
+    CHECK_SAME_DEVICE(c, a, b);
+    CHECK_SAME_DTYPE(c->dtype(), a->dtype(), b->dtype());
+    ASSERT(a->ndim() == 3 && b->ndim() == 3 && c->ndim() == 3, "Bmm: a, b and c must be 3-D");
+    const size_t batch = a->shape()[0];
+    const size_t m = trans_a ? a->shape()[2] : a->shape()[1];
+    const size_t k = trans_a ? a->shape()[1] : a->shape()[2];
+    const size_t n = trans_b ? b->shape()[1] : b->shape()[2];
+    const size_t kb = trans_b ? b->shape()[2] : b->shape()[1];
+    ASSERT(b->shape()[0] > 0 && batch % b->shape()[0] == 0,
+           "Bmm: batch of a must be a multiple of batch of b");
+    ASSERT(k == kb, "Bmm: inner dimensions mismatch");
+    ASSERT(c->shape()[0] == batch && c->shape()[1] == m && c->shape()[2] == n, "Bmm: invalid output shape");
+    if (c->deviceType() == LLAISYS_DEVICE_CPU) {
+        return device::cpu::launch([=] { llaisys::ops::cpu::bmm(c, a, b, trans_a, trans_b, alpha, beta); });
+    }
+#ifdef ENABLE_NVIDIA_API
+    if (c->deviceType() == LLAISYS_DEVICE_NVIDIA) {
+        return nvidia::bmm(c, a, b, trans_a, trans_b, alpha, beta);
+    }
+#endif
+    EXCEPTION_UNSUPPORTED_DEVICE;
+}
+} // namespace llaisys::ops
@@ -0,0 +1,11 @@
+#pragma once
+
+#include "../../tensor/tensor.hpp"
+
+namespace llaisys::ops {
+// 批量矩阵乘 c[i] = alpha * op(a[i]) · op(b[i / group]) + beta * c[i]
+// a 为 [B, M, K]（trans_a 时为 [B, K, M]），b 为 [Bb, K, N]（trans_b 时为 [Bb, N, K]），c 为 [B, M, N]。
+// B 须为 Bb 的整数倍，相邻的 group = B / Bb 个 batch 共用 b 的同一个 batch（GQA 中同一 kv 头对应的各 q 头）。
+// 三者可以是任意步长的视图（如 [seq, head, dim] permute 成 [head, seq, dim]）；beta 为 0 时不读取 c
+void bmm(tensor_t c, tensor_t a, tensor_t b, bool trans_a, bool trans_b, float alpha, float beta);
+} // namespace llaisys::ops
@@ -1,4 +1,5 @@
 #include "embedding_cpu.hpp"
+#include "../../../device/cpu/cpu_thread_pool.hpp"
 #include "../../../tensor/tensor.hpp"
 #include "../../../utils.hpp"
 
@@ -19,15 +20,17 @@ template <typename T>
 void contiguous_embedding_(T *out_data, int64_t *index_data, T *weight_data,
                            size_t index_numel, size_t col_numel, size_t row_stride) {
 
-    for (size_t i = 0; i < index_numel; i++) {
-        int64_t row_idx = index_data[i]; // weight的行号
-        ASSERT(row_idx >= 0, "Embedding: index must be non-negative");
-        // weight_data第row_idx行起始地址为
-        size_t weight_start_idx = static_cast<size_t>(row_idx) * row_stride;
-        std::memcpy(out_data + i * col_numel,
-                    weight_data + weight_start_idx,
-                    sizeof(T) * col_numel);
-    }
+    llaisys::device::cpu::parallel_for(0, index_numel, 16, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            int64_t row_idx = index_data[i]; // weight的行号
+            ASSERT(row_idx >= 0, "Embedding: index must be non-negative");
+            // weight_data第row_idx行起始地址为
+            size_t weight_start_idx = static_cast<size_t>(row_idx) * row_stride;
+            std::memcpy(out_data + i * col_numel,
+                        weight_data + weight_start_idx,
+                        sizeof(T) * col_numel);
+        }
+    });
 }
 // 列不连续时的embedding
 template <typename T>
@@ -36,16 +39,18 @@ void uncontiguous_embedding_(T *out_data, int64_t *index_data, T *weight_data,
                              size_t row_stride, size_t col_stride) {
 
     // 遍历行，再遍历列
-    for (size_t i = 0; i < index_numel; i++) {
-        int64_t row_idx = index_data[i];
-        ASSERT(row_idx >= 0, "Embedding: index must be non-negative");
-        size_t weight_start_idx = static_cast<size_t>(row_idx) * row_stride;
-        for (size_t j = 0; j < col_numel; j++) {
-            // 遍历列
-            size_t offset = col_stride * j;
-            out_data[i * col_numel + j] = weight_data[weight_start_idx + offset];
+    llaisys::device::cpu::parallel_for(0, index_numel, 16, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            int64_t row_idx = index_data[i];
+            ASSERT(row_idx >= 0, "Embedding: index must be non-negative");
+            size_t weight_start_idx = static_cast<size_t>(row_idx) * row_stride;
+            for (size_t j = 0; j < col_numel; j++) {
+                // 遍历列
+                size_t offset = col_stride * j;
+                out_data[i * col_numel + j] = weight_data[weight_start_idx + offset];
+            }
         }
-    }
+    });
 }
 // 根据shape的stride类型来分别使用两种实现
 namespace llaisys::ops::cpu {
@@ -89,8 +89,5 @@ void embedding(tensor_t out, tensor_t index, tensor_t weight) {
     default:
         EXCEPTION_UNSUPPORTED_DATATYPE(out->dtype());
     }
-
-    auto& runtime = llaisys::core::context().runtime();
-    runtime.api()->stream_synchronize(runtime.stream());
 }
 } // namespace llaisys::ops::nvidia
@@ -1,4 +1,5 @@
 #include "op.hpp"
+#include "../../device/cpu/cpu_launch.hpp"
 #include "../../core/llaisys_core.hpp"
 #include "../../utils.hpp"
 
@@ -21,7 +22,7 @@ void embedding(tensor_t out, tensor_t index, tensor_t weight) {
     }
     // 调用cpu实现
     if (out->deviceType() == LLAISYS_DEVICE_CPU) {
-        return llaisys::ops::cpu::embedding(out, index, weight);
+        return device::cpu::launch([=] { llaisys::ops::cpu::embedding(out, index, weight); });
     }
 #ifdef ENABLE_NVIDIA_API
     if (out->deviceType() == LLAISYS_DEVICE_NVIDIA) {
@@ -28,10 +28,12 @@ inline void check_cuda_error(cudaError_t err, const char* func, const char* file
 
 // seq_q == 1: SingleDecode (逐 token 推理, 每次只处理一个 query token)
 // seq_q >  1: SinglePrefill (支持 causal mask, 适用于 prefill 阶段)
-template <typename DType>
-void launch_flashinfer_attention_h128_impl(void* q, void* k, void* v, void* out, int seq_q, int seq_kv,
-                                           int num_qo_heads, int num_kv_heads, bool is_causal, float sm_scale,
-                                           void* workspace, size_t workspace_size, cudaStream_t stream) {
+// Variant 决定是否编译滑动窗口分支，window_left < 0 时使用不带窗口的 Variant
+template <typename DType, typename Variant>
+void launch_flashinfer_attention_h128_variant(void* q, void* k, void* v, void* out, int seq_q, int seq_kv,
+                                              int num_qo_heads, int num_kv_heads, bool is_causal, int window_left,
+                                              float sm_scale, void* workspace, size_t workspace_size,
+                                              cudaStream_t stream) {
     using namespace flashinfer;
     constexpr uint32_t HEAD_DIM = 128;
 
@@ -41,12 +43,6 @@ void launch_flashinfer_attention_h128_impl(void* q, void* k, void* v, void* out,
     DType* o_ptr = static_cast<DType*>(out);
     DType* tmp_ptr = (workspace && workspace_size > 0) ? static_cast<DType*>(workspace) : nullptr;
 
-    using Variant = DefaultAttention<
-        /*use_custom_mask=*/false,
-        /*use_sliding_window=*/false,
-        /*use_logits_soft_cap=*/false,
-        /*use_alibi=*/false>;
-
     // FlashInfer decode 内核仅支持 group_size ∈ {1,2,3,4,8}，
     // 不匹配时回退到 prefill 路径（seq_q=1 的 prefill 功能等价于 decode）
     bool use_decode = (seq_q == 1);
@@ -63,7 +59,7 @@ void launch_flashinfer_attention_h128_impl(void* q, void* k, void* v, void* out,
                                                        /*maybe_alibi_slopes=*/nullptr, static_cast<uint32_t>(seq_kv),
                                                        static_cast<uint32_t>(num_qo_heads),
                                                        static_cast<uint32_t>(num_kv_heads), QKVLayout::kNHD, HEAD_DIM,
-                                                       /*window_left=*/-1,
+                                                       window_left,
                                                        /*logits_soft_cap=*/0.0f, sm_scale,
                                                        /*rope_scale=*/1.0f,
                                                        /*rope_theta=*/1e4f);
@@ -84,7 +80,7 @@ void launch_flashinfer_attention_h128_impl(void* q, void* k, void* v, void* out,
             /*maybe_alibi_slopes=*/nullptr, static_cast<uint32_t>(num_qo_heads), static_cast<uint32_t>(num_kv_heads),
             static_cast<uint32_t>(seq_q), static_cast<uint32_t>(seq_kv), q_stride_n, q_stride_h, kv_stride_n,
             kv_stride_h, HEAD_DIM,
-            /*window_left=*/-1,
+            window_left,
             /*logits_soft_cap=*/0.0f, sm_scale,
             /*rope_scale=*/1.0f,
             /*rope_theta=*/1e4f);
@@ -103,6 +99,33 @@ void launch_flashinfer_attention_h128_impl(void* q, void* k, void* v, void* out,
     }
 }
 
+template <typename DType>
+void launch_flashinfer_attention_h128_impl(void* q, void* k, void* v, void* out, int seq_q, int seq_kv,
+                                           int num_qo_heads, int num_kv_heads, bool is_causal, int window_left,
+                                           float sm_scale, void* workspace, size_t workspace_size,
+                                           cudaStream_t stream) {
+    using namespace flashinfer;
+    if (window_left >= 0) {
+        using Variant = DefaultAttention<
+            /*use_custom_mask=*/false,
+            /*use_sliding_window=*/true,
+            /*use_logits_soft_cap=*/false,
+            /*use_alibi=*/false>;
+        launch_flashinfer_attention_h128_variant<DType, Variant>(q, k, v, out, seq_q, seq_kv, num_qo_heads,
+                                                                 num_kv_heads, is_causal, window_left, sm_scale,
+                                                                 workspace, workspace_size, stream);
+    } else {
+        using Variant = DefaultAttention<
+            /*use_custom_mask=*/false,
+            /*use_sliding_window=*/false,
+            /*use_logits_soft_cap=*/false,
+            /*use_alibi=*/false>;
+        launch_flashinfer_attention_h128_variant<DType, Variant>(q, k, v, out, seq_q, seq_kv, num_qo_heads,
+                                                                 num_kv_heads, is_causal, -1, sm_scale,
+                                                                 workspace, workspace_size, stream);
+    }
+}
+
 template <typename DType>
 void launch_flashinfer_paged_attention_h128_impl(void* q, void* paged_kv_data, int32_t* kv_indptr, int32_t* kv_indices,
                                                  int32_t* kv_last_page_len, void* out, int batch_size, int num_qo_heads,
@@ -201,18 +224,19 @@ void launch_flashinfer_decode_bf16_h128_pagedattn(void* q, void* paged_kv_data,
 
 // ======================== FP16 ========================
 void launch_flashinfer_decode_fp16_h128(void* q, void* k, void* v, void* out, int seq_q, int seq_kv, int num_qo_heads,
-                                        int num_kv_heads, bool is_causal, float sm_scale, void* workspace,
-                                        size_t workspace_size, cudaStream_t stream) {
+                                        int num_kv_heads, bool is_causal, int window_left, float sm_scale,
+                                        void* workspace, size_t workspace_size, cudaStream_t stream) {
     launch_flashinfer_attention_h128_impl<__half>(q, k, v, out, seq_q, seq_kv, num_qo_heads, num_kv_heads, is_causal,
-                                                  sm_scale, workspace, workspace_size, stream);
+                                                  window_left, sm_scale, workspace, workspace_size, stream);
 }
 
 // ======================== BF16 ========================
 void launch_flashinfer_decode_bf16_h128(void* q, void* k, void* v, void* out, int seq_q, int seq_kv, int num_qo_heads,
-                                        int num_kv_heads, bool is_causal, float sm_scale, void* workspace,
-                                        size_t workspace_size, cudaStream_t stream) {
+                                        int num_kv_heads, bool is_causal, int window_left, float sm_scale,
+                                        void* workspace, size_t workspace_size, cudaStream_t stream) {
     launch_flashinfer_attention_h128_impl<__nv_bfloat16>(q, k, v, out, seq_q, seq_kv, num_qo_heads, num_kv_heads,
-                                                         is_causal, sm_scale, workspace, workspace_size, stream);
+                                                         is_causal, window_left, sm_scale, workspace, workspace_size,
+                                                         stream);
 }
 
 } // namespace llaisys::ops::nvidia
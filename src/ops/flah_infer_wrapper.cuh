@@ -64,6 +64,7 @@ void launch_flashinfer_decode_bf16_h128_pagedattn(
 //
 // seq_q == 1 时走 FlashInfer SingleDecode 路径 (针对逐 token 推理优化)
 // seq_q >  1 时走 FlashInfer SinglePrefill 路径 (针对 prefill 阶段优化)
+// window_left >= 0 时启用滑动窗口：query 只看自身及之前 window_left 个 key，-1 表示关闭
 //
 // 注意: FlashInfer 内核依赖 Tensor Core MMA 和 cp_async 硬件指令，
 //       仅支持 2 字节数据类型 (FP16 / BF16)，不支持 FP32。
@@ -78,6 +79,7 @@ void launch_flashinfer_decode_fp16_h128(
     int num_qo_heads,
     int num_kv_heads,
     bool is_causal,
+    int window_left,
     float sm_scale,
     void* workspace,
     size_t workspace_size,
@@ -93,6 +95,7 @@ void launch_flashinfer_decode_bf16_h128(
     int num_qo_heads,
     int num_kv_heads,
     bool is_causal,
+    int window_left,
     float sm_scale,
     void* workspace,
     size_t workspace_size,
@@ -0,0 +1,80 @@
+#include "kv_quant_cpu.hpp"
+#include "../../../device/cpu/cpu_convert.hpp"
+#include "../../../device/cpu/cpu_thread_pool.hpp"
+#include "../../../utils.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace {
+template <typename Q>
+constexpr float quant_max() {
+    if constexpr (std::is_same_v<Q, int8_t>) {
+        return 127.0f;
+    } else {
+        return 448.0f; // E4M3 最大有限值
+    }
+}
+
+template <typename Q>
+Q quant_raw(float x) {
+    if constexpr (std::is_same_v<Q, int8_t>) {
+        float r = std::nearbyint(x);
+        r = std::min(127.0f, std::max(-127.0f, r));
+        return static_cast<int8_t>(r);
+    } else {
+        return llaisys::utils::cast<llaisys::fp8_t>(x);
+    }
+}
+
+template <typename T, typename Q>
+void quantize_kv_(Q *out, float *scale, const T *in, size_t rows, size_t d) {
+    llaisys::device::cpu::parallel_for(0, rows, std::max<size_t>(1, 8192 / std::max<size_t>(d, 1)), [&](size_t begin, size_t end) {
+        std::vector<float> row(d);
+        for (size_t r = begin; r < end; r++) {
+            llaisys::device::cpu::to_f32(row.data(), in + r * d, d);
+            float amax = 0.0f;
+            for (size_t l = 0; l < d; l++) {
+                amax = std::max(amax, std::fabs(row[l]));
+            }
+            float s = amax > 0.0f ? amax / quant_max<Q>() : 1.0f;
+            float inv = 1.0f / s;
+            scale[r] = s;
+            for (size_t l = 0; l < d; l++) {
+                out[r * d + l] = quant_raw<Q>(row[l] * inv);
+            }
+        }
+    });
+}
+
+template <typename T>
+void quantize_kv_dispatch(llaisys::tensor_t out, float *scale, const T *in, size_t rows, size_t d) {
+    switch (out->dtype()) {
+    case LLAISYS_DTYPE_I8:
+        return quantize_kv_(reinterpret_cast<int8_t *>(out->data()), scale, in, rows, d);
+    case LLAISYS_DTYPE_F8:
+        return quantize_kv_(reinterpret_cast<llaisys::fp8_t *>(out->data()), scale, in, rows, d);
+    default:
+        EXCEPTION_UNSUPPORTED_DATATYPE(out->dtype());
+    }
+}
+} // namespace
+
+namespace llaisys::ops::cpu {
+void quantize_kv(tensor_t out, tensor_t scale, tensor_t in) {
+    size_t rows = in->shape()[0] * in->shape()[1];
+    size_t d = in->shape()[2];
+    float *scale_data = reinterpret_cast<float *>(scale->data());
+    switch (in->dtype()) {
+    case LLAISYS_DTYPE_F32:
+        return quantize_kv_dispatch(out, scale_data, reinterpret_cast<const float *>(in->data()), rows, d);
+    case LLAISYS_DTYPE_BF16:
+        return quantize_kv_dispatch(out, scale_data, reinterpret_cast<const llaisys::bf16_t *>(in->data()), rows, d);
+    case LLAISYS_DTYPE_F16:
+        return quantize_kv_dispatch(out, scale_data, reinterpret_cast<const llaisys::fp16_t *>(in->data()), rows, d);
+    default:
+        EXCEPTION_UNSUPPORTED_DATATYPE(in->dtype());
+    }
+}
+} // namespace llaisys::ops::cpu
@@ -0,0 +1,71 @@
+#pragma once
+
+// 量化 KV 的设备端读写工具，供 quantize_kv 与量化注意力内核共用
+#include <cuda_bf16.h>
+#include <cuda_fp16.h>
+#include <cuda_fp8.h>
+#include <cuda_runtime.h>
+#include <cstdint>
+
+namespace llaisys::ops::nvidia::kv_quant {
+
+template <typename T>
+__device__ __forceinline__ float to_float(T v);
+template <>
+__device__ __forceinline__ float to_float<float>(float v) { return v; }
+template <>
+__device__ __forceinline__ float to_float<__half>(__half v) { return __half2float(v); }
+template <>
+__device__ __forceinline__ float to_float<__nv_bfloat16>(__nv_bfloat16 v) { return __bfloat162float(v); }
+
+template <typename T>
+__device__ __forceinline__ T from_float(float v);
+template <>
+__device__ __forceinline__ float from_float<float>(float v) { return v; }
+template <>
+__device__ __forceinline__ __half from_float<__half>(float v) { return __float2half_rn(v); }
+template <>
+__device__ __forceinline__ __nv_bfloat16 from_float<__nv_bfloat16>(float v) { return __float2bfloat16_rn(v); }
+
+template <typename Q>
+__device__ __forceinline__ float dequant_raw(Q v);
+template <>
+__device__ __forceinline__ float dequant_raw<int8_t>(int8_t v) { return static_cast<float>(v); }
+template <>
+__device__ __forceinline__ float dequant_raw<__nv_fp8_e4m3>(__nv_fp8_e4m3 v) { return static_cast<float>(v); }
+
+template <typename Q>
+__device__ __forceinline__ Q quant_raw(float x);
+template <>
+__device__ __forceinline__ int8_t quant_raw<int8_t>(float x) {
+    int r = __float2int_rn(x);
+    r = max(-127, min(127, r));
+    return static_cast<int8_t>(r);
+}
+template <>
+__device__ __forceinline__ __nv_fp8_e4m3 quant_raw<__nv_fp8_e4m3>(float x) {
+    return __nv_fp8_e4m3(x); // 构造函数使用 __NV_SATFINITE 饱和
+}
+
+template <typename Q>
+__host__ __device__ constexpr float quant_max();
+template <>
+__host__ __device__ constexpr float quant_max<int8_t>() { return 127.0f; }
+template <>
+__host__ __device__ constexpr float quant_max<__nv_fp8_e4m3>() { return 448.0f; }
+
+__device__ __forceinline__ float warp_max(float v) {
+    for (int offset = 16; offset > 0; offset >>= 1) {
+        v = fmaxf(v, __shfl_xor_sync(0xffffffff, v, offset));
+    }
+    return v;
+}
+
+__device__ __forceinline__ float warp_sum(float v) {
+    for (int offset = 16; offset > 0; offset >>= 1) {
+        v += __shfl_xor_sync(0xffffffff, v, offset);
+    }
+    return v;
+}
+
+} // namespace llaisys::ops::nvidia::kv_quant
@@ -0,0 +1,97 @@
+#include "kv_quant_nvidia.cuh"
+#include "kv_quant_device.cuh"
+
+#include "../../../core/llaisys_core.hpp"
+#include "../../../utils.hpp"
+
+namespace llaisys::ops::nvidia {
+
+namespace {
+using namespace kv_quant;
+
+// 一个 block 处理一行 (token, head)：先求 absmax，再按 scale 量化
+template <typename T, typename Q>
+__global__ void quantize_kv_kernel(Q *out, float *scale, const T *in, int d) {
+    const size_t row = blockIdx.x;
+    const T *src = in + row * static_cast<size_t>(d);
+    Q *dst = out + row * static_cast<size_t>(d);
+
+    float local = 0.0f;
+    for (int l = threadIdx.x; l < d; l += blockDim.x) {
+        local = fmaxf(local, fabsf(to_float(src[l])));
+    }
+    __shared__ float smem[32];
+    const int lane = threadIdx.x & 31;
+    const int warp = threadIdx.x >> 5;
+    local = warp_max(local);
+    if (lane == 0) {
+        smem[warp] = local;
+    }
+    __syncthreads();
+    if (warp == 0) {
+        const int nwarps = (blockDim.x + 31) >> 5;
+        float v = lane < nwarps ? smem[lane] : 0.0f;
+        v = warp_max(v);
+        if (lane == 0) {
+            smem[0] = v;
+        }
+    }
+    __syncthreads();
+
+    const float amax = smem[0];
+    const float s = amax > 0.0f ? amax / quant_max<Q>() : 1.0f;
+    if (threadIdx.x == 0) {
+        scale[row] = s;
+    }
+    const float inv = 1.0f / s;
+    for (int l = threadIdx.x; l < d; l += blockDim.x) {
+        dst[l] = quant_raw<Q>(to_float(src[l]) * inv);
+    }
+}
+
+template <typename T>
+void launch_quantize(tensor_t out, tensor_t scale, const T *in, int rows, int d, cudaStream_t stream) {
+    constexpr int block_size = 128;
+    float *scale_ptr = reinterpret_cast<float *>(scale->data());
+    switch (out->dtype()) {
+    case LLAISYS_DTYPE_I8:
+        quantize_kv_kernel<T, int8_t><<<rows, block_size, 0, stream>>>(
+            reinterpret_cast<int8_t *>(out->data()), scale_ptr, in, d);
+        break;
+    case LLAISYS_DTYPE_F8:
+        quantize_kv_kernel<T, __nv_fp8_e4m3><<<rows, block_size, 0, stream>>>(
+            reinterpret_cast<__nv_fp8_e4m3 *>(out->data()), scale_ptr, in, d);
+        break;
+    default:
+        EXCEPTION_UNSUPPORTED_DATATYPE(out->dtype());
+    }
+}
+} // namespace
+
+void quantize_kv(tensor_t out, tensor_t scale, tensor_t in) {
+    const int rows = static_cast<int>(in->shape()[0] * in->shape()[1]);
+    const int d = static_cast<int>(in->shape()[2]);
+    if (rows == 0 || d == 0) {
+        return;
+    }
+
+    llaisys::core::context().setDevice(LLAISYS_DEVICE_NVIDIA, in->deviceId());
+    auto &runtime = llaisys::core::context().runtime();
+    auto stream = reinterpret_cast<cudaStream_t>(runtime.stream());
+
+    switch (in->dtype()) {
+    case LLAISYS_DTYPE_F32:
+        launch_quantize(out, scale, reinterpret_cast<const float *>(in->data()), rows, d, stream);
+        break;
+    case LLAISYS_DTYPE_F16:
+        launch_quantize(out, scale, reinterpret_cast<const __half *>(in->data()), rows, d, stream);
+        break;
+    case LLAISYS_DTYPE_BF16:
+        launch_quantize(out, scale, reinterpret_cast<const __nv_bfloat16 *>(in->data()), rows, d, stream);
+        break;
+    default:
+        EXCEPTION_UNSUPPORTED_DATATYPE(in->dtype());
+    }
+}
+
+} // namespace llaisys::ops::nvidia
@@ -0,0 +1,7 @@
+#pragma once
+
+#include "../../../tensor/tensor.hpp"
+
+namespace llaisys::ops::nvidia {
+void quantize_kv(tensor_t out, tensor_t scale, tensor_t in);
+}
@@ -0,0 +1,30 @@
+#include "op.hpp"
+#include "../../device/cpu/cpu_launch.hpp"
+#include "./cpu/kv_quant_cpu.hpp"
+#ifdef ENABLE_NVIDIA_API
+#include "./nvidia/kv_quant_nvidia.cuh"
+#endif
+
+namespace llaisys::ops {
+void quantize_kv(tensor_t out, tensor_t scale, tensor_t in) {
+    CHECK_SAME_DEVICE(out, scale, in);
+    CHECK_SAME_SHAPE(out->shape(), in->shape());
+    ASSERT(in->ndim() == 3, "QuantizeKV: input must be [seq, nkvhead, d]");
+    ASSERT(out->dtype() == LLAISYS_DTYPE_I8 || out->dtype() == LLAISYS_DTYPE_F8,
+           "QuantizeKV: output dtype must be int8 or float8");
+    ASSERT(scale->dtype() == LLAISYS_DTYPE_F32, "QuantizeKV: scale dtype must be float32");
+    ASSERT(scale->ndim() == 2 && scale->shape()[0] == in->shape()[0] && scale->shape()[1] == in->shape()[1],
+           "QuantizeKV: scale must be [seq, nkvhead]");
+    ASSERT(out->isContiguous() && scale->isContiguous() && in->isContiguous(),
+           "QuantizeKV: inputs must be contiguous");
+    if (in->deviceType() == LLAISYS_DEVICE_CPU) {
+        return device::cpu::launch([=] { cpu::quantize_kv(out, scale, in); });
+    }
+#ifdef ENABLE_NVIDIA_API
+    if (in->deviceType() == LLAISYS_DEVICE_NVIDIA) {
+        return nvidia::quantize_kv(out, scale, in);
+    }
+#endif
+    EXCEPTION_UNSUPPORTED_DEVICE;
+}
+} // namespace llaisys::ops
@@ -0,0 +1,10 @@
+#pragma once
+
+#include "../../tensor/tensor.hpp"
+
+namespace llaisys::ops {
+// K/V 按 (token, head) 做对称量化：
+// in: [seq, nkvhead, d] (F32/F16/BF16) -> out: 同形状的 I8 或 F8(E4M3)，scale: [seq, nkvhead] (F32)
+// 反量化为 out * scale
+void quantize_kv(tensor_t out, tensor_t scale, tensor_t in);
+} // namespace llaisys::ops
@@ -0,0 +1,189 @@
+// immintrin.h 须在 llaisys.h 之前包含（见 device/cpu/cpu_convert.cpp）
+#if defined(__x86_64__) && defined(__linux__) && (defined(__GNUC__) || defined(__clang__))
+#define LLAISYS_LINEAR_AMX 1
+#include <immintrin.h>
+#endif
+
+#include "linear_amx.hpp"
+#include "../../../device/cpu/cpu_isa.hpp"
+#include "../../../device/cpu/cpu_thread_pool.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+namespace llaisys::ops::cpu {
+#ifdef LLAISYS_LINEAR_AMX
+namespace {
+constexpr size_t kTileRows = 16;
+// 每个 tile 步在 k 方向上覆盖 32 个 bf16（一行 64 字节）
+constexpr size_t kStep = 32;
+constexpr size_t kGrainMacs = 1 << 15;
+
+size_t input_blocks(size_t m) {
+    return ((m + kTileRows - 1) / kTileRows + 1) / 2 * 2;
+}
+
+struct alignas(64) TileConfig {
+    uint8_t palette_id;
+    uint8_t start_row;
+    uint8_t reserved[14];
+    uint16_t colsb[16];
+    uint8_t rows[16];
+};
+
+// 计算 outᵀ = weight · inᵀ：权重行（输出列 j）直接作为 A tile（16 行 × 32 个 bf16），
+// 输入打包成 B tile 要求的 VNNI 布局：每 16 个输入行（i 块）、每个 k 步一块 16 × 16 的 bf16 对，
+// 第 r 行第 c 列为 (in[i0 + c][k0 + 2r], in[i0 + c][k0 + 2r + 1])。i 块数补齐为偶数，多出的行填 0
+std::vector<uint32_t> pack_input(const bf16_t *in, size_t m, size_t k, size_t i_blocks) {
+    const size_t steps = k / kStep;
+    std::vector<uint32_t> packed(i_blocks * steps * kTileRows * kTileRows, 0);
+    llaisys::device::cpu::parallel_for(0, i_blocks, 1, [&](size_t begin, size_t end) {
+        for (size_t ib = begin; ib < end; ++ib) {
+            for (size_t c = 0; c < kTileRows && ib * kTileRows + c < m; ++c) {
+                const uint16_t *row = reinterpret_cast<const uint16_t *>(in + (ib * kTileRows + c) * k);
+                for (size_t s = 0; s < steps; ++s) {
+                    uint32_t *tile = packed.data() + (ib * steps + s) * kTileRows * kTileRows;
+                    for (size_t r = 0; r < kTileRows; ++r) {
+                        const uint16_t *pair = row + s * kStep + 2 * r;
+                        tile[r * kTileRows + c] = static_cast<uint32_t>(pair[0]) | (static_cast<uint32_t>(pair[1]) << 16);
+                    }
+                }
+            }
+        }
+    });
+    return packed;
+}
+
+// tmm0..3 为累加器（C[a][b] = A[a] · B[b]，下标 2a + b），tmm4/5 为两块权重 A，tmm6/7 为两块输入 B。
+// rows0 / rows1 为两块权重实际的行数（rows1 为 0 时第二块不参与计算，配置成 1 行）
+__attribute__((target("amx-tile,amx-bf16"))) void configure(size_t rows0, size_t rows1) {
+    TileConfig cfg{};
+    cfg.palette_id = 1;
+    const uint8_t r0 = static_cast<uint8_t>(rows0);
+    const uint8_t r1 = static_cast<uint8_t>(std::max<size_t>(rows1, 1));
+    const uint8_t rows[8] = {r0, r0, r1, r1, r0, r1, kTileRows, kTileRows};
+    for (size_t t = 0; t < 8; ++t) {
+        cfg.rows[t] = rows[t];
+        cfg.colsb[t] = 64;
+    }
+    // GCC 的 _tile_loadconfig 只传入指针，不视为读取这 64 字节，rows / colsb 的写入会被当作死存储删掉，
+    // 加载的是未初始化的配置。用以 cfg 为内存输入的空 asm 保留这些写入
+    __asm__ volatile("" : : "m"(cfg));
+    _tile_loadconfig(&cfg);
+}
+
+// 计算输出列 [j_begin, j_end)：每次取 32 个权重行与 32 个输入行（两块 × 两块），
+// 每个结果以 store(i, j, v) 交给调用方
+template <typename Store>
+__attribute__((target("amx-tile,amx-bf16"))) void amx_rows(const uint32_t *packed, const bf16_t *weight, size_t m,
+                                                         size_t k, size_t i_blocks, size_t j_begin, size_t j_end,
+                                                         Store store) {
+    const size_t steps = k / kStep;
+    const size_t tile = kTileRows * kTileRows;
+    const size_t w_stride = k * sizeof(bf16_t);
+    alignas(64) float c[4][kTileRows * kTileRows];
+    size_t cfg0 = 0, cfg1 = 0;
+    for (size_t j0 = j_begin; j0 < j_end; j0 += 2 * kTileRows) {
+        const size_t rows0 = std::min(kTileRows, j_end - j0);
+        const size_t rows1 = j_end - j0 > kTileRows ? std::min(kTileRows, j_end - j0 - kTileRows) : 0;
+        if (rows0 != cfg0 || rows1 != cfg1) {
+            configure(rows0, rows1);
+            cfg0 = rows0;
+            cfg1 = rows1;
+        }
+        const bf16_t *w0 = weight + j0 * k;
+        const bf16_t *w1 = w0 + kTileRows * k;
+        for (size_t ib = 0; ib < i_blocks; ib += 2) {
+            const uint32_t *b0 = packed + ib * steps * tile;
+            const uint32_t *b1 = b0 + steps * tile;
+            _tile_zero(0);
+            _tile_zero(1);
+            _tile_zero(2);
+            _tile_zero(3);
+            for (size_t s = 0; s < steps; ++s) {
+                _tile_loadd(4, w0 + s * kStep, w_stride);
+                _tile_loadd(6, b0 + s * tile, 64);
+                _tile_loadd(7, b1 + s * tile, 64);
+                _tile_dpbf16ps(0, 4, 6);
+                _tile_dpbf16ps(1, 4, 7);
+                if (rows1) {
+                    _tile_loadd(5, w1 + s * kStep, w_stride);
+                    _tile_dpbf16ps(2, 5, 6);
+                    _tile_dpbf16ps(3, 5, 7);
+                }
+            }
+            _tile_stored(0, c[0], 64);
+            _tile_stored(1, c[1], 64);
+            if (rows1) {
+                _tile_stored(2, c[2], 64);
+                _tile_stored(3, c[3], 64);
+            }
+            // c[2a + b] 的第 r 行第 col 列对应输出 (i, j) = ((ib + b) * 16 + col, j0 + a * 16 + r)
+            for (size_t t = 0; t < (rows1 ? 4u : 2u); ++t) {
+                const size_t a = t / 2;
+                const size_t rows = a ? rows1 : rows0;
+                for (size_t col = 0; col < kTileRows; ++col) {
+                    const size_t i = (ib + t % 2) * kTileRows + col;
+                    if (i >= m) {
+                        break;
+                    }
+                    for (size_t r = 0; r < rows; ++r) {
+                        store(i, j0 + a * kTileRows + r, c[t][r * kTileRows + col]);
+                    }
+                }
+            }
+        }
+    }
+    _tile_release();
+}
+} // namespace
+
+bool linear_amx_supported(size_t k) {
+    return k > 0 && k % kStep == 0 && llaisys::device::cpu::isa() == llaisys::device::cpu::Isa::Amx;
+}
+
+void linear_amx(bf16_t *out, const bf16_t *in, const bf16_t *weight, const bf16_t *bias,
+                size_t m, size_t k, size_t n) {
+    const size_t i_blocks = input_blocks(m);
+    std::vector<uint32_t> packed = pack_input(in, m, k, i_blocks);
+    // 与其他 linear 路径相同，按权重行分块并行，各 NUMA 节点处理本地的权重分片
+    llaisys::device::cpu::parallel_for_rows(n, std::max<size_t>(2 * kTileRows, kGrainMacs / std::max<size_t>(m * k, 1)),
+                                            [&](size_t begin, size_t end) {
+        amx_rows(packed.data(), weight, m, k, i_blocks, begin, end, [&](size_t i, size_t j, float v) {
+            if (bias) {
+                v += llaisys::utils::cast<float>(bias[j]);
+            }
+            out[i * n + j] = llaisys::utils::cast<bf16_t>(v);
+        });
+    });
+}
+
+std::vector<uint32_t> linear_amx_pack(const bf16_t *in, size_t m, size_t k) {
+    return pack_input(in, m, k, input_blocks(m));
+}
+
+void linear_amx_f32(float *out, size_t ldo, const std::vector<uint32_t> &packed, const bf16_t *weight,
+                    size_t m, size_t k, size_t j_begin, size_t j_end) {
+    amx_rows(packed.data(), weight, m, k, input_blocks(m), j_begin, j_end, [&](size_t i, size_t j, float v) {
+        out[i * ldo + (j - j_begin)] = v;
+    });
+}
+#else
+bool linear_amx_supported(size_t) {
+    return false;
+}
+
+void linear_amx(bf16_t *, const bf16_t *, const bf16_t *, const bf16_t *, size_t, size_t, size_t) {
+    EXCEPTION_UNSUPPORTED_DEVICE;
+}
+
+std::vector<uint32_t> linear_amx_pack(const bf16_t *, size_t, size_t) {
+    EXCEPTION_UNSUPPORTED_DEVICE;
+}
+
+void linear_amx_f32(float *, size_t, const std::vector<uint32_t> &, const bf16_t *, size_t, size_t, size_t, size_t) {
+    EXCEPTION_UNSUPPORTED_DEVICE;
+}
+#endif
+} // namespace llaisys::ops::cpu
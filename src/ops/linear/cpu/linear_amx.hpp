@@ -0,0 +1,23 @@
+#pragma once
+
+#include "../../../utils.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace llaisys::ops::cpu {
+// 当前指令集档位为 amx 且 k 为 32 的倍数时，bf16 linear 可以走 AMX tile 路径
+bool linear_amx_supported(size_t k);
+// out[m, n] = in[m, k] · weight[n, k]ᵀ (+ bias)，bias 可以为空。
+// tile 乘加以 f32 累加（输入的次正规数按 0 处理），结果与 f32 路径只在舍入上有差别；
+// 每个输出元素的累加顺序只取决于 k，与 m 无关，prefill 与 decode 的结果一致
+void linear_amx(bf16_t *out, const bf16_t *in, const bf16_t *weight, const bf16_t *bias,
+                size_t m, size_t k, size_t n);
+// 分段计算同一输入的不同输出列（如 linear_topk 按词表分块）：先打包一次输入，
+// 再由 linear_amx_f32 在调用线程上求 out[i * ldo + (j - j_begin)] = in[i] · weight[j]（不加 bias、不舍入），
+// j ∈ [j_begin, j_end)。累加顺序与 linear_amx 相同
+std::vector<uint32_t> linear_amx_pack(const bf16_t *in, size_t m, size_t k);
+void linear_amx_f32(float *out, size_t ldo, const std::vector<uint32_t> &packed, const bf16_t *weight,
+                    size_t m, size_t k, size_t j_begin, size_t j_end);
+} // namespace llaisys::ops::cpu
@@ -1,72 +1,97 @@
 #include "linear_cpu.hpp"
+#include "linear_amx.hpp"
+#include "../../../device/cpu/cpu_convert.hpp"
+#include "../../../device/cpu/cpu_kernels.hpp"
+#include "../../../device/cpu/cpu_thread_pool.hpp"
 #include "../../../tensor/tensor.hpp"
 #include "../../../utils.hpp"
 
+#include <algorithm>
 #include <cmath>
 #include <cstring>
-// 无偏置情形, 2D情形
+#include <vector>
+namespace {
+constexpr size_t kGrainMacs = 1 << 15;
+}
+// 半精度：输入整体成批转成 f32，每个输出列 j 的权重行成批转换一次后供全部 m 行复用；
+// 点积由 device/cpu/cpu_kernels 按指令集档位计算。bias 可以为空
 template <typename T>
-void non_bias_linear_(T *out_data, const T *in_data, const T *weight_data,
-                      const std::vector<size_t> &shape) {
+void half_linear_(T *out_data, const T *in_data, const T *weight_data, const T *bias_data,
+                  const std::vector<size_t> &shape) {
     size_t m = shape[0];
     size_t k = shape[1];
     size_t n = shape[2];
-    for (size_t i = 0; i < m; i++) {
-        for (size_t j = 0; j < n; j++) {
-            size_t out_idx = i * n + j;
-            if constexpr (std::is_same_v<T, llaisys::bf16_t>
-                          || std::is_same_v<T, llaisys::fp16_t>) {
-                float acc = 0.0f;
-                for (size_t l = 0; l < k; l++) {
-                    size_t in_idx = i * k + l;
-                    size_t weight_idx = j * k + l;
-                    acc += llaisys::utils::cast<float>(in_data[in_idx])
-                         * llaisys::utils::cast<float>(weight_data[weight_idx]);
-                }
-                out_data[out_idx] = llaisys::utils::cast<T>(acc);
-            } else {
-                T acc = T(0);
-                for (size_t l = 0; l < k; l++) {
-                    size_t in_idx = i * k + l;
-                    size_t weight_idx = j * k + l;
-                    acc += in_data[in_idx] * weight_data[weight_idx];
+    if constexpr (std::is_same_v<T, llaisys::bf16_t>) {
+        // AMX 可用时 bf16 直接做 tile 乘加，不再转换成 f32
+        if (llaisys::ops::cpu::linear_amx_supported(k)) {
+            return llaisys::ops::cpu::linear_amx(out_data, in_data, weight_data, bias_data, m, k, n);
+        }
+    }
+    std::vector<float> in(m * k);
+    llaisys::device::cpu::parallel_for(0, m, std::max<size_t>(1, 8192 / std::max<size_t>(k, 1)), [&](size_t begin, size_t end) {
+        llaisys::device::cpu::to_f32(in.data() + begin * k, in_data + begin * k, (end - begin) * k);
+    });
+    llaisys::device::cpu::parallel_for_rows(n, std::max<size_t>(1, kGrainMacs / std::max<size_t>(m * k, 1)),
+                                            [&](size_t begin, size_t end) {
+        std::vector<float> w(k);
+        for (size_t j = begin; j < end; j++) {
+            llaisys::device::cpu::to_f32(w.data(), weight_data + j * k, k);
+            const float bias = bias_data ? llaisys::utils::cast<float>(bias_data[j]) : 0.0f;
+            for (size_t i = 0; i < m; i++) {
+                float acc = llaisys::device::cpu::dot(in.data() + i * k, w.data(), k);
+                if (bias_data) {
+                    acc += bias;
                 }
-                out_data[out_idx] = acc;
+                out_data[i * n + j] = llaisys::utils::cast<T>(acc);
             }
         }
+    });
+}
+// 无偏置情形, 2D情形
+template <typename T>
+void non_bias_linear_(T *out_data, const T *in_data, const T *weight_data,
+                      const std::vector<size_t> &shape) {
+    if constexpr (std::is_same_v<T, llaisys::bf16_t>
+                  || std::is_same_v<T, llaisys::fp16_t>) {
+        half_linear_<T>(out_data, in_data, weight_data, nullptr, shape);
+    } else {
+        size_t m = shape[0];
+        size_t k = shape[1];
+        size_t n = shape[2];
+        // 按权重行（输出列 j）分块并行，每块约 kGrainMacs 次乘加；多 NUMA 节点时各节点只计算
+        // first-touch 到本地的权重分片（见 device/cpu/cpu_numa.hpp）
+        llaisys::device::cpu::parallel_for_rows(n, std::max<size_t>(1, kGrainMacs / std::max<size_t>(m * k, 1)),
+                                                [&](size_t begin, size_t end) {
+            for (size_t i = 0; i < m; i++) {
+                for (size_t j = begin; j < end; j++) {
+                    T acc = llaisys::device::cpu::dot(in_data + i * k, weight_data + j * k, k);
+                    out_data[i * n + j] = acc;
+                }
+            }
+        });
     }
 }
 // 有偏置情形
 template <typename T>
 void bias_linear_(T *out_data, const T *in_data, const T *weight_data, const T *bias_data,
                   const std::vector<size_t> &shape) {
-    size_t m = shape[0];
-    size_t k = shape[1];
-    size_t n = shape[2];
-    for (size_t i = 0; i < m; i++) {
-        for (size_t j = 0; j < n; j++) {
-            if constexpr (std::is_same_v<T, llaisys::bf16_t>
-                          || std::is_same_v<T, llaisys::fp16_t>) {
-                float acc = 0.0f;
-                for (size_t l = 0; l < k; l++) {
-                    size_t in_idx = i * k + l;
-                    size_t weight_idx = j * k + l;
-                    acc += llaisys::utils::cast<float>(in_data[in_idx])
-                         * llaisys::utils::cast<float>(weight_data[weight_idx]);
-                }
-                acc += llaisys::utils::cast<float>(bias_data[j]);
-                out_data[i * n + j] = llaisys::utils::cast<T>(acc);
-            } else {
-                T acc = T(0);
-                for (size_t l = 0; l < k; l++) {
-                    size_t in_idx = i * k + l;
-                    size_t weight_idx = j * k + l;
-                    acc += in_data[in_idx] * weight_data[weight_idx];
+    if constexpr (std::is_same_v<T, llaisys::bf16_t>
+                  || std::is_same_v<T, llaisys::fp16_t>) {
+        half_linear_<T>(out_data, in_data, weight_data, bias_data, shape);
+    } else {
+        size_t m = shape[0];
+        size_t k = shape[1];
+        size_t n = shape[2];
+        llaisys::device::cpu::parallel_for_rows(n, std::max<size_t>(1, kGrainMacs / std::max<size_t>(m * k, 1)),
+                                                [&](size_t begin, size_t end) {
+            for (size_t i = 0; i < m; i++) {
+                for (size_t j = begin; j < end; j++) {
+                    T acc = llaisys::device::cpu::dot(in_data + i * k, weight_data + j * k, k);
+                    acc += bias_data[j];
+                    out_data[i * n + j] = acc;
                 }
-                acc += bias_data[j];
-                out_data[i * n + j] = acc;
             }
-        }
+        });
     }
 }
 // 对外接口
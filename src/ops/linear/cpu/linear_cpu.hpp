@@ -6,4 +6,6 @@
 #include <cstring>
 namespace llaisys::ops::cpu {
 void linear(tensor_t out, tensor_t in, tensor_t weight, tensor_t bias);
+void linear_topk(tensor_t out_idx, tensor_t out_val, tensor_t lse, tensor_t in, tensor_t weight);
+void linear_logprob(tensor_t out, tensor_t in, tensor_t weight, tensor_t target);
 }
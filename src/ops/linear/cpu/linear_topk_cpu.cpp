@@ -0,0 +1,222 @@
+#include "linear_cpu.hpp"
+#include "linear_amx.hpp"
+#include "../../../device/cpu/cpu_convert.hpp"
+#include "../../../device/cpu/cpu_kernels.hpp"
+#include "../../../device/cpu/cpu_thread_pool.hpp"
+#include "../../../device/cpu/cpu_topk.hpp"
+#include "../../../utils.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+namespace {
+// 每次算 kTile 个输出列的 logits，只在线程本地的小缓冲里停留
+constexpr size_t kTile = 256;
+constexpr size_t kGrainMacs = 1 << 15;
+
+// 一个并行块（一段连续的权重行）的结果：每行的候选，以及 logsumexp 的部分量 (max, Σ exp(x - max))
+struct ChunkResult {
+    size_t begin;
+    std::vector<std::vector<llaisys::device::cpu::TopkEntry>> entries;
+    std::vector<float> max;
+    std::vector<double> sum;
+};
+
+// 与 linear 相同的并行划分与点积：f32 直接点积，半精度先把输入与权重行转成 f32，bf16 在 AMX 可用时走 tile 路径。
+// 每个 logit 按 T 舍入后再比较，与先算出 logits 再 argmax / topk 的结果一致。
+// target 不为空时顺带取出每行第 target[i] 个 logit 写入 target_logit（它只落在一个块里，各线程写不同的行）
+template <typename T>
+void linear_topk_(int64_t *out_idx, T *out_val, float *lse, const int64_t *target, float *target_logit,
+                  const T *in, const T *weight, size_t m, size_t kd, size_t n, size_t k) {
+    constexpr bool is_float = std::is_same_v<T, float>;
+    bool amx = false;
+    if constexpr (std::is_same_v<T, llaisys::bf16_t>) {
+        amx = llaisys::ops::cpu::linear_amx_supported(kd);
+    }
+    std::vector<uint32_t> packed;
+    std::vector<float> in_f32;
+    if (amx) {
+        if constexpr (std::is_same_v<T, llaisys::bf16_t>) {
+            packed = llaisys::ops::cpu::linear_amx_pack(in, m, kd);
+        }
+    } else if constexpr (!is_float) {
+        in_f32.resize(m * kd);
+        llaisys::device::cpu::to_f32(in_f32.data(), in, m * kd);
+    }
+    auto in_row = [&](size_t i) -> const float * {
+        if constexpr (is_float) {
+            return in + i * kd;
+        } else {
+            return in_f32.data() + i * kd;
+        }
+    };
+
+    std::mutex mutex;
+    std::vector<ChunkResult> chunks;
+    llaisys::device::cpu::parallel_for_rows(n, std::max<size_t>(1, kGrainMacs / std::max<size_t>(m * kd, 1)),
+                                            [&](size_t begin, size_t end) {
+        ChunkResult result{begin, {}, std::vector<float>(m, -std::numeric_limits<float>::infinity()),
+                           std::vector<double>(m, 0.0)};
+        std::vector<llaisys::device::cpu::TopkHeap> heaps(m, llaisys::device::cpu::TopkHeap(k));
+        std::vector<float> logits(m * kTile);
+        std::vector<float> w(is_float ? 0 : kd);
+        for (size_t j0 = begin; j0 < end; j0 += kTile) {
+            const size_t len = std::min(kTile, end - j0);
+            if (amx) {
+                if constexpr (std::is_same_v<T, llaisys::bf16_t>) {
+                    llaisys::ops::cpu::linear_amx_f32(logits.data(), kTile, packed, weight, m, kd, j0, j0 + len);
+                }
+            } else {
+                for (size_t j = j0; j < j0 + len; j++) {
+                    const float *w_row;
+                    if constexpr (is_float) {
+                        w_row = weight + j * kd;
+                    } else {
+                        llaisys::device::cpu::to_f32(w.data(), weight + j * kd, kd);
+                        w_row = w.data();
+                    }
+                    for (size_t i = 0; i < m; i++) {
+                        logits[i * kTile + (j - j0)] = llaisys::device::cpu::dot(in_row(i), w_row, kd);
+                    }
+                }
+            }
+            for (size_t i = 0; i < m; i++) {
+                float *row = logits.data() + i * kTile;
+                if constexpr (!is_float) {
+                    for (size_t l = 0; l < len; l++) {
+                        row[l] = llaisys::utils::cast<float>(llaisys::utils::cast<T>(row[l]));
+                    }
+                }
+                if (target != nullptr) {
+                    const auto t = static_cast<size_t>(target[i]);
+                    if (t >= j0 && t < j0 + len) {
+                        target_logit[i] = row[t - j0];
+                    }
+                }
+                float tile_max;
+                llaisys::device::cpu::argmax(row, len, &tile_max);
+                heaps[i].push(row, len, j0, tile_max);
+                if (lse == nullptr) {
+                    continue;
+                }
+                // 在线 logsumexp：最大值变大时先把已有的和缩放到新的基准上
+                if (tile_max > result.max[i]) {
+                    result.sum[i] *= std::exp(static_cast<double>(result.max[i]) - tile_max);
+                    result.max[i] = tile_max;
+                }
+                if (result.max[i] > -std::numeric_limits<float>::infinity()) {
+                    for (size_t l = 0; l < len; l++) {
+                        if (!std::isnan(row[l])) {
+                            result.sum[i] += std::exp(row[l] - result.max[i]);
+                        }
+                    }
+                }
+            }
+        }
+        for (auto &heap : heaps) {
+            result.entries.push_back(heap.entries());
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        chunks.push_back(std::move(result));
+    });
+    // 按块的起点合并，使 logsumexp 的求和顺序与线程调度无关
+    std::sort(chunks.begin(), chunks.end(), [](const ChunkResult &a, const ChunkResult &b) { return a.begin < b.begin; });
+    for (size_t i = 0; i < m; i++) {
+        std::vector<llaisys::device::cpu::TopkEntry> merged;
+        float max = -std::numeric_limits<float>::infinity();
+        for (const auto &c : chunks) {
+            merged.insert(merged.end(), c.entries[i].begin(), c.entries[i].end());
+            max = std::max(max, c.max[i]);
+        }
+        llaisys::device::cpu::topk_sort(merged, k);
+        for (size_t r = 0; r < k; r++) {
+            out_idx[i * k + r] = static_cast<int64_t>(merged[r].idx);
+            out_val[i * k + r] = llaisys::utils::cast<T>(merged[r].key);
+        }
+        if (lse != nullptr) {
+            double sum = 0.0;
+            if (max > -std::numeric_limits<float>::infinity()) {
+                for (const auto &c : chunks) {
+                    sum += c.sum[i] * std::exp(static_cast<double>(c.max[i]) - max);
+                }
+            }
+            lse[i] = sum > 0.0 ? max + static_cast<float>(std::log(sum)) : max;
+        }
+    }
+}
+} // namespace
+
+namespace llaisys::ops::cpu {
+void linear_topk(tensor_t out_idx, tensor_t out_val, tensor_t lse, tensor_t in, tensor_t weight) {
+    const size_t m = in->shape()[0];
+    const size_t kd = in->shape()[1];
+    const size_t n = weight->shape()[0];
+    const size_t k = out_idx->shape()[1];
+    auto *idx = reinterpret_cast<int64_t *>(out_idx->data());
+    auto *lse_data = lse ? reinterpret_cast<float *>(lse->data()) : nullptr;
+    switch (in->dtype()) {
+    case LLAISYS_DTYPE_F32:
+        return linear_topk_(idx, reinterpret_cast<float *>(out_val->data()), lse_data, nullptr, nullptr,
+                            reinterpret_cast<const float *>(in->data()),
+                            reinterpret_cast<const float *>(weight->data()), m, kd, n, k);
+    case LLAISYS_DTYPE_BF16:
+        return linear_topk_(idx, reinterpret_cast<llaisys::bf16_t *>(out_val->data()), lse_data, nullptr, nullptr,
+                            reinterpret_cast<const llaisys::bf16_t *>(in->data()),
+                            reinterpret_cast<const llaisys::bf16_t *>(weight->data()), m, kd, n, k);
+    case LLAISYS_DTYPE_F16:
+        return linear_topk_(idx, reinterpret_cast<llaisys::fp16_t *>(out_val->data()), lse_data, nullptr, nullptr,
+                            reinterpret_cast<const llaisys::fp16_t *>(in->data()),
+                            reinterpret_cast<const llaisys::fp16_t *>(weight->data()), m, kd, n, k);
+    default:
+        EXCEPTION_UNSUPPORTED_DATATYPE(in->dtype());
+    }
+}
+
+// 复用 linear_topk 的分块与在线 logsumexp，k = 1 的候选只是附带结果
+void linear_logprob(tensor_t out, tensor_t in, tensor_t weight, tensor_t target) {
+    const size_t m = in->shape()[0];
+    const size_t kd = in->shape()[1];
+    const size_t n = weight->shape()[0];
+    const auto *target_data = reinterpret_cast<const int64_t *>(target->data());
+    for (size_t i = 0; i < m; i++) {
+        ASSERT(target_data[i] >= 0 && static_cast<size_t>(target_data[i]) < n, "LinearLogprob: target out of range");
+    }
+    std::vector<int64_t> idx(m);
+    std::vector<float> lse(m);
+    std::vector<float> target_logit(m);
+    switch (in->dtype()) {
+    case LLAISYS_DTYPE_F32: {
+        std::vector<float> val(m);
+        linear_topk_(idx.data(), val.data(), lse.data(), target_data, target_logit.data(),
+                     reinterpret_cast<const float *>(in->data()),
+                     reinterpret_cast<const float *>(weight->data()), m, kd, n, 1);
+        break;
+    }
+    case LLAISYS_DTYPE_BF16: {
+        std::vector<llaisys::bf16_t> val(m);
+        linear_topk_(idx.data(), val.data(), lse.data(), target_data, target_logit.data(),
+                     reinterpret_cast<const llaisys::bf16_t *>(in->data()),
+                     reinterpret_cast<const llaisys::bf16_t *>(weight->data()), m, kd, n, 1);
+        break;
+    }
+    case LLAISYS_DTYPE_F16: {
+        std::vector<llaisys::fp16_t> val(m);
+        linear_topk_(idx.data(), val.data(), lse.data(), target_data, target_logit.data(),
+                     reinterpret_cast<const llaisys::fp16_t *>(in->data()),
+                     reinterpret_cast<const llaisys::fp16_t *>(weight->data()), m, kd, n, 1);
+        break;
+    }
+    default:
+        EXCEPTION_UNSUPPORTED_DATATYPE(in->dtype());
+    }
+    auto *out_data = reinterpret_cast<float *>(out->data());
+    for (size_t i = 0; i < m; i++) {
+        out_data[i] = target_logit[i] - lse[i];
+    }
+}
+} // namespace llaisys::ops::cpu
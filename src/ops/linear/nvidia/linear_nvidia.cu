@@ -119,7 +119,6 @@ void linear_cublaslt_impl(tensor_t out, tensor_t in, tensor_t weight, tensor_t b
 
 void linear(tensor_t out, tensor_t in, tensor_t weight, tensor_t bias) {
     llaisys::core::context().setDevice(LLAISYS_DEVICE_NVIDIA, out->deviceId());
-    auto &runtime = llaisys::core::context().runtime();
     if (bias != nullptr) {
         ASSERT(bias->numel() == out->shape()[1],
                "Linear(NVIDIA): bias numel must equal out.shape[1]");
@@ -137,6 +136,5 @@ void linear(tensor_t out, tensor_t in, tensor_t weight, tensor_t bias) {
     default:
         EXCEPTION_UNSUPPORTED_DATATYPE(out->dtype());
     }
-    runtime.api()->stream_synchronize(runtime.stream());
 }
 } // namespace llaisys::ops::nvidia
@@ -0,0 +1,125 @@
+#include "linear_nvidia.cuh"
+
+#include "../../../core/llaisys_core.hpp"
+#include "../../../utils.hpp"
+#include "../../topk/nvidia/topk_nvidia.cuh"
+
+#include <cuda_bf16.h>
+#include <cuda_fp16.h>
+#include <cuda_runtime.h>
+#include <math_constants.h>
+
+namespace llaisys::ops::nvidia {
+namespace {
+constexpr int kThreads = 256;
+
+template <typename T>
+__device__ float to_float_val(T val);
+
+template <>
+__device__ float to_float_val<float>(float val) { return val; }
+
+template <>
+__device__ float to_float_val<__half>(__half val) { return __half2float(val); }
+
+template <>
+__device__ float to_float_val<__nv_bfloat16>(__nv_bfloat16 val) { return __bfloat162float(val); }
+
+__device__ __forceinline__ void merge_lse(float &max, float &sum, float other_max, float other_sum) {
+    if (other_max > max) {
+        sum = sum * __expf(max - other_max) + other_sum;
+        max = other_max;
+    } else if (other_max > -CUDART_INF_F) {
+        sum += other_sum * __expf(other_max - max);
+    }
+}
+
+// 每个 block 处理一行：各线程先求局部 (max, Σ exp(x - max))，再在 warp 内、warp 间合并。
+// target 不为空时写出 log-softmax 在 target 处的值而不是 logsumexp
+template <typename T>
+__global__ void logsumexp_kernel(float *lse, const T *logits, size_t n, const int64_t *target) {
+    __shared__ float s_max[32];
+    __shared__ float s_sum[32];
+    const T *row = logits + blockIdx.x * n;
+    float max = -CUDART_INF_F;
+    float sum = 0.0f;
+    for (size_t j = threadIdx.x; j < n; j += blockDim.x) {
+        float v = to_float_val(row[j]);
+        if (!isnan(v)) {
+            merge_lse(max, sum, v, 1.0f);
+        }
+    }
+    for (int offset = 16; offset > 0; offset >>= 1) {
+        merge_lse(max, sum, __shfl_down_sync(0xffffffff, max, offset), __shfl_down_sync(0xffffffff, sum, offset));
+    }
+    const int lane = threadIdx.x & 31;
+    const int wid = threadIdx.x >> 5;
+    if (lane == 0) {
+        s_max[wid] = max;
+        s_sum[wid] = sum;
+    }
+    __syncthreads();
+    if (wid == 0) {
+        const int warps = (blockDim.x + 31) / 32;
+        max = lane < warps ? s_max[lane] : -CUDART_INF_F;
+        sum = lane < warps ? s_sum[lane] : 0.0f;
+        for (int offset = 16; offset > 0; offset >>= 1) {
+            merge_lse(max, sum, __shfl_down_sync(0xffffffff, max, offset), __shfl_down_sync(0xffffffff, sum, offset));
+        }
+        if (lane == 0) {
+            const float log_z = sum > 0.0f ? max + logf(sum) : max;
+            lse[blockIdx.x] = target ? to_float_val(row[target[blockIdx.x]]) - log_z : log_z;
+        }
+    }
+}
+
+// logits [m, n] 每行一个 block，结果写入 F32 的 out [m]
+void launch_logsumexp(tensor_t out, tensor_t logits, const int64_t *target) {
+    const size_t m = logits->shape()[0];
+    const size_t n = logits->shape()[1];
+    auto stream = reinterpret_cast<cudaStream_t>(llaisys::core::context().runtime().stream());
+    auto *out_ptr = reinterpret_cast<float *>(out->data());
+    switch (logits->dtype()) {
+    case LLAISYS_DTYPE_F32:
+        logsumexp_kernel<<<static_cast<unsigned int>(m), kThreads, 0, stream>>>(
+            out_ptr, reinterpret_cast<const float *>(logits->data()), n, target);
+        break;
+    case LLAISYS_DTYPE_BF16:
+        logsumexp_kernel<<<static_cast<unsigned int>(m), kThreads, 0, stream>>>(
+            out_ptr, reinterpret_cast<const __nv_bfloat16 *>(logits->data()), n, target);
+        break;
+    case LLAISYS_DTYPE_F16:
+        logsumexp_kernel<<<static_cast<unsigned int>(m), kThreads, 0, stream>>>(
+            out_ptr, reinterpret_cast<const __half *>(logits->data()), n, target);
+        break;
+    default:
+        EXCEPTION_UNSUPPORTED_DATATYPE(logits->dtype());
+    }
+}
+} // namespace
+
+// GPU 上 lm_head 由 cuBLAS 一次算完整块 logits 效率最高，这里先写到临时缓冲再选 top-k，
+// 调用方仍只拿到 [m, k] 的结果，不需要把 logits 拷回主机
+void linear_topk(tensor_t out_idx, tensor_t out_val, tensor_t lse, tensor_t in, tensor_t weight) {
+    llaisys::core::context().setDevice(LLAISYS_DEVICE_NVIDIA, in->deviceId());
+    const size_t m = in->shape()[0];
+    const size_t n = weight->shape()[0];
+    tensor_t logits = Tensor::create({m, n}, in->dtype(), LLAISYS_DEVICE_NVIDIA, in->deviceId());
+    linear(logits, in, weight, nullptr);
+    topk(out_idx, out_val, logits);
+    if (lse == nullptr) {
+        return;
+    }
+    launch_logsumexp(lse, logits, nullptr);
+}
+
+// 打分同样先由 cuBLAS 写出这一块的 logits，再逐行求 log-softmax 并取 target 处的值；块长由调用方控制
+void linear_logprob(tensor_t out, tensor_t in, tensor_t weight, tensor_t target) {
+    llaisys::core::context().setDevice(LLAISYS_DEVICE_NVIDIA, in->deviceId());
+    const size_t m = in->shape()[0];
+    const size_t n = weight->shape()[0];
+    tensor_t logits = Tensor::create({m, n}, in->dtype(), LLAISYS_DEVICE_NVIDIA, in->deviceId());
+    linear(logits, in, weight, nullptr);
+    launch_logsumexp(out, logits, reinterpret_cast<const int64_t *>(target->data()));
+}
+} // namespace llaisys::ops::nvidia
@@ -1,5 +1,6 @@
 
 #include "op.hpp"
+#include "../../device/cpu/cpu_launch.hpp"
 #include "./cpu/linear_cpu.hpp"
 #ifdef ENABLE_NVIDIA_API
 #include "./nvidia/linear_nvidia.cuh"
@@ -27,7 +28,7 @@ void linear(tensor_t out, tensor_t in, tensor_t weight, tensor_t bias) {
     ASSERT(in->shape()[0] == out->shape()[0] && in->shape()[1] == weight->shape()[1] && weight->shape()[0] == out->shape()[1],
            "Invalid shape number");
     if (out->deviceType() == LLAISYS_DEVICE_CPU) {
-        return llaisys::ops::cpu::linear(out, in, weight, bias);
+        return device::cpu::launch([=] { llaisys::ops::cpu::linear(out, in, weight, bias); });
     }
 #ifdef ENABLE_NVIDIA_API
     if (out->deviceType() == LLAISYS_DEVICE_NVIDIA) {
@@ -36,4 +37,53 @@ void linear(tensor_t out, tensor_t in, tensor_t weight, tensor_t bias) {
 #endif
     EXCEPTION_UNSUPPORTED_DEVICE;
 }
+
+void linear_topk(tensor_t out_idx, tensor_t out_val, tensor_t lse, tensor_t in, tensor_t weight) {
+    CHECK_SAME_DEVICE(out_idx, out_val, in, weight);
+    CHECK_SAME_DTYPE(out_val->dtype(), in->dtype(), weight->dtype());
+    ASSERT(out_idx->dtype() == LLAISYS_DTYPE_I64, "LinearTopk: data type of out_idx must be LLAISYS_DTYPE_I64");
+    ASSERT(in->ndim() == 2 && weight->ndim() == 2 && out_idx->ndim() == 2, "LinearTopk: Invalid shape size");
+    CHECK_SAME_SHAPE(out_idx->shape(), out_val->shape());
+    ASSERT(in->shape()[1] == weight->shape()[1] && out_idx->shape()[0] == in->shape()[0],
+           "LinearTopk: Invalid shape number");
+    ASSERT(out_idx->shape()[1] > 0 && out_idx->shape()[1] <= weight->shape()[0], "LinearTopk: k must be in [1, n]");
+    ASSERT(in->isContiguous() && weight->isContiguous() && out_idx->isContiguous() && out_val->isContiguous(),
+           "LinearTopk: all tensors must be contiguous");
+    if (lse) {
+        CHECK_SAME_DEVICE(lse, in);
+        ASSERT(lse->dtype() == LLAISYS_DTYPE_F32 && lse->numel() == in->shape()[0] && lse->isContiguous(),
+               "LinearTopk: lse must be a contiguous F32 tensor with one element per row");
+    }
+    if (in->deviceType() == LLAISYS_DEVICE_CPU) {
+        return device::cpu::launch([=] { llaisys::ops::cpu::linear_topk(out_idx, out_val, lse, in, weight); });
+    }
+#ifdef ENABLE_NVIDIA_API
+    if (in->deviceType() == LLAISYS_DEVICE_NVIDIA) {
+        return nvidia::linear_topk(out_idx, out_val, lse, in, weight);
+    }
+#endif
+    EXCEPTION_UNSUPPORTED_DEVICE;
+}
+
+void linear_logprob(tensor_t out, tensor_t in, tensor_t weight, tensor_t target) {
+    CHECK_SAME_DEVICE(out, in, weight, target);
+    CHECK_SAME_DTYPE(in->dtype(), weight->dtype());
+    ASSERT(out->dtype() == LLAISYS_DTYPE_F32, "LinearLogprob: data type of out must be LLAISYS_DTYPE_F32");
+    ASSERT(target->dtype() == LLAISYS_DTYPE_I64, "LinearLogprob: data type of target must be LLAISYS_DTYPE_I64");
+    ASSERT(in->ndim() == 2 && weight->ndim() == 2, "LinearLogprob: Invalid shape size");
+    ASSERT(in->shape()[1] == weight->shape()[1] && out->numel() == in->shape()[0] &&
+               target->numel() == in->shape()[0],
+           "LinearLogprob: Invalid shape number");
+    ASSERT(in->isContiguous() && weight->isContiguous() && out->isContiguous() && target->isContiguous(),
+           "LinearLogprob: all tensors must be contiguous");
+    if (in->deviceType() == LLAISYS_DEVICE_CPU) {
+        return device::cpu::launch([=] { llaisys::ops::cpu::linear_logprob(out, in, weight, target); });
+    }
+#ifdef ENABLE_NVIDIA_API
+    if (in->deviceType() == LLAISYS_DEVICE_NVIDIA) {
+        return nvidia::linear_logprob(out, in, weight, target);
+    }
+#endif
+    EXCEPTION_UNSUPPORTED_DEVICE;
+}
 } // namespace llaisys::ops
@@ -4,4 +4,11 @@
 
 namespace llaisys::ops {
 void linear(tensor_t out, tensor_t in, tensor_t weight, tensor_t bias);
+// 输出头用的 linear + top-k：logits = in · weightᵀ（in [m, k_dim]、weight [n, k_dim]，按 in 的类型舍入）不写出，
+// 每行只给出最大的 k 个（out_idx 为 I64、out_val 与 in 同类型，均为 [m, k]，顺序与 ops::topk 相同）。
+// lse 可以为空，否则为 F32 [m]，写入每行的 log Σ exp(logits)，供计算 log-prob
+void linear_topk(tensor_t out_idx, tensor_t out_val, tensor_t lse, tensor_t in, tensor_t weight);
+// 打分用的 linear + log-softmax gather：out[i] = logits[i, target[i]] - log Σ exp(logits[i])，
+// logits 的计算与舍入同 linear_topk 且不写出。out 为 F32 [m]，target 为 I64 [m]
+void linear_logprob(tensor_t out, tensor_t in, tensor_t weight, tensor_t target);
 }
@@ -1,7 +1,9 @@
+#include "../../../device/cpu/cpu_thread_pool.hpp"
 #include "../../../tensor/tensor.hpp"
 #include "../../../utils.hpp"
 
 #include "matmul_cpu.hpp"
+#include <algorithm>
 #include <cmath>
 #include <cstring>
 #include <type_traits>
@@ -29,8 +31,11 @@ void transpose_matmul_(T *C, T *A, T *B,
          return;
      } */
 
-    for (size_t i = 0; i < m; ++i) {
-        for (size_t j = 0; j < n; ++j) {
+    llaisys::device::cpu::parallel_for(0, m * n, std::max<size_t>(1, (1 << 15) / std::max<size_t>(k, 1)),
+                                       [&](size_t begin, size_t end) {
+        for (size_t idx = begin; idx < end; ++idx) {
+            size_t i = idx / n;
+            size_t j = idx % n;
             size_t c_idx = i * c_s0 + j * c_s1;
             if constexpr (std::is_same_v<T, llaisys::bf16_t>
                           || std::is_same_v<T, llaisys::fp16_t>) {
@@ -52,7 +57,7 @@ void transpose_matmul_(T *C, T *A, T *B,
                 C[c_idx] = acc * scale;
             }
         }
-    }
+    });
 }
 
 namespace llaisys::ops::cpu {
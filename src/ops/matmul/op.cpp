@@ -1,4 +1,5 @@
 #include "op.hpp"
+#include "../../device/cpu/cpu_launch.hpp"
 #include "./cpu/matmul_cpu.hpp"
 #ifdef ENABLE_NVIDIA_API
 #include "./nvidia/matmul_nvidia.cuh"
@@ -17,7 +18,7 @@ void transpose_matmul(tensor_t c, tensor_t a, tensor_t b, float scale) {
                && b->shape()[0] == c->shape()[1],
            "Matmul: Invalid shape number");
     if (c->deviceType() == LLAISYS_DEVICE_CPU) {
-        return llaisys::ops::cpu::transpose_matmul(c, a, b, scale);
+        return device::cpu::launch([=] { llaisys::ops::cpu::transpose_matmul(c, a, b, scale); });
     }
 #ifdef ENABLE_NVIDIA_API
     if (c->deviceType() == LLAISYS_DEVICE_NVIDIA) {
@@ -2,11 +2,16 @@
 
 #include "add/op.hpp"
 #include "argmax/op.hpp"
+#include "bmm/op.hpp"
 #include "embedding/op.hpp"
+#include "kv_quant/op.hpp"
 #include "linear/op.hpp"
 #include "matmul/op.hpp"
+#include "paged_kv_scatter/op.hpp"
 #include "rearrange/op.hpp"
 #include "rms_norm/op.hpp"
 #include "rope/op.hpp"
+#include "rope_append_kv/op.hpp"
 #include "self_attention/op.hpp"
 #include "swiglu/op.hpp"
+#include "topk/op.hpp"
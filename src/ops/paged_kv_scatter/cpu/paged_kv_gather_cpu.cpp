@@ -0,0 +1,36 @@
+#include "paged_kv_scatter_cpu.hpp"
+
+#include "../../../device/cpu/cpu_thread_pool.hpp"
+#include "../../../utils.hpp"
+
+#include <cstring>
+
+namespace llaisys::ops::cpu {
+void paged_kv_gather(tensor_t k, tensor_t v, tensor_t paged_kv, tensor_t slot_mapping) {
+    size_t seq = k->shape()[0];
+    size_t nkvhead = k->shape()[1];
+    size_t d = k->shape()[2];
+    size_t num_pages = paged_kv->shape()[0];
+    size_t page_size = paged_kv->shape()[3];
+    size_t row_bytes = d * k->elementSize();
+    const std::byte *src = paged_kv->data();
+    std::byte *k_dst = k->data();
+    std::byte *v_dst = v->data();
+    const int64_t *slots = reinterpret_cast<const int64_t *>(slot_mapping->data());
+    llaisys::device::cpu::parallel_for(0, seq, 8, [&](size_t begin, size_t end) {
+        for (size_t t = begin; t < end; t++) {
+            ASSERT(slots[t] >= 0, "PagedKVGather: invalid slot");
+            size_t page = static_cast<size_t>(slots[t]) / page_size;
+            size_t offset = static_cast<size_t>(slots[t]) % page_size;
+            ASSERT(page < num_pages, "PagedKVGather: page index out of range");
+            for (size_t h = 0; h < nkvhead; h++) {
+                size_t dst = (t * nkvhead + h) * row_bytes;
+                size_t k_src = (((page * 2 + 0) * nkvhead + h) * page_size + offset) * row_bytes;
+                size_t v_src = (((page * 2 + 1) * nkvhead + h) * page_size + offset) * row_bytes;
+                std::memcpy(k_dst + dst, src + k_src, row_bytes);
+                std::memcpy(v_dst + dst, src + v_src, row_bytes);
+            }
+        }
+    });
+}
+} // namespace llaisys::ops::cpu
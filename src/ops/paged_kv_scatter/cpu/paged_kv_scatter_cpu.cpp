@@ -0,0 +1,36 @@
+#include "paged_kv_scatter_cpu.hpp"
+
+#include "../../../device/cpu/cpu_thread_pool.hpp"
+#include "../../../utils.hpp"
+
+#include <cstring>
+
+namespace llaisys::ops::cpu {
+void paged_kv_scatter(tensor_t paged_kv, tensor_t k, tensor_t v, tensor_t slot_mapping) {
+    size_t seq = k->shape()[0];
+    size_t nkvhead = k->shape()[1];
+    size_t d = k->shape()[2];
+    size_t num_pages = paged_kv->shape()[0];
+    size_t page_size = paged_kv->shape()[3];
+    size_t row_bytes = d * k->elementSize();
+    std::byte *dst = paged_kv->data();
+    const std::byte *k_src = k->data();
+    const std::byte *v_src = v->data();
+    const int64_t *slots = reinterpret_cast<const int64_t *>(slot_mapping->data());
+    llaisys::device::cpu::parallel_for(0, seq, 8, [&](size_t begin, size_t end) {
+        for (size_t t = begin; t < end; t++) {
+            ASSERT(slots[t] >= 0, "PagedKVScatter: invalid slot");
+            size_t page = static_cast<size_t>(slots[t]) / page_size;
+            size_t offset = static_cast<size_t>(slots[t]) % page_size;
+            ASSERT(page < num_pages, "PagedKVScatter: page index out of range");
+            for (size_t h = 0; h < nkvhead; h++) {
+                size_t src = (t * nkvhead + h) * row_bytes;
+                size_t k_dst = (((page * 2 + 0) * nkvhead + h) * page_size + offset) * row_bytes;
+                size_t v_dst = (((page * 2 + 1) * nkvhead + h) * page_size + offset) * row_bytes;
+                std::memcpy(dst + k_dst, k_src + src, row_bytes);
+                std::memcpy(dst + v_dst, v_src + src, row_bytes);
+            }
+        }
+    });
+}
+} // namespace llaisys::ops::cpu
@@ -0,0 +1,68 @@
+#include "paged_kv_scatter_nvidia.cuh"
+
+#include "../../../core/llaisys_core.hpp"
+#include "../../../utils.hpp"
+
+#include <cuda_runtime.h>
+
+namespace llaisys::ops::nvidia {
+
+namespace {
+// grid (seq, nkvhead)：一个 block 搬运一个 (token, head) 的 K 行与 V 行，按 4 字节为单位拷贝
+template <typename W>
+__global__ void paged_kv_scatter_kernel(W *paged_kv,
+                                        const W *k,
+                                        const W *v,
+                                        const int64_t *slots,
+                                        int nkvhead,
+                                        int page_size,
+                                        int row_words) {
+    const int t = static_cast<int>(blockIdx.x);
+    const int h = static_cast<int>(blockIdx.y);
+    const int64_t slot = slots[t];
+    const size_t page = static_cast<size_t>(slot / page_size);
+    const size_t offset = static_cast<size_t>(slot % page_size);
+    const size_t src = (static_cast<size_t>(t) * nkvhead + h) * row_words;
+    const size_t k_dst = (((page * 2 + 0) * nkvhead + h) * page_size + offset) * row_words;
+    const size_t v_dst = (((page * 2 + 1) * nkvhead + h) * page_size + offset) * row_words;
+    for (int i = static_cast<int>(threadIdx.x); i < row_words; i += blockDim.x) {
+        paged_kv[k_dst + i] = k[src + i];
+        paged_kv[v_dst + i] = v[src + i];
+    }
+}
+
+template <typename W>
+void launch_paged_kv_scatter(tensor_t paged_kv, tensor_t k, tensor_t v, tensor_t slot_mapping, int row_words,
+                             cudaStream_t stream) {
+    const int seq = static_cast<int>(k->shape()[0]);
+    const int nkvhead = static_cast<int>(k->shape()[1]);
+    const int block_size = row_words < 128 ? ((row_words + 31) / 32) * 32 : 128;
+    dim3 grid(static_cast<unsigned int>(seq), static_cast<unsigned int>(nkvhead), 1u);
+    paged_kv_scatter_kernel<W><<<grid, block_size, 0, stream>>>(
+        reinterpret_cast<W *>(paged_kv->data()),
+        reinterpret_cast<const W *>(k->data()),
+        reinterpret_cast<const W *>(v->data()),
+        reinterpret_cast<const int64_t *>(slot_mapping->data()),
+        nkvhead,
+        static_cast<int>(paged_kv->shape()[3]),
+        row_words);
+}
+} // namespace
+
+void paged_kv_scatter(tensor_t paged_kv, tensor_t k, tensor_t v, tensor_t slot_mapping) {
+    const int seq = static_cast<int>(k->shape()[0]);
+    const size_t row_bytes = k->shape()[2] * k->elementSize();
+    if (seq == 0 || k->shape()[1] == 0 || row_bytes == 0) {
+        return;
+    }
+    llaisys::core::context().setDevice(LLAISYS_DEVICE_NVIDIA, k->deviceId());
+    auto cu_stream = reinterpret_cast<cudaStream_t>(llaisys::core::context().runtime().stream());
+    if (row_bytes % sizeof(uint32_t) == 0) {
+        launch_paged_kv_scatter<uint32_t>(paged_kv, k, v, slot_mapping,
+                                          static_cast<int>(row_bytes / sizeof(uint32_t)), cu_stream);
+    } else {
+        launch_paged_kv_scatter<uint16_t>(paged_kv, k, v, slot_mapping,
+                                          static_cast<int>(row_bytes / sizeof(uint16_t)), cu_stream);
+    }
+}
+} // namespace llaisys::ops::nvidia
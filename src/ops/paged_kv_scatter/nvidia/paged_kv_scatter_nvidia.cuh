@@ -0,0 +1,8 @@
+#pragma once
+
+#include "../../../tensor/tensor.hpp"
+
+namespace llaisys::ops::nvidia {
+void paged_kv_scatter(tensor_t paged_kv, tensor_t k, tensor_t v, tensor_t slot_mapping);
+void paged_kv_gather(tensor_t k, tensor_t v, tensor_t paged_kv, tensor_t slot_mapping);
+}
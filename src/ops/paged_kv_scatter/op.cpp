@@ -0,0 +1,54 @@
+#include "op.hpp"
+#include "../../device/cpu/cpu_launch.hpp"
+#include "./cpu/paged_kv_scatter_cpu.hpp"
+#ifdef ENABLE_NVIDIA_API
+#include "./nvidia/paged_kv_scatter_nvidia.cuh"
+#endif
+
+namespace llaisys::ops {
+void paged_kv_scatter(tensor_t paged_kv, tensor_t k, tensor_t v, tensor_t slot_mapping) {
+    CHECK_SAME_DEVICE(paged_kv, k, v, slot_mapping);
+    CHECK_SAME_DTYPE(paged_kv->dtype(), k->dtype(), v->dtype());
+    CHECK_SAME_SHAPE(k->shape(), v->shape());
+    ASSERT(k->ndim() == 3, "PagedKVScatter: k/v must be [seq, nkvhead, d]");
+    ASSERT(paged_kv->ndim() == 5 && paged_kv->shape()[1] == 2 && paged_kv->shape()[2] == k->shape()[1] &&
+               paged_kv->shape()[4] == k->shape()[2],
+           "PagedKVScatter: paged_kv must be [num_pages, 2, nkvhead, page_size, d]");
+    ASSERT(slot_mapping->dtype() == LLAISYS_DTYPE_I64 && slot_mapping->shape()[0] == k->shape()[0],
+           "PagedKVScatter: slot_mapping must be int64 [seq]");
+    ASSERT(paged_kv->isContiguous() && k->isContiguous() && v->isContiguous() && slot_mapping->isContiguous(),
+           "PagedKVScatter: inputs must be contiguous");
+    if (k->deviceType() == LLAISYS_DEVICE_CPU) {
+        return device::cpu::launch([=] { cpu::paged_kv_scatter(paged_kv, k, v, slot_mapping); });
+    }
+#ifdef ENABLE_NVIDIA_API
+    if (k->deviceType() == LLAISYS_DEVICE_NVIDIA) {
+        return nvidia::paged_kv_scatter(paged_kv, k, v, slot_mapping);
+    }
+#endif
+    EXCEPTION_UNSUPPORTED_DEVICE;
+}
+
+void paged_kv_gather(tensor_t k, tensor_t v, tensor_t paged_kv, tensor_t slot_mapping) {
+    CHECK_SAME_DEVICE(k, v, paged_kv, slot_mapping);
+    CHECK_SAME_DTYPE(paged_kv->dtype(), k->dtype(), v->dtype());
+    CHECK_SAME_SHAPE(k->shape(), v->shape());
+    ASSERT(k->ndim() == 3, "PagedKVGather: k/v must be [seq, nkvhead, d]");
+    ASSERT(paged_kv->ndim() == 5 && paged_kv->shape()[1] == 2 && paged_kv->shape()[2] == k->shape()[1] &&
+               paged_kv->shape()[4] == k->shape()[2],
+           "PagedKVGather: paged_kv must be [num_pages, 2, nkvhead, page_size, d]");
+    ASSERT(slot_mapping->dtype() == LLAISYS_DTYPE_I64 && slot_mapping->shape()[0] == k->shape()[0],
+           "PagedKVGather: slot_mapping must be int64 [seq]");
+    ASSERT(paged_kv->isContiguous() && k->isContiguous() && v->isContiguous() && slot_mapping->isContiguous(),
+           "PagedKVGather: inputs must be contiguous");
+    if (k->deviceType() == LLAISYS_DEVICE_CPU) {
+        return device::cpu::launch([=] { cpu::paged_kv_gather(k, v, paged_kv, slot_mapping); });
+    }
+#ifdef ENABLE_NVIDIA_API
+    if (k->deviceType() == LLAISYS_DEVICE_NVIDIA) {
+        return nvidia::paged_kv_gather(k, v, paged_kv, slot_mapping);
+    }
+#endif
+    EXCEPTION_UNSUPPORTED_DEVICE;
+}
+} // namespace llaisys::ops
@@ -0,0 +1,12 @@
+#pragma once
+
+#include "../../tensor/tensor.hpp"
+
+namespace llaisys::ops {
+// 把 k/v: [seq, nkvhead, d] 一次写入分页缓存 paged_kv: [num_pages, 2, nkvhead, page_size, d]，
+// slot_mapping: [seq] (I64)，第 i 个 token 写入页 slot / page_size 的 slot % page_size 行
+void paged_kv_scatter(tensor_t paged_kv, tensor_t k, tensor_t v, tensor_t slot_mapping);
+// paged_kv_scatter 的逆操作：按 slot_mapping 从分页缓存读出 k/v: [seq, nkvhead, d]，
+// 供分页缓存上的续接 prefill 把已有的页拼成连续的 K/V
+void paged_kv_gather(tensor_t k, tensor_t v, tensor_t paged_kv, tensor_t slot_mapping);
+} // namespace llaisys::ops
@@ -1,5 +1,8 @@
 #include "rearrange_cpu.hpp"
 
+#include "../../../device/cpu/cpu_thread_pool.hpp"
+
+#include <algorithm>
 #include <cstring>
 #include <functional>
 
@@ -35,6 +38,24 @@ void rearrange(tensor_t out, tensor_t in) {
                     dim + 1);
         }
     };
-    copy_nd(in->data(), out->data(), 0);
+    if (shape.empty()) {
+        return;
+    }
+    // 最外层维度各切片互不重叠，按其并行；一维时按元素分块
+    const std::byte *src = in->data();
+    std::byte *dst = out->data();
+    const size_t inner = in->numel() / std::max<size_t>(shape[0], 1);
+    llaisys::device::cpu::parallel_for(0, shape[0], std::max<size_t>(1, 4096 / std::max<size_t>(inner, 1)),
+                                       [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const std::byte *s = src + i * src_strides[0] * elem_size;
+            std::byte *d = dst + i * dst_strides[0] * elem_size;
+            if (shape.size() == 1) {
+                std::memcpy(d, s, elem_size);
+            } else {
+                copy_nd(s, d, 1);
+            }
+        }
+    });
 }
 } // namespace llaisys::ops::cpu
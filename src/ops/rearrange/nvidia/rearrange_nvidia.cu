@@ -99,7 +99,5 @@ namespace llaisys::ops::nvidia {
         } else {
             ASSERT(false, "rearrange: unsupported element size");
         }
-    
-        runtime.api()->stream_synchronize(runtime.stream());
     }
     } // namespace llaisys::ops::nvidia
\ No newline at end of file
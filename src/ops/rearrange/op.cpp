@@ -1,4 +1,5 @@
 #include "op.hpp"
+#include "../../device/cpu/cpu_launch.hpp"
 #include "./cpu/rearrange_cpu.hpp"
 #ifdef ENABLE_NVIDIA_API
 #include "./nvidia/rearrange_nvidia.cuh"
@@ -10,7 +11,7 @@ void rearrange(tensor_t out, tensor_t in) {
     CHECK_SAME_DTYPE(out->dtype(), in->dtype());
     CHECK_SAME_SHAPE(out->shape(), in->shape());
     if (in->deviceType() == LLAISYS_DEVICE_CPU) {
-        return llaisys::ops::cpu::rearrange(out, in);
+        return device::cpu::launch([=] { llaisys::ops::cpu::rearrange(out, in); });
     }
 #ifdef ENABLE_NVIDIA_API
     if (in->deviceType() == LLAISYS_DEVICE_NVIDIA) {
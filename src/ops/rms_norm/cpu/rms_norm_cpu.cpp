@@ -1,7 +1,11 @@
 #include "rms_norm_cpu.hpp"
+#include "../../../device/cpu/cpu_convert.hpp"
+#include "../../../device/cpu/cpu_kernels.hpp"
+#include "../../../device/cpu/cpu_thread_pool.hpp"
 #include "../../../tensor/tensor.hpp"
 #include "../../../utils.hpp"
 
+#include <algorithm>
 #include <cmath>
 #include <cstring>
 
@@ -10,30 +14,36 @@ void rms_norm_(T *out_data, T *in_data, T *weight_data,
                float eps, const std::vector<size_t> &shape) {
     size_t m = shape[0]; // 行维度
     size_t n = shape[1]; // 列维度
-    for (size_t i = 0; i < m; i++) {
-        // 先计算分母
-        float norm = 0.0f;
-        for (size_t j = 0; j < n; j++) {
-            if constexpr (std::is_same_v<T, llaisys::bf16_t>
-                          || std::is_same_v<T, llaisys::fp16_t>) {
-                norm += llaisys::utils::cast<float>(in_data[i * n + j])
-                      * llaisys::utils::cast<float>(in_data[i * n + j]);
-            } else {
-                norm += in_data[i * n + j] * in_data[i * n + j];
+    if constexpr (std::is_same_v<T, llaisys::bf16_t>
+                  || std::is_same_v<T, llaisys::fp16_t>) {
+        // 半精度：权重转换一次，每行成批转成 f32 计算后再成批写回
+        std::vector<float> weight(n);
+        llaisys::device::cpu::to_f32(weight.data(), weight_data, n);
+        llaisys::device::cpu::parallel_for(0, m, std::max<size_t>(1, 8192 / std::max<size_t>(n, 1)), [&](size_t begin, size_t end) {
+            std::vector<float> row(n);
+            for (size_t i = begin; i < end; i++) {
+                llaisys::device::cpu::to_f32(row.data(), in_data + i * n, n);
+                float norm = llaisys::device::cpu::dot(row.data(), row.data(), n);
+                norm = std::sqrt(norm / n + eps);
+                for (size_t j = 0; j < n; j++) {
+                    row[j] = weight[j] * row[j] / norm;
+                }
+                llaisys::device::cpu::from_f32(out_data + i * n, row.data(), n);
             }
-        }
-        norm = std::sqrt(norm / n + eps);
-        // 计算分子
-        for (size_t j = 0; j < n; j++) {
-            if constexpr (std::is_same_v<T, llaisys::bf16_t>
-                          || std::is_same_v<T, llaisys::fp16_t>) {
-                out_data[i * n + j] = llaisys::utils::cast<T>(
-                    llaisys::utils::cast<float>(weight_data[j])
-                    * llaisys::utils::cast<float>(in_data[i * n + j]) / norm);
-            } else {
-                out_data[i * n + j] = weight_data[j] * in_data[i * n + j] / norm;
+        });
+    } else {
+        // 各行互不依赖，按行并行
+        llaisys::device::cpu::parallel_for(0, m, std::max<size_t>(1, 8192 / std::max<size_t>(n, 1)), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                // 先计算分母
+                float norm = llaisys::device::cpu::dot(in_data + i * n, in_data + i * n, n);
+                norm = std::sqrt(norm / n + eps);
+                // 计算分子
+                for (size_t j = 0; j < n; j++) {
+                    out_data[i * n + j] = weight_data[j] * in_data[i * n + j] / norm;
+                }
             }
-        }
+        });
     }
 }
 
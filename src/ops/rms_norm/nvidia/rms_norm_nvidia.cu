@@ -286,7 +286,5 @@ void rms_norm(tensor_t out, tensor_t in, tensor_t weight, float eps) {
     default:
         EXCEPTION_UNSUPPORTED_DATATYPE(in->dtype());
     }
-
-    runtime.api()->stream_synchronize(runtime.stream());
 }
 } // namespace llaisys::ops::nvidia
@@ -1,4 +1,5 @@
 #include "op.hpp"
+#include "../../device/cpu/cpu_launch.hpp"
 #include "./cpu/rms_norm_cpu.hpp"
 #ifdef ENABLE_NVIDIA_API
 #include "./nvidia/rms_norm_nvidia.cuh"
@@ -12,7 +13,7 @@ void rms_norm(tensor_t out, tensor_t in, tensor_t weight, float eps) {
     ASSERT(eps > 0.0f, "Rms_norm: eps must larger than 0");
     ASSERT(out->shape() == in->shape() && weight->shape()[0] == in->shape()[1], "Rms_norm:Mismatch shape size");
     if (in->deviceType() == LLAISYS_DEVICE_CPU) {
-        return llaisys::ops::cpu::rms_norm(out, in, weight, eps);
+        return device::cpu::launch([=] { llaisys::ops::cpu::rms_norm(out, in, weight, eps); });
     }
 #ifdef ENABLE_NVIDIA_API
     if (in->deviceType() == LLAISYS_DEVICE_NVIDIA) {
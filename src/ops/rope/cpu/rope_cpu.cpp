@@ -1,49 +1,114 @@
-
 #include "rope_cpu.hpp"
 
+#include "../../../device/cpu/cpu_convert.hpp"
+#include "../../../device/cpu/cpu_thread_pool.hpp"
 #include "../../../tensor/tensor.hpp"
 #include "../../../utils.hpp"
 
 #include <cmath>
-#include <cstring>
+#include <type_traits>
+#include <vector>
 
+namespace {
+// 用同一行 cos/sin 旋转连续存放的 nhead 个头：[a, b] -> [a*c - b*s, b*c + a*s]。
+// 内层循环没有分支和超越函数，编译器可直接向量化；半精度先成批展开到 float 缓冲再计算
 template <typename T>
+void rotate_heads_(T *out, const T *in, const float *c, const float *s,
+                   size_t nhead, size_t d, float *xa, float *xb) {
+    size_t half = d / 2;
+    for (size_t h = 0; h < nhead; h++) {
+        const T *x = in + h * d;
+        T *y = out + h * d;
+        if constexpr (std::is_same_v<T, float>) {
+            for (size_t k = 0; k < half; k++) {
+                float a = x[k];
+                float b = x[k + half];
+                y[k] = a * c[k] - b * s[k];
+                y[k + half] = b * c[k] + a * s[k];
+            }
+        } else {
+            llaisys::device::cpu::to_f32(xa, x, half);
+            llaisys::device::cpu::to_f32(xb, x + half, half);
+            for (size_t k = 0; k < half; k++) {
+                float a = xa[k];
+                float b = xb[k];
+                xa[k] = a * c[k] - b * s[k];
+                xb[k] = b * c[k] + a * s[k];
+            }
+            llaisys::device::cpu::from_f32(y, xa, half);
+            llaisys::device::cpu::from_f32(y + half, xb, half);
+        }
+    }
+}
 
-void rope_(T *out_data, T *in_data, int64_t *pos_ids,
+// 现算版本：每个 token 只算一次 cos/sin，所有头共用。角度按 pos / theta^(2k/d) 计算（与原实现一致），
+// 改成乘以倒数会在大位置上多出一次舍入
+template <typename T>
+void rope_(T *out_data, const T *in_data, const int64_t *pos_ids,
            float theta, const std::vector<size_t> &shape, const std::vector<ptrdiff_t> &strides) {
     size_t seqlen = shape[0];
     size_t nhead = shape[1];
     size_t d = shape[2];
-    for (size_t i = 0; i < seqlen; i++) {
-        for (size_t j = 0; j < nhead; j++) {
-            size_t start_offset = i * static_cast<size_t>(strides[0]) + j * static_cast<size_t>(strides[1]);
-            for (size_t k = 0; k < d / 2; k++) {
-                size_t a_idx = start_offset + k;
-                size_t b_idx = start_offset + k + d / 2;
-                if constexpr (std::is_same_v<T, llaisys::bf16_t>
-                              || std::is_same_v<T, llaisys::fp16_t>) {
-                    float angle = pos_ids[i]
-                                / (std::pow(theta, 2.0f * k / d));
-                    float c = std::cos(angle);
-                    float s = std::sin(angle);
-                    out_data[a_idx] = llaisys::utils::cast<T>(llaisys::utils::cast<float>(in_data[a_idx]) * c
-                                                              - llaisys::utils::cast<float>(in_data[b_idx]) * s);
-                    out_data[b_idx] = llaisys::utils::cast<T>(llaisys::utils::cast<float>(in_data[b_idx]) * c
-                                                              + llaisys::utils::cast<float>(in_data[a_idx]) * s);
-                } else {
-                    float angle = pos_ids[i]
-                                / (std::pow(theta, 2.0f * k / d));
-                    float c = std::cos(angle);
-                    float s = std::sin(angle);
-                    out_data[a_idx] = in_data[a_idx] * c
-                                    - in_data[b_idx] * s;
-                    out_data[b_idx] = in_data[b_idx] * c
-                                    + in_data[a_idx] * s;
-                }
+    size_t half = d / 2;
+    std::vector<float> freq_div(half);
+    for (size_t k = 0; k < half; k++) {
+        freq_div[k] = std::pow(theta, 2.0f * k / d);
+    }
+    llaisys::device::cpu::parallel_for(0, seqlen, 1, [&](size_t begin, size_t end) {
+        std::vector<float> c(half), s(half), xa(half), xb(half);
+        for (size_t i = begin; i < end; i++) {
+            float pos = static_cast<float>(pos_ids[i]);
+            for (size_t k = 0; k < half; k++) {
+                float angle = pos / freq_div[k];
+                c[k] = std::cos(angle);
+                s[k] = std::sin(angle);
+            }
+            for (size_t j = 0; j < nhead; j++) {
+                size_t start_offset = i * static_cast<size_t>(strides[0]) + j * static_cast<size_t>(strides[1]);
+                rotate_heads_(out_data + start_offset, in_data + start_offset, c.data(), s.data(),
+                              1, d, xa.data(), xb.data());
+            }
+        }
+    });
+}
+
+// 查表版本：q、k 共用同一组 pos_ids 的表行，k 可为空
+template <typename T>
+void rope_table_(T *q_out, const T *q, size_t nhead, T *k_out, const T *k, size_t nkvhead,
+                 const int64_t *pos_ids, const float *cos, const float *sin, size_t seqlen, size_t d) {
+    size_t half = d / 2;
+    // 按 token 分块并行；单 token 解码时直接在调用线程执行
+    llaisys::device::cpu::parallel_for(0, seqlen, 4, [&](size_t begin, size_t end) {
+        std::vector<float> xa(half), xb(half);
+        for (size_t i = begin; i < end; i++) {
+            const float *c = cos + static_cast<size_t>(pos_ids[i]) * half;
+            const float *s = sin + static_cast<size_t>(pos_ids[i]) * half;
+            rotate_heads_(q_out + i * nhead * d, q + i * nhead * d, c, s, nhead, d, xa.data(), xb.data());
+            if (k != nullptr) {
+                rotate_heads_(k_out + i * nkvhead * d, k + i * nkvhead * d, c, s, nkvhead, d, xa.data(), xb.data());
             }
         }
+    });
+}
+
+template <typename T>
+void rope_table_dispatch(llaisys::tensor_t q_out, llaisys::tensor_t k_out, llaisys::tensor_t q, llaisys::tensor_t k,
+                         llaisys::tensor_t pos_ids, llaisys::tensor_t cos, llaisys::tensor_t sin) {
+    size_t seqlen = q->shape()[0];
+    size_t d = q->shape()[2];
+    size_t max_pos = cos->shape()[0];
+    const int64_t *pos = reinterpret_cast<const int64_t *>(pos_ids->data());
+    for (size_t i = 0; i < seqlen; i++) {
+        ASSERT(pos[i] >= 0 && static_cast<size_t>(pos[i]) < max_pos, "Rope: pos_ids out of rope table range");
     }
+    rope_table_(reinterpret_cast<T *>(q_out->data()), reinterpret_cast<const T *>(q->data()), q->shape()[1],
+                k ? reinterpret_cast<T *>(k_out->data()) : nullptr,
+                k ? reinterpret_cast<const T *>(k->data()) : nullptr,
+                k ? k->shape()[1] : 0,
+                pos, reinterpret_cast<const float *>(cos->data()), reinterpret_cast<const float *>(sin->data()),
+                seqlen, d);
 }
+} // namespace
 
 namespace llaisys::ops::cpu {
 void rope(tensor_t out, tensor_t in, tensor_t pos_ids, float theta) {
@@ -76,4 +141,21 @@ void rope(tensor_t out, tensor_t in, tensor_t pos_ids, float theta) {
         EXCEPTION_UNSUPPORTED_DATATYPE(in->dtype());
     }
 }
-} // namespace llaisys::ops::cpu
\ No newline at end of file
+
+void rope(tensor_t out, tensor_t in, tensor_t pos_ids, tensor_t cos, tensor_t sin) {
+    rope_qk(out, nullptr, in, nullptr, pos_ids, cos, sin);
+}
+
+void rope_qk(tensor_t q_out, tensor_t k_out, tensor_t q, tensor_t k, tensor_t pos_ids, tensor_t cos, tensor_t sin) {
+    switch (q->dtype()) {
+    case LLAISYS_DTYPE_BF16:
+        return rope_table_dispatch<llaisys::bf16_t>(q_out, k_out, q, k, pos_ids, cos, sin);
+    case LLAISYS_DTYPE_F16:
+        return rope_table_dispatch<llaisys::fp16_t>(q_out, k_out, q, k, pos_ids, cos, sin);
+    case LLAISYS_DTYPE_F32:
+        return rope_table_dispatch<float>(q_out, k_out, q, k, pos_ids, cos, sin);
+    default:
+        EXCEPTION_UNSUPPORTED_DATATYPE(q->dtype());
+    }
+}
+} // namespace llaisys::ops::cpu
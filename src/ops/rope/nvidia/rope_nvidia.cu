@@ -100,6 +100,82 @@ __global__ void rope_kernel_bf16(__nv_bfloat16 *out,
         out[idx_b] = __float2bfloat16_rn(b * c + a * s);
     }
 }
+
+__device__ __forceinline__ float rope_to_float(float x) { return x; }
+__device__ __forceinline__ float rope_to_float(__half x) { return __half2float(x); }
+__device__ __forceinline__ float rope_to_float(__nv_bfloat16 x) { return __bfloat162float(x); }
+
+template <typename T>
+__device__ __forceinline__ T rope_from_float(float x);
+template <>
+__device__ __forceinline__ float rope_from_float<float>(float x) { return x; }
+template <>
+__device__ __forceinline__ __half rope_from_float<__half>(float x) { return __float2half_rn(x); }
+template <>
+__device__ __forceinline__ __nv_bfloat16 rope_from_float<__nv_bfloat16>(float x) { return __float2bfloat16_rn(x); }
+
+// 查表版：grid (seq, nhead_q + nhead_k)，前 nhead_q 个 block 处理 q，其余处理 k
+template <typename T>
+__global__ void rope_table_kernel(T *q_out,
+                                  const T *q,
+                                  T *k_out,
+                                  const T *k,
+                                  const int64_t *pos_ids,
+                                  const float *cos_table,
+                                  const float *sin_table,
+                                  int nhead_q,
+                                  int nhead_k,
+                                  int half_d,
+                                  int d) {
+    const int seq = static_cast<int>(blockIdx.x);
+    int head = static_cast<int>(blockIdx.y);
+    T *out = q_out;
+    const T *in = q;
+    int nhead = nhead_q;
+    if (head >= nhead_q) {
+        head -= nhead_q;
+        out = k_out;
+        in = k;
+        nhead = nhead_k;
+    }
+    const int base = seq * (nhead * d) + head * d;
+    const float *c = cos_table + pos_ids[seq] * half_d;
+    const float *s = sin_table + pos_ids[seq] * half_d;
+
+    for (int i = static_cast<int>(threadIdx.x); i < half_d; i += blockDim.x) {
+        const float a = rope_to_float(in[base + i]);
+        const float b = rope_to_float(in[base + i + half_d]);
+        out[base + i] = rope_from_float<T>(a * c[i] - b * s[i]);
+        out[base + i + half_d] = rope_from_float<T>(b * c[i] + a * s[i]);
+    }
+}
+
+template <typename T>
+void launch_rope_table(tensor_t q_out, tensor_t k_out, tensor_t q, tensor_t k,
+                       tensor_t pos_ids, tensor_t cos, tensor_t sin, cudaStream_t stream) {
+    const int seqlen = static_cast<int>(q->shape()[0]);
+    const int nhead_q = static_cast<int>(q->shape()[1]);
+    const int nhead_k = k ? static_cast<int>(k->shape()[1]) : 0;
+    const int d = static_cast<int>(q->shape()[2]);
+    const int half_d = d / 2;
+    if (seqlen == 0 || half_d == 0) {
+        return;
+    }
+    // 半维不超过 128 时一个线程处理一对元素
+    const int block_size = half_d < 128 ? ((half_d + 31) / 32) * 32 : 128;
+    dim3 grid(static_cast<unsigned int>(seqlen),
+              static_cast<unsigned int>(nhead_q + nhead_k),
+              1u);
+    rope_table_kernel<T><<<grid, block_size, 0, stream>>>(
+        reinterpret_cast<T *>(q_out->data()),
+        reinterpret_cast<const T *>(q->data()),
+        k ? reinterpret_cast<T *>(k_out->data()) : nullptr,
+        k ? reinterpret_cast<const T *>(k->data()) : nullptr,
+        reinterpret_cast<const int64_t *>(pos_ids->data()),
+        reinterpret_cast<const float *>(cos->data()),
+        reinterpret_cast<const float *>(sin->data()),
+        nhead_q, nhead_k, half_d, d);
+}
 } // namespace
 
 void rope(tensor_t out, tensor_t in, tensor_t pos_ids, float theta) {
@@ -154,8 +230,29 @@ void rope(tensor_t out, tensor_t in, tensor_t pos_ids, float theta) {
     default:
         EXCEPTION_UNSUPPORTED_DATATYPE(in->dtype());
     }
+}
 
-    auto api = runtime.api();
-    api->stream_synchronize(stream);
+// 表在加载时构建，这里只做查表旋转，不再同步 stream
+void rope(tensor_t out, tensor_t in, tensor_t pos_ids, tensor_t cos, tensor_t sin) {
+    rope_qk(out, nullptr, in, nullptr, pos_ids, cos, sin);
+}
+
+void rope_qk(tensor_t q_out, tensor_t k_out, tensor_t q, tensor_t k, tensor_t pos_ids, tensor_t cos, tensor_t sin) {
+    llaisys::core::context().setDevice(LLAISYS_DEVICE_NVIDIA, q->deviceId());
+    auto cu_stream = reinterpret_cast<cudaStream_t>(llaisys::core::context().runtime().stream());
+
+    switch (q->dtype()) {
+    case LLAISYS_DTYPE_F32:
+        launch_rope_table<float>(q_out, k_out, q, k, pos_ids, cos, sin, cu_stream);
+        break;
+    case LLAISYS_DTYPE_F16:
+        launch_rope_table<__half>(q_out, k_out, q, k, pos_ids, cos, sin, cu_stream);
+        break;
+    case LLAISYS_DTYPE_BF16:
+        launch_rope_table<__nv_bfloat16>(q_out, k_out, q, k, pos_ids, cos, sin, cu_stream);
+        break;
+    default:
+        EXCEPTION_UNSUPPORTED_DATATYPE(q->dtype());
+    }
 }
-} // namespace llaisys::ops::nvidia
\ No newline at end of file
+} // namespace llaisys::ops::nvidia
@@ -4,4 +4,6 @@
 
 namespace llaisys::ops::nvidia {
 void rope(tensor_t out, tensor_t in, tensor_t pos_ids, float theta);
+void rope(tensor_t out, tensor_t in, tensor_t pos_ids, tensor_t cos, tensor_t sin);
+void rope_qk(tensor_t q_out, tensor_t k_out, tensor_t q, tensor_t k, tensor_t pos_ids, tensor_t cos, tensor_t sin);
 }
@@ -1,5 +1,8 @@
 #include "op.hpp"
+#include "../../device/cpu/cpu_launch.hpp"
 #include "./cpu/rope_cpu.hpp"
+#include <cmath>
+#include <vector>
 #ifdef ENABLE_NVIDIA_API
 #include "./nvidia/rope_nvidia.cuh"
 #endif
@@ -11,7 +14,7 @@ void rope(tensor_t out, tensor_t in, tensor_t pos_ids, float theta) {
     ASSERT(pos_ids->dtype() == LLAISYS_DTYPE_I64, "Rope: data type of pos_ids must be int64");
     ASSERT(pos_ids->shape()[0] == in->shape()[0], "Rope:Shape mismatch");
     if (in->deviceType() == LLAISYS_DEVICE_CPU) {
-        return llaisys::ops::cpu::rope(out, in, pos_ids, theta);
+        return device::cpu::launch([=] { llaisys::ops::cpu::rope(out, in, pos_ids, theta); });
     }
 #ifdef ENABLE_NVIDIA_API
     if (in->deviceType() == LLAISYS_DEVICE_NVIDIA) {
@@ -20,4 +23,83 @@ void rope(tensor_t out, tensor_t in, tensor_t pos_ids, float theta) {
 #endif
     EXCEPTION_UNSUPPORTED_DEVICE;
 }
+
+void rope_init_table(tensor_t cos, tensor_t sin, float theta) {
+    CHECK_SAME_DEVICE(cos, sin);
+    CHECK_SAME_SHAPE(cos->shape(), sin->shape());
+    ASSERT(cos->dtype() == LLAISYS_DTYPE_F32 && sin->dtype() == LLAISYS_DTYPE_F32,
+           "RopeInitTable: cos/sin must be float32");
+    ASSERT(cos->ndim() == 2 && cos->isContiguous() && sin->isContiguous(),
+           "RopeInitTable: cos/sin must be contiguous [max_pos, head_dim/2]");
+    ASSERT(theta > 0.0f, "RopeInitTable: theta must be positive");
+    size_t max_pos = cos->shape()[0];
+    size_t half = cos->shape()[1];
+    size_t d = 2 * half;
+    // 与 rope(theta) 的 CPU 实现使用同一组 float 运算，查表与现算结果一致
+    std::vector<float> inv_freq(half);
+    for (size_t k = 0; k < half; k++) {
+        inv_freq[k] = 1.0f / std::pow(theta, 2.0f * k / d);
+    }
+    std::vector<float> cos_host(max_pos * half);
+    std::vector<float> sin_host(max_pos * half);
+    for (size_t p = 0; p < max_pos; p++) {
+        for (size_t k = 0; k < half; k++) {
+            float angle = static_cast<float>(p) * inv_freq[k];
+            cos_host[p * half + k] = std::cos(angle);
+            sin_host[p * half + k] = std::sin(angle);
+        }
+    }
+    cos->load(cos_host.data());
+    sin->load(sin_host.data());
+}
+
+namespace {
+void check_rope_table(tensor_t x, tensor_t pos_ids, tensor_t cos, tensor_t sin) {
+    ASSERT(pos_ids->dtype() == LLAISYS_DTYPE_I64, "Rope: data type of pos_ids must be int64");
+    ASSERT(pos_ids->shape()[0] == x->shape()[0], "Rope: Shape mismatch");
+    ASSERT(x->ndim() == 3 && x->shape()[2] % 2 == 0, "Rope: input must be [seqlen, nhead, d] with even d");
+    ASSERT(cos->dtype() == LLAISYS_DTYPE_F32 && sin->dtype() == LLAISYS_DTYPE_F32,
+           "Rope: cos/sin table must be float32");
+    ASSERT(cos->ndim() == 2 && cos->shape()[1] * 2 == x->shape()[2], "Rope: cos/sin table must be [max_pos, d/2]");
+    CHECK_SAME_SHAPE(cos->shape(), sin->shape());
+    ASSERT(cos->isContiguous() && sin->isContiguous(), "Rope: cos/sin table must be contiguous");
+}
+} // namespace
+
+void rope(tensor_t out, tensor_t in, tensor_t pos_ids, tensor_t cos, tensor_t sin) {
+    CHECK_SAME_DEVICE(out, in, pos_ids, cos, sin);
+    CHECK_SAME_DTYPE(out->dtype(), in->dtype());
+    CHECK_SAME_SHAPE(out->shape(), in->shape());
+    check_rope_table(in, pos_ids, cos, sin);
+    ASSERT(out->isContiguous() && in->isContiguous(), "Rope: in/out must be contiguous");
+    if (in->deviceType() == LLAISYS_DEVICE_CPU) {
+        return device::cpu::launch([=] { cpu::rope(out, in, pos_ids, cos, sin); });
+    }
+#ifdef ENABLE_NVIDIA_API
+    if (in->deviceType() == LLAISYS_DEVICE_NVIDIA) {
+        return nvidia::rope(out, in, pos_ids, cos, sin);
+    }
+#endif
+    EXCEPTION_UNSUPPORTED_DEVICE;
+}
+
+void rope_qk(tensor_t q_out, tensor_t k_out, tensor_t q, tensor_t k, tensor_t pos_ids, tensor_t cos, tensor_t sin) {
+    CHECK_SAME_DEVICE(q_out, k_out, q, k, pos_ids, cos, sin);
+    CHECK_SAME_DTYPE(q_out->dtype(), k_out->dtype(), q->dtype(), k->dtype());
+    CHECK_SAME_SHAPE(q_out->shape(), q->shape());
+    CHECK_SAME_SHAPE(k_out->shape(), k->shape());
+    check_rope_table(q, pos_ids, cos, sin);
+    check_rope_table(k, pos_ids, cos, sin);
+    ASSERT(q_out->isContiguous() && k_out->isContiguous() && q->isContiguous() && k->isContiguous(),
+           "RopeQK: q/k must be contiguous");
+    if (q->deviceType() == LLAISYS_DEVICE_CPU) {
+        return device::cpu::launch([=] { cpu::rope_qk(q_out, k_out, q, k, pos_ids, cos, sin); });
+    }
+#ifdef ENABLE_NVIDIA_API
+    if (q->deviceType() == LLAISYS_DEVICE_NVIDIA) {
+        return nvidia::rope_qk(q_out, k_out, q, k, pos_ids, cos, sin);
+    }
+#endif
+    EXCEPTION_UNSUPPORTED_DEVICE;
+}
 } // namespace llaisys::ops
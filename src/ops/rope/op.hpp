@@ -4,4 +4,11 @@
 
 namespace llaisys::ops {
 void rope(tensor_t out, tensor_t in, tensor_t pos_ids, float theta);
-}
+// 预计算 rope 表：cos/sin 为 [max_pos, head_dim/2] 的 F32，
+// cos[p][k] = cos(p * theta^(-2k/head_dim))，在 host 上计算后拷到张量所在设备
+void rope_init_table(tensor_t cos, tensor_t sin, float theta);
+// 查表版 rope：按 pos_ids 取 cos/sin 行，pos_ids 必须小于表长
+void rope(tensor_t out, tensor_t in, tensor_t pos_ids, tensor_t cos, tensor_t sin);
+// 同一组 pos_ids 一次旋转 q:[seq, nhead, d] 与 k:[seq, nkvhead, d]
+void rope_qk(tensor_t q_out, tensor_t k_out, tensor_t q, tensor_t k, tensor_t pos_ids, tensor_t cos, tensor_t sin);
+} // namespace llaisys::ops
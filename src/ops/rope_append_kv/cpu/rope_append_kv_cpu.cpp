@@ -0,0 +1,126 @@
+#include "rope_append_kv_cpu.hpp"
+
+#include "../../../device/cpu/cpu_convert.hpp"
+#include "../../../device/cpu/cpu_thread_pool.hpp"
+#include "../../../utils.hpp"
+
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace {
+// dst_row(t, h) 给出第 t 个 token、第 h 个头在缓存中的 K/V 目标行，K 旋转后写入，V 原样拷贝
+template <typename T, typename DstRow>
+void rope_append_kv_(const T *k, const T *v, const int64_t *pos_ids, const float *cos, const float *sin,
+                     size_t max_pos, size_t seqlen, size_t nkvhead, size_t d, DstRow dst_row) {
+    size_t half = d / 2;
+    // 各 token 的目标行互不重叠，按 token 分块并行
+    llaisys::device::cpu::parallel_for(0, seqlen, 1, [&](size_t begin, size_t end) {
+        std::vector<float> xa(half), xb(half);
+        for (size_t t = begin; t < end; t++) {
+            ASSERT(pos_ids[t] >= 0 && static_cast<size_t>(pos_ids[t]) < max_pos,
+                   "RopeAppendKV: pos_ids out of rope table range");
+            const float *c = cos + static_cast<size_t>(pos_ids[t]) * half;
+            const float *s = sin + static_cast<size_t>(pos_ids[t]) * half;
+            for (size_t h = 0; h < nkvhead; h++) {
+                const T *x = k + (t * nkvhead + h) * d;
+                T *k_dst;
+                T *v_dst;
+                dst_row(t, h, k_dst, v_dst);
+                if constexpr (std::is_same_v<T, float>) {
+                    for (size_t i = 0; i < half; i++) {
+                        float a = x[i];
+                        float b = x[i + half];
+                        k_dst[i] = a * c[i] - b * s[i];
+                        k_dst[i + half] = b * c[i] + a * s[i];
+                    }
+                } else {
+                    llaisys::device::cpu::to_f32(xa.data(), x, half);
+                    llaisys::device::cpu::to_f32(xb.data(), x + half, half);
+                    for (size_t i = 0; i < half; i++) {
+                        float a = xa[i];
+                        float b = xb[i];
+                        xa[i] = a * c[i] - b * s[i];
+                        xb[i] = b * c[i] + a * s[i];
+                    }
+                    llaisys::device::cpu::from_f32(k_dst, xa.data(), half);
+                    llaisys::device::cpu::from_f32(k_dst + half, xb.data(), half);
+                }
+                std::memcpy(v_dst, v + (t * nkvhead + h) * d, d * sizeof(T));
+            }
+        }
+    });
+}
+
+template <typename T>
+void rope_append_kv_slab(llaisys::tensor_t k_cache, llaisys::tensor_t v_cache, llaisys::tensor_t k,
+                         llaisys::tensor_t v, llaisys::tensor_t pos_ids, llaisys::tensor_t cos,
+                         llaisys::tensor_t sin) {
+    size_t nkvhead = k->shape()[1];
+    size_t d = k->shape()[2];
+    T *k_base = reinterpret_cast<T *>(k_cache->data());
+    T *v_base = reinterpret_cast<T *>(v_cache->data());
+    rope_append_kv_(reinterpret_cast<const T *>(k->data()), reinterpret_cast<const T *>(v->data()),
+                    reinterpret_cast<const int64_t *>(pos_ids->data()),
+                    reinterpret_cast<const float *>(cos->data()), reinterpret_cast<const float *>(sin->data()),
+                    cos->shape()[0], k->shape()[0], nkvhead, d,
+                    [&](size_t t, size_t h, T *&k_dst, T *&v_dst) {
+                        k_dst = k_base + (t * nkvhead + h) * d;
+                        v_dst = v_base + (t * nkvhead + h) * d;
+                    });
+}
+
+template <typename T>
+void rope_append_kv_pages(llaisys::tensor_t paged_kv, llaisys::tensor_t k, llaisys::tensor_t v,
+                          llaisys::tensor_t pos_ids, llaisys::tensor_t cos, llaisys::tensor_t sin,
+                          llaisys::tensor_t slot_mapping) {
+    size_t num_pages = paged_kv->shape()[0];
+    size_t nkvhead = k->shape()[1];
+    size_t page_size = paged_kv->shape()[3];
+    size_t d = k->shape()[2];
+    T *base = reinterpret_cast<T *>(paged_kv->data());
+    const int64_t *slots = reinterpret_cast<const int64_t *>(slot_mapping->data());
+    rope_append_kv_(reinterpret_cast<const T *>(k->data()), reinterpret_cast<const T *>(v->data()),
+                    reinterpret_cast<const int64_t *>(pos_ids->data()),
+                    reinterpret_cast<const float *>(cos->data()), reinterpret_cast<const float *>(sin->data()),
+                    cos->shape()[0], k->shape()[0], nkvhead, d,
+                    [&](size_t t, size_t h, T *&k_dst, T *&v_dst) {
+                        ASSERT(slots[t] >= 0, "RopeAppendKV: invalid slot");
+                        size_t page = static_cast<size_t>(slots[t]) / page_size;
+                        size_t offset = static_cast<size_t>(slots[t]) % page_size;
+                        ASSERT(page < num_pages, "RopeAppendKV: page index out of range");
+                        k_dst = base + (((page * 2 + 0) * nkvhead + h) * page_size + offset) * d;
+                        v_dst = base + (((page * 2 + 1) * nkvhead + h) * page_size + offset) * d;
+                    });
+}
+} // namespace
+
+namespace llaisys::ops::cpu {
+void rope_append_kv(tensor_t k_cache, tensor_t v_cache, tensor_t k, tensor_t v,
+                    tensor_t pos_ids, tensor_t cos, tensor_t sin) {
+    switch (k->dtype()) {
+    case LLAISYS_DTYPE_F32:
+        return rope_append_kv_slab<float>(k_cache, v_cache, k, v, pos_ids, cos, sin);
+    case LLAISYS_DTYPE_BF16:
+        return rope_append_kv_slab<llaisys::bf16_t>(k_cache, v_cache, k, v, pos_ids, cos, sin);
+    case LLAISYS_DTYPE_F16:
+        return rope_append_kv_slab<llaisys::fp16_t>(k_cache, v_cache, k, v, pos_ids, cos, sin);
+    default:
+        EXCEPTION_UNSUPPORTED_DATATYPE(k->dtype());
+    }
+}
+
+void rope_append_kv_paged(tensor_t paged_kv, tensor_t k, tensor_t v, tensor_t pos_ids,
+                          tensor_t cos, tensor_t sin, tensor_t slot_mapping) {
+    switch (k->dtype()) {
+    case LLAISYS_DTYPE_F32:
+        return rope_append_kv_pages<float>(paged_kv, k, v, pos_ids, cos, sin, slot_mapping);
+    case LLAISYS_DTYPE_BF16:
+        return rope_append_kv_pages<llaisys::bf16_t>(paged_kv, k, v, pos_ids, cos, sin, slot_mapping);
+    case LLAISYS_DTYPE_F16:
+        return rope_append_kv_pages<llaisys::fp16_t>(paged_kv, k, v, pos_ids, cos, sin, slot_mapping);
+    default:
+        EXCEPTION_UNSUPPORTED_DATATYPE(k->dtype());
+    }
+}
+} // namespace llaisys::ops::cpu
@@ -0,0 +1,10 @@
+#pragma once
+
+#include "../../../tensor/tensor.hpp"
+
+namespace llaisys::ops::cpu {
+void rope_append_kv(tensor_t k_cache, tensor_t v_cache, tensor_t k, tensor_t v,
+                    tensor_t pos_ids, tensor_t cos, tensor_t sin);
+void rope_append_kv_paged(tensor_t paged_kv, tensor_t k, tensor_t v, tensor_t pos_ids,
+                          tensor_t cos, tensor_t sin, tensor_t slot_mapping);
+}
@@ -0,0 +1,106 @@
+#include "rope_append_kv_nvidia.cuh"
+
+#include "../../kv_quant/nvidia/kv_quant_device.cuh"
+
+#include "../../../core/llaisys_core.hpp"
+#include "../../../utils.hpp"
+
+namespace llaisys::ops::nvidia {
+
+namespace {
+using kv_quant::from_float;
+using kv_quant::to_float;
+
+// grid (seq, nkvhead)：一个 block 处理一个 (token, head)，K 旋转后与 V 一起写到缓存目标行。
+// slots 为空时目标为连续缓存 [seq, nkvhead, d]，否则为分页缓存 [num_pages, 2, nkvhead, page_size, d]
+template <typename T>
+__global__ void rope_append_kv_kernel(T *k_cache,
+                                      T *v_cache,
+                                      const T *k,
+                                      const T *v,
+                                      const int64_t *pos_ids,
+                                      const float *cos_table,
+                                      const float *sin_table,
+                                      const int64_t *slots,
+                                      int nkvhead,
+                                      int page_size,
+                                      int half_d,
+                                      int d) {
+    const int t = static_cast<int>(blockIdx.x);
+    const int h = static_cast<int>(blockIdx.y);
+    const size_t src = (static_cast<size_t>(t) * nkvhead + h) * d;
+    size_t k_dst = src;
+    size_t v_dst = src;
+    if (slots != nullptr) {
+        const int64_t slot = slots[t];
+        const size_t page = static_cast<size_t>(slot / page_size);
+        const size_t offset = static_cast<size_t>(slot % page_size);
+        k_dst = (((page * 2 + 0) * nkvhead + h) * page_size + offset) * d;
+        v_dst = (((page * 2 + 1) * nkvhead + h) * page_size + offset) * d;
+    }
+    const float *c = cos_table + pos_ids[t] * half_d;
+    const float *s = sin_table + pos_ids[t] * half_d;
+
+    for (int i = static_cast<int>(threadIdx.x); i < half_d; i += blockDim.x) {
+        const float a = to_float(k[src + i]);
+        const float b = to_float(k[src + i + half_d]);
+        k_cache[k_dst + i] = from_float<T>(a * c[i] - b * s[i]);
+        k_cache[k_dst + i + half_d] = from_float<T>(b * c[i] + a * s[i]);
+    }
+    for (int i = static_cast<int>(threadIdx.x); i < d; i += blockDim.x) {
+        v_cache[v_dst + i] = v[src + i];
+    }
+}
+
+template <typename T>
+void launch_rope_append_kv(std::byte *k_cache, std::byte *v_cache, tensor_t k, tensor_t v, tensor_t pos_ids,
+                           tensor_t cos, tensor_t sin, const int64_t *slots, int page_size) {
+    const int seqlen = static_cast<int>(k->shape()[0]);
+    const int nkvhead = static_cast<int>(k->shape()[1]);
+    const int d = static_cast<int>(k->shape()[2]);
+    if (seqlen == 0 || nkvhead == 0 || d == 0) {
+        return;
+    }
+    llaisys::core::context().setDevice(LLAISYS_DEVICE_NVIDIA, k->deviceId());
+    auto cu_stream = reinterpret_cast<cudaStream_t>(llaisys::core::context().runtime().stream());
+    const int block_size = d < 128 ? ((d + 31) / 32) * 32 : 128;
+    dim3 grid(static_cast<unsigned int>(seqlen), static_cast<unsigned int>(nkvhead), 1u);
+    rope_append_kv_kernel<T><<<grid, block_size, 0, cu_stream>>>(
+        reinterpret_cast<T *>(k_cache),
+        reinterpret_cast<T *>(v_cache),
+        reinterpret_cast<const T *>(k->data()),
+        reinterpret_cast<const T *>(v->data()),
+        reinterpret_cast<const int64_t *>(pos_ids->data()),
+        reinterpret_cast<const float *>(cos->data()),
+        reinterpret_cast<const float *>(sin->data()),
+        slots, nkvhead, page_size, d / 2, d);
+}
+
+template <typename... Args>
+void dispatch_rope_append_kv(llaisysDataType_t dtype, Args &&...args) {
+    switch (dtype) {
+    case LLAISYS_DTYPE_F32:
+        return launch_rope_append_kv<float>(std::forward<Args>(args)...);
+    case LLAISYS_DTYPE_F16:
+        return launch_rope_append_kv<__half>(std::forward<Args>(args)...);
+    case LLAISYS_DTYPE_BF16:
+        return launch_rope_append_kv<__nv_bfloat16>(std::forward<Args>(args)...);
+    default:
+        EXCEPTION_UNSUPPORTED_DATATYPE(dtype);
+    }
+}
+} // namespace
+
+void rope_append_kv(tensor_t k_cache, tensor_t v_cache, tensor_t k, tensor_t v,
+                    tensor_t pos_ids, tensor_t cos, tensor_t sin) {
+    dispatch_rope_append_kv(k->dtype(), k_cache->data(), v_cache->data(), k, v, pos_ids, cos, sin,
+                            static_cast<const int64_t *>(nullptr), 1);
+}
+
+void rope_append_kv_paged(tensor_t paged_kv, tensor_t k, tensor_t v, tensor_t pos_ids,
+                          tensor_t cos, tensor_t sin, tensor_t slot_mapping) {
+    dispatch_rope_append_kv(k->dtype(), paged_kv->data(), paged_kv->data(), k, v, pos_ids, cos, sin,
+                            reinterpret_cast<const int64_t *>(slot_mapping->data()),
+                            static_cast<int>(paged_kv->shape()[3]));
+}
+} // namespace llaisys::ops::nvidia
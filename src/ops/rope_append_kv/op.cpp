@@ -0,0 +1,69 @@
+#include "op.hpp"
+#include "../../device/cpu/cpu_launch.hpp"
+#include "./cpu/rope_append_kv_cpu.hpp"
+#ifdef ENABLE_NVIDIA_API
+#include "./nvidia/rope_append_kv_nvidia.cuh"
+#endif
+
+namespace llaisys::ops {
+namespace {
+void check_rope_kv(tensor_t k, tensor_t v, tensor_t pos_ids, tensor_t cos, tensor_t sin) {
+    CHECK_SAME_DEVICE(k, v, pos_ids, cos, sin);
+    CHECK_SAME_DTYPE(k->dtype(), v->dtype());
+    CHECK_SAME_SHAPE(k->shape(), v->shape());
+    ASSERT(k->ndim() == 3 && k->shape()[2] % 2 == 0, "RopeAppendKV: k/v must be [seq, nkvhead, d] with even d");
+    ASSERT(pos_ids->dtype() == LLAISYS_DTYPE_I64 && pos_ids->shape()[0] == k->shape()[0],
+           "RopeAppendKV: pos_ids must be int64 [seq]");
+    ASSERT(cos->dtype() == LLAISYS_DTYPE_F32 && sin->dtype() == LLAISYS_DTYPE_F32,
+           "RopeAppendKV: cos/sin table must be float32");
+    ASSERT(cos->ndim() == 2 && cos->shape()[1] * 2 == k->shape()[2], "RopeAppendKV: cos/sin table must be [max_pos, d/2]");
+    CHECK_SAME_SHAPE(cos->shape(), sin->shape());
+    ASSERT(k->isContiguous() && v->isContiguous() && pos_ids->isContiguous() && cos->isContiguous() &&
+               sin->isContiguous(),
+           "RopeAppendKV: inputs must be contiguous");
+}
+} // namespace
+
+void rope_append_kv(tensor_t k_cache, tensor_t v_cache, tensor_t k, tensor_t v,
+                    tensor_t pos_ids, tensor_t cos, tensor_t sin) {
+    check_rope_kv(k, v, pos_ids, cos, sin);
+    CHECK_SAME_DEVICE(k_cache, v_cache, k);
+    CHECK_SAME_DTYPE(k_cache->dtype(), v_cache->dtype(), k->dtype());
+    CHECK_SAME_SHAPE(k_cache->shape(), k->shape());
+    CHECK_SAME_SHAPE(v_cache->shape(), v->shape());
+    ASSERT(k_cache->isContiguous() && v_cache->isContiguous(), "RopeAppendKV: cache views must be contiguous");
+    if (k->deviceType() == LLAISYS_DEVICE_CPU) {
+        return device::cpu::launch([=] { cpu::rope_append_kv(k_cache, v_cache, k, v, pos_ids, cos, sin); });
+    }
+#ifdef ENABLE_NVIDIA_API
+    if (k->deviceType() == LLAISYS_DEVICE_NVIDIA) {
+        return nvidia::rope_append_kv(k_cache, v_cache, k, v, pos_ids, cos, sin);
+    }
+#endif
+    EXCEPTION_UNSUPPORTED_DEVICE;
+}
+
+void rope_append_kv_paged(tensor_t paged_kv, tensor_t k, tensor_t v, tensor_t pos_ids,
+                          tensor_t cos, tensor_t sin, tensor_t slot_mapping) {
+    check_rope_kv(k, v, pos_ids, cos, sin);
+    CHECK_SAME_DEVICE(paged_kv, k, slot_mapping);
+    CHECK_SAME_DTYPE(paged_kv->dtype(), k->dtype());
+    ASSERT(paged_kv->ndim() == 5 && paged_kv->shape()[1] == 2 && paged_kv->shape()[2] == k->shape()[1] &&
+               paged_kv->shape()[4] == k->shape()[2],
+           "RopeAppendKV: paged_kv must be [num_pages, 2, nkvhead, page_size, d]");
+    ASSERT(paged_kv->isContiguous(), "RopeAppendKV: paged_kv must be contiguous");
+    ASSERT(slot_mapping->dtype() == LLAISYS_DTYPE_I64 && slot_mapping->shape()[0] == k->shape()[0],
+           "RopeAppendKV: slot_mapping must be int64 [seq]");
+    if (k->deviceType() == LLAISYS_DEVICE_CPU) {
+        return device::cpu::launch([=] {
+            cpu::rope_append_kv_paged(paged_kv, k, v, pos_ids, cos, sin, slot_mapping);
+        });
+    }
+#ifdef ENABLE_NVIDIA_API
+    if (k->deviceType() == LLAISYS_DEVICE_NVIDIA) {
+        return nvidia::rope_append_kv_paged(paged_kv, k, v, pos_ids, cos, sin, slot_mapping);
+    }
+#endif
+    EXCEPTION_UNSUPPORTED_DEVICE;
+}
+} // namespace llaisys::ops
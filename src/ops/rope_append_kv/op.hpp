@@ -0,0 +1,15 @@
+#pragma once
+
+#include "../../tensor/tensor.hpp"
+
+namespace llaisys::ops {
+// rope 与写 KV 缓存融合：k/v 为 rope 前的 [seq, nkvhead, d]，K 按 pos_ids 查 cos/sin 表旋转，
+// 与 V 一起直接写入缓存，省去中间 k_rope 张量的一次写与一次读
+// 连续缓存：k_cache/v_cache 为缓存中目标行的 [seq, nkvhead, d] 视图
+void rope_append_kv(tensor_t k_cache, tensor_t v_cache, tensor_t k, tensor_t v,
+                    tensor_t pos_ids, tensor_t cos, tensor_t sin);
+// 分页缓存：paged_kv 为 [num_pages, 2, nkvhead, page_size, d]，slot_mapping: [seq] (I64)，
+// 第 i 个 token 写入页 slot / page_size 的 slot % page_size 行
+void rope_append_kv_paged(tensor_t paged_kv, tensor_t k, tensor_t v, tensor_t pos_ids,
+                          tensor_t cos, tensor_t sin, tensor_t slot_mapping);
+} // namespace llaisys::ops
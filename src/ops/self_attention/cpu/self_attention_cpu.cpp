@@ -1,12 +1,18 @@
 #include "self_attention_cpu.hpp"
+#include "../../../device/cpu/cpu_convert.hpp"
+#include "../../../device/cpu/cpu_kernels.hpp"
+#include "../../../device/cpu/cpu_thread_pool.hpp"
 #include "../../../tensor/tensor.hpp"
 #include "../../../utils.hpp"
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstdint>
 #include <cstring>
 #include <vector>
 template <typename T>
 void self_attention_(T *attn_val_data, T *q_data, T *k_data, T *v_data,
-                     float scale,
+                     float scale, size_t window,
                      const std::vector<size_t> &q_shape,
                      const std::vector<size_t> &k_shape,
                      const std::vector<size_t> &v_shape,
@@ -23,92 +29,187 @@ void self_attention_(T *attn_val_data, T *q_data, T *k_data, T *v_data,
     size_t group = nhead / nkvhead;
     size_t shift = total_len >= seqlen ? (total_len - seqlen) : 0;
 
-    std::vector<float> scores(total_len);
-    std::vector<float> probs(total_len);
-
-    for (size_t h = 0; h < nhead; h++) {
-        size_t kv_h = h / group;
-        for (size_t i = 0; i < seqlen; i++) {
-            // compute scores
+    // q / k / v 的行以 f32 参与计算：f32 且最后一维连续时直接使用原数据，否则先成批转换到行缓冲
+    // （最后一维连续时整行转换）。点积与加权和由 device/cpu/cpu_kernels 按指令集档位计算
+    auto load_row = [](float *buf, const T *src, size_t n, ptrdiff_t stride) -> const float * {
+        if constexpr (std::is_same_v<T, float>) {
+            if (stride == 1) {
+                return src;
+            }
+        }
+        if (stride == 1) {
+            llaisys::device::cpu::to_f32(buf, src, n);
+        } else {
+            for (size_t l = 0; l < n; l++) {
+                buf[l] = llaisys::utils::cast<float>(src[l * static_cast<size_t>(stride)]);
+            }
+        }
+        return buf;
+    };
+    // 各 (head, query) 的输出互不依赖，展平后分块并行，打分与行缓冲为块内私有
+    llaisys::device::cpu::parallel_for(0, nhead * seqlen, 1, [&](size_t begin, size_t end) {
+        std::vector<float> scores(total_len);
+        std::vector<float> q_buf(d), k_buf(d), v_buf(dv), acc(dv);
+        for (size_t hq = begin; hq < end; hq++) {
+            size_t h = hq / seqlen;
+            size_t i = hq % seqlen;
+            size_t kv_h = h / group;
+            // 因果 + 滑动窗口：只有 [lo, hi) 内的 key 可见
+            size_t hi = std::min(total_len, i + shift + 1);
+            size_t lo = (window > 0 && hi > window) ? hi - window : 0;
+            const float *q_row = load_row(q_buf.data(), q_data + i * q_strides[0] + h * q_strides[1], d, q_strides[2]);
             float max_score = -1e30f;
-            for (size_t t = 0; t < total_len; t++) {
-                if (t > i + shift) {
-                    scores[t] = -1e30f;
-                    continue;
+            for (size_t t = lo; t < hi; t++) {
+                const float *k_row = load_row(k_buf.data(), k_data + t * k_strides[0] + kv_h * k_strides[1], d, k_strides[2]);
+                float dot = llaisys::device::cpu::dot(q_row, k_row, d) * scale;
+                scores[t] = dot;
+                if (dot > max_score) {
+                    max_score = dot;
                 }
-                float acc = 0.0f;
-                for (size_t l = 0; l < d; l++) {
-                    size_t q_idx = i * static_cast<size_t>(q_strides[0])
-                                 + h * static_cast<size_t>(q_strides[1])
-                                 + l * static_cast<size_t>(q_strides[2]);
-                    size_t k_idx = t * static_cast<size_t>(k_strides[0])
-                                 + kv_h * static_cast<size_t>(k_strides[1])
-                                 + l * static_cast<size_t>(k_strides[2]);
-                    if constexpr (std::is_same_v<T, llaisys::bf16_t>
-                                  || std::is_same_v<T, llaisys::fp16_t>) {
-                        acc += llaisys::utils::cast<float>(q_data[q_idx])
-                             * llaisys::utils::cast<float>(k_data[k_idx]);
-                    } else {
-                        acc += static_cast<float>(q_data[q_idx])
-                             * static_cast<float>(k_data[k_idx]);
-                    }
+            }
+            float sum = 0.0f;
+            for (size_t t = lo; t < hi; t++) {
+                scores[t] = std::exp(scores[t] - max_score);
+                sum += scores[t];
+            }
+            float inv_sum = sum > 0.0f ? (1.0f / sum) : 0.0f;
+            std::fill(acc.begin(), acc.end(), 0.0f);
+            for (size_t t = lo; t < hi; t++) {
+                const float *v_row = load_row(v_buf.data(), v_data + t * v_strides[0] + kv_h * v_strides[1], dv, v_strides[2]);
+                llaisys::device::cpu::axpy(acc.data(), scores[t] * inv_sum, v_row, dv);
+            }
+            T *out = attn_val_data + i * attn_val_strides[0] + h * attn_val_strides[1];
+            if (attn_val_strides[2] == 1) {
+                llaisys::device::cpu::from_f32(out, acc.data(), dv);
+            } else {
+                for (size_t l = 0; l < dv; l++) {
+                    out[l * static_cast<size_t>(attn_val_strides[2])] = llaisys::utils::cast<T>(acc[l]);
                 }
-                acc *= scale;
-                scores[t] = acc;
-                if (acc > max_score) {
-                    max_score = acc;
+            }
+        }
+    });
+}
+
+namespace {
+// FP8(E4M3) 只有 256 个取值，查表反量化
+const std::array<float, 256> &fp8_table() {
+    static const std::array<float, 256> table = [] {
+        std::array<float, 256> t{};
+        for (size_t i = 0; i < t.size(); i++) {
+            t[i] = llaisys::utils::cast<float>(llaisys::fp8_t{static_cast<uint8_t>(i)});
+        }
+        return t;
+    }();
+    return table;
+}
+
+template <typename Q>
+inline float dequant_raw(Q v, const float *lut) {
+    if constexpr (std::is_same_v<Q, int8_t>) {
+        (void)lut;
+        return static_cast<float>(v);
+    } else {
+        return lut[v._v];
+    }
+}
+
+// 量化 KV 的因果注意力：scale 在 (token, head) 粒度上与行无关，
+// 可以提到点积/加权和之外，内层循环只做原始值的乘加
+template <typename T, typename Q>
+void self_attention_quantized_(T *attn_val_data, const T *q_data, const Q *k_data, const Q *v_data,
+                               const float *k_scale, const float *v_scale, float scale, size_t window,
+                               size_t seqlen, size_t nhead, size_t d,
+                               size_t total_len, size_t nkvhead, size_t dv) {
+    size_t group = nhead / nkvhead;
+    size_t shift = total_len >= seqlen ? (total_len - seqlen) : 0;
+    const float *lut = fp8_table().data();
+
+    llaisys::device::cpu::parallel_for(0, nhead * seqlen, 1, [&](size_t begin, size_t end) {
+        std::vector<float> q_row(d);
+        std::vector<float> scores(total_len);
+        std::vector<float> acc(dv);
+        for (size_t hq = begin; hq < end; hq++) {
+            size_t h = hq / seqlen;
+            size_t i = hq % seqlen;
+            size_t kv_h = h / group;
+            const T *q_ptr = q_data + (i * nhead + h) * d;
+            llaisys::device::cpu::to_f32(q_row.data(), q_ptr, d);
+            size_t limit = std::min(total_len, i + shift + 1);
+            size_t lo = (window > 0 && limit > window) ? limit - window : 0;
+            float max_score = -1e30f;
+            for (size_t t = lo; t < limit; t++) {
+                const Q *k_ptr = k_data + (t * nkvhead + kv_h) * d;
+                float dot = 0.0f;
+                for (size_t l = 0; l < d; l++) {
+                    dot += q_row[l] * dequant_raw(k_ptr[l], lut);
                 }
+                float s = dot * k_scale[t * nkvhead + kv_h] * scale;
+                scores[t] = s;
+                max_score = std::max(max_score, s);
             }
 
-            // softmax
             float sum = 0.0f;
-            for (size_t t = 0; t < total_len; t++) {
-                float v = std::exp(scores[t] - max_score);
-                probs[t] = v;
-                sum += v;
+            for (size_t t = lo; t < limit; t++) {
+                scores[t] = std::exp(scores[t] - max_score);
+                sum += scores[t];
             }
             float inv_sum = sum > 0.0f ? (1.0f / sum) : 0.0f;
-            for (size_t t = 0; t < total_len; t++) {
-                probs[t] *= inv_sum;
-            }
 
-            // weighted sum with V
-            for (size_t dv_idx = 0; dv_idx < dv; dv_idx++) {
-                float acc = 0.0f;
-                for (size_t t = 0; t < total_len; t++) {
-                    size_t v_idx = t * static_cast<size_t>(v_strides[0])
-                                 + kv_h * static_cast<size_t>(v_strides[1])
-                                 + dv_idx * static_cast<size_t>(v_strides[2]);
-                    if constexpr (std::is_same_v<T, llaisys::bf16_t>
-                                  || std::is_same_v<T, llaisys::fp16_t>) {
-                        acc += probs[t] * llaisys::utils::cast<float>(v_data[v_idx]);
-                    } else {
-                        acc += probs[t] * static_cast<float>(v_data[v_idx]);
-                    }
-                }
-                size_t out_idx = i * static_cast<size_t>(attn_val_strides[0])
-                               + h * static_cast<size_t>(attn_val_strides[1])
-                               + dv_idx * static_cast<size_t>(attn_val_strides[2]);
-                if constexpr (std::is_same_v<T, llaisys::bf16_t>
-                              || std::is_same_v<T, llaisys::fp16_t>) {
-                    attn_val_data[out_idx] = llaisys::utils::cast<T>(acc);
-                } else {
-                    attn_val_data[out_idx] = static_cast<T>(acc);
+            std::fill(acc.begin(), acc.end(), 0.0f);
+            for (size_t t = lo; t < limit; t++) {
+                float w = scores[t] * inv_sum * v_scale[t * nkvhead + kv_h];
+                const Q *v_ptr = v_data + (t * nkvhead + kv_h) * dv;
+                for (size_t l = 0; l < dv; l++) {
+                    acc[l] += w * dequant_raw(v_ptr[l], lut);
                 }
             }
+            llaisys::device::cpu::from_f32(attn_val_data + (i * nhead + h) * dv, acc.data(), dv);
         }
+    });
+}
+
+template <typename T>
+void self_attention_quantized_dispatch(llaisys::tensor_t attn_val, llaisys::tensor_t q,
+                                       llaisys::tensor_t k, llaisys::tensor_t v,
+                                       llaisys::tensor_t k_scale, llaisys::tensor_t v_scale, float scale,
+                                       size_t window) {
+    const auto &q_shape = q->shape();
+    const auto &k_shape = k->shape();
+    const auto &v_shape = v->shape();
+    T *out = reinterpret_cast<T *>(attn_val->data());
+    const T *q_ptr = reinterpret_cast<const T *>(q->data());
+    const float *ks = reinterpret_cast<const float *>(k_scale->data());
+    const float *vs = reinterpret_cast<const float *>(v_scale->data());
+    switch (k->dtype()) {
+    case LLAISYS_DTYPE_I8:
+        return self_attention_quantized_(out, q_ptr,
+                                         reinterpret_cast<const int8_t *>(k->data()),
+                                         reinterpret_cast<const int8_t *>(v->data()),
+                                         ks, vs, scale, window,
+                                         q_shape[0], q_shape[1], q_shape[2],
+                                         k_shape[0], k_shape[1], v_shape[2]);
+    case LLAISYS_DTYPE_F8:
+        return self_attention_quantized_(out, q_ptr,
+                                         reinterpret_cast<const llaisys::fp8_t *>(k->data()),
+                                         reinterpret_cast<const llaisys::fp8_t *>(v->data()),
+                                         ks, vs, scale, window,
+                                         q_shape[0], q_shape[1], q_shape[2],
+                                         k_shape[0], k_shape[1], v_shape[2]);
+    default:
+        EXCEPTION_UNSUPPORTED_DATATYPE(k->dtype());
     }
 }
+} // namespace
 
 namespace llaisys::ops::cpu {
-void self_attention(tensor_t attn_val, tensor_t q, tensor_t k, tensor_t v, float scale) {
+void self_attention(tensor_t attn_val, tensor_t q, tensor_t k, tensor_t v, float scale, size_t window) {
     switch (q->dtype()) {
     case LLAISYS_DTYPE_F32:
         return self_attention_(reinterpret_cast<float *>(attn_val->data()),
                                reinterpret_cast<float *>(q->data()),
                                reinterpret_cast<float *>(k->data()),
                                reinterpret_cast<float *>(v->data()),
-                               scale,
+                               scale, window,
                                q->shape(), k->shape(), v->shape(),
                                q->strides(), k->strides(), v->strides(),
                                attn_val->strides());
@@ -117,7 +218,7 @@ void self_attention(tensor_t attn_val, tensor_t q, tensor_t k, tensor_t v, float
                                reinterpret_cast<llaisys::bf16_t *>(q->data()),
                                reinterpret_cast<llaisys::bf16_t *>(k->data()),
                                reinterpret_cast<llaisys::bf16_t *>(v->data()),
-                               scale,
+                               scale, window,
                                q->shape(), k->shape(), v->shape(),
                                q->strides(), k->strides(), v->strides(),
                                attn_val->strides());
@@ -126,7 +227,7 @@ void self_attention(tensor_t attn_val, tensor_t q, tensor_t k, tensor_t v, float
                                reinterpret_cast<llaisys::fp16_t *>(q->data()),
                                reinterpret_cast<llaisys::fp16_t *>(k->data()),
                                reinterpret_cast<llaisys::fp16_t *>(v->data()),
-                               scale,
+                               scale, window,
                                q->shape(), k->shape(), v->shape(),
                                q->strides(), k->strides(), v->strides(),
                                attn_val->strides());
@@ -134,4 +235,24 @@ void self_attention(tensor_t attn_val, tensor_t q, tensor_t k, tensor_t v, float
         EXCEPTION_UNSUPPORTED_DATATYPE(q->dtype());
     }
 }
-} // namespace llaisys::ops::cpu
\ No newline at end of file
+
+void self_attention_quantized(tensor_t attn_val,
+                              tensor_t q,
+                              tensor_t k,
+                              tensor_t v,
+                              tensor_t k_scale,
+                              tensor_t v_scale,
+                              float scale,
+                              size_t window) {
+    switch (q->dtype()) {
+    case LLAISYS_DTYPE_F32:
+        return self_attention_quantized_dispatch<float>(attn_val, q, k, v, k_scale, v_scale, scale, window);
+    case LLAISYS_DTYPE_BF16:
+        return self_attention_quantized_dispatch<llaisys::bf16_t>(attn_val, q, k, v, k_scale, v_scale, scale, window);
+    case LLAISYS_DTYPE_F16:
+        return self_attention_quantized_dispatch<llaisys::fp16_t>(attn_val, q, k, v, k_scale, v_scale, scale, window);
+    default:
+        EXCEPTION_UNSUPPORTED_DATATYPE(q->dtype());
+    }
+}
+} // namespace llaisys::ops::cpu
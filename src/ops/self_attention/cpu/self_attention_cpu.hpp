@@ -3,5 +3,13 @@
 #include "../../../tensor/tensor.hpp"
 
 namespace llaisys::ops::cpu {
-void self_attention(tensor_t attn_val, tensor_t q, tensor_t k, tensor_t v, float scale);
+void self_attention(tensor_t attn_val, tensor_t q, tensor_t k, tensor_t v, float scale, size_t window);
+void self_attention_quantized(tensor_t attn_val,
+                              tensor_t q,
+                              tensor_t k,
+                              tensor_t v,
+                              tensor_t k_scale,
+                              tensor_t v_scale,
+                              float scale,
+                              size_t window);
 }
@@ -3,10 +3,146 @@
 #include "../../../core/llaisys_core.hpp"
 #include "../../../utils.hpp"
 #include "../../flah_infer_wrapper.cuh"
+#include "../../kv_quant/nvidia/kv_quant_device.cuh"
 
 namespace llaisys::ops::nvidia {
 
-void self_attention(tensor_t attn_val, tensor_t q, tensor_t k, tensor_t v, float scale) {
+namespace {
+using namespace kv_quant;
+
+constexpr int kQuantAttnWarps = 4;
+constexpr int kQuantAttnMaxDim = 256;
+constexpr int kQuantAttnPerLane = kQuantAttnMaxDim / 32;
+
+// 量化 KV 注意力：grid = (seqlen, nhead)，每个 warp 以 online-softmax 处理一部分 key，
+// 最后在 shared memory 中合并各 warp 的 (max, sum, acc)
+template <typename T, typename Q>
+__global__ void self_attention_quantized_kernel(T *out, const T *q, const Q *k, const Q *v,
+                                                const float *k_scale, const float *v_scale, float scale, int window,
+                                                int seqlen, int nhead, int d, int total_len, int nkvhead) {
+    const int i = blockIdx.x;
+    const int h = blockIdx.y;
+    const int kv_h = h / (nhead / nkvhead);
+    const int lane = threadIdx.x & 31;
+    const int warp = threadIdx.x >> 5;
+    const int shift = total_len >= seqlen ? total_len - seqlen : 0;
+    const int limit = min(total_len, i + shift + 1);
+    const int lo = (window > 0 && limit > window) ? limit - window : 0;
+
+    float q_reg[kQuantAttnPerLane];
+    float acc[kQuantAttnPerLane];
+    const T *q_ptr = q + (static_cast<size_t>(i) * nhead + h) * d;
+#pragma unroll
+    for (int j = 0; j < kQuantAttnPerLane; j++) {
+        const int l = lane + 32 * j;
+        q_reg[j] = l < d ? to_float(q_ptr[l]) : 0.0f;
+        acc[j] = 0.0f;
+    }
+
+    float m = -INFINITY;
+    float sum = 0.0f;
+    for (int t = lo + warp; t < limit; t += kQuantAttnWarps) {
+        const size_t row = static_cast<size_t>(t) * nkvhead + kv_h;
+        const Q *k_ptr = k + row * d;
+        float dot = 0.0f;
+#pragma unroll
+        for (int j = 0; j < kQuantAttnPerLane; j++) {
+            const int l = lane + 32 * j;
+            if (l < d) {
+                dot += q_reg[j] * dequant_raw(k_ptr[l]);
+            }
+        }
+        dot = warp_sum(dot);
+        const float s = dot * k_scale[row] * scale;
+        const float m_new = fmaxf(m, s);
+        const float corr = __expf(m - m_new);
+        const float p = __expf(s - m_new);
+        sum = sum * corr + p;
+        const float w = p * v_scale[row];
+        const Q *v_ptr = v + row * d;
+#pragma unroll
+        for (int j = 0; j < kQuantAttnPerLane; j++) {
+            const int l = lane + 32 * j;
+            if (l < d) {
+                acc[j] = acc[j] * corr + w * dequant_raw(v_ptr[l]);
+            }
+        }
+        m = m_new;
+    }
+
+    __shared__ float s_max[kQuantAttnWarps];
+    __shared__ float s_sum[kQuantAttnWarps];
+    __shared__ float s_acc[kQuantAttnWarps][kQuantAttnMaxDim];
+    if (lane == 0) {
+        s_max[warp] = m;
+        s_sum[warp] = sum;
+    }
+#pragma unroll
+    for (int j = 0; j < kQuantAttnPerLane; j++) {
+        const int l = lane + 32 * j;
+        if (l < d) {
+            s_acc[warp][l] = acc[j];
+        }
+    }
+    __syncthreads();
+
+    float g_max = -INFINITY;
+    for (int w = 0; w < kQuantAttnWarps; w++) {
+        g_max = fmaxf(g_max, s_max[w]);
+    }
+    float g_sum = 0.0f;
+    for (int w = 0; w < kQuantAttnWarps; w++) {
+        if (s_max[w] != -INFINITY) {
+            g_sum += s_sum[w] * __expf(s_max[w] - g_max);
+        }
+    }
+    const float inv_sum = g_sum > 0.0f ? 1.0f / g_sum : 0.0f;
+    T *out_ptr = out + (static_cast<size_t>(i) * nhead + h) * d;
+    for (int l = threadIdx.x; l < d; l += blockDim.x) {
+        float o = 0.0f;
+        for (int w = 0; w < kQuantAttnWarps; w++) {
+            if (s_max[w] != -INFINITY) {
+                o += s_acc[w][l] * __expf(s_max[w] - g_max);
+            }
+        }
+        out_ptr[l] = from_float<T>(o * inv_sum);
+    }
+}
+
+template <typename T>
+void launch_self_attention_quantized(tensor_t attn_val, tensor_t q, tensor_t k, tensor_t v,
+                                     tensor_t k_scale, tensor_t v_scale, float scale, int window,
+                                     cudaStream_t stream) {
+    const int seqlen = static_cast<int>(q->shape()[0]);
+    const int nhead = static_cast<int>(q->shape()[1]);
+    const int d = static_cast<int>(q->shape()[2]);
+    const int total_len = static_cast<int>(k->shape()[0]);
+    const int nkvhead = static_cast<int>(k->shape()[1]);
+    dim3 grid(static_cast<unsigned int>(seqlen), static_cast<unsigned int>(nhead), 1u);
+    dim3 block(32 * kQuantAttnWarps);
+    T *out = reinterpret_cast<T *>(attn_val->data());
+    const T *q_ptr = reinterpret_cast<const T *>(q->data());
+    const float *ks = reinterpret_cast<const float *>(k_scale->data());
+    const float *vs = reinterpret_cast<const float *>(v_scale->data());
+    switch (k->dtype()) {
+    case LLAISYS_DTYPE_I8:
+        self_attention_quantized_kernel<T, int8_t><<<grid, block, 0, stream>>>(
+            out, q_ptr, reinterpret_cast<const int8_t *>(k->data()), reinterpret_cast<const int8_t *>(v->data()),
+            ks, vs, scale, window, seqlen, nhead, d, total_len, nkvhead);
+        break;
+    case LLAISYS_DTYPE_F8:
+        self_attention_quantized_kernel<T, __nv_fp8_e4m3><<<grid, block, 0, stream>>>(
+            out, q_ptr, reinterpret_cast<const __nv_fp8_e4m3 *>(k->data()),
+            reinterpret_cast<const __nv_fp8_e4m3 *>(v->data()),
+            ks, vs, scale, window, seqlen, nhead, d, total_len, nkvhead);
+        break;
+    default:
+        EXCEPTION_UNSUPPORTED_DATATYPE(k->dtype());
+    }
+}
+} // namespace
+
+void self_attention(tensor_t attn_val, tensor_t q, tensor_t k, tensor_t v, float scale, size_t window) {
     const auto& q_shape = q->shape();
     const auto& k_shape = k->shape();
 
@@ -14,6 +150,8 @@ void self_attention(tensor_t attn_val, tensor_t q, tensor_t k, tensor_t v, float
     int num_qo_heads = static_cast<int>(q_shape[1]);
     int seq_kv        = static_cast<int>(k_shape[0]);
     int num_kv_heads  = static_cast<int>(k_shape[1]);
+    // FlashInfer 的 window_left 不含当前 token，window = 0 时传 -1 关闭滑动窗口
+    int window_left = window > 0 ? static_cast<int>(window) - 1 : -1;
 
     llaisys::core::context().setDevice(LLAISYS_DEVICE_NVIDIA, q->deviceId());
     auto& runtime = llaisys::core::context().runtime();
@@ -24,7 +162,7 @@ void self_attention(tensor_t attn_val, tensor_t q, tensor_t k, tensor_t v, float
         launch_flashinfer_decode_fp16_h128(
             q->data(), k->data(), v->data(), attn_val->data(),
             seq_q, seq_kv, num_qo_heads, num_kv_heads,
-            /*is_causal=*/true, scale,
+            /*is_causal=*/true, window_left, scale,
             /*workspace=*/nullptr, /*workspace_size=*/0,
             stream);
         break;
@@ -32,15 +170,13 @@ void self_attention(tensor_t attn_val, tensor_t q, tensor_t k, tensor_t v, float
         launch_flashinfer_decode_bf16_h128(
             q->data(), k->data(), v->data(), attn_val->data(),
             seq_q, seq_kv, num_qo_heads, num_kv_heads,
-            /*is_causal=*/true, scale,
+            /*is_causal=*/true, window_left, scale,
             /*workspace=*/nullptr, /*workspace_size=*/0,
             stream);
         break;
     default:
         EXCEPTION_UNSUPPORTED_DATATYPE(q->dtype());
     }
-
-    runtime.api()->stream_synchronize(runtime.stream());
 }
 
 void self_attention_paged(tensor_t attn_val,
@@ -116,8 +252,43 @@ void self_attention_paged(tensor_t attn_val,
     default:
         EXCEPTION_UNSUPPORTED_DATATYPE(q->dtype());
     }
+}
+
+void self_attention_quantized(tensor_t attn_val,
+                              tensor_t q,
+                              tensor_t k,
+                              tensor_t v,
+                              tensor_t k_scale,
+                              tensor_t v_scale,
+                              float scale,
+                              size_t window) {
+    ASSERT(q->shape()[2] <= static_cast<size_t>(kQuantAttnMaxDim),
+           "self_attention_quantized: head_dim must be <= 256");
+    ASSERT(v->shape()[2] == q->shape()[2], "self_attention_quantized: v head_dim must equal q head_dim");
+    if (q->shape()[0] == 0 || k->shape()[0] == 0) {
+        return;
+    }
+
+    llaisys::core::context().setDevice(LLAISYS_DEVICE_NVIDIA, q->deviceId());
+    auto& runtime = llaisys::core::context().runtime();
+    auto stream = reinterpret_cast<cudaStream_t>(runtime.stream());
 
-    runtime.api()->stream_synchronize(runtime.stream());
+    switch (q->dtype()) {
+    case LLAISYS_DTYPE_F32:
+        launch_self_attention_quantized<float>(attn_val, q, k, v, k_scale, v_scale, scale,
+                                                      static_cast<int>(window), stream);
+        break;
+    case LLAISYS_DTYPE_F16:
+        launch_self_attention_quantized<__half>(attn_val, q, k, v, k_scale, v_scale, scale,
+                                                      static_cast<int>(window), stream);
+        break;
+    case LLAISYS_DTYPE_BF16:
+        launch_self_attention_quantized<__nv_bfloat16>(attn_val, q, k, v, k_scale, v_scale, scale,
+                                                      static_cast<int>(window), stream);
+        break;
+    default:
+        EXCEPTION_UNSUPPORTED_DATATYPE(q->dtype());
+    }
 }
 
 } // namespace llaisys::ops::nvidia
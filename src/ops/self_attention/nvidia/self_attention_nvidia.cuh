@@ -3,7 +3,7 @@
 #include "../../../tensor/tensor.hpp"
 
 namespace llaisys::ops::nvidia {
-void self_attention(tensor_t attn_val, tensor_t q, tensor_t k, tensor_t v, float scale);
+void self_attention(tensor_t attn_val, tensor_t q, tensor_t k, tensor_t v, float scale, size_t window);
 void self_attention_paged(tensor_t attn_val,
                           tensor_t q,
                           tensor_t paged_kv_data,
@@ -12,4 +12,12 @@ void self_attention_paged(tensor_t attn_val,
                           tensor_t kv_last_page_len,
                           int page_size,
                           float scale);
+void self_attention_quantized(tensor_t attn_val,
+                              tensor_t q,
+                              tensor_t k,
+                              tensor_t v,
+                              tensor_t k_scale,
+                              tensor_t v_scale,
+                              float scale,
+                              size_t window);
 }
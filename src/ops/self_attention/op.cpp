@@ -1,4 +1,5 @@
 #include "op.hpp"
+#include "../../device/cpu/cpu_launch.hpp"
 #include "./cpu/self_attention_cpu.hpp"
 #include <stdexcept>
 #ifdef ENABLE_NVIDIA_API
@@ -6,7 +7,7 @@
 #endif
 
 namespace llaisys::ops {
-void self_attention(tensor_t attn_val, tensor_t q, tensor_t k, tensor_t v, float scale) {
+void self_attention(tensor_t attn_val, tensor_t q, tensor_t k, tensor_t v, float scale, size_t window) {
     CHECK_SAME_DEVICE(attn_val, q, k, v);
     CHECK_SAME_DTYPE(attn_val->dtype(), q->dtype(), k->dtype(), v->dtype());
     ASSERT(attn_val->isContiguous() && q->isContiguous() && k->isContiguous() && v->isContiguous(),
@@ -15,11 +16,13 @@ void self_attention(tensor_t attn_val, tensor_t q, tensor_t k, tensor_t v, float
                && k->shape().size() == 3 && v->shape().size() == 3,
            "SelfAttention: invalid shape size");
     if (attn_val->deviceType() == LLAISYS_DEVICE_CPU) {
-        return llaisys::ops::cpu::self_attention(attn_val, q, k, v, scale);
+        return device::cpu::launch([=] {
+            llaisys::ops::cpu::self_attention(attn_val, q, k, v, scale, window);
+        });
     }
 #ifdef ENABLE_NVIDIA_API
     if (attn_val->deviceType() == LLAISYS_DEVICE_NVIDIA) {
-        return nvidia::self_attention(attn_val, q, k, v, scale);
+        return nvidia::self_attention(attn_val, q, k, v, scale, window);
     }
 #endif
     EXCEPTION_UNSUPPORTED_DEVICE;
@@ -55,4 +58,44 @@ void self_attention_paged(tensor_t attn_val,
 #endif
     EXCEPTION_UNSUPPORTED_DEVICE;
 }
+
+void self_attention_quantized(tensor_t attn_val,
+                              tensor_t q,
+                              tensor_t k,
+                              tensor_t v,
+                              tensor_t k_scale,
+                              tensor_t v_scale,
+                              float scale,
+                              size_t window) {
+    CHECK_SAME_DEVICE(attn_val, q, k, v, k_scale, v_scale);
+    CHECK_SAME_DTYPE(attn_val->dtype(), q->dtype());
+    CHECK_SAME_DTYPE(k->dtype(), v->dtype());
+    ASSERT(k->dtype() == LLAISYS_DTYPE_I8 || k->dtype() == LLAISYS_DTYPE_F8,
+           "SelfAttentionQuantized: k/v dtype must be int8 or float8");
+    ASSERT(k_scale->dtype() == LLAISYS_DTYPE_F32 && v_scale->dtype() == LLAISYS_DTYPE_F32,
+           "SelfAttentionQuantized: scale dtype must be float32");
+    ASSERT(attn_val->isContiguous() && q->isContiguous() && k->isContiguous() && v->isContiguous()
+               && k_scale->isContiguous() && v_scale->isContiguous(),
+           "SelfAttentionQuantized: inputs must be contiguous");
+    ASSERT(attn_val->shape().size() == 3 && q->shape().size() == 3
+               && k->shape().size() == 3 && v->shape().size() == 3,
+           "SelfAttentionQuantized: invalid shape size");
+    ASSERT(k_scale->shape().size() == 2 && k_scale->shape()[0] == k->shape()[0]
+               && k_scale->shape()[1] == k->shape()[1],
+           "SelfAttentionQuantized: k_scale must be [total_len, nkvhead]");
+    ASSERT(v_scale->shape().size() == 2 && v_scale->shape()[0] == v->shape()[0]
+               && v_scale->shape()[1] == v->shape()[1],
+           "SelfAttentionQuantized: v_scale must be [total_len, nkvhead]");
+    if (attn_val->deviceType() == LLAISYS_DEVICE_CPU) {
+        return device::cpu::launch([=] {
+            cpu::self_attention_quantized(attn_val, q, k, v, k_scale, v_scale, scale, window);
+        });
+    }
+#ifdef ENABLE_NVIDIA_API
+    if (attn_val->deviceType() == LLAISYS_DEVICE_NVIDIA) {
+        return nvidia::self_attention_quantized(attn_val, q, k, v, k_scale, v_scale, scale, window);
+    }
+#endif
+    EXCEPTION_UNSUPPORTED_DEVICE;
+}
 } // namespace llaisys::ops
@@ -3,7 +3,8 @@
 #include "../../tensor/tensor.hpp"
 
 namespace llaisys::ops {
-void self_attention(tensor_t attn_val, tensor_t q, tensor_t k, tensor_t v, float scale);
+// window > 0 时为滑动窗口因果注意力：第 i 个 query 只看最近 window 个 key（含自身）
+void self_attention(tensor_t attn_val, tensor_t q, tensor_t k, tensor_t v, float scale, size_t window = 0);
 void self_attention_paged(tensor_t attn_val,
                           tensor_t q,
                           tensor_t paged_kv_data,
@@ -12,4 +13,14 @@ void self_attention_paged(tensor_t attn_val,
                           tensor_t kv_last_page_len,
                           int page_size,
                           float scale);
+// 量化 KV 版本：k/v 为 I8 或 F8(E4M3)，k_scale/v_scale 为 [total_len, nkvhead] 的 F32，
+// 内核中按 (token, head) 反量化，q/attn_val 仍为计算精度
+void self_attention_quantized(tensor_t attn_val,
+                              tensor_t q,
+                              tensor_t k,
+                              tensor_t v,
+                              tensor_t k_scale,
+                              tensor_t v_scale,
+                              float scale,
+                              size_t window = 0);
 }
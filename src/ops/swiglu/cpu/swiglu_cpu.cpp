@@ -1,6 +1,9 @@
 #include "swiglu_cpu.hpp"
+#include "../../../device/cpu/cpu_convert.hpp"
+#include "../../../device/cpu/cpu_thread_pool.hpp"
 #include "../../../tensor/tensor.hpp"
 #include "../../../utils.hpp"
+#include <algorithm>
 #include <cmath>
 #include <cstring>
 #include <vector>
@@ -9,21 +12,28 @@ void swiglu_(T *out_data, T *gate_data, T *up_data,
              const std::vector<size_t> &shape) {
     size_t seqlen = shape[0];
     size_t intermediate_size = shape[1];
-    for (size_t i = 0; i < seqlen; i++) {
-        for (size_t j = 0; j < intermediate_size; j++) {
-            size_t idx = i * intermediate_size + j;
-            if constexpr (std::is_same_v<T, llaisys::bf16_t>
-                          || std::is_same_v<T, llaisys::fp16_t>) {
-                float acc = 0.0f;
-                acc = llaisys::utils::cast<float>(up_data[idx])
-                    * llaisys::utils::cast<float>(gate_data[idx])
-                    / (1 + std::exp(-llaisys::utils::cast<float>(gate_data[idx])));
-                out_data[idx] = llaisys::utils::cast<T>(acc);
-            } else {
+    // 逐元素运算，按展平下标分块并行
+    llaisys::device::cpu::parallel_for(0, seqlen * intermediate_size, 1 << 13, [&](size_t begin, size_t end) {
+        if constexpr (std::is_same_v<T, llaisys::bf16_t>
+                      || std::is_same_v<T, llaisys::fp16_t>) {
+            // 半精度：按小块成批转成 f32 计算后再成批写回
+            constexpr size_t kTile = 256;
+            float gate[kTile], up[kTile];
+            for (size_t base = begin; base < end; base += kTile) {
+                size_t len = std::min(kTile, end - base);
+                llaisys::device::cpu::to_f32(gate, gate_data + base, len);
+                llaisys::device::cpu::to_f32(up, up_data + base, len);
+                for (size_t l = 0; l < len; l++) {
+                    up[l] = up[l] * gate[l] / (1 + std::exp(-gate[l]));
+                }
+                llaisys::device::cpu::from_f32(out_data + base, up, len);
+            }
+        } else {
+            for (size_t idx = begin; idx < end; idx++) {
                 out_data[idx] = up_data[idx] * gate_data[idx] / (1 + std::exp(-gate_data[idx]));
             }
         }
-    }
+    });
 }
 
 namespace llaisys::ops::cpu {
@@ -105,8 +105,5 @@ void swiglu(tensor_t out, tensor_t gate, tensor_t up) {
     default:
         EXCEPTION_UNSUPPORTED_DATATYPE(out->dtype());
     }
-
-    auto api = runtime.api();
-    api->stream_synchronize(stream);
 }
 } // namespace llaisys::ops::nvidia
@@ -1,4 +1,5 @@
 #include "op.hpp"
+#include "../../device/cpu/cpu_launch.hpp"
 #include "./cpu/swiglu_cpu.hpp"
 #ifdef ENABLE_NVIDIA_API
 #include "./nvidia/swiglu_nvidia.cuh"
@@ -15,7 +16,7 @@ void swiglu(tensor_t out, tensor_t gate, tensor_t up) {
     ASSERT(out->shape() == gate->shape() && out->shape() == up->shape(),
            "SwiGLU: shape mismatch");
     if (out->deviceType() == LLAISYS_DEVICE_CPU) {
-        return llaisys::ops::cpu::swiglu(out, gate, up);
+        return device::cpu::launch([=] { llaisys::ops::cpu::swiglu(out, gate, up); });
     }
 #ifdef ENABLE_NVIDIA_API
     if (out->deviceType() == LLAISYS_DEVICE_NVIDIA) {
@@ -0,0 +1,97 @@
+#include "topk_cpu.hpp"
+#include "../../../device/cpu/cpu_convert.hpp"
+#include "../../../device/cpu/cpu_thread_pool.hpp"
+#include "../../../device/cpu/cpu_topk.hpp"
+#include "../../../utils.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+namespace {
+// 每次转换 kTile 个元素到 f32；一行至少 kMinBlock 个元素才拆给多个线程
+constexpr size_t kTile = 1024;
+constexpr size_t kMinBlock = 16384;
+
+template <typename T>
+const float *tile_f32(float *buf, const T *src, size_t n, ptrdiff_t stride) {
+    if constexpr (std::is_same_v<T, float>) {
+        if (stride == 1) {
+            return src;
+        }
+    }
+    if (stride == 1) {
+        llaisys::device::cpu::to_f32(buf, src, n);
+    } else {
+        for (size_t l = 0; l < n; l++) {
+            buf[l] = llaisys::utils::cast<float>(src[static_cast<ptrdiff_t>(l) * stride]);
+        }
+    }
+    return buf;
+}
+
+// 每行切成 blocks 块，rows × blocks 个块并行各自选出 k 个候选，再按行合并、排序
+template <typename T>
+void topk_(int64_t *out_idx, T *out_val, const T *vals, size_t rows, size_t n, size_t k,
+           ptrdiff_t row_stride, ptrdiff_t col_stride) {
+    const size_t threads = llaisys::device::cpu::ThreadPool::instance().size();
+    const size_t blocks = std::clamp<size_t>((threads + rows - 1) / rows, 1,
+                                             std::max<size_t>(1, n / std::max(kMinBlock, 4 * k)));
+    const size_t step = (n + blocks - 1) / blocks;
+    std::vector<std::vector<llaisys::device::cpu::TopkEntry>> partial(rows * blocks);
+    llaisys::device::cpu::parallel_for(0, rows * blocks, 1, [&](size_t begin, size_t end) {
+        std::vector<float> buf(kTile);
+        for (size_t task = begin; task < end; task++) {
+            const T *row = vals + static_cast<ptrdiff_t>(task / blocks) * row_stride;
+            const size_t first = (task % blocks) * step;
+            const size_t last = std::min(n, first + step);
+            llaisys::device::cpu::TopkHeap heap(k);
+            for (size_t t = first; t < last; t += kTile) {
+                const size_t len = std::min(kTile, last - t);
+                heap.push(tile_f32(buf.data(), row + static_cast<ptrdiff_t>(t) * col_stride, len, col_stride), len, t);
+            }
+            partial[task] = heap.entries();
+        }
+    });
+    llaisys::device::cpu::parallel_for(0, rows, 1, [&](size_t begin, size_t end) {
+        for (size_t r = begin; r < end; r++) {
+            std::vector<llaisys::device::cpu::TopkEntry> merged;
+            for (size_t b = 0; b < blocks; b++) {
+                merged.insert(merged.end(), partial[r * blocks + b].begin(), partial[r * blocks + b].end());
+            }
+            llaisys::device::cpu::topk_sort(merged, k);
+            const T *row = vals + static_cast<ptrdiff_t>(r) * row_stride;
+            for (size_t i = 0; i < k; i++) {
+                out_idx[r * k + i] = static_cast<int64_t>(merged[i].idx);
+                out_val[r * k + i] = row[static_cast<ptrdiff_t>(merged[i].idx) * col_stride];
+            }
+        }
+    });
+}
+} // namespace
+
+namespace llaisys::ops::cpu {
+void topk(tensor_t out_idx, tensor_t out_val, tensor_t vals) {
+    const size_t rows = vals->ndim() == 2 ? vals->shape()[0] : 1;
+    const size_t n = vals->shape().back();
+    const size_t k = out_idx->shape().back();
+    const ptrdiff_t row_stride = vals->ndim() == 2 ? vals->strides()[0] : 0;
+    const ptrdiff_t col_stride = vals->strides().back();
+    auto *idx = reinterpret_cast<int64_t *>(out_idx->data());
+
+    switch (vals->dtype()) {
+    case LLAISYS_DTYPE_F32:
+        return topk_(idx, reinterpret_cast<float *>(out_val->data()),
+                     reinterpret_cast<const float *>(vals->data()), rows, n, k, row_stride, col_stride);
+    case LLAISYS_DTYPE_BF16:
+        return topk_(idx, reinterpret_cast<llaisys::bf16_t *>(out_val->data()),
+                     reinterpret_cast<const llaisys::bf16_t *>(vals->data()), rows, n, k, row_stride, col_stride);
+    case LLAISYS_DTYPE_F16:
+        return topk_(idx, reinterpret_cast<llaisys::fp16_t *>(out_val->data()),
+                     reinterpret_cast<const llaisys::fp16_t *>(vals->data()), rows, n, k, row_stride, col_stride);
+    default:
+        EXCEPTION_UNSUPPORTED_DATATYPE(vals->dtype());
+    }
+}
+} // namespace llaisys::ops::cpu
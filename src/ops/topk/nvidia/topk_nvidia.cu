@@ -0,0 +1,128 @@
+#include "topk_nvidia.cuh"
+
+#include "../../../core/llaisys_core.hpp"
+#include "../../../utils.hpp"
+
+#include <cuda_bf16.h>
+#include <cuda_fp16.h>
+#include <cuda_runtime.h>
+#include <cstdint>
+#include <math_constants.h>
+
+namespace llaisys::ops::nvidia {
+namespace {
+constexpr int kThreads = 256;
+
+template <typename T>
+__device__ float to_float_val(T val);
+
+template <>
+__device__ float to_float_val<float>(float val) { return val; }
+
+template <>
+__device__ float to_float_val<__half>(__half val) { return __half2float(val); }
+
+template <>
+__device__ float to_float_val<__nv_bfloat16>(__nv_bfloat16 val) { return __bfloat162float(val); }
+
+// 值大者优先，值相同时下标小者优先；这是一个全序，归约顺序不影响结果
+__device__ __forceinline__ bool better(float v, int64_t i, float best_v, int64_t best_i) {
+    return v > best_v || (v == best_v && i < best_i);
+}
+
+__device__ __forceinline__ void warp_best(float &v, int64_t &i) {
+    for (int offset = 16; offset > 0; offset >>= 1) {
+        float ov = __shfl_down_sync(0xffffffff, v, offset);
+        int64_t oi = __shfl_down_sync(0xffffffff, i, offset);
+        if (better(ov, oi, v, i)) {
+            v = ov;
+            i = oi;
+        }
+    }
+}
+
+// 每个 block 处理一行，做 k 轮选择：第 j 轮找排在第 j - 1 轮结果之后的最好元素。
+// 采样用的 k 很小，k 轮扫描（每轮读一遍 L2 中的行）比整行排序更省
+template <typename T>
+__global__ void topk_kernel(int64_t *out_idx, T *out_val, const T *vals, size_t n, size_t k,
+                            ptrdiff_t row_stride, ptrdiff_t col_stride) {
+    __shared__ float s_val[32];
+    __shared__ int64_t s_idx[32];
+    __shared__ float prev_v;
+    __shared__ int64_t prev_i;
+    const T *row = vals + static_cast<ptrdiff_t>(blockIdx.x) * row_stride;
+    const int lane = threadIdx.x & 31;
+    const int wid = threadIdx.x >> 5;
+    if (threadIdx.x == 0) {
+        prev_v = CUDART_INF_F;
+        prev_i = -1;
+    }
+    __syncthreads();
+
+    for (size_t j = 0; j < k; ++j) {
+        const float pv = prev_v;
+        const int64_t pi = prev_i;
+        float best_v = -CUDART_INF_F;
+        int64_t best_i = INT64_MAX;
+        for (size_t e = threadIdx.x; e < n; e += blockDim.x) {
+            float v = to_float_val(row[static_cast<ptrdiff_t>(e) * col_stride]);
+            v = isnan(v) ? -CUDART_INF_F : v;
+            const int64_t i = static_cast<int64_t>(e);
+            if (better(pv, pi, v, i) && better(v, i, best_v, best_i)) {
+                best_v = v;
+                best_i = i;
+            }
+        }
+        warp_best(best_v, best_i);
+        if (lane == 0) {
+            s_val[wid] = best_v;
+            s_idx[wid] = best_i;
+        }
+        __syncthreads();
+        if (wid == 0) {
+            const int warps = (blockDim.x + 31) / 32;
+            best_v = lane < warps ? s_val[lane] : -CUDART_INF_F;
+            best_i = lane < warps ? s_idx[lane] : INT64_MAX;
+            warp_best(best_v, best_i);
+            if (lane == 0) {
+                prev_v = best_v;
+                prev_i = best_i;
+                out_idx[blockIdx.x * k + j] = best_i;
+                out_val[blockIdx.x * k + j] = row[static_cast<ptrdiff_t>(best_i) * col_stride];
+            }
+        }
+        __syncthreads();
+    }
+}
+
+template <typename T>
+void topk_rows(tensor_t out_idx, tensor_t out_val, tensor_t vals, cudaStream_t stream) {
+    const size_t rows = vals->ndim() == 2 ? vals->shape()[0] : 1;
+    const ptrdiff_t row_stride = vals->ndim() == 2 ? vals->strides()[0] : 0;
+    topk_kernel<T><<<static_cast<unsigned int>(rows), kThreads, 0, stream>>>(
+        reinterpret_cast<int64_t *>(out_idx->data()),
+        reinterpret_cast<T *>(out_val->data()),
+        reinterpret_cast<const T *>(vals->data()),
+        vals->shape().back(),
+        out_idx->shape().back(),
+        row_stride,
+        vals->strides().back());
+}
+} // namespace
+
+void topk(tensor_t out_idx, tensor_t out_val, tensor_t vals) {
+    llaisys::core::context().setDevice(LLAISYS_DEVICE_NVIDIA, vals->deviceId());
+    auto stream = reinterpret_cast<cudaStream_t>(llaisys::core::context().runtime().stream());
+
+    switch (vals->dtype()) {
+    case LLAISYS_DTYPE_F32:
+        return topk_rows<float>(out_idx, out_val, vals, stream);
+    case LLAISYS_DTYPE_BF16:
+        return topk_rows<__nv_bfloat16>(out_idx, out_val, vals, stream);
+    case LLAISYS_DTYPE_F16:
+        return topk_rows<__half>(out_idx, out_val, vals, stream);
+    default:
+        EXCEPTION_UNSUPPORTED_DATATYPE(vals->dtype());
+    }
+}
+} // namespace llaisys::ops::nvidia
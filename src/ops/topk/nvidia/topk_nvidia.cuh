@@ -0,0 +1,7 @@
+#pragma once
+
+#include "../../../tensor/tensor.hpp"
+
+namespace llaisys::ops::nvidia {
+void topk(tensor_t out_idx, tensor_t out_val, tensor_t vals);
+}
@@ -0,0 +1,32 @@
+#include "op.hpp"
+#include "../../device/cpu/cpu_launch.hpp"
+
+#include "cpu/topk_cpu.hpp"
+#ifdef ENABLE_NVIDIA_API
+#include "nvidia/topk_nvidia.cuh"
+#endif
+
+namespace llaisys::ops {
+void topk(tensor_t out_idx, tensor_t out_val, tensor_t vals) {
+    CHECK_SAME_DEVICE(out_idx, out_val, vals);
+    CHECK_SAME_DTYPE(out_val->dtype(), vals->dtype());
+    ASSERT(out_idx->dtype() == LLAISYS_DTYPE_I64, "Topk: data type of out_idx must be LLAISYS_DTYPE_I64");
+    ASSERT(vals->ndim() == 1 || vals->ndim() == 2, "Topk: vals must be a 1D or 2D tensor");
+    CHECK_SAME_SHAPE(out_idx->shape(), out_val->shape());
+    ASSERT(out_idx->ndim() == vals->ndim(), "Topk: out_idx, out_val and vals must have the same number of dimensions");
+    ASSERT(vals->ndim() == 1 || out_idx->shape()[0] == vals->shape()[0], "Topk: out_idx and vals must have the same number of rows");
+    const size_t k = out_idx->shape().back();
+    ASSERT(k > 0 && k <= vals->shape().back(), "Topk: k must be in [1, n]");
+    ASSERT(out_idx->isContiguous() && out_val->isContiguous(), "Topk: out_idx and out_val must be contiguous");
+
+    if (vals->deviceType() == LLAISYS_DEVICE_CPU) {
+        return device::cpu::launch([=] { cpu::topk(out_idx, out_val, vals); });
+    }
+#ifdef ENABLE_NVIDIA_API
+    if (vals->deviceType() == LLAISYS_DEVICE_NVIDIA) {
+        return nvidia::topk(out_idx, out_val, vals);
+    }
+#endif
+    EXCEPTION_UNSUPPORTED_DEVICE;
+}
+} // namespace llaisys::ops
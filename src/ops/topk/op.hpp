@@ -0,0 +1,9 @@
+#pragma once
+
+#include "../../tensor/tensor.hpp"
+
+namespace llaisys::ops {
+// 每行最大的 k 个元素：vals 为 [n] 或 [rows, n]，out_idx（I64）、out_val 为 [k] 或 [rows, k]，k 取自其最后一维。
+// 结果按值从大到小排列，值相同时下标小的在前（k = 1 时与 argmax 一致），NaN 按 -inf 参与排序
+void topk(tensor_t out_idx, tensor_t out_val, tensor_t vals);
+} // namespace llaisys::ops
@@ -165,14 +165,13 @@ void Tensor::debug() const {
 }
 // 检查张量的形状和步长，判断它在内存中是否连续
 bool Tensor::isContiguous() const {
-    // TO_BE_IMPLEMENTED();
-    for (size_t i = 0; i < this->ndim() - 1; i++) {
-        if (this->strides()[i] != this->strides()[i + 1] * static_cast<ptrdiff_t>(this->shape()[i + 1])) {
+    // 长度为 1 的维度步长不影响内存布局（例如 slice 出的单层 KV-cache 视图），跳过检查
+    ptrdiff_t expected = 1;
+    for (size_t i = this->ndim(); i-- > 0;) {
+        if (this->shape()[i] != 1 && this->strides()[i] != expected) {
             return false;
         }
-    }
-    if (this->strides()[this->ndim() - 1] != 1) {
-        return false;
+        expected *= static_cast<ptrdiff_t>(this->shape()[i]);
     }
     return true;
 }
@@ -235,7 +234,9 @@ tensor_t Tensor::slice(size_t dim, size_t start, size_t end) const {
 // 查看构造函数了解如何获取当前设备上下文的运行时API，并执行从主机到设备的内存复制。
 void Tensor::load(const void *src_) {
     if (this->deviceType() == LLAISYS_DEVICE_CPU) {
-        std::memcpy(this->data(), src_, this->numel() * this->elementSize());
+        // 经 CPU runtime 拷贝，先等待 CPU stream 上可能仍在读写该张量的算子
+        llaisys::device::getRuntimeAPI(LLAISYS_DEVICE_CPU)
+            ->memcpy_sync(this->data(), src_, this->numel() * this->elementSize(), LLAISYS_MEMCPY_H2H);
     } else {
         core::context().setDevice(this->deviceType(), this->deviceId());
         core::context().runtime().api()->memcpy_sync(this->data(), src_, this->numel() * this->elementSize(), LLAISYS_MEMCPY_H2D);
@@ -289,6 +290,9 @@ tensor_t Tensor::to(llaisysDeviceType_t device_type, int device) const {
         ASSERT(false, "Tensor::to currently does not support cross-device D2D copy");
     }
 
+    if (this->deviceType() == LLAISYS_DEVICE_CPU) {
+        llaisys::device::getRuntimeAPI(LLAISYS_DEVICE_CPU)->device_synchronize();
+    }
     if (memcpy_kind == LLAISYS_MEMCPY_H2H) {
         std::memcpy(dst->data(), this->data(), this->numel() * this->elementSize());
         return dst;
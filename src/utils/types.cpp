@@ -3,83 +3,66 @@
 #include <cstring>
 
 namespace llaisys::utils {
-float _f16_to_f32(fp16_t val) {
-    uint16_t h = val._v;
-    uint32_t sign = (h & 0x8000) << 16;
-    int32_t exponent = (h >> 10) & 0x1F;
-    uint32_t mantissa = h & 0x3FF;
+float _f8_to_f32(fp8_t val) {
+    uint32_t sign = static_cast<uint32_t>(val._v & 0x80) << 24;
+    uint32_t exponent = (val._v >> 3) & 0xF;
+    uint32_t mantissa = val._v & 0x7;
 
     uint32_t f32;
-    if (exponent == 31) {
-        if (mantissa != 0) {
-            f32 = sign | 0x7F800000 | (mantissa << 13);
-        } else {
-            f32 = sign | 0x7F800000;
-        }
+    if (exponent == 0xF && mantissa == 0x7) {
+        f32 = sign | 0x7FC00000; // NaN
     } else if (exponent == 0) {
-        if (mantissa == 0) {
-            f32 = sign;
-        } else {
-            exponent = -14;
-            while ((mantissa & 0x400) == 0) {
-                mantissa <<= 1;
-                exponent--;
-            }
-            mantissa &= 0x3FF;
-            f32 = sign | ((exponent + 127) << 23) | (mantissa << 13);
-        }
+        // 次正规数：mantissa * 2^-9
+        float out = static_cast<float>(mantissa) * (1.0f / 512.0f);
+        return sign ? -out : out;
     } else {
-        f32 = sign | ((exponent + 127 - 15) << 23) | (mantissa << 13);
+        f32 = sign | ((exponent - 7 + 127) << 23) | (mantissa << 20);
     }
 
     float result;
-    memcpy(&result, &f32, sizeof(result));
+    std::memcpy(&result, &f32, sizeof(result));
     return result;
 }
 
-fp16_t _f32_to_f16(float val) {
+fp8_t _f32_to_f8(float val) {
     uint32_t f32;
-    memcpy(&f32, &val, sizeof(f32));               // Read the bits of the float32
-    uint16_t sign = (f32 >> 16) & 0x8000;          // Extract the sign bit
-    int32_t exponent = ((f32 >> 23) & 0xFF) - 127; // Extract and de-bias the exponent
-    uint32_t mantissa = f32 & 0x7FFFFF;            // Extract the mantissa (fraction part)
+    std::memcpy(&f32, &val, sizeof(f32));
+    uint8_t sign = static_cast<uint8_t>((f32 >> 24) & 0x80);
+    uint32_t abs_bits = f32 & 0x7FFFFFFF;
 
-    if (exponent >= 16) { // Special cases for Inf and NaN
-        // NaN
-        if (exponent == 128 && mantissa != 0) {
-            return fp16_t{static_cast<uint16_t>(sign | 0x7E00)};
+    if (abs_bits > 0x7F800000) { // NaN
+        return fp8_t{static_cast<uint8_t>(sign | 0x7F)};
+    }
+    int32_t exponent = static_cast<int32_t>(abs_bits >> 23) - 127;
+    if (exponent < -6) {
+        // 次正规区间：按 2^-9 的步长就近偶数舍入，可能进位到最小正规数 0x08
+        float mag;
+        std::memcpy(&mag, &abs_bits, sizeof(mag));
+        float q = mag * 512.0f;
+        if (q >= 8.0f) {
+            return fp8_t{static_cast<uint8_t>(sign | 0x08)};
         }
-        // Infinity
-        return fp16_t{static_cast<uint16_t>(sign | 0x7C00)};
-    } else if (exponent >= -14) { // Normalized case
-        return fp16_t{(uint16_t)(sign | ((exponent + 15) << 10) | (mantissa >> 13))};
-    } else if (exponent >= -24) {
-        mantissa |= 0x800000; // Add implicit leading 1
-        mantissa >>= (-14 - exponent);
-        return fp16_t{(uint16_t)(sign | (mantissa >> 13))};
-    } else {
-        // Too small for subnormal: return signed zero
-        return fp16_t{(uint16_t)sign};
+        uint32_t m = static_cast<uint32_t>(q);
+        float rem = q - static_cast<float>(m);
+        if (rem > 0.5f || (rem == 0.5f && (m & 1))) {
+            ++m;
+        }
+        return fp8_t{static_cast<uint8_t>(sign | m)};
     }
-}
 
-float _bf16_to_f32(bf16_t val) {
-    uint32_t bits32 = static_cast<uint32_t>(val._v) << 16;
-
-    float out;
-    std::memcpy(&out, &bits32, sizeof(out));
-    return out;
-}
-
-bf16_t _f32_to_bf16(float val) {
-    uint32_t bits32;
-    std::memcpy(&bits32, &val, sizeof(bits32));
-
-    const uint32_t rounding_bias = 0x00007FFF + // 0111 1111 1111 1111
-                                   ((bits32 >> 16) & 1);
-
-    uint16_t bf16_bits = static_cast<uint16_t>((bits32 + rounding_bias) >> 16);
-
-    return bf16_t{bf16_bits};
+    uint32_t mantissa = (abs_bits & 0x7FFFFF) >> 20;
+    uint32_t rest = abs_bits & 0xFFFFF;
+    if (rest > 0x80000 || (rest == 0x80000 && (mantissa & 1))) {
+        ++mantissa;
+    }
+    if (mantissa == 8) {
+        mantissa = 0;
+        ++exponent;
+    }
+    int32_t biased = exponent + 7;
+    if (biased > 15 || (biased == 15 && mantissa == 7)) {
+        return fp8_t{static_cast<uint8_t>(sign | 0x7E)}; // 饱和到 448
+    }
+    return fp8_t{static_cast<uint8_t>(sign | (biased << 3) | mantissa)};
 }
 } // namespace llaisys::utils
@@ -1,5 +1,7 @@
 #include "llaisys.h"
 
+#include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <stdexcept>
 
@@ -14,6 +16,12 @@ struct CustomBFloat16 {
 };
 typedef struct CustomBFloat16 bf16_t;
 
+// FP8 E4M3（OCP "fn" 变体：无 inf，0x7F/0xFF 为 NaN，最大值 448）
+struct CustomFloat8 {
+    uint8_t _v;
+};
+typedef struct CustomFloat8 fp8_t;
+
 namespace utils {
 inline size_t dsize(llaisysDataType_t dtype) {
     switch (dtype) {
@@ -107,11 +115,65 @@ inline const char *dtype_to_str(llaisysDataType_t dtype) {
     }
 }
 
-float _f16_to_f32(fp16_t val);
-fp16_t _f32_to_f16(float val);
+// 半精度与 f32 的标量转换放在头文件中，可以内联进各 CPU 算子的内层循环；
+// 成批转换见 device/cpu/cpu_convert.hpp。舍入均为就近偶数，与 F16C / GPU 的转换指令一致
+inline uint32_t _f32_bits(float val) {
+    uint32_t bits;
+    std::memcpy(&bits, &val, sizeof(bits));
+    return bits;
+}
+
+inline float _bits_f32(uint32_t bits) {
+    float val;
+    std::memcpy(&val, &bits, sizeof(val));
+    return val;
+}
+
+inline float _f16_to_f32(fp16_t val) {
+    const uint32_t sign = static_cast<uint32_t>(val._v & 0x8000) << 16;
+    const uint32_t em = val._v & 0x7FFF;
+    if (em >= 0x7C00) { // Inf / NaN
+        return _bits_f32(sign | 0x7F800000 | ((em & 0x3FF) << 13));
+    }
+    if (em >= 0x0400) { // 正规数：指数偏置 15 -> 127
+        return _bits_f32(sign | ((em << 13) + 0x38000000));
+    }
+    // 零与次正规数：em * 2^-24 可以精确表示
+    return _bits_f32(sign | _f32_bits(static_cast<float>(em) * 5.9604644775390625e-8f));
+}
+
+inline fp16_t _f32_to_f16(float val) {
+    uint32_t bits = _f32_bits(val);
+    const uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+    bits &= 0x7FFFFFFF;
+    if (bits >= 0x7F800000) { // Inf / NaN
+        return fp16_t{static_cast<uint16_t>(sign | (bits > 0x7F800000 ? 0x7E00 : 0x7C00))};
+    }
+    if (bits >= 0x477FF000) { // >= 65520 舍入后溢出
+        return fp16_t{static_cast<uint16_t>(sign | 0x7C00)};
+    }
+    if (bits < 0x38800000) {
+        // 次正规数与零：加 0.5f 让硬件按 2^-24 的步长就近偶数舍入，尾数位即结果
+        const uint32_t r = _f32_bits(_bits_f32(bits) + 0.5f) - 0x3F000000;
+        return fp16_t{static_cast<uint16_t>(sign | r)};
+    }
+    // 正规数：重新偏置指数并就近偶数舍入
+    bits += 0xC8000FFF + ((bits >> 13) & 1);
+    return fp16_t{static_cast<uint16_t>(sign | (bits >> 13))};
+}
+
+inline float _bf16_to_f32(bf16_t val) {
+    return _bits_f32(static_cast<uint32_t>(val._v) << 16);
+}
+
+inline bf16_t _f32_to_bf16(float val) {
+    const uint32_t bits = _f32_bits(val);
+    const uint32_t rounding_bias = 0x00007FFF + ((bits >> 16) & 1);
+    return bf16_t{static_cast<uint16_t>((bits + rounding_bias) >> 16)};
+}
 
-float _bf16_to_f32(bf16_t val);
-bf16_t _f32_to_bf16(float val);
+float _f8_to_f32(fp8_t val);
+fp8_t _f32_to_f8(float val); // 超出范围时饱和到 ±448
 
 template <typename TypeTo, typename TypeFrom>
 TypeTo cast(TypeFrom val) {
@@ -133,6 +195,14 @@ TypeTo cast(TypeFrom val) {
         return _bf16_to_f32(val);
     } else if constexpr (std::is_same<TypeFrom, bf16_t>::value && !std::is_same<TypeTo, float>::value) {
         return static_cast<TypeTo>(_bf16_to_f32(val));
+    } else if constexpr (std::is_same<TypeTo, fp8_t>::value && std::is_same<TypeFrom, float>::value) {
+        return _f32_to_f8(val);
+    } else if constexpr (std::is_same<TypeTo, fp8_t>::value && !std::is_same<TypeFrom, float>::value) {
+        return _f32_to_f8(static_cast<float>(val));
+    } else if constexpr (std::is_same<TypeFrom, fp8_t>::value && std::is_same<TypeTo, float>::value) {
+        return _f8_to_f32(val);
+    } else if constexpr (std::is_same<TypeFrom, fp8_t>::value && !std::is_same<TypeTo, float>::value) {
+        return static_cast<TypeTo>(_f8_to_f32(val));
     } else {
         return static_cast<TypeTo>(val);
     }
@@ -0,0 +1,208 @@
+#include "src/core/llaisys_core.hpp"
+#include "src/device/cpu/cpu_convert.hpp"
+#include "src/device/cpu/cpu_isa.hpp"
+#include "src/device/cpu/cpu_kernels.hpp"
+#include "src/device/cpu/cpu_process.hpp"
+#include "src/device/cpu/cpu_stream.hpp"
+#include "src/ops/linear/op.hpp"
+#include "src/ops/rms_norm/op.hpp"
+#include "src/ops/self_attention/op.hpp"
+#include "src/tensor/tensor.hpp"
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// 指令集档位：LLAISYS_CPU_ISA 强制的每个档位（不超过本机支持）下，dot / axpy / argmax、
+// 半精度成批转换与经由它们的算子都与 scalar 档位逐字节一致。档位在进程启动后第一次使用时读取，
+// 每个档位在一个 fork 出的工作进程里运行
+namespace {
+using namespace llaisys;
+namespace cpu = llaisys::device::cpu;
+
+bool check(bool ok, const std::string &what) {
+    if (!ok) {
+        std::cerr << "[FAILED] " << what << std::endl;
+    }
+    return ok;
+}
+
+void require(bool ok, const std::string &what) {
+    if (!ok) {
+        throw std::runtime_error(what);
+    }
+}
+
+// 覆盖 64 路部分和、8 / 16 路向量与各种尾部长度
+const size_t kLengths[] = {0, 1, 7, 8, 9, 15, 16, 17, 63, 64, 65, 100, 127, 128, 129, 1000, 4097};
+
+std::vector<float> random_floats(size_t n, std::mt19937 &rng) {
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<float> v(n);
+    for (auto &x : v) {
+        x = dist(rng);
+    }
+    return v;
+}
+
+template <typename T>
+void append(std::vector<std::byte> &out, const T *data, size_t n) {
+    const auto *bytes = reinterpret_cast<const std::byte *>(data);
+    out.insert(out.end(), bytes, bytes + n * sizeof(T));
+}
+
+void append(std::vector<std::byte> &out, const tensor_t &t) {
+    out.insert(out.end(), t->data(), t->data() + t->numel() * t->elementSize());
+}
+
+tensor_t random_tensor(const std::vector<size_t> &shape, llaisysDataType_t dtype, std::mt19937 &rng) {
+    auto t = Tensor::create(shape, dtype);
+    const auto f = random_floats(t->numel(), rng);
+    if (dtype == LLAISYS_DTYPE_F32) {
+        t->load(f.data());
+    } else if (dtype == LLAISYS_DTYPE_BF16) {
+        std::vector<bf16_t> h(f.size());
+        for (size_t i = 0; i < f.size(); ++i) {
+            h[i] = utils::cast<bf16_t>(f[i]);
+        }
+        t->load(h.data());
+    } else {
+        std::vector<fp16_t> h(f.size());
+        for (size_t i = 0; i < f.size(); ++i) {
+            h[i] = utils::cast<fp16_t>(f[i]);
+        }
+        t->load(h.data());
+    }
+    return t;
+}
+
+void run_vector_kernels(std::vector<std::byte> &out, std::mt19937 &rng) {
+    for (size_t n : kLengths) {
+        const auto a = random_floats(n, rng);
+        const auto b = random_floats(n, rng);
+        const float d = cpu::dot(a.data(), b.data(), n);
+        append(out, &d, 1);
+
+        auto y = random_floats(n, rng);
+        cpu::axpy(y.data(), 0.37f, a.data(), n);
+        append(out, y.data(), n);
+
+        // 并列的最大值与 NaN：取第一个最大值，NaN 不参与比较
+        auto x = random_floats(n, rng);
+        if (n > 2) {
+            x[n / 3] = x[n - 1] = 3.0f;
+            x[n / 2] = std::numeric_limits<float>::quiet_NaN();
+        }
+        float max_val;
+        const uint64_t idx = cpu::argmax(x.data(), n, &max_val);
+        append(out, &idx, 1);
+        append(out, &max_val, 1);
+    }
+}
+
+// 舍入的边界值：进位、恰在中间、非规格化、溢出、无穷与 NaN
+void run_converters(std::vector<std::byte> &out, std::mt19937 &rng) {
+    auto f = random_floats(1003, rng);
+    const float specials[] = {0.0f, -0.0f, 1.0f + 0x1p-8f, 1.0f + 0x1p-9f, 1.0f + 0x1p-11f, 0x1p-130f, 0x1p-20f,
+                              65504.0f, 65520.0f, 1e30f, std::numeric_limits<float>::infinity(),
+                              -std::numeric_limits<float>::infinity(), std::numeric_limits<float>::quiet_NaN()};
+    f.insert(f.end(), std::begin(specials), std::end(specials));
+    std::vector<bf16_t> bf(f.size());
+    std::vector<fp16_t> hf(f.size());
+    std::vector<float> back(f.size());
+    cpu::f32_to_bf16(bf.data(), f.data(), f.size());
+    cpu::bf16_to_f32(back.data(), bf.data(), bf.size());
+    append(out, bf.data(), bf.size());
+    append(out, back.data(), back.size());
+    cpu::f32_to_f16(hf.data(), f.data(), f.size());
+    cpu::f16_to_f32(back.data(), hf.data(), hf.size());
+    append(out, hf.data(), hf.size());
+    append(out, back.data(), back.size());
+}
+
+// 在工作进程中执行：确认档位已按环境变量生效，再把各内核与算子的输出按顺序拼接返回
+std::vector<std::byte> run_kernels(cpu::Isa isa) {
+    require(cpu::isa() == isa, std::string("LLAISYS_CPU_ISA=") + cpu::isa_name(isa) + " did not take effect");
+    std::mt19937 rng(11);
+    std::vector<std::byte> out;
+    run_vector_kernels(out, rng);
+    run_converters(out, rng);
+    for (auto dtype : {LLAISYS_DTYPE_F32, LLAISYS_DTYPE_BF16, LLAISYS_DTYPE_F16}) {
+        // k 不是 32 的倍数：amx 档位的 bf16 也走 dot 内核（AMX tile 只在容差内与其他档位一致）
+        auto in = random_tensor({19, 257}, dtype, rng);
+        auto weight = random_tensor({131, 257}, dtype, rng);
+        auto bias = random_tensor({131}, dtype, rng);
+        auto y = Tensor::create({19, 131}, dtype);
+        ops::linear(y, in, weight, bias);
+        auto y_no_bias = Tensor::create({19, 131}, dtype);
+        ops::linear(y_no_bias, in, weight, nullptr);
+
+        auto q = random_tensor({23, 4, 72}, dtype, rng);
+        auto k = random_tensor({29, 2, 72}, dtype, rng);
+        auto v = random_tensor({29, 2, 40}, dtype, rng);
+        auto attn = Tensor::create({23, 4, 40}, dtype);
+        ops::self_attention(attn, q, k, v, 0.125f);
+
+        auto x = random_tensor({13, 1000}, dtype, rng);
+        auto norm_w = random_tensor({1000}, dtype, rng);
+        auto norm = Tensor::create({13, 1000}, dtype);
+        ops::rms_norm(norm, x, norm_w, 1e-6f);
+
+        cpu::synchronize_streams();
+        for (const auto &t : {y, y_no_bias, attn, norm}) {
+            append(out, t);
+        }
+    }
+    return out;
+}
+
+// 在 LLAISYS_CPU_ISA=isa 的工作进程中执行 run_kernels，失败时返回空
+std::vector<std::byte> run_with_isa(cpu::Isa isa) {
+    setenv("LLAISYS_CPU_ISA", cpu::isa_name(isa), 1);
+    auto fds = cpu::socket_pair();
+    int pid = cpu::fork_worker({fds.first}, [&] {
+        auto out = run_kernels(isa);
+        uint64_t size = out.size();
+        cpu::send_all(fds.second, &size, sizeof(size));
+        cpu::send_all(fds.second, out.data(), out.size());
+    });
+    cpu::close_fd(fds.second);
+    std::vector<std::byte> out;
+    uint64_t size = 0;
+    if (cpu::recv_all(fds.first, &size, sizeof(size))) {
+        out.resize(size);
+        cpu::recv_all(fds.first, out.data(), out.size());
+    }
+    cpu::close_fd(fds.first);
+    if (cpu::wait_worker(pid) != 0) {
+        out.clear();
+    }
+    return out;
+}
+} // namespace
+
+int main() {
+    const auto base = run_with_isa(cpu::Isa::Scalar);
+    bool ok = check(!base.empty(), "scalar worker failed");
+    for (auto isa : {cpu::Isa::Avx2, cpu::Isa::Avx512, cpu::Isa::Amx}) {
+        const std::string name = cpu::isa_name(isa);
+        if (static_cast<int>(isa) > static_cast<int>(cpu::detected_isa())) {
+            std::cout << name << " is not supported on this CPU, skipped\n";
+            continue;
+        }
+        const auto out = run_with_isa(isa);
+        ok &= check(!out.empty(), name + ": worker failed");
+        ok &= check(out.empty() || out == base, name + ": kernel outputs differ from the scalar tier");
+    }
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "Test passed!\n";
+    return 0;
+}
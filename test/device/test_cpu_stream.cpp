@@ -0,0 +1,165 @@
+#include "src/core/llaisys_core.hpp"
+#include "src/device/cpu/cpu_launch.hpp"
+#include "src/device/cpu/cpu_stream.hpp"
+#include "src/device/runtime_api.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// CPU stream：任务按提交顺序执行（含异步拷贝与算子交错），任务中的异常在下一次同步时抛出一次，
+// 释放仍可能被 stream 上任务访问的内存时，延迟到这些任务执行完
+namespace {
+using namespace llaisys;
+namespace cpu = llaisys::device::cpu;
+
+bool check(bool ok, const std::string &what) {
+    if (!ok) {
+        std::cerr << "[FAILED] " << what << std::endl;
+    }
+    return ok;
+}
+
+bool test_order() {
+    cpu::Stream stream;
+    std::vector<int> seen;
+    for (int i = 0; i < 1000; ++i) {
+        stream.submit([&seen, i] {
+            // 偶尔让出执行线程，打乱时序
+            if (i % 97 == 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+            seen.push_back(i);
+        });
+    }
+    stream.synchronize();
+    bool ok = check(stream.idle(), "stream is busy after synchronize");
+    for (int i = 0; i < 1000; ++i) {
+        ok &= seen.size() == 1000 && seen[i] == i;
+    }
+    return check(ok, "stream tasks ran out of order");
+}
+
+// 同一 stream 上：拷入 a、算子读 a 写 b、再改写 a，算子看到的是第一次拷贝的值
+bool test_copy_and_launch_order() {
+    core::context().setDevice(LLAISYS_DEVICE_CPU, 0);
+    auto &rt = core::context().runtime();
+    auto api = rt.api();
+    const size_t n = 1 << 16;
+    auto *a = static_cast<int32_t *>(api->malloc_device(n * sizeof(int32_t)));
+    auto *b = static_cast<int32_t *>(api->malloc_device(n * sizeof(int32_t)));
+    std::promise<void> gate;
+    auto opened = gate.get_future().share();
+    // 先堵住 stream，保证后面的任务都是排队后才执行
+    cpu::launch([opened] { opened.wait(); });
+    std::vector<int32_t> first(n), second(n);
+    for (size_t i = 0; i < n; ++i) {
+        first[i] = static_cast<int32_t>(i);
+        second[i] = -1;
+    }
+    api->memcpy_async(a, first.data(), n * sizeof(int32_t), LLAISYS_MEMCPY_H2D, rt.stream());
+    cpu::launch([a, b, n] { std::memcpy(b, a, n * sizeof(int32_t)); });
+    // 源为可分页内存：调用时已暂存，之后改写源不影响排队中的拷贝
+    api->memcpy_async(a, second.data(), n * sizeof(int32_t), LLAISYS_MEMCPY_H2D, rt.stream());
+    second.assign(n, -2);
+    gate.set_value();
+    std::vector<int32_t> got_a(n), got_b(n);
+    api->memcpy_sync(got_b.data(), b, n * sizeof(int32_t), LLAISYS_MEMCPY_D2H);
+    api->memcpy_sync(got_a.data(), a, n * sizeof(int32_t), LLAISYS_MEMCPY_D2H);
+    bool ok = check(got_b == first, "launched op did not see the preceding copy");
+    ok &= check(got_a == std::vector<int32_t>(n, -1), "copy queued after the op did not run last");
+    api->free_device(a);
+    api->free_device(b);
+    return ok;
+}
+
+bool test_error() {
+    cpu::Stream stream;
+    std::atomic<int> ran{0};
+    stream.submit([&] { ++ran; });
+    stream.submit([] { throw std::runtime_error("task failed"); });
+    stream.submit([&] { ++ran; });
+    bool thrown = false;
+    try {
+        stream.synchronize();
+    } catch (const std::runtime_error &) {
+        thrown = true;
+    }
+    bool ok = check(thrown, "synchronize did not rethrow the task's exception");
+    ok &= check(ran.load() == 2, "tasks after a failed task did not run");
+    thrown = false;
+    try {
+        stream.synchronize();
+    } catch (...) {
+        thrown = true;
+    }
+    ok &= check(!thrown, "the exception was rethrown twice");
+    return ok;
+}
+
+// 释放时 stream 被堵住：被释放的内存在 stream 执行到释放时的位置之前保持有效
+bool test_deferred_free() {
+    auto api = device::getRuntimeAPI(LLAISYS_DEVICE_CPU);
+    auto stream = api->create_stream();
+    const size_t n = 1 << 20;
+    auto *buf = static_cast<uint8_t *>(api->malloc_device(n));
+    std::memset(buf, 0x5a, n);
+    std::promise<void> gate;
+    auto opened = gate.get_future().share();
+    std::vector<uint8_t> seen(n);
+    cpu::submit(stream, [opened, buf, &seen, n] {
+        opened.wait();
+        std::memcpy(seen.data(), buf, n);
+    });
+    api->free_device(buf);
+    // 若 buf 已被释放，同样大小的新分配很可能复用它
+    for (int i = 0; i < 8; ++i) {
+        auto *other = static_cast<uint8_t *>(api->malloc_device(n));
+        std::memset(other, 0xff, n);
+        api->free_device(other);
+    }
+
+    // 直接检查释放时机：holder 在 stream 执行到当前位置之后才析构
+    std::atomic<bool> released{false};
+    auto holder = std::shared_ptr<void>(nullptr, [&released](void *) { released = true; });
+    bool ok = check(cpu::retain_until_drained(holder), "busy stream not reported");
+    holder.reset();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    ok &= check(!released.load(), "holder released while the stream was still busy");
+
+    gate.set_value();
+    api->stream_synchronize(stream);
+    ok &= check(released.load(), "holder not released after the stream drained");
+    ok &= check(seen == std::vector<uint8_t>(n, 0x5a), "memory freed before the stream finished using it");
+
+    // 所有 stream 空闲时不延迟
+    released = false;
+    holder = std::shared_ptr<void>(nullptr, [&released](void *) { released = true; });
+    ok &= check(!cpu::retain_until_drained(holder), "idle streams reported as busy");
+    holder.reset();
+    ok &= check(released.load(), "holder not released at once with idle streams");
+    api->destroy_stream(stream);
+    return ok;
+}
+} // namespace
+
+int main() {
+    bool ok = test_order();
+    ok &= test_copy_and_launch_order();
+    ok &= test_error();
+    ok &= test_deferred_free();
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "Test passed!\n";
+    return 0;
+}
@@ -0,0 +1,182 @@
+#include "src/core/llaisys_core.hpp"
+#include "src/device/cpu/cpu_process.hpp"
+#include "src/device/cpu/cpu_stream.hpp"
+#include "src/device/cpu/cpu_thread_pool.hpp"
+#include "src/ops/argmax/op.hpp"
+#include "src/ops/linear/op.hpp"
+#include "src/ops/rms_norm/op.hpp"
+#include "src/ops/self_attention/op.hpp"
+#include "src/ops/swiglu/op.hpp"
+#include "src/tensor/tensor.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// 线程池：parallel_for 恰好覆盖每个下标一次（含池内嵌套调用），
+// 各算子的输出与线程数无关、逐字节一致。线程池按进程创建，每个线程数在一个 fork 出的工作进程里运行
+namespace {
+using namespace llaisys;
+namespace cpu = llaisys::device::cpu;
+
+bool check(bool ok, const std::string &what) {
+    if (!ok) {
+        std::cerr << "[FAILED] " << what << std::endl;
+    }
+    return ok;
+}
+
+void require(bool ok, const std::string &what) {
+    if (!ok) {
+        throw std::runtime_error(what);
+    }
+}
+
+tensor_t random_tensor(const std::vector<size_t> &shape, llaisysDataType_t dtype, std::mt19937 &rng) {
+    auto t = Tensor::create(shape, dtype);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<float> f(t->numel());
+    for (auto &x : f) {
+        x = dist(rng);
+    }
+    if (dtype == LLAISYS_DTYPE_F32) {
+        t->load(f.data());
+    } else {
+        // bf16 取 f32 的高 16 位
+        std::vector<uint16_t> h(f.size());
+        for (size_t i = 0; i < f.size(); ++i) {
+            uint32_t bits;
+            std::memcpy(&bits, &f[i], sizeof(bits));
+            h[i] = static_cast<uint16_t>(bits >> 16);
+        }
+        t->load(h.data());
+    }
+    return t;
+}
+
+void append(std::vector<std::byte> &out, const tensor_t &t) {
+    out.insert(out.end(), t->data(), t->data() + t->numel() * t->elementSize());
+}
+
+void check_coverage(size_t begin, size_t end, size_t grain) {
+    std::vector<std::atomic<int>> hits(end);
+    cpu::parallel_for(begin, end, grain, [&](size_t b, size_t e) {
+        for (size_t i = b; i < e; ++i) {
+            hits[i].fetch_add(1);
+        }
+    });
+    for (size_t i = 0; i < end; ++i) {
+        require(hits[i].load() == (i >= begin ? 1 : 0),
+                "parallel_for(" + std::to_string(begin) + ", " + std::to_string(end) + ", " + std::to_string(grain) +
+                    ") visited index " + std::to_string(i) + " " + std::to_string(hits[i].load()) + " times");
+    }
+}
+
+// 在工作进程中执行：检查覆盖，再把各算子的输出按顺序拼接返回
+std::vector<std::byte> run_kernels(size_t threads) {
+    require(cpu::ThreadPool::instance().size() == threads, "thread pool has a wrong size");
+    check_coverage(0, 1, 1);
+    check_coverage(3, 10007, 13);
+    check_coverage(0, 64, 1000);
+    // 池内线程再次调用 parallel_for 时串行执行，不能死锁
+    std::atomic<size_t> nested{0};
+    cpu::parallel_for(0, 64, 1, [&](size_t b, size_t e) {
+        for (size_t i = b; i < e; ++i) {
+            cpu::parallel_for(0, 100, 7, [&](size_t nb, size_t ne) { nested.fetch_add(ne - nb); });
+        }
+    });
+    require(nested.load() == 64 * 100, "nested parallel_for lost work");
+
+    std::mt19937 rng(7);
+    std::vector<std::byte> out;
+    for (auto dtype : {LLAISYS_DTYPE_F32, LLAISYS_DTYPE_BF16}) {
+        auto in = random_tensor({33, 257}, dtype, rng);
+        auto weight = random_tensor({515, 257}, dtype, rng);
+        auto bias = random_tensor({515}, dtype, rng);
+        auto y = Tensor::create({33, 515}, dtype);
+        ops::linear(y, in, weight, bias);
+
+        auto q = random_tensor({37, 4, 64}, dtype, rng);
+        auto k = random_tensor({45, 2, 64}, dtype, rng);
+        auto v = random_tensor({45, 2, 64}, dtype, rng);
+        auto attn = Tensor::create({37, 4, 64}, dtype);
+        ops::self_attention(attn, q, k, v, 0.125f);
+
+        auto x = random_tensor({61, 1000}, dtype, rng);
+        auto norm_w = random_tensor({1000}, dtype, rng);
+        auto norm = Tensor::create({61, 1000}, dtype);
+        ops::rms_norm(norm, x, norm_w, 1e-6f);
+
+        auto gate = random_tensor({4099, 3}, dtype, rng);
+        auto up = random_tensor({4099, 3}, dtype, rng);
+        auto act = Tensor::create({4099, 3}, dtype);
+        ops::swiglu(act, gate, up);
+
+        cpu::synchronize_streams();
+        for (const auto &t : {y, attn, norm, act}) {
+            append(out, t);
+        }
+    }
+    // 最大值出现多次时取第一个
+    std::vector<float> vals(100003, 0.5f);
+    vals[4242] = vals[77777] = vals[99999] = 2.0f;
+    auto vals_t = Tensor::create({vals.size()}, LLAISYS_DTYPE_F32);
+    vals_t->load(vals.data());
+    auto max_idx = Tensor::create({1}, LLAISYS_DTYPE_I64);
+    auto max_val = Tensor::create({1}, LLAISYS_DTYPE_F32);
+    ops::argmax(max_idx, max_val, vals_t);
+    cpu::synchronize_streams();
+    int64_t idx;
+    std::memcpy(&idx, max_idx->data(), sizeof(idx));
+    require(idx == 4242, "argmax did not return the first maximum");
+    append(out, max_idx);
+    append(out, max_val);
+    return out;
+}
+
+// 在 threads 个线程的工作进程中执行 run_kernels，失败时返回空
+std::vector<std::byte> run_with_threads(size_t threads) {
+    setenv("LLAISYS_NUM_THREADS", std::to_string(threads).c_str(), 1);
+    auto fds = cpu::socket_pair();
+    int pid = cpu::fork_worker({fds.first}, [&] {
+        auto out = run_kernels(threads);
+        uint64_t size = out.size();
+        cpu::send_all(fds.second, &size, sizeof(size));
+        cpu::send_all(fds.second, out.data(), out.size());
+    });
+    cpu::close_fd(fds.second);
+    std::vector<std::byte> out;
+    uint64_t size = 0;
+    if (cpu::recv_all(fds.first, &size, sizeof(size))) {
+        out.resize(size);
+        cpu::recv_all(fds.first, out.data(), out.size());
+    }
+    cpu::close_fd(fds.first);
+    if (cpu::wait_worker(pid) != 0) {
+        out.clear();
+    }
+    return out;
+}
+} // namespace
+
+int main() {
+    const auto base = run_with_threads(1);
+    bool ok = check(!base.empty(), "single-threaded worker failed");
+    for (size_t threads : {2, 3, 4, 7}) {
+        const auto out = run_with_threads(threads);
+        const std::string name = std::to_string(threads) + " threads";
+        ok &= check(!out.empty(), name + ": worker failed");
+        ok &= check(out.empty() || out == base, name + ": kernel outputs differ from the single-threaded run");
+    }
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "Test passed!\n";
+    return 0;
+}
@@ -0,0 +1,142 @@
+#include "tiny_qwen2.hpp"
+
+#include <stdexcept>
+#include <thread>
+
+// Engine 的提交 / 轮询 / 取消 / 释放：并发的两个请求各自得到与参考前向贪心一致的 token，
+// 取消与释放不影响其他请求
+namespace {
+using namespace tiny_qwen2;
+
+bool test_submit_poll(const TinyQwen2 &t) {
+    Engine engine(t.model);
+    const auto a = random_tokens(5, 1);
+    const auto b = random_tokens(9, 2);
+    const size_t steps = 6;
+    uint64_t id_a = engine.submit(a, steps);
+    std::vector<int64_t> streamed;
+    bool last_finished = false;
+    uint64_t id_b = engine.submit(b, steps, [&](uint64_t, int64_t token, bool finished) {
+        streamed.push_back(token);
+        last_finished = finished;
+        return true;
+    });
+
+    // 轮询取出的 token 依次拼起来就是完整的生成结果
+    std::vector<int64_t> polled;
+    RequestStatus status = RequestStatus::Pending;
+    // 结束时可能还有未取走的 token，取到空为止
+    for (size_t n = 1; n > 0 || status == RequestStatus::Pending || status == RequestStatus::Running;) {
+        engine.wait(id_a);
+        int64_t buf[4];
+        n = engine.poll(id_a, buf, 4, &status);
+        polled.insert(polled.end(), buf, buf + n);
+    }
+    const auto ref_a = t.greedy(a, steps);
+    const auto ref_b = t.greedy(b, steps);
+    bool ok = check(status == RequestStatus::Finished, "request a did not finish");
+    ok &= check(std::vector<int64_t>(ref_a.begin() + static_cast<std::ptrdiff_t>(a.size()), ref_a.end()) == polled,
+                "polled tokens differ from the reference");
+    ok &= check(engine.tokens(id_a) == ref_a, "tokens() differs from the reference");
+    ok &= check(engine.stop_reason(id_a) == StopReason::MaxNewTokens, "unexpected stop reason");
+
+    ok &= check(drain(engine, id_b) == RequestStatus::Finished, "request b did not finish");
+    ok &= check(engine.tokens(id_b) == ref_b, "interleaved request differs from the reference");
+    ok &= check(std::vector<int64_t>(ref_b.begin() + static_cast<std::ptrdiff_t>(b.size()), ref_b.end()) == streamed &&
+                    last_finished,
+                "callback tokens differ from the reference");
+    return ok;
+}
+
+bool test_cancel(const TinyQwen2 &t) {
+    Engine engine(t.model);
+    const auto prompt = random_tokens(5, 3);
+    const size_t max_new_tokens = 500;
+    uint64_t id = engine.submit(prompt, max_new_tokens);
+    // 排在后面的请求在第一次执行前就被取消：以 token = -1 回调一次
+    int64_t cancelled_token = 0;
+    bool cancelled_finished = false;
+    uint64_t queued = engine.submit(prompt, max_new_tokens, [&](uint64_t, int64_t token, bool finished) {
+        cancelled_token = token;
+        cancelled_finished = finished;
+        return true;
+    });
+    bool ok = check(engine.cancel(queued), "cancel of a queued request returned false");
+
+    engine.wait(id);
+    ok &= check(engine.cancel(id), "cancel of a running request returned false");
+    ok &= check(drain(engine, id) == RequestStatus::Cancelled, "running request was not cancelled");
+    ok &= check(drain(engine, queued) == RequestStatus::Cancelled, "queued request was not cancelled");
+    ok &= check(!engine.cancel(id), "cancel of a finished request returned true");
+    ok &= check(engine.stop_reason(id) == StopReason::None, "cancelled request has a stop reason");
+    ok &= check(engine.tokens(id).size() < prompt.size() + max_new_tokens, "request ran to completion");
+    ok &= check(cancelled_token == -1 && cancelled_finished, "queued request callback was not notified");
+
+    // 取消之后引擎照常处理新请求
+    uint64_t next = engine.submit(prompt, 4);
+    ok &= check(drain(engine, next) == RequestStatus::Finished && engine.tokens(next) == t.greedy(prompt, 4),
+                "request after cancel differs from the reference");
+    return ok;
+}
+
+bool test_release(const TinyQwen2 &t) {
+    Engine engine(t.model);
+    const auto prompt = random_tokens(7, 4);
+    uint64_t done = engine.submit(prompt, 3);
+    uint64_t running = engine.submit(prompt, 500);
+    uint64_t other = engine.submit(prompt, 5);
+    bool ok = check(drain(engine, done) == RequestStatus::Finished, "request did not finish");
+    engine.release(done);
+    engine.release(running);
+    // 未知的 id：已释放的请求不能再访问，重复释放是空操作
+    bool threw = false;
+    try {
+        engine.tokens(done);
+    } catch (const std::runtime_error &) {
+        threw = true;
+    }
+    ok &= check(threw, "released request is still accessible");
+    engine.release(done);
+    ok &= check(drain(engine, other) == RequestStatus::Finished && engine.tokens(other) == t.greedy(prompt, 5),
+                "request next to a released one differs from the reference");
+    return ok;
+}
+// 另一线程 release 的同时 shutdown：release 已标记、尚未取消的请求由 shutdown 结束并从 requests_ 删除，
+// 不能在遍历 requests_ 的过程中删掉
+bool test_release_during_shutdown(const TinyQwen2 &t) {
+    const auto prompt = random_tokens(5, 8);
+    for (int round = 0; round < 50; ++round) {
+        Engine engine(t.model);
+        std::vector<uint64_t> ids;
+        for (int i = 0; i < 8; ++i) {
+            ids.push_back(engine.submit(prompt, 500));
+        }
+        engine.wait(ids.front());
+        std::thread releaser([&] {
+            for (uint64_t id : ids) {
+                engine.release(id);
+            }
+        });
+        engine.shutdown();
+        releaser.join();
+    }
+    // 引擎反复关闭之后模型照常可用
+    Engine engine(t.model);
+    uint64_t id = engine.submit(prompt, 3);
+    return check(drain(engine, id) == RequestStatus::Finished && engine.tokens(id) == t.greedy(prompt, 3),
+                 "request after a shutdown racing release differs from the reference");
+}
+} // namespace
+
+int main() {
+    auto t = make_tiny_qwen2();
+    bool ok = test_submit_poll(t);
+    ok &= test_cancel(t);
+    ok &= test_release(t);
+    ok &= test_release_during_shutdown(t);
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "Test passed!\n";
+    return 0;
+}
@@ -0,0 +1,160 @@
+#include "tiny_qwen2.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <mutex>
+
+// 数据并行（LLAISYS_DATA_PARALLEL=2）：Engine 的两个工作线程在两个副本上同时推进请求；
+// 多个并发的生成、打分、文本向量请求与交替进行的多轮会话都与参考前向一致。
+// 分页缓存时会话数上限为各副本之和，超出的请求排队
+namespace {
+using namespace tiny_qwen2;
+
+// 两个请求的首个 token 回调互相等待：只有两个请求真的同时在执行时才能会合
+struct Rendezvous {
+    std::mutex mutex;
+    std::condition_variable cv;
+    size_t arrived = 0;
+    // 先到的一方等不到另一方（后到的一方此时不必再等）
+    bool missed = false;
+
+    TokenCallback callback() {
+        return [this, first = std::make_shared<bool>(true)](uint64_t, int64_t, bool) {
+            if (*first) {
+                *first = false;
+                std::unique_lock<std::mutex> lock(mutex);
+                ++arrived;
+                cv.notify_all();
+                // 未能会合时超时放行，测试失败而不是卡住
+                if (!cv.wait_for(lock, std::chrono::seconds(10), [this] { return arrived == 2; })) {
+                    missed = true;
+                }
+            }
+            return true;
+        };
+    }
+};
+
+bool test_two_replicas(const TinyQwen2 &t, Engine &engine) {
+    const size_t steps = 6;
+    const auto a = random_tokens(8, 1);
+    const auto b = random_tokens(5, 2);
+    Rendezvous rendezvous;
+    uint64_t id_a = engine.submit(a, steps, rendezvous.callback());
+    uint64_t id_b = engine.submit(b, steps, rendezvous.callback());
+    bool ok = check(drain(engine, id_a) == RequestStatus::Finished && engine.tokens(id_a) == t.greedy(a, steps),
+                    "first replica request differs from the reference");
+    ok &= check(drain(engine, id_b) == RequestStatus::Finished && engine.tokens(id_b) == t.greedy(b, steps),
+                "second replica request differs from the reference");
+    ok &= check(rendezvous.arrived == 2 && !rendezvous.missed, "the two requests did not run at the same time");
+    return ok;
+}
+
+bool test_many(const TinyQwen2 &t, Engine &engine) {
+    const size_t steps = 7;
+    std::vector<std::vector<int64_t>> prompts;
+    std::vector<uint64_t> ids;
+    for (unsigned i = 0; i < 7; ++i) {
+        prompts.push_back(random_tokens(3 + 4 * i, 10 + i));
+        ids.push_back(engine.submit(prompts.back(), steps));
+    }
+    const auto doc = random_tokens(300, 30);
+    uint64_t score_id = engine.submit_score(doc);
+    const std::vector<std::vector<int64_t>> inputs{random_tokens(12, 31), random_tokens(5, 32)};
+    uint64_t embed_id = engine.submit_embed(inputs, Pooling::Last);
+
+    bool ok = true;
+    for (size_t i = 0; i < ids.size(); ++i) {
+        ok &= check(drain(engine, ids[i]) == RequestStatus::Finished && engine.tokens(ids[i]) == t.greedy(prompts[i], steps),
+                    "concurrent request " + std::to_string(i) + " differs from the reference");
+    }
+    ok &= check(drain(engine, score_id) == RequestStatus::Finished, "score request did not finish");
+    const auto lp = t.log_softmax(doc);
+    const auto scores = engine.scores(score_id);
+    bool close = scores.size() == doc.size() - 1;
+    for (size_t i = 0; close && i + 1 < doc.size(); ++i) {
+        close = std::abs(scores[i] - lp[i * t.meta.vocab_size + static_cast<size_t>(doc[i + 1])]) < 1e-4;
+    }
+    ok &= check(close, "scores differ from the reference");
+    ok &= check(drain(engine, embed_id) == RequestStatus::Finished, "embed request did not finish");
+    const size_t h = t.meta.hidden_size;
+    const auto embeddings = engine.embeddings(embed_id);
+    close = embeddings.size() == inputs.size() * h;
+    for (size_t s = 0; close && s < inputs.size(); ++s) {
+        const auto hs = t.hidden(inputs[s]);
+        for (size_t k = 0; close && k < h; ++k) {
+            close = std::abs(embeddings[s * h + k] - hs[(inputs[s].size() - 1) * h + k]) < 1e-4;
+        }
+    }
+    ok &= check(close, "embeddings differ from the reference");
+    return ok;
+}
+
+bool test_sessions(const TinyQwen2 &t, Engine &engine) {
+    GenerationConfig gen;
+    gen.max_new_tokens = 4;
+    const uint64_t sids[2] = {engine.open_session(), engine.open_session()};
+    std::vector<int64_t> contexts[2];
+    bool ok = true;
+    for (unsigned turn = 0; turn < 3; ++turn) {
+        uint64_t ids[2];
+        for (int c = 0; c < 2; ++c) {
+            const auto input = random_tokens(3 + turn, 40 + 10 * c + turn);
+            contexts[c].insert(contexts[c].end(), input.begin(), input.end());
+            ids[c] = engine.submit_turn(sids[c], input, gen);
+        }
+        for (int c = 0; c < 2; ++c) {
+            contexts[c] = t.greedy(contexts[c], gen.max_new_tokens);
+            ok &= check(drain(engine, ids[c]) == RequestStatus::Finished && engine.session_tokens(sids[c]) == contexts[c],
+                        "conversation " + std::to_string(c) + " differs from the reference in turn " + std::to_string(turn));
+        }
+    }
+    for (uint64_t sid : sids) {
+        engine.close_session(sid);
+    }
+    return ok;
+}
+
+// 每个副本的分页缓存只留 per_replica 行会话：同时至多 2 * per_replica 个请求，其余排队
+bool test_paged(size_t per_replica) {
+    setenv("LLAISYS_USE_PAGED_ATTENTION", "1", 1);
+    setenv("LLAISYS_MAX_NUM_SEQS", std::to_string(per_replica).c_str(), 1);
+    auto t = make_tiny_qwen2();
+    unsetenv("LLAISYS_USE_PAGED_ATTENTION");
+    unsetenv("LLAISYS_MAX_NUM_SEQS");
+    bool ok = check(t.model->maxSessions() == 2 * per_replica, "paged replicas report a wrong session limit");
+    Engine engine(t.model);
+    const size_t steps = 5;
+    std::vector<std::vector<int64_t>> prompts;
+    std::vector<uint64_t> ids;
+    for (unsigned i = 0; i < 5; ++i) {
+        prompts.push_back(random_tokens(4 + i, 50 + i));
+        ids.push_back(engine.submit(prompts.back(), steps));
+    }
+    for (size_t i = 0; i < ids.size(); ++i) {
+        ok &= check(drain(engine, ids[i]) == RequestStatus::Finished && engine.tokens(ids[i]) == t.greedy(prompts[i], steps),
+                    "queued paged request " + std::to_string(i) + " differs from the reference");
+    }
+    return ok;
+}
+} // namespace
+
+int main() {
+    setenv("LLAISYS_DATA_PARALLEL", "2", 1);
+    bool ok = true;
+    {
+        auto t = make_tiny_qwen2();
+        ok &= check(t.model->parallelSpec().data_parallel == 2, "model is not data parallel");
+        Engine engine(t.model);
+        ok &= test_two_replicas(t, engine);
+        ok &= test_many(t, engine);
+        ok &= test_sessions(t, engine);
+    }
+    ok &= test_paged(1);
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "Test passed!\n";
+    return 0;
+}
@@ -0,0 +1,75 @@
+#include "tiny_qwen2.hpp"
+
+// 文本向量：打包的各序列之间注意力不串，Last / Mean 池化结果与逐条参考前向的 final norm 隐状态一致；
+// Engine 中合计超过 kEmbedPackTokens 的输入分多轮处理
+namespace {
+using namespace tiny_qwen2;
+
+std::vector<double> reference_embed(const TinyQwen2 &t, const std::vector<std::vector<int64_t>> &inputs, Pooling pooling) {
+    const size_t h = t.meta.hidden_size;
+    std::vector<double> out;
+    for (const auto &ids : inputs) {
+        const auto hs = t.hidden(ids);
+        const size_t n = ids.size();
+        for (size_t k = 0; k < h; ++k) {
+            if (pooling == Pooling::Last) {
+                out.push_back(hs[(n - 1) * h + k]);
+            } else {
+                double sum = 0.0;
+                for (size_t i = 0; i < n; ++i) {
+                    sum += hs[i * h + k];
+                }
+                out.push_back(sum / static_cast<double>(n));
+            }
+        }
+    }
+    return out;
+}
+
+bool close(const std::vector<float> &got, const std::vector<double> &expect, const std::string &what) {
+    bool ok = got.size() == expect.size();
+    for (size_t i = 0; ok && i < got.size(); ++i) {
+        ok = std::abs(got[i] - expect[i]) < 1e-4;
+    }
+    return check(ok, what);
+}
+} // namespace
+
+int main() {
+    auto t = make_tiny_qwen2();
+    // 长短不一的序列，含单个 token 的序列
+    const std::vector<std::vector<int64_t>> small{random_tokens(9, 11), random_tokens(1, 12), random_tokens(33, 13),
+                                                  random_tokens(4, 14)};
+    // 合计 2500 个 token，Engine 须分两轮打包
+    std::vector<std::vector<int64_t>> large;
+    for (unsigned i = 0; i < 5; ++i) {
+        large.push_back(random_tokens(500, 20 + i));
+    }
+
+    Engine engine(t.model);
+    bool ok = true;
+    for (Pooling pooling : {Pooling::Last, Pooling::Mean}) {
+        const std::string name = pooling == Pooling::Last ? "last" : "mean";
+        const auto ref_small = reference_embed(t, small, pooling);
+        const auto ref_large = reference_embed(t, large, pooling);
+        ok &= close(t.qwen2()->embed(small, pooling), ref_small, name + ": embed() differs from the reference");
+        // 单条序列与打包时的结果相同
+        ok &= close(t.qwen2()->embed({small[2]}, pooling),
+                    std::vector<double>(ref_small.begin() + 2 * static_cast<std::ptrdiff_t>(t.meta.hidden_size),
+                                        ref_small.begin() + 3 * static_cast<std::ptrdiff_t>(t.meta.hidden_size)),
+                    name + ": single-sequence embed() differs from the packed one");
+
+        uint64_t id_small = engine.submit_embed(small, pooling);
+        uint64_t id_large = engine.submit_embed(large, pooling);
+        ok &= check(drain(engine, id_small) == RequestStatus::Finished, name + ": embed request did not finish");
+        ok &= close(engine.embeddings(id_small), ref_small, name + ": engine embeddings differ from the reference");
+        ok &= check(drain(engine, id_large) == RequestStatus::Finished, name + ": large embed request did not finish");
+        ok &= close(engine.embeddings(id_large), ref_large,
+                    name + ": engine embeddings over several packs differ from the reference");
+    }
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "Test passed!\n";
+    return 0;
+}
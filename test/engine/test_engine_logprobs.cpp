@@ -0,0 +1,137 @@
+#include "tiny_qwen2.hpp"
+
+// 生成时的 log-prob 与候选：inferStep 与 Engine::poll 取出的值都与参考前向的 log-softmax 一致，
+// 候选按概率从大到小，poll 的 top_capacity 大于请求的 top_logprobs 时多出的位置填 -1 / -inf
+namespace {
+using namespace tiny_qwen2;
+
+constexpr double kTol = 1e-4;
+
+// 参考前向在生成第 s 个 token 时的 log-softmax 行与前 top 个候选
+struct Step {
+    std::vector<double> row;
+    std::vector<int64_t> top;
+};
+
+std::vector<Step> reference_steps(const TinyQwen2 &t, const std::vector<int64_t> &full, size_t prompt_len, size_t top) {
+    const size_t vocab = t.meta.vocab_size;
+    const auto lp = t.log_softmax(full);
+    std::vector<Step> steps;
+    for (size_t i = prompt_len - 1; i + 1 < full.size(); ++i) {
+        Step s;
+        s.row.assign(lp.begin() + static_cast<std::ptrdiff_t>(i * vocab),
+                     lp.begin() + static_cast<std::ptrdiff_t>((i + 1) * vocab));
+        std::vector<int64_t> order(vocab);
+        for (size_t j = 0; j < vocab; ++j) {
+            order[j] = static_cast<int64_t>(j);
+        }
+        std::partial_sort(order.begin(), order.begin() + static_cast<std::ptrdiff_t>(top), order.end(),
+                          [&](int64_t a, int64_t b) { return s.row[a] > s.row[b]; });
+        s.top.assign(order.begin(), order.begin() + static_cast<std::ptrdiff_t>(top));
+        steps.push_back(std::move(s));
+    }
+    return steps;
+}
+
+// 一步的 top 个候选与参考一致，之后 width - top 个位置是填充
+bool check_top(const Step &ref, const int64_t *tokens, const float *logprobs, size_t top, size_t width,
+               const std::string &what) {
+    bool ok = true;
+    for (size_t j = 0; j < width; ++j) {
+        if (j < top) {
+            ok &= tokens[j] == ref.top[j] && std::abs(logprobs[j] - ref.row[ref.top[j]]) < kTol;
+        } else {
+            ok &= tokens[j] == -1 && std::isinf(logprobs[j]) && logprobs[j] < 0;
+        }
+    }
+    return check(ok, what);
+}
+
+bool test_infer_step(const TinyQwen2 &t, const std::vector<int64_t> &prompt, const std::vector<int64_t> &full,
+                     const std::vector<Step> &ref, size_t top) {
+    auto session = t.qwen2()->createSession(prompt);
+    InferenceOptions options;
+    options.logprobs = true;
+    options.top_logprobs = top;
+    bool ok = true;
+    for (size_t s = 0; s < ref.size(); ++s) {
+        auto out = t.qwen2()->inferStep(session, options);
+        const int64_t expect = full[prompt.size() + s];
+        ok &= check(out.next_token == expect, "inferStep token differs from the reference");
+        ok &= check(std::abs(out.logprob - ref[s].row[expect]) < kTol, "inferStep logprob differs from the reference");
+        ok &= check(out.top_tokens.size() == top && out.top_logprobs.size() == top, "inferStep returned a wrong top size");
+        if (out.top_tokens.size() == top && out.top_logprobs.size() == top) {
+            ok &= check_top(ref[s], out.top_tokens.data(), out.top_logprobs.data(), top, top,
+                            "inferStep top candidates differ from the reference");
+        }
+    }
+    return ok;
+}
+
+// 每次最多取 capacity 个 token，候选缓冲每个 token 宽 top_capacity
+bool test_poll(const TinyQwen2 &t, Engine &engine, const std::vector<int64_t> &prompt, const std::vector<int64_t> &full,
+               const std::vector<Step> &ref, GenerationConfig gen, size_t capacity, size_t top_capacity) {
+    uint64_t id = engine.submit(prompt, gen);
+    std::vector<int64_t> tokens;
+    std::vector<float> logprobs;
+    std::vector<int64_t> top_tokens;
+    std::vector<float> top_logprobs;
+    RequestStatus status = RequestStatus::Pending;
+    // 结束时可能还有未取走的 token，取到空为止
+    for (size_t n = 1; n > 0 || status == RequestStatus::Pending || status == RequestStatus::Running;) {
+        engine.wait(id);
+        std::vector<int64_t> out(capacity);
+        std::vector<float> lp(capacity);
+        std::vector<int64_t> tt(capacity * top_capacity);
+        std::vector<float> tl(capacity * top_capacity);
+        n = engine.poll(id, out.data(), capacity, &status, lp.data(), tt.data(), tl.data(), top_capacity);
+        tokens.insert(tokens.end(), out.begin(), out.begin() + static_cast<std::ptrdiff_t>(n));
+        logprobs.insert(logprobs.end(), lp.begin(), lp.begin() + static_cast<std::ptrdiff_t>(n));
+        top_tokens.insert(top_tokens.end(), tt.begin(), tt.begin() + static_cast<std::ptrdiff_t>(n * top_capacity));
+        top_logprobs.insert(top_logprobs.end(), tl.begin(), tl.begin() + static_cast<std::ptrdiff_t>(n * top_capacity));
+    }
+    const std::string name = "poll(capacity " + std::to_string(capacity) + ", top_capacity " +
+                             std::to_string(top_capacity) + ")";
+    bool ok = check(status == RequestStatus::Finished, name + ": request did not finish");
+    ok &= check(tokens.size() == ref.size(), name + ": wrong number of tokens");
+    if (!ok) {
+        return false;
+    }
+    const size_t top = std::min(gen.top_logprobs, top_capacity);
+    for (size_t s = 0; s < ref.size(); ++s) {
+        const int64_t expect = full[prompt.size() + s];
+        ok &= check(tokens[s] == expect, name + ": token differs from the reference");
+        ok &= check(std::abs(logprobs[s] - ref[s].row[expect]) < kTol, name + ": logprob differs from the reference");
+        ok &= check_top(ref[s], top_tokens.data() + s * top_capacity, top_logprobs.data() + s * top_capacity, top,
+                        top_capacity, name + ": top candidates differ from the reference");
+    }
+    return ok;
+}
+} // namespace
+
+int main() {
+    auto t = make_tiny_qwen2();
+    const auto prompt = random_tokens(7, 6);
+    const size_t steps = 8;
+    const size_t top = 5;
+    const auto full = t.greedy(prompt, steps);
+    const auto ref = reference_steps(t, full, prompt.size(), top);
+
+    bool ok = test_infer_step(t, prompt, full, ref, top);
+
+    Engine engine(t.model);
+    GenerationConfig gen;
+    gen.max_new_tokens = steps;
+    gen.logprobs = true;
+    gen.top_logprobs = top;
+    ok &= test_poll(t, engine, prompt, full, ref, gen, 3, 8);
+    ok &= test_poll(t, engine, prompt, full, ref, gen, 1, 2);
+    // 只要求候选时同样给出所选 token 的 log-prob
+    gen.logprobs = false;
+    ok &= test_poll(t, engine, prompt, full, ref, gen, 4, top);
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "Test passed!\n";
+    return 0;
+}
@@ -0,0 +1,97 @@
+#include "tiny_qwen2.hpp"
+
+#include <cstdlib>
+#include <future>
+#include <mutex>
+#include <set>
+
+// 分页缓存上的并发请求：缓存按 LLAISYS_MAX_NUM_SEQS 预留会话的行，名额内的请求同时推进，
+// 超出的请求在队列中等到有会话释放，结果都与参考前向的贪心一致
+namespace {
+using namespace tiny_qwen2;
+
+// 记录各请求已出 token 而未结束的最大个数，以及两个请求是否交替产出 token
+struct Tracker {
+    std::mutex mutex;
+    std::set<uint64_t> active;
+    size_t max_active = 0;
+    std::vector<uint64_t> order;
+
+    TokenCallback callback() {
+        return [this](uint64_t id, int64_t, bool finished) {
+            std::lock_guard<std::mutex> lock(mutex);
+            order.push_back(id);
+            if (finished) {
+                active.erase(id);
+            } else {
+                active.insert(id);
+                max_active = std::max(max_active, active.size());
+            }
+            return true;
+        };
+    }
+};
+
+bool test_two_at_once(const TinyQwen2 &t) {
+    Engine engine(t.model);
+    const auto a = random_tokens(6, 41);
+    const auto b = random_tokens(9, 42);
+    const size_t steps = 8;
+    Tracker tracker;
+    // a 的首个 token 等到 b 提交后才返回，否则 a 可能在 b 提交前就跑完
+    std::promise<void> submitted;
+    auto gate = submitted.get_future().share();
+    auto track = tracker.callback();
+    uint64_t id_a = engine.submit(a, steps, [&, gate](uint64_t id, int64_t token, bool finished) {
+        gate.wait();
+        return track(id, token, finished);
+    });
+    uint64_t id_b = engine.submit(b, steps, tracker.callback());
+    submitted.set_value();
+    bool ok = check(drain(engine, id_a) == RequestStatus::Finished && engine.tokens(id_a) == t.greedy(a, steps),
+                    "first concurrent request differs from the reference");
+    ok &= check(drain(engine, id_b) == RequestStatus::Finished && engine.tokens(id_b) == t.greedy(b, steps),
+                "second concurrent request differs from the reference");
+    ok &= check(tracker.max_active == 2, "the two requests did not run at the same time");
+    return ok;
+}
+
+bool test_queue_beyond_limit(const TinyQwen2 &t, size_t limit) {
+    Engine engine(t.model);
+    const size_t steps = 5;
+    Tracker tracker;
+    std::vector<std::vector<int64_t>> prompts;
+    std::vector<uint64_t> ids;
+    for (unsigned i = 0; i < 5; ++i) {
+        prompts.push_back(random_tokens(4 + i, 50 + i));
+        ids.push_back(engine.submit(prompts.back(), steps, tracker.callback()));
+    }
+    // 打分请求同样占用一行
+    const auto doc = random_tokens(40, 60);
+    uint64_t score_id = engine.submit_score(doc);
+    bool ok = true;
+    for (size_t i = 0; i < ids.size(); ++i) {
+        ok &= check(drain(engine, ids[i]) == RequestStatus::Finished && engine.tokens(ids[i]) == t.greedy(prompts[i], steps),
+                    "queued request " + std::to_string(i) + " differs from the reference");
+    }
+    ok &= check(drain(engine, score_id) == RequestStatus::Finished && engine.scores(score_id).size() == doc.size() - 1,
+                "score request next to queued requests did not finish");
+    ok &= check(tracker.max_active <= limit, "more requests ran at once than the paged cache has rows");
+    return ok;
+}
+} // namespace
+
+int main() {
+    const size_t limit = 2;
+    setenv("LLAISYS_USE_PAGED_ATTENTION", "1", 1);
+    setenv("LLAISYS_MAX_NUM_SEQS", std::to_string(limit).c_str(), 1);
+    auto t = make_tiny_qwen2();
+    bool ok = check(t.model->maxSessions() == limit, "paged cache reports a wrong session limit");
+    ok &= test_two_at_once(t);
+    ok &= test_queue_beyond_limit(t, limit);
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "Test passed!\n";
+    return 0;
+}
@@ -0,0 +1,171 @@
+#include "tiny_qwen2.hpp"
+#include "src/device/cpu/cpu_process.hpp"
+
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <dirent.h>
+#include <fstream>
+#include <stdexcept>
+#include <sys/types.h>
+#include <unistd.h>
+
+// 流水线并行（LLAISYS_PIPELINE_PARALLEL=2，第 1 层在 fork 出的工作进程中）：微批小于 prompt 时
+// 分块 prefill 的打分、Engine 中并发的请求与多轮会话都与参考前向一致；
+// 某一步失败后请求以 Failed 结束、之后的请求照常正确；工作进程退出后请求以 Failed 结束而不是卡住
+namespace {
+using namespace tiny_qwen2;
+
+// 本进程的子进程（即流水线的工作进程）
+std::vector<pid_t> child_processes() {
+    std::vector<pid_t> out;
+    DIR *proc = opendir("/proc");
+    if (proc == nullptr) {
+        return out;
+    }
+    while (dirent *entry = readdir(proc)) {
+        const pid_t pid = static_cast<pid_t>(std::atoi(entry->d_name));
+        if (pid <= 0) {
+            continue;
+        }
+        // /proc/<pid>/stat：pid (comm) state ppid ...，comm 可能含空格，从最后一个 ')' 之后读
+        std::ifstream stat("/proc/" + std::string(entry->d_name) + "/stat");
+        std::string line;
+        std::getline(stat, line);
+        const size_t close = line.rfind(')');
+        if (close == std::string::npos) {
+            continue;
+        }
+        char state = 0;
+        long ppid = 0;
+        if (std::sscanf(line.c_str() + close + 1, " %c %ld", &state, &ppid) == 2 && ppid == getpid()) {
+            out.push_back(pid);
+        }
+    }
+    closedir(proc);
+    return out;
+}
+
+bool test_score(const TinyQwen2 &t, const std::string &name) {
+    // 600 个 token 分三块 prefill，每块再切成微批
+    const auto doc = random_tokens(600, 3);
+    const auto lp = t.log_softmax(doc);
+    const auto got = t.qwen2()->score(doc);
+    bool ok = got.size() == doc.size() - 1;
+    for (size_t i = 0; ok && i + 1 < doc.size(); ++i) {
+        ok = std::abs(got[i] - lp[i * t.meta.vocab_size + static_cast<size_t>(doc[i + 1])]) < 1e-4;
+    }
+    return check(ok, name + ": scores differ from the reference");
+}
+
+bool test_concurrent(const TinyQwen2 &t, Engine &engine, const std::string &name) {
+    const size_t steps = 8;
+    std::vector<std::vector<int64_t>> prompts;
+    std::vector<uint64_t> ids;
+    for (unsigned i = 0; i < 3; ++i) {
+        prompts.push_back(random_tokens(5 + 6 * i, 10 + i));
+        ids.push_back(engine.submit(prompts.back(), steps));
+    }
+    bool ok = true;
+    for (size_t i = 0; i < ids.size(); ++i) {
+        ok &= check(drain(engine, ids[i]) == RequestStatus::Finished && engine.tokens(ids[i]) == t.greedy(prompts[i], steps),
+                    name + ": request " + std::to_string(i) + " differs from the reference");
+    }
+    return ok;
+}
+
+bool test_session(const TinyQwen2 &t, Engine &engine, const std::string &name) {
+    uint64_t sid = engine.open_session();
+    GenerationConfig gen;
+    gen.max_new_tokens = 5;
+    std::vector<int64_t> expect;
+    bool ok = true;
+    for (unsigned round = 0; round < 2; ++round) {
+        const auto input = random_tokens(7, 20 + round);
+        expect.insert(expect.end(), input.begin(), input.end());
+        expect = t.greedy(expect, gen.max_new_tokens);
+        uint64_t id = engine.submit_turn(sid, input, gen);
+        ok &= check(drain(engine, id) == RequestStatus::Finished && engine.session_tokens(sid) == expect,
+                    name + ": session differs from the reference in round " + std::to_string(round));
+    }
+    engine.close_session(sid);
+    return ok;
+}
+
+// 超出缓存长度的 prompt 在写缓存时失败，流水线仍可继续使用
+bool test_failed_step(const TinyQwen2 &t, Engine &engine, const std::string &name) {
+    const size_t steps = 6;
+    uint64_t bad_id = engine.submit(random_tokens(t.meta.max_position_embeddings + 20, 31), steps);
+    bool ok = check(drain(engine, bad_id) == RequestStatus::Failed, name + ": overlong prompt did not fail");
+    const auto after = random_tokens(9, 32);
+    uint64_t after_id = engine.submit(after, steps);
+    ok &= check(drain(engine, after_id) == RequestStatus::Finished && engine.tokens(after_id) == t.greedy(after, steps),
+                name + ": request after a failed step differs from the reference");
+    return ok;
+}
+
+bool run(const char *micro_batch) {
+    const std::string name = std::string("micro batch ") + (micro_batch ? micro_batch : "default");
+    if (micro_batch) {
+        setenv("LLAISYS_PIPELINE_MICRO_BATCH", micro_batch, 1);
+    } else {
+        unsetenv("LLAISYS_PIPELINE_MICRO_BATCH");
+    }
+    auto t = make_tiny_qwen2();
+    bool ok = check(t.model->parallelSpec().pipeline_parallel == 2, name + ": model is not pipeline parallel");
+    ok &= test_score(t, name);
+    Engine engine(t.model);
+    ok &= test_concurrent(t, engine, name);
+    ok &= test_session(t, engine, name);
+    ok &= test_failed_step(t, engine, name);
+    return ok;
+}
+
+// 工作进程被杀掉后，正在进行与之后提交的请求都以 Failed 结束，模型随后可以正常析构
+bool test_worker_killed() {
+    unsetenv("LLAISYS_PIPELINE_MICRO_BATCH");
+    auto t = make_tiny_qwen2();
+    Engine engine(t.model);
+    const auto prompt = random_tokens(6, 40);
+    uint64_t id = engine.submit(prompt, 4);
+    bool ok = check(drain(engine, id) == RequestStatus::Finished && engine.tokens(id) == t.greedy(prompt, 4),
+                    "request before the worker died differs from the reference");
+    const auto workers = child_processes();
+    ok &= check(workers.size() == 1, "expected exactly one pipeline worker process");
+    for (pid_t pid : workers) {
+        kill(pid, SIGKILL);
+    }
+    for (unsigned i = 0; i < 2; ++i) {
+        id = engine.submit(prompt, 4);
+        ok &= check(drain(engine, id) == RequestStatus::Failed, "request after the worker died did not fail");
+    }
+    engine.shutdown();
+    return ok;
+}
+
+// fork_worker 的退出码：正常结束为 0，body 抛出异常为 1，被信号终止为 -1
+bool test_worker_exit_codes() {
+    namespace cpu = llaisys::device::cpu;
+    bool ok = check(cpu::wait_worker(cpu::fork_worker({}, [] {})) == 0, "finished worker reported a failure");
+    ok &= check(cpu::wait_worker(cpu::fork_worker({}, [] { throw std::runtime_error("worker failed"); })) == 1,
+                "throwing worker not reported as a failure");
+    ok &= check(cpu::wait_worker(cpu::fork_worker({}, [] { raise(SIGKILL); })) == -1,
+                "killed worker not reported as a failure");
+    return ok;
+}
+} // namespace
+
+int main() {
+    setenv("LLAISYS_PIPELINE_PARALLEL", "2", 1);
+    bool ok = test_worker_exit_codes();
+    // 微批为 1 与 5 时 prompt 与打分的分块都切成多个微批，默认的 32 时短 prompt 只有一个微批
+    for (const char *micro_batch : {"1", "5", static_cast<const char *>(nullptr)}) {
+        ok &= run(micro_batch);
+    }
+    ok &= test_worker_killed();
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "Test passed!\n";
+    return 0;
+}
@@ -0,0 +1,64 @@
+#include "tiny_qwen2.hpp"
+
+// 打分：长于一块（256 个位置）的文档分块 prefill 后，每个位置的 log-prob 与整段参考前向的 log-softmax 一致；
+// Engine 中打分请求与生成请求轮流执行，互不影响
+namespace {
+using namespace tiny_qwen2;
+
+std::vector<double> reference_scores(const TinyQwen2 &t, const std::vector<int64_t> &tokens) {
+    const size_t vocab = t.meta.vocab_size;
+    const auto lp = t.log_softmax(tokens);
+    std::vector<double> scores(tokens.size() - 1);
+    for (size_t i = 0; i + 1 < tokens.size(); ++i) {
+        scores[i] = lp[i * vocab + static_cast<size_t>(tokens[i + 1])];
+    }
+    return scores;
+}
+
+bool close(const std::vector<float> &got, const std::vector<double> &expect, const std::string &what) {
+    bool ok = got.size() == expect.size();
+    for (size_t i = 0; ok && i < got.size(); ++i) {
+        ok = std::abs(got[i] - expect[i]) < 1e-4;
+    }
+    return check(ok, what);
+}
+} // namespace
+
+int main() {
+    auto t = make_tiny_qwen2();
+    // 2 个 token 只有一个位置；257 个 token 正好填满一块；600 个 token 分三块
+    const std::vector<size_t> lengths{2, 257, 600};
+    std::vector<std::vector<int64_t>> docs;
+    std::vector<std::vector<double>> refs;
+    for (size_t n : lengths) {
+        docs.push_back(random_tokens(n, static_cast<unsigned>(n)));
+        refs.push_back(reference_scores(t, docs.back()));
+    }
+
+    bool ok = true;
+    for (size_t i = 0; i < docs.size(); ++i) {
+        ok &= close(t.qwen2()->score(docs[i]), refs[i],
+                    "score() differs from the reference for " + std::to_string(lengths[i]) + " tokens");
+    }
+
+    Engine engine(t.model);
+    const auto prompt = random_tokens(5, 7);
+    const size_t steps = 6;
+    uint64_t gen_id = engine.submit(prompt, steps);
+    std::vector<uint64_t> ids;
+    for (const auto &doc : docs) {
+        ids.push_back(engine.submit_score(doc));
+    }
+    for (size_t i = 0; i < docs.size(); ++i) {
+        ok &= check(drain(engine, ids[i]) == RequestStatus::Finished, "score request did not finish");
+        ok &= close(engine.scores(ids[i]), refs[i],
+                    "engine scores differ from the reference for " + std::to_string(lengths[i]) + " tokens");
+    }
+    ok &= check(drain(engine, gen_id) == RequestStatus::Finished && engine.tokens(gen_id) == t.greedy(prompt, steps),
+                "generation next to score requests differs from the reference");
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "Test passed!\n";
+    return 0;
+}
@@ -0,0 +1,192 @@
+#include "tiny_qwen2.hpp"
+
+#include <cstdlib>
+#include <stdexcept>
+
+// 多轮会话：KV 缓存在各轮之间保留，续接的每一轮得到的 token 与 log-prob 和对整段重新 prefill 的参考前向一致。
+// 朴素缓存与分页缓存各跑一遍（分页缓存在 CPU 上由 LLAISYS_USE_PAGED_ATTENTION 开启，只留两个会话的行）
+namespace {
+using namespace tiny_qwen2;
+
+constexpr double kTol = 1e-4;
+
+// 参考：在 context 之后贪心生成 steps 个 token，并给出每个 token 的 log-prob
+void reference_turn(const TinyQwen2 &t, const std::vector<int64_t> &context, size_t steps, std::vector<int64_t> &tokens,
+                    std::vector<double> &logprobs) {
+    const size_t vocab = t.meta.vocab_size;
+    const auto full = t.greedy(context, steps);
+    const auto lp = t.log_softmax(full);
+    tokens.assign(full.begin() + static_cast<std::ptrdiff_t>(context.size()), full.end());
+    logprobs.clear();
+    for (size_t i = context.size(); i < full.size(); ++i) {
+        logprobs.push_back(lp[(i - 1) * vocab + static_cast<size_t>(full[i])]);
+    }
+}
+
+bool close(const std::vector<float> &got, const std::vector<double> &expect) {
+    bool ok = got.size() == expect.size();
+    for (size_t i = 0; ok && i < got.size(); ++i) {
+        ok = std::abs(got[i] - expect[i]) < kTol;
+    }
+    return ok;
+}
+
+// 每轮新加入的 token；最后一轮为空，只是接着上一轮生成
+std::vector<std::vector<int64_t>> turns() {
+    return {random_tokens(5, 31), random_tokens(6, 32), random_tokens(1, 33), {}};
+}
+
+bool test_engine_turns(const TinyQwen2 &t, const std::string &cache) {
+    Engine engine(t.model);
+    const uint64_t sid = engine.open_session();
+    const size_t steps = 4;
+    GenerationConfig gen;
+    gen.max_new_tokens = steps;
+    gen.logprobs = true;
+
+    std::vector<int64_t> context;
+    bool ok = true;
+    for (const auto &input : turns()) {
+        context.insert(context.end(), input.begin(), input.end());
+        std::vector<int64_t> expect;
+        std::vector<double> expect_lp;
+        reference_turn(t, context, steps, expect, expect_lp);
+
+        uint64_t id = engine.submit_turn(sid, input, gen);
+        std::vector<int64_t> tokens;
+        std::vector<float> logprobs;
+        RequestStatus status = RequestStatus::Pending;
+        // 结束时可能还有未取走的 token，取到空为止
+        for (size_t n = 1; n > 0 || status == RequestStatus::Pending || status == RequestStatus::Running;) {
+            engine.wait(id);
+            int64_t buf[8];
+            float lp[8];
+            n = engine.poll(id, buf, 8, &status, lp);
+            tokens.insert(tokens.end(), buf, buf + n);
+            logprobs.insert(logprobs.end(), lp, lp + n);
+        }
+        ok &= check(status == RequestStatus::Finished, cache + ": turn did not finish");
+        ok &= check(tokens == expect, cache + ": turn tokens differ from a fresh prefill");
+        ok &= check(close(logprobs, expect_lp), cache + ": turn logprobs differ from a fresh prefill");
+        context.insert(context.end(), expect.begin(), expect.end());
+        ok &= check(engine.session_tokens(sid) == context, cache + ": session tokens differ from the turns");
+    }
+    engine.close_session(sid);
+
+    // 关闭会话后缓存已释放，新的请求照常
+    const auto prompt = random_tokens(8, 34);
+    uint64_t id = engine.submit(prompt, steps);
+    ok &= check(drain(engine, id) == RequestStatus::Finished && engine.tokens(id) == t.greedy(prompt, steps),
+                cache + ": request after close_session differs from the reference");
+    return ok;
+}
+
+// 两个多轮会话交替进行，每一轮都同时提交两边；分页缓存的名额用满后，再打开会话会被拒绝，
+// 新的请求排队到有会话关闭
+bool test_two_conversations(const TinyQwen2 &t, const std::string &cache) {
+    Engine engine(t.model);
+    const size_t steps = 3;
+    GenerationConfig gen;
+    gen.max_new_tokens = steps;
+    const uint64_t sids[2] = {engine.open_session(), engine.open_session()};
+    std::vector<int64_t> contexts[2];
+    bool ok = true;
+    for (unsigned turn = 0; turn < 3; ++turn) {
+        uint64_t ids[2];
+        for (int c = 0; c < 2; ++c) {
+            const auto input = random_tokens(3 + turn, 70 + 10 * c + turn);
+            contexts[c].insert(contexts[c].end(), input.begin(), input.end());
+            ids[c] = engine.submit_turn(sids[c], input, gen);
+        }
+        for (int c = 0; c < 2; ++c) {
+            ok &= check(drain(engine, ids[c]) == RequestStatus::Finished, cache + ": interleaved turn did not finish");
+            contexts[c] = t.greedy(contexts[c], steps);
+            ok &= check(engine.session_tokens(sids[c]) == contexts[c],
+                        cache + ": interleaved conversation differs from a fresh prefill");
+        }
+    }
+
+    const auto prompt = random_tokens(6, 80);
+    const size_t limit = t.model->maxSessions();
+    if (limit == 2) {
+        bool threw = false;
+        try {
+            engine.open_session();
+        } catch (const std::runtime_error &) {
+            threw = true;
+        }
+        ok &= check(threw, cache + ": opening a session beyond the cache rows was not rejected");
+        uint64_t id = engine.submit(prompt, steps);
+        ok &= check(engine.wait(id, 200) == RequestStatus::Pending,
+                    cache + ": request started while both conversations hold the cache rows");
+        engine.close_session(sids[0]);
+        ok &= check(drain(engine, id) == RequestStatus::Finished && engine.tokens(id) == t.greedy(prompt, steps),
+                    cache + ": queued request differs from the reference after a conversation closed");
+    } else {
+        uint64_t id = engine.submit(prompt, steps);
+        ok &= check(drain(engine, id) == RequestStatus::Finished && engine.tokens(id) == t.greedy(prompt, steps),
+                    cache + ": request next to open conversations differs from the reference");
+    }
+    // 关闭后的名额可以给新会话
+    const uint64_t sid = engine.open_session();
+    uint64_t id = engine.submit_turn(sid, prompt, gen);
+    ok &= check(drain(engine, id) == RequestStatus::Finished && engine.session_tokens(sid) == t.greedy(prompt, steps),
+                cache + ": conversation opened after a close differs from the reference");
+    return ok;
+}
+
+// 直接在模型上续接：两次 inferStep 之间 append 的 token 在下一步作为续接的 prefill 处理
+bool test_model_turns(const TinyQwen2 &t, const std::string &cache) {
+    const size_t steps = 3;
+    InferenceOptions options;
+    options.logprobs = true;
+    auto session = t.qwen2()->createSession();
+    std::vector<int64_t> context;
+    bool ok = true;
+    for (const auto &input : turns()) {
+        for (int64_t token : input) {
+            session->append(token);
+        }
+        context.insert(context.end(), input.begin(), input.end());
+        std::vector<int64_t> expect;
+        std::vector<double> expect_lp;
+        reference_turn(t, context, steps, expect, expect_lp);
+        std::vector<int64_t> tokens;
+        std::vector<float> logprobs;
+        for (size_t s = 0; s < steps; ++s) {
+            auto out = t.qwen2()->inferStep(session, options);
+            tokens.push_back(out.next_token);
+            logprobs.push_back(out.logprob);
+        }
+        ok &= check(tokens == expect, cache + ": inferStep continuation differs from a fresh prefill");
+        ok &= check(close(logprobs, expect_lp), cache + ": inferStep continuation logprobs differ from a fresh prefill");
+        context.insert(context.end(), expect.begin(), expect.end());
+        ok &= check(session->tokens() == context, cache + ": session tokens differ from the turns");
+    }
+    return ok;
+}
+} // namespace
+
+int main() {
+    bool ok = true;
+    {
+        auto t = make_tiny_qwen2();
+        ok &= test_engine_turns(t, "naive cache");
+        ok &= test_two_conversations(t, "naive cache");
+        ok &= test_model_turns(t, "naive cache");
+    }
+    setenv("LLAISYS_USE_PAGED_ATTENTION", "1", 1);
+    setenv("LLAISYS_MAX_NUM_SEQS", "2", 1);
+    {
+        auto t = make_tiny_qwen2();
+        ok &= check(t.model->maxSessions() == 2, "paged cache reports a wrong session limit");
+        ok &= test_engine_turns(t, "paged cache");
+        ok &= test_two_conversations(t, "paged cache");
+        ok &= test_model_turns(t, "paged cache");
+    }
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "Test passed!\n";
+    return 0;
+}
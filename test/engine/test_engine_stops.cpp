@@ -0,0 +1,114 @@
+#include "tiny_qwen2.hpp"
+
+// 生成的停止条件：eos、停止序列、max_new_tokens 与 max_length。
+// 期望结果由参考前向的贪心生成截断得到，命中的 eos / 停止序列保留在输出中
+namespace {
+using namespace tiny_qwen2;
+
+struct Case {
+    std::string name;
+    GenerationConfig gen;
+    size_t expect_generated;
+    StopReason expect_reason;
+};
+
+// generated 中第一个不在它之前出现过的位置（不小于 from）
+size_t first_fresh(const std::vector<int64_t> &generated, size_t from) {
+    for (size_t k = from; k < generated.size(); ++k) {
+        if (std::find(generated.begin(), generated.begin() + static_cast<std::ptrdiff_t>(k), generated[k]) ==
+            generated.begin() + static_cast<std::ptrdiff_t>(k)) {
+            return k;
+        }
+    }
+    return generated.size();
+}
+
+bool run_case(const TinyQwen2 &t, Engine &engine, const std::vector<int64_t> &prompt,
+              const std::vector<int64_t> &reference, const Case &c) {
+    std::vector<int64_t> expect(reference.begin(),
+                                reference.begin() + static_cast<std::ptrdiff_t>(prompt.size() + c.expect_generated));
+    uint64_t id = engine.submit(prompt, c.gen);
+    bool ok = check(drain(engine, id) == RequestStatus::Finished, c.name + ": request did not finish");
+    ok &= check(engine.tokens(id) == expect, c.name + ": engine tokens differ from the expected ones");
+    ok &= check(engine.stop_reason(id) == c.expect_reason, c.name + ": unexpected engine stop reason");
+    std::vector<int64_t> tokens = prompt;
+    ok &= check(t.qwen2()->inferDialog(tokens, c.gen) == expect, c.name + ": inferDialog differs from the expected tokens");
+    return ok;
+}
+} // namespace
+
+int main() {
+    auto t = make_tiny_qwen2();
+    const auto prompt = random_tokens(6, 5);
+    const size_t steps = 16;
+    const auto reference = t.greedy(prompt, steps);
+    const std::vector<int64_t> generated(reference.begin() + static_cast<std::ptrdiff_t>(prompt.size()), reference.end());
+
+    const size_t k = first_fresh(generated, 3);
+    if (k + 1 >= steps) {
+        std::cerr << "reference generation repeats too early for this test\n";
+        return 1;
+    }
+    std::vector<Case> cases;
+    {
+        // 任一 eos id 出现即结束，eos 保留在输出中；不在词表中的 id 不影响
+        Case c{"eos", {}, k + 1, StopReason::Eos};
+        c.gen.max_new_tokens = steps;
+        c.gen.eos_token_ids = {100001, generated[k]};
+        cases.push_back(c);
+    }
+    {
+        // eos 与 max_new_tokens 同一步命中时报告 eos
+        Case c{"eos at max_new_tokens", {}, k + 1, StopReason::Eos};
+        c.gen.max_new_tokens = k + 1;
+        c.gen.eos_token_ids = {generated[k]};
+        cases.push_back(c);
+    }
+    {
+        // 停止序列 generated[k-1..k]：在它第一次完整出现处结束
+        size_t end = 1;
+        while (!(generated[end - 1] == generated[k - 1] && generated[end] == generated[k])) {
+            ++end;
+        }
+        Case c{"stop sequence", {}, end + 1, StopReason::StopSequence};
+        c.gen.max_new_tokens = steps;
+        c.gen.stop_sequences = {{100001, 100002}, {generated[k - 1], generated[k]}};
+        cases.push_back(c);
+    }
+    {
+        // 跨过输入末尾的停止序列不算命中：只匹配生成部分
+        Case c{"stop sequence across the prompt", {}, 3, StopReason::MaxNewTokens};
+        c.gen.max_new_tokens = 3;
+        c.gen.stop_sequences = {{prompt.back(), generated[0]}};
+        bool recurs = false;
+        for (size_t i = 1; i < 3; ++i) {
+            recurs |= generated[i - 1] == prompt.back() && generated[i] == generated[0];
+        }
+        if (!recurs) {
+            cases.push_back(c);
+        }
+    }
+    {
+        Case c{"max_new_tokens", {}, 2, StopReason::MaxNewTokens};
+        c.gen.max_new_tokens = 2;
+        cases.push_back(c);
+    }
+    {
+        // 总长度上限包括输入
+        Case c{"max_length", {}, 3, StopReason::MaxLength};
+        c.gen.max_new_tokens = steps;
+        c.gen.max_length = prompt.size() + 3;
+        cases.push_back(c);
+    }
+
+    Engine engine(t.model);
+    bool ok = true;
+    for (const auto &c : cases) {
+        ok &= run_case(t, engine, prompt, reference, c);
+    }
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "Test passed!\n";
+    return 0;
+}
@@ -0,0 +1,123 @@
+#include "tiny_qwen2.hpp"
+
+#include <cstdlib>
+
+// 流式缓存（LLAISYS_STREAMING_WINDOW / LLAISYS_ATTENTION_SINKS）：序列不超过 sink + 窗口时与完整缓存的贪心一致；
+// 超出之后与只看得到 sink 和最近窗口的参考前向一致（被淘汰的位置不可见，K 按缓存内位置旋转），
+// 生成远超窗口的长度也不出错
+namespace {
+using namespace tiny_qwen2;
+
+constexpr size_t kSinks = 4;
+constexpr size_t kWindow = 16;
+
+// 流式缓存下各步写入的 token 区间：prefill 按窗口大小分块，decode 每步一个 token
+struct Schedule {
+    size_t sinks;
+    size_t window;
+    std::vector<std::pair<size_t, size_t>> steps;
+
+    void prefill(size_t begin, size_t end) {
+        for (; begin + window < end; begin += window) {
+            steps.push_back({begin, begin + window});
+        }
+        steps.push_back({begin, end});
+    }
+    void decode(size_t i) { steps.push_back({i, i + 1}); }
+
+    // 长度为 len 时缓存保留的 token：前 sinks 个与之后最近的 window 个
+    std::vector<size_t> retained(size_t len) const {
+        std::vector<size_t> keys;
+        for (size_t j = 0; j < std::min(len, sinks); ++j) {
+            keys.push_back(j);
+        }
+        for (size_t j = std::max(sinks, len > window ? len - window : 0); j < len; ++j) {
+            keys.push_back(j);
+        }
+        return keys;
+    }
+
+    // 单 token 的一步先写入再读取缓存；多 token 的一步读取写入前的缓存，再拼接本块中 i 及之前的 token
+    std::vector<size_t> visible(size_t i) const {
+        for (const auto &[begin, end] : steps) {
+            if (i < begin || i >= end) {
+                continue;
+            }
+            if (end - begin == 1) {
+                return retained(i + 1);
+            }
+            auto keys = retained(begin);
+            for (size_t j = begin; j <= i; ++j) {
+                keys.push_back(j);
+            }
+            return keys;
+        }
+        ASSERT(false, "Schedule: token " << i << " is not covered by any step");
+        return {};
+    }
+};
+
+// 一个请求的参考贪心生成：prompt 分块 prefill，之后逐个 decode
+std::vector<int64_t> streaming_greedy(const TinyQwen2 &t, std::vector<int64_t> ids, size_t steps) {
+    Schedule schedule{kSinks, kWindow, {}};
+    schedule.prefill(0, ids.size());
+    const Visible visible = [&schedule](size_t i) { return schedule.visible(i); };
+    for (size_t s = 0; s < steps; ++s) {
+        ids = t.greedy(ids, 1, visible);
+        // 最后生成的 token 不再前向
+        if (s + 1 < steps) {
+            schedule.decode(ids.size() - 1);
+        }
+    }
+    return ids;
+}
+
+bool run(const TinyQwen2 &t, Engine &engine, const std::vector<int64_t> &prompt, size_t steps,
+         const std::vector<int64_t> &expect, const std::string &what) {
+    uint64_t id = engine.submit(prompt, steps);
+    return check(drain(engine, id) == RequestStatus::Finished && engine.tokens(id) == expect, what);
+}
+} // namespace
+
+int main() {
+    setenv("LLAISYS_STREAMING_WINDOW", std::to_string(kWindow).c_str(), 1);
+    setenv("LLAISYS_ATTENTION_SINKS", std::to_string(kSinks).c_str(), 1);
+    auto t = make_tiny_qwen2();
+    Engine engine(t.model);
+    bool ok = true;
+
+    // 不超过 sink + 窗口：与完整缓存一致，包括分两块 prefill 的 prompt
+    for (size_t len : {7, 18}) {
+        const auto prompt = random_tokens(len, static_cast<unsigned>(len));
+        const size_t steps = kSinks + kWindow - len;
+        ok &= run(t, engine, prompt, steps, t.greedy(prompt, steps),
+                  "prompt of " + std::to_string(len) + " tokens within the window differs from the full cache");
+    }
+
+    // 参考前向的淘汰规则本身：没有淘汰时与普通因果注意力相同
+    {
+        const auto prompt = random_tokens(12, 1);
+        ok &= check(streaming_greedy(t, prompt, 8) == t.greedy(prompt, 8),
+                    "streaming reference differs from the full reference before eviction");
+    }
+
+    // 超出窗口：prompt 最后一块只有 1 个 token（按 decode 处理）、decode 跨过 sink + 窗口，以及远超窗口的长 prompt
+    for (const auto &[len, steps] : std::vector<std::pair<size_t, size_t>>{{5, 40}, {33, 12}, {40, 30}, {150, 6}}) {
+        const auto prompt = random_tokens(len, static_cast<unsigned>(100 + len));
+        ok &= run(t, engine, prompt, steps, streaming_greedy(t, prompt, steps),
+                  "prompt of " + std::to_string(len) + " tokens past the window differs from the masked reference");
+    }
+
+    // 生成长度远超窗口与位置表：只检查正常结束、长度正确
+    {
+        const size_t steps = t.meta.max_position_embeddings + 100;
+        uint64_t id = engine.submit(random_tokens(3, 7), steps);
+        ok &= check(drain(engine, id) == RequestStatus::Finished && engine.tokens(id).size() == 3 + steps,
+                    "long streaming generation did not finish");
+    }
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "Test passed!\n";
+    return 0;
+}
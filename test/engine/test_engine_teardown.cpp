@@ -0,0 +1,66 @@
+#include "tiny_qwen2.hpp"
+
+// 调用方持有模型时销毁 Engine：工作线程退出前须释放模型在其上分配的缓冲，
+// 之后同一模型可以再交给新的 Engine，或在调用线程上直接推理，最后正常析构
+namespace {
+using namespace tiny_qwen2;
+
+std::vector<int64_t> run_engine(const model_t &model, const std::vector<int64_t> &prompt, size_t max_new_tokens) {
+    Engine engine(model);
+    uint64_t id = engine.submit(prompt, max_new_tokens);
+    if (drain(engine, id) != RequestStatus::Finished) {
+        return {};
+    }
+    return engine.tokens(id);
+}
+
+// 销毁 Engine 时仍有会话未释放：进行中的请求、已结束一轮但未关闭的多轮会话、关闭时一轮还在进行的会话。
+// 这些会话都须交给工作线程释放，之后模型照常可用
+void run_engine_with_open_sessions(const model_t &model, const std::vector<int64_t> &prompt) {
+    Engine engine(model);
+    GenerationConfig gen;
+    gen.max_new_tokens = 500;
+    uint64_t running = engine.submit(prompt, gen);
+    uint64_t idle = engine.open_session();
+    gen.max_new_tokens = 2;
+    drain(engine, engine.submit_turn(idle, prompt, gen));
+    uint64_t closing = engine.open_session();
+    gen.max_new_tokens = 500;
+    uint64_t turn = engine.submit_turn(closing, prompt, gen);
+    engine.wait(turn);
+    engine.close_session(closing);
+    engine.wait(running);
+}
+} // namespace
+
+int main() {
+    auto t = make_tiny_qwen2();
+    const std::vector<int64_t> prompt{1, 5, 9, 13, 17};
+    const size_t steps = 6;
+
+    auto first = run_engine(t.model, prompt, steps);
+    auto second = run_engine(t.model, prompt, steps);
+    if (first.size() != prompt.size() + steps || first != second) {
+        std::cerr << "engine outputs differ across engines on the same model\n";
+        return 1;
+    }
+
+    std::vector<int64_t> tokens = prompt;
+    GenerationConfig gen;
+    gen.max_new_tokens = steps;
+    auto direct = t.qwen2()->inferDialog(tokens, gen);
+    if (direct != first) {
+        std::cerr << "inferDialog after engine teardown differs from the engine output\n";
+        return 1;
+    }
+
+    run_engine_with_open_sessions(t.model, prompt);
+    if (run_engine(t.model, prompt, steps) != first) {
+        std::cerr << "engine output after tearing down open sessions differs\n";
+        return 1;
+    }
+
+    t.model.reset();
+    std::cout << "Test passed!\n";
+    return 0;
+}
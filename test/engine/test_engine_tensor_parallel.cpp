@@ -0,0 +1,91 @@
+#include "tiny_qwen2.hpp"
+
+#include <cstdlib>
+
+// 张量并行（LLAISYS_TENSOR_PARALLEL=2）：分块 prefill 的打分、Engine 中并发的请求与多轮会话都与参考前向一致；
+// 某一步在各 rank 上失败（缓存写满）后请求以 Failed 结束，中止的 all-reduce 恢复，之后的请求照常正确
+namespace {
+using namespace tiny_qwen2;
+
+bool test_score(const TinyQwen2 &t) {
+    // 600 个 token 分三块 prefill
+    const auto doc = random_tokens(600, 3);
+    const auto lp = t.log_softmax(doc);
+    const auto got = t.qwen2()->score(doc);
+    bool ok = got.size() == doc.size() - 1;
+    for (size_t i = 0; ok && i + 1 < doc.size(); ++i) {
+        ok = std::abs(got[i] - lp[i * t.meta.vocab_size + static_cast<size_t>(doc[i + 1])]) < 1e-4;
+    }
+    return check(ok, "tensor parallel scores differ from the reference");
+}
+
+bool test_concurrent(const TinyQwen2 &t, Engine &engine) {
+    const size_t steps = 8;
+    std::vector<std::vector<int64_t>> prompts;
+    std::vector<uint64_t> ids;
+    for (unsigned i = 0; i < 3; ++i) {
+        prompts.push_back(random_tokens(5 + 3 * i, 10 + i));
+        ids.push_back(engine.submit(prompts.back(), steps));
+    }
+    bool ok = true;
+    for (size_t i = 0; i < ids.size(); ++i) {
+        ok &= check(drain(engine, ids[i]) == RequestStatus::Finished && engine.tokens(ids[i]) == t.greedy(prompts[i], steps),
+                    "tensor parallel request " + std::to_string(i) + " differs from the reference");
+    }
+    return ok;
+}
+
+bool test_session(const TinyQwen2 &t, Engine &engine) {
+    uint64_t sid = engine.open_session();
+    GenerationConfig gen;
+    gen.max_new_tokens = 5;
+    std::vector<int64_t> expect;
+    bool ok = true;
+    for (unsigned round = 0; round < 2; ++round) {
+        const auto input = random_tokens(4, 20 + round);
+        expect.insert(expect.end(), input.begin(), input.end());
+        expect = t.greedy(expect, gen.max_new_tokens);
+        uint64_t id = engine.submit_turn(sid, input, gen);
+        ok &= check(drain(engine, id) == RequestStatus::Finished && engine.session_tokens(sid) == expect,
+                    "tensor parallel session differs from the reference in round " + std::to_string(round));
+    }
+    engine.close_session(sid);
+    return ok;
+}
+
+// 超出缓存长度的 prompt 在各 rank 写缓存时失败，其余请求不受影响
+bool test_failed_step(const TinyQwen2 &t, Engine &engine) {
+    const size_t steps = 6;
+    const auto prompt = random_tokens(7, 30);
+    uint64_t ok_id = engine.submit(prompt, steps);
+    uint64_t bad_id = engine.submit(random_tokens(t.meta.max_position_embeddings + 20, 31), steps);
+    bool ok = check(drain(engine, bad_id) == RequestStatus::Failed, "overlong prompt did not fail");
+    ok &= check(drain(engine, ok_id) == RequestStatus::Finished && engine.tokens(ok_id) == t.greedy(prompt, steps),
+                "request next to a failed step differs from the reference");
+    // 失败之后的每一步仍要经过 all-reduce
+    const auto after = random_tokens(9, 32);
+    uint64_t after_id = engine.submit(after, steps);
+    ok &= check(drain(engine, after_id) == RequestStatus::Finished && engine.tokens(after_id) == t.greedy(after, steps),
+                "request after a failed step differs from the reference");
+    return ok;
+}
+} // namespace
+
+int main() {
+    setenv("LLAISYS_TENSOR_PARALLEL", "2", 1);
+    auto t = make_tiny_qwen2();
+    if (!check(t.model->parallelSpec().tensor_parallel == 2, "model is not tensor parallel")) {
+        return 1;
+    }
+    bool ok = test_score(t);
+    Engine engine(t.model);
+    ok &= test_concurrent(t, engine);
+    ok &= test_session(t, engine);
+    ok &= test_failed_step(t, engine);
+    ok &= test_concurrent(t, engine);
+    if (!ok) {
+        return 1;
+    }
+    std::cout << "Test passed!\n";
+    return 0;
+}
@@ -0,0 +1,307 @@
+/*
+引擎与模型测试共用：随机初始化的小 Qwen2（F32、CPU），以及不经过 llaisys 算子的 double 精度参考前向，
+用来对照 log-prob、打分与文本向量
+*/
+#pragma once
+
+#include "src/core/llaisys_core.hpp"
+#include "src/model/Qwen2/model_qwen2.hpp"
+#include "src/model/engine.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace tiny_qwen2 {
+using namespace llaisys;
+using namespace llaisys::model;
+
+// 第 i 个 token 的注意力范围：按顺序排列、以 i 结尾的 token 下标，各 token 的 rope 位置取其在列表中的下标。
+// 为空时是普通的因果注意力（0..i，位置即下标）
+using Visible = std::function<std::vector<size_t>(size_t i)>;
+
+struct TinyQwen2 {
+    meta_data meta{};
+    // 权重的 host 副本，参考前向只读这里
+    std::unordered_map<std::string, std::vector<float>> host;
+    model_t model;
+
+    std::shared_ptr<Model_Qwen2> qwen2() const { return std::dynamic_pointer_cast<Model_Qwen2>(model); }
+
+    // final norm 之后的隐状态，[n, hidden_size] 按行排列
+    std::vector<double> hidden(const std::vector<int64_t> &ids, const Visible &visible = {}) const;
+    // [n, vocab_size] 的 log-softmax
+    std::vector<double> log_softmax(const std::vector<int64_t> &ids, const Visible &visible = {}) const;
+    // 参考前向的贪心生成，返回输入加生成的 token；visible 须覆盖生成后的全部 token
+    std::vector<int64_t> greedy(std::vector<int64_t> ids, size_t steps, const Visible &visible = {}) const;
+
+private:
+    const std::vector<float> &w(const std::string &name) const { return host.at(name); }
+};
+
+inline TinyQwen2 make_tiny_qwen2(unsigned seed = 0) {
+    core::context().setDevice(LLAISYS_DEVICE_CPU, 0);
+    TinyQwen2 t;
+    meta_data &meta = t.meta;
+    meta.hidden_size = 64;
+    meta.num_attention_heads = 4;
+    meta.num_key_value_heads = 2;
+    meta.num_hidden_layers = 2;
+    meta.intermediate_size = 96;
+    meta.vocab_size = 128;
+    meta.max_position_embeddings = 1024;
+    meta.rms_norm_eps = 1e-6f;
+    meta.rope_theta = 10000;
+    meta.torch_type = LLAISYS_DTYPE_F32;
+    meta.bos_token_id = 1;
+    meta.eos_token_id = 100000;
+    const size_t h = meta.hidden_size;
+    const size_t kv = meta.num_key_value_heads * (h / meta.num_attention_heads);
+    const size_t inter = meta.intermediate_size;
+
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> dist(0.0f, 1.0f);
+    WeightsMap weights;
+    auto add = [&](const std::string &name, std::vector<size_t> shape) {
+        auto tensor = Tensor::create(shape, LLAISYS_DTYPE_F32, LLAISYS_DEVICE_CPU, 0);
+        auto *data = reinterpret_cast<float *>(tensor->data());
+        // norm 权重在 1 附近，其余为小的随机值
+        bool norm = name.find("norm") != std::string::npos;
+        std::vector<float> values(tensor->numel());
+        for (auto &x : values) {
+            x = norm ? 1.0f + 0.1f * dist(rng) : 0.1f * dist(rng);
+        }
+        std::copy(values.begin(), values.end(), data);
+        t.host[name] = std::move(values);
+        weights[name] = std::make_shared<Weights>(name, tensor);
+    };
+    add("model.embed_tokens.weight", {meta.vocab_size, h});
+    add("model.norm.weight", {h});
+    add("lm_head.weight", {meta.vocab_size, h});
+    for (size_t l = 0; l < meta.num_hidden_layers; ++l) {
+        std::string p = "model.layers." + std::to_string(l) + ".";
+        add(p + "input_layernorm.weight", {h});
+        add(p + "post_attention_layernorm.weight", {h});
+        add(p + "self_attn.q_proj.weight", {h, h});
+        add(p + "self_attn.k_proj.weight", {kv, h});
+        add(p + "self_attn.v_proj.weight", {kv, h});
+        add(p + "self_attn.o_proj.weight", {h, h});
+        add(p + "self_attn.q_proj.bias", {h});
+        add(p + "self_attn.k_proj.bias", {kv});
+        add(p + "self_attn.v_proj.bias", {kv});
+        add(p + "mlp.gate_proj.weight", {inter, h});
+        add(p + "mlp.up_proj.weight", {inter, h});
+        add(p + "mlp.down_proj.weight", {h, inter});
+    }
+    t.model = Model_Qwen2::create(weights, meta, DeviceSpec{}, ParallelSpec{});
+    return t;
+}
+
+namespace detail {
+// y[n, out] = x[n, in] · Wᵀ (+ b)
+inline std::vector<double> linear(const std::vector<double> &x, size_t n, size_t in, const std::vector<float> &weight,
+                                  size_t out, const std::vector<float> *bias = nullptr) {
+    std::vector<double> y(n * out);
+    for (size_t i = 0; i < n; ++i) {
+        for (size_t j = 0; j < out; ++j) {
+            double acc = bias ? (*bias)[j] : 0.0;
+            for (size_t k = 0; k < in; ++k) {
+                acc += x[i * in + k] * weight[j * in + k];
+            }
+            y[i * out + j] = acc;
+        }
+    }
+    return y;
+}
+
+inline std::vector<double> rms_norm(const std::vector<double> &x, size_t n, size_t d, const std::vector<float> &weight,
+                                    double eps) {
+    std::vector<double> y(n * d);
+    for (size_t i = 0; i < n; ++i) {
+        double ss = 0.0;
+        for (size_t k = 0; k < d; ++k) {
+            ss += x[i * d + k] * x[i * d + k];
+        }
+        double inv = 1.0 / std::sqrt(ss / static_cast<double>(d) + eps);
+        for (size_t k = 0; k < d; ++k) {
+            y[i * d + k] = x[i * d + k] * inv * weight[k];
+        }
+    }
+    return y;
+}
+
+// row: [nhead * hd]，各头按位置 pos 旋转；前后两半配对
+inline void rope(double *row, size_t nhead, size_t hd, size_t pos, double theta) {
+    const size_t half = hd / 2;
+    for (size_t k = 0; k < half; ++k) {
+        double angle = static_cast<double>(pos) / std::pow(theta, 2.0 * static_cast<double>(k) / static_cast<double>(hd));
+        double c = std::cos(angle), s = std::sin(angle);
+        for (size_t head = 0; head < nhead; ++head) {
+            double *x = row + head * hd;
+            double a = x[k], b = x[k + half];
+            x[k] = a * c - b * s;
+            x[k + half] = b * c + a * s;
+        }
+    }
+}
+} // namespace detail
+
+inline std::vector<double> TinyQwen2::hidden(const std::vector<int64_t> &ids, const Visible &visible) const {
+    const size_t n = ids.size();
+    const size_t h = meta.hidden_size;
+    const size_t nh = meta.num_attention_heads;
+    const size_t nkv = meta.num_key_value_heads;
+    const size_t hd = h / nh;
+    const size_t inter = meta.intermediate_size;
+    const double eps = meta.rms_norm_eps;
+
+    std::vector<double> x(n * h);
+    const auto &embed = w("model.embed_tokens.weight");
+    for (size_t i = 0; i < n; ++i) {
+        std::copy_n(embed.begin() + static_cast<std::ptrdiff_t>(ids[i] * h), h, x.begin() + static_cast<std::ptrdiff_t>(i * h));
+    }
+    for (size_t l = 0; l < meta.num_hidden_layers; ++l) {
+        const std::string p = "model.layers." + std::to_string(l) + ".";
+        auto xn = detail::rms_norm(x, n, h, w(p + "input_layernorm.weight"), eps);
+        auto q = detail::linear(xn, n, h, w(p + "self_attn.q_proj.weight"), nh * hd, &w(p + "self_attn.q_proj.bias"));
+        auto k = detail::linear(xn, n, h, w(p + "self_attn.k_proj.weight"), nkv * hd, &w(p + "self_attn.k_proj.bias"));
+        auto v = detail::linear(xn, n, h, w(p + "self_attn.v_proj.weight"), nkv * hd, &w(p + "self_attn.v_proj.bias"));
+        std::vector<double> attn(n * nh * hd, 0.0);
+        const double scale = 1.0 / std::sqrt(static_cast<double>(hd));
+        const double theta = static_cast<double>(meta.rope_theta);
+        // 因果注意力时 k 的位置与各 query 无关，只旋转一次
+        if (!visible) {
+            for (size_t j = 0; j < n; ++j) {
+                detail::rope(k.data() + j * nkv * hd, nkv, hd, j, theta);
+            }
+        }
+        for (size_t i = 0; i < n; ++i) {
+            std::vector<size_t> keys;
+            if (visible) {
+                keys = visible(i);
+            } else {
+                for (size_t j = 0; j <= i; ++j) {
+                    keys.push_back(j);
+                }
+            }
+            const size_t m = keys.size();
+            // 按本 query 的注意力范围旋转 q 与可见的 k
+            std::vector<double> qi(q.begin() + static_cast<std::ptrdiff_t>(i * nh * hd),
+                                   q.begin() + static_cast<std::ptrdiff_t>((i + 1) * nh * hd));
+            detail::rope(qi.data(), nh, hd, m - 1, theta);
+            std::vector<double> kr(m * nkv * hd);
+            for (size_t r = 0; r < m; ++r) {
+                std::copy_n(k.begin() + static_cast<std::ptrdiff_t>(keys[r] * nkv * hd), nkv * hd,
+                            kr.begin() + static_cast<std::ptrdiff_t>(r * nkv * hd));
+                if (visible) {
+                    detail::rope(kr.data() + r * nkv * hd, nkv, hd, r, theta);
+                }
+            }
+            for (size_t head = 0; head < nh; ++head) {
+                const size_t kvh = head / (nh / nkv);
+                std::vector<double> s(m);
+                double mx = -INFINITY;
+                for (size_t r = 0; r < m; ++r) {
+                    double dot = 0.0;
+                    for (size_t d = 0; d < hd; ++d) {
+                        dot += qi[head * hd + d] * kr[(r * nkv + kvh) * hd + d];
+                    }
+                    s[r] = dot * scale;
+                    mx = std::max(mx, s[r]);
+                }
+                double sum = 0.0;
+                for (auto &e : s) {
+                    e = std::exp(e - mx);
+                    sum += e;
+                }
+                for (size_t r = 0; r < m; ++r) {
+                    for (size_t d = 0; d < hd; ++d) {
+                        attn[(i * nh + head) * hd + d] += s[r] / sum * v[(keys[r] * nkv + kvh) * hd + d];
+                    }
+                }
+            }
+        }
+        auto o = detail::linear(attn, n, h, w(p + "self_attn.o_proj.weight"), h);
+        for (size_t i = 0; i < n * h; ++i) {
+            x[i] += o[i];
+        }
+
+        xn = detail::rms_norm(x, n, h, w(p + "post_attention_layernorm.weight"), eps);
+        auto gate = detail::linear(xn, n, h, w(p + "mlp.gate_proj.weight"), inter);
+        auto up = detail::linear(xn, n, h, w(p + "mlp.up_proj.weight"), inter);
+        for (size_t i = 0; i < n * inter; ++i) {
+            gate[i] = gate[i] / (1.0 + std::exp(-gate[i])) * up[i];
+        }
+        auto down = detail::linear(gate, n, inter, w(p + "mlp.down_proj.weight"), h);
+        for (size_t i = 0; i < n * h; ++i) {
+            x[i] += down[i];
+        }
+    }
+    return detail::rms_norm(x, n, h, w("model.norm.weight"), eps);
+}
+
+inline std::vector<double> TinyQwen2::log_softmax(const std::vector<int64_t> &ids, const Visible &visible) const {
+    const size_t n = ids.size();
+    const size_t vocab = meta.vocab_size;
+    auto logits = detail::linear(hidden(ids, visible), n, meta.hidden_size, w("lm_head.weight"), vocab);
+    for (size_t i = 0; i < n; ++i) {
+        double *row = logits.data() + i * vocab;
+        double m = *std::max_element(row, row + vocab);
+        double sum = 0.0;
+        for (size_t j = 0; j < vocab; ++j) {
+            sum += std::exp(row[j] - m);
+        }
+        const double lse = m + std::log(sum);
+        for (size_t j = 0; j < vocab; ++j) {
+            row[j] -= lse;
+        }
+    }
+    return logits;
+}
+
+inline std::vector<int64_t> TinyQwen2::greedy(std::vector<int64_t> ids, size_t steps, const Visible &visible) const {
+    const size_t vocab = meta.vocab_size;
+    for (size_t s = 0; s < steps; ++s) {
+        auto lp = log_softmax(ids, visible);
+        const double *last = lp.data() + (ids.size() - 1) * vocab;
+        ids.push_back(static_cast<int64_t>(std::max_element(last, last + vocab) - last));
+    }
+    return ids;
+}
+
+// 小模型上的伪随机 token 序列（避开 bos）
+inline std::vector<int64_t> random_tokens(size_t n, unsigned seed, int64_t vocab = 128) {
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int64_t> dist(2, vocab - 1);
+    std::vector<int64_t> ids(n);
+    for (auto &id : ids) {
+        id = dist(rng);
+    }
+    return ids;
+}
+
+// 引擎请求跑完：把 token 取空并等到结束，返回结束状态
+inline RequestStatus drain(Engine &engine, uint64_t id) {
+    RequestStatus status = engine.wait(id);
+    int64_t buf[16];
+    while (status == RequestStatus::Pending || status == RequestStatus::Running) {
+        while (engine.poll(id, buf, 16) > 0) {
+        }
+        status = engine.wait(id);
+    }
+    return status;
+}
+
+inline bool check(bool ok, const std::string &what) {
+    if (!ok) {
+        std::cerr << what << "\n";
+    }
+    return ok;
+}
+} // namespace tiny_qwen2
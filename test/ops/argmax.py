@@ -39,6 +39,33 @@ def test_op_argmax(
         )
 
 
+def test_op_argmax_rows(
+    shape,
+    dtype_name="f32",
+    device_name="cpu",
+    profile=False,
+):
+    # 按行求最大值：vals [rows, n]，max_idx、max_val [rows]
+    print(f"   rows shape {shape} dtype <{dtype_name}>")
+    vals, vals_ = random_tensor(shape, dtype_name, device_name)
+    max_idx, max_idx_ = zero_tensor((shape[0],), "i64", device_name)
+    max_val, max_val_ = zero_tensor((shape[0],), dtype_name, device_name)
+
+    max_idx.copy_(torch.argmax(vals, dim=-1))
+    max_val.copy_(vals.gather(-1, max_idx.unsqueeze(-1)).squeeze(-1))
+    llaisys.Ops.argmax(max_idx_, max_val_, vals_)
+
+    assert check_equal(max_idx_, max_idx, strict=True)
+    assert check_equal(max_val_, max_val, strict=True)
+
+    if profile:
+        benchmark(
+            lambda: torch.argmax(vals, dim=-1),
+            lambda: llaisys.Ops.argmax(max_idx_, max_val_, vals_),
+            device_name,
+        )
+
+
 if __name__ == "__main__":
     import argparse
 
@@ -52,5 +79,9 @@ if __name__ == "__main__":
     for shape in testShapes:
         for dtype_name in testDtype:
             test_op_argmax(shape, dtype_name, args.device, args.profile)
+    testRowShapes = [(3, 4), (8, 151936)]
+    for shape in testRowShapes:
+        for dtype_name in testDtype:
+            test_op_argmax_rows(shape, dtype_name, args.device, args.profile)
 
     print("\033[92mTest passed!\033[0m\n")
@@ -0,0 +1,107 @@
+import sys
+import os
+
+parent_dir = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
+sys.path.insert(0, parent_dir)
+import llaisys
+import torch
+from test_utils import random_tensor, check_equal, benchmark
+
+
+def torch_bmm(c, a, b, trans_a, trans_b, alpha, beta):
+    a = a.transpose(-1, -2) if trans_a else a
+    b = b.transpose(-1, -2) if trans_b else b
+    b = b.repeat_interleave(a.size(0) // b.size(0), 0)
+    result = alpha * (a.float() @ b.float())
+    if beta != 0.0:
+        result += beta * c.float()
+    c.copy_(result.to(c.dtype))
+
+
+def test_op_bmm(
+    batch,
+    b_batch,
+    m,
+    n,
+    k,
+    trans_a=False,
+    trans_b=False,
+    alpha=1.0,
+    beta=0.0,
+    dtype_name="f32",
+    atol=1e-5,
+    rtol=1e-5,
+    device_name="cpu",
+    profile=False,
+):
+    print(
+        f"   batch={batch}/{b_batch} m={m} n={n} k={k} trans=({trans_a}, {trans_b}) "
+        f"alpha={alpha} beta={beta} dtype <{dtype_name}>"
+    )
+    a_shape = (batch, k, m) if trans_a else (batch, m, k)
+    b_shape = (b_batch, n, k) if trans_b else (b_batch, k, n)
+    a, a_ = random_tensor(a_shape, dtype_name, device_name, scale=0.1)
+    b, b_ = random_tensor(b_shape, dtype_name, device_name, scale=0.1)
+    c, c_ = random_tensor((batch, m, n), dtype_name, device_name)
+
+    torch_bmm(c, a, b, trans_a, trans_b, alpha, beta)
+    llaisys.Ops.bmm(c_, a_, b_, trans_a, trans_b, alpha, beta)
+    assert check_equal(c_, c, atol=atol, rtol=rtol)
+
+    if profile:
+        benchmark(
+            lambda: torch_bmm(c, a, b, trans_a, trans_b, alpha, beta),
+            lambda: llaisys.Ops.bmm(c_, a_, b_, trans_a, trans_b, alpha, beta),
+            device_name,
+        )
+
+
+def test_op_bmm_strided(
+    qlen, kvlen, nh, nkvh, hd, dtype_name="f32", atol=1e-5, rtol=1e-5, device_name="cpu"
+):
+    # 注意力打分：q [qlen, nh, hd] 与 k [kvlen, nkvh, hd] 直接以 permute 视图参与计算
+    print(f"   scores qlen={qlen} kvlen={kvlen} nh={nh} nkvh={nkvh} hd={hd} dtype <{dtype_name}>")
+    q, q_ = random_tensor((qlen, nh, hd), dtype_name, device_name)
+    k, k_ = random_tensor((kvlen, nkvh, hd), dtype_name, device_name)
+    scores, scores_ = random_tensor((nh, qlen, kvlen), dtype_name, device_name)
+    scale = 1.0 / (hd**0.5)
+
+    torch_bmm(scores, q.transpose(0, 1), k.transpose(0, 1), False, True, scale, 0.0)
+    llaisys.Ops.bmm(scores_, q_.permute(1, 0, 2), k_.permute(1, 0, 2), False, True, scale, 0.0)
+    assert check_equal(scores_, scores, atol=atol, rtol=rtol)
+
+
+if __name__ == "__main__":
+    import argparse
+
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--device", default="cpu", choices=["cpu", "nvidia"], type=str)
+    parser.add_argument("--profile", action="store_true")
+    args = parser.parse_args()
+    testShapes = [
+        # batch, b_batch, m, n, k, trans_a, trans_b, alpha, beta
+        (2, 2, 3, 4, 5, False, False, 1.0, 0.0),
+        (4, 2, 5, 6, 8, False, True, 0.5, 0.0),
+        (3, 1, 4, 7, 6, True, False, 1.0, 1.0),
+        (12, 2, 128, 256, 128, False, True, 1.0, 0.5),
+    ]
+    testStridedShapes = [
+        # qlen, kvlen, nh, nkvh, hd
+        (5, 11, 4, 2, 8),
+        (64, 128, 12, 2, 128),
+    ]
+    testDtypePrec = [
+        # type, atol, rtol
+        ("f32", 1e-5, 1e-5),
+        ("f16", 1e-3, 1e-3),
+        ("bf16", 1e-2, 1e-2),
+    ]
+    print(f"Testing Ops.bmm on {args.device}")
+    for shape in testShapes:
+        for dtype_name, atol, rtol in testDtypePrec:
+            test_op_bmm(*shape, dtype_name, atol, rtol, args.device, args.profile)
+    for shape in testStridedShapes:
+        for dtype_name, atol, rtol in testDtypePrec:
+            test_op_bmm_strided(*shape, dtype_name, atol, rtol, args.device)
+
+    print("\033[92mTest passed!\033[0m\n")
@@ -0,0 +1,170 @@
+import sys
+import os
+
+parent_dir = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
+sys.path.insert(0, parent_dir)
+import llaisys
+import torch
+from test_utils import random_tensor, zero_tensor, to_torch, check_equal, benchmark
+
+QUANT_MAX = {"i8": 127.0, "f8": 448.0}
+
+
+def torch_kv_scale(x, q_dtype_name):
+    amax = x.float().abs().amax(dim=-1)
+    return torch.where(amax > 0, amax / QUANT_MAX[q_dtype_name], torch.ones_like(amax))
+
+
+def torch_dequant_error_bound(x, scale, q_dtype_name):
+    # int8：四舍五入误差不超过半个量化步长；E4M3：3 位尾数，正规数相对误差不超过 2^-4，
+    # 次正规数（|x / scale| < 2^-6）步长为 2^-9
+    scale = scale.unsqueeze(-1)
+    if q_dtype_name == "i8":
+        return scale * (0.5 + 1e-4)
+    y = x.float().abs() / scale
+    return scale * torch.clamp(y * 2**-4, min=2**-10) * (1 + 1e-4)
+
+
+def torch_attention(query, key, value, scale, window=0):
+    L, S = query.size(0), key.size(0)
+    i = torch.arange(L, device=query.device).unsqueeze(1) + (S - L)
+    j = torch.arange(S, device=query.device).unsqueeze(0)
+    mask = j <= i
+    if window > 0:
+        mask = mask & (j > i - window)
+
+    query = query.transpose(0, 1)
+    key = key.transpose(0, 1).repeat_interleave(query.size(0) // key.size(1), 0)
+    value = value.transpose(0, 1).repeat_interleave(query.size(0) // value.size(1), 0)
+    attn_weight = query @ key.transpose(-2, -1) * scale
+    attn_weight = attn_weight.masked_fill(mask.logical_not(), float("-inf"))
+    attn_weight = torch.softmax(attn_weight, dim=-1)
+    return (attn_weight @ value).transpose(0, 1)
+
+
+def load_from_torch(llaisys_tensor, torch_tensor):
+    api = llaisys.RuntimeAPI(llaisys_tensor.device_type())
+    api.memcpy_sync(
+        llaisys_tensor.data_ptr(),
+        torch_tensor.data_ptr(),
+        torch_tensor.numel() * torch_tensor.element_size(),
+        llaisys.MemcpyKind.D2D,
+    )
+
+
+def test_op_quantize_kv(
+    shape,
+    dtype_name="f32",
+    q_dtype_name="i8",
+    device_name="cpu",
+    profile=False,
+):
+    print(f"   shape {shape} dtype <{dtype_name}> -> <{q_dtype_name}>")
+    x, x_ = random_tensor(shape, dtype_name, device_name, scale=2.0, bias=-1.0)
+    # 全零的一行：scale 取 1，量化结果全为 0
+    x[0, 0] = 0
+    load_from_torch(x_, x)
+    _, out_ = zero_tensor(shape, q_dtype_name, device_name)
+    _, scale_ = zero_tensor(shape[:-1], "f32", device_name)
+
+    scale = torch_kv_scale(x, q_dtype_name)
+    llaisys.Ops.quantize_kv(out_, scale_, x_)
+    assert check_equal(scale_, scale, atol=0, rtol=1e-6)
+
+    quant = to_torch(out_).float()
+    assert torch.all(quant[0, 0] == 0)
+    # 每行绝对值最大的元素恰好落在量化上限
+    assert torch.all(quant.abs().amax(dim=-1)[1:] == QUANT_MAX[q_dtype_name])
+    err = (quant * scale.unsqueeze(-1) - x.float()).abs()
+    assert torch.all(err <= torch_dequant_error_bound(x, scale, q_dtype_name))
+
+    if profile:
+        benchmark(
+            lambda: torch_kv_scale(x, q_dtype_name),
+            lambda: llaisys.Ops.quantize_kv(out_, scale_, x_),
+            device_name,
+        )
+
+
+def test_op_self_attention_quantized(
+    qlen,
+    kvlen,
+    nh,
+    nkvh,
+    hd,
+    window,
+    dtype_name="f32",
+    q_dtype_name="i8",
+    atol=1e-5,
+    rtol=1e-5,
+    device_name="cpu",
+    profile=False,
+):
+    print(
+        f"   qlen={qlen} kvlen={kvlen} nh={nh} nkvh={nkvh} hd={hd} window={window} "
+        f"dtype <{dtype_name}> kv <{q_dtype_name}>"
+    )
+    q, q_ = random_tensor((qlen, nh, hd), dtype_name, device_name)
+    _, k_ = random_tensor((kvlen, nkvh, hd), "f32", device_name, scale=2.0, bias=-1.0)
+    _, v_ = random_tensor((kvlen, nkvh, hd), "f32", device_name, scale=2.0, bias=-1.0)
+    _, kq_ = zero_tensor((kvlen, nkvh, hd), q_dtype_name, device_name)
+    _, vq_ = zero_tensor((kvlen, nkvh, hd), q_dtype_name, device_name)
+    _, ks_ = zero_tensor((kvlen, nkvh), "f32", device_name)
+    _, vs_ = zero_tensor((kvlen, nkvh), "f32", device_name)
+    llaisys.Ops.quantize_kv(kq_, ks_, k_)
+    llaisys.Ops.quantize_kv(vq_, vs_, v_)
+    scale = 1.0 / (hd**0.5)
+
+    # 参考结果：先按 scale 反量化，再做普通的 f32 注意力
+    k = to_torch(kq_).float() * to_torch(ks_).unsqueeze(-1)
+    v = to_torch(vq_).float() * to_torch(vs_).unsqueeze(-1)
+    attn_val = torch_attention(q.float(), k, v, scale, window).to(q.dtype)
+    _, attn_val_ = zero_tensor((qlen, nh, hd), dtype_name, device_name)
+    llaisys.Ops.self_attention_quantized(attn_val_, q_, kq_, vq_, ks_, vs_, scale, window)
+    assert check_equal(attn_val_, attn_val, atol=atol, rtol=rtol)
+
+    if profile:
+        benchmark(
+            lambda: torch_attention(q.float(), k, v, scale, window),
+            lambda: llaisys.Ops.self_attention_quantized(attn_val_, q_, kq_, vq_, ks_, vs_, scale, window),
+            device_name,
+        )
+
+
+if __name__ == "__main__":
+    import argparse
+
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--device", default="cpu", choices=["cpu", "nvidia"], type=str)
+    parser.add_argument("--profile", action="store_true")
+    args = parser.parse_args()
+    testQuantShapes = [(3, 2, 8), (17, 4, 128)]
+    testQuantDtype = ["i8", "f8"]
+    testDtypePrec = [
+        # type, atol, rtol
+        ("f32", 1e-5, 1e-5),
+        ("f16", 1e-3, 1e-3),
+        ("bf16", 1e-2, 1e-2),
+    ]
+    print(f"Testing Ops.quantize_kv on {args.device}")
+    for shape in testQuantShapes:
+        for dtype_name, _, _ in testDtypePrec:
+            for q_dtype_name in testQuantDtype:
+                test_op_quantize_kv(shape, dtype_name, q_dtype_name, args.device, args.profile)
+
+    testAttnShapes = [
+        # qlen, kvlen, nh, nkvh, hd, window
+        (2, 2, 1, 1, 4, 0),
+        (5, 11, 4, 2, 8, 0),
+        (5, 11, 4, 2, 8, 3),
+        (1, 11, 4, 2, 64, 4),
+    ]
+    print(f"Testing Ops.self_attention_quantized on {args.device}")
+    for shape in testAttnShapes:
+        for dtype_name, atol, rtol in testDtypePrec:
+            for q_dtype_name in testQuantDtype:
+                test_op_self_attention_quantized(
+                    *shape, dtype_name, q_dtype_name, atol, rtol, args.device, args.profile
+                )
+
+    print("\033[92mTest passed!\033[0m\n")
@@ -0,0 +1,76 @@
+import sys
+import os
+
+parent_dir = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
+sys.path.insert(0, parent_dir)
+import llaisys
+import torch
+from test_utils import random_tensor, zero_tensor, from_torch, to_torch, check_equal, benchmark
+
+
+def torch_linear(x, w, bias):
+    # 与 AMX 路径一致：bf16 输入以 f32 累加，加上 bias 后按 bf16 舍入
+    return (x.float() @ w.float().T + bias.float()).to(x.dtype)
+
+
+def test_op_linear_amx(
+    m,
+    k,
+    n,
+    atol=1e-2,
+    rtol=1e-2,
+    device_name="cpu",
+    profile=False,
+):
+    print(f"   x ({m}, {k}) w ({n}, {k}) dtype <bf16>")
+    x, x_ = random_tensor((m, k), "bf16", device_name, scale=2.0, bias=-1.0)
+    w, w_ = random_tensor((n, k), "bf16", device_name, scale=0.2, bias=-0.1)
+    bias, bias_ = random_tensor((n,), "bf16", device_name, scale=2.0, bias=-1.0)
+    _, out_ = zero_tensor((m, n), "bf16", device_name)
+
+    llaisys.Ops.linear(out_, x_, w_, bias_)
+    assert check_equal(out_, torch_linear(x, w, bias), atol=atol, rtol=rtol)
+
+    # 每个输出的累加顺序与 m 无关：逐行单独计算（decode）与整批（prefill）逐位相同
+    out = to_torch(out_)
+    for i in sorted({0, m // 2, m - 1}):
+        row_ = from_torch(x[i : i + 1], "bf16", device_name)
+        _, row_out_ = zero_tensor((1, n), "bf16", device_name)
+        llaisys.Ops.linear(row_out_, row_, w_, bias_)
+        assert check_equal(row_out_, out[i : i + 1], strict=True)
+
+    if profile:
+        benchmark(
+            lambda: torch_linear(x, w, bias),
+            lambda: llaisys.Ops.linear(out_, x_, w_, bias_),
+            device_name,
+        )
+
+
+if __name__ == "__main__":
+    import argparse
+
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--device", default="cpu", choices=["cpu"], type=str)
+    parser.add_argument("--profile", action="store_true")
+    args = parser.parse_args()
+    print(f"Testing Ops.linear (AMX bf16 tiles) on {args.device}")
+    if llaisys.get_cpu_isa(detected=True) != "amx":
+        print("     Skipped: this CPU does not support AMX")
+        sys.exit(0)
+    llaisys.set_cpu_isa("amx")
+    testShapes = [
+        # m, k, n：k 须为 32 的倍数才走 tile 路径；覆盖不满 16 行的输入块与权重块、
+        # 奇数个输入块、只有一块权重的尾部，以及按权重行并行分块
+        (1, 32, 16),
+        (1, 1536, 300),
+        (17, 64, 33),
+        (40, 96, 70),
+        (64, 512, 1000),
+        (128, 1536, 512),
+    ]
+    for shape in testShapes:
+        test_op_linear_amx(*shape, device_name=args.device, profile=args.profile)
+    llaisys.set_cpu_isa("auto")
+
+    print("\033[92mTest passed!\033[0m\n")
@@ -0,0 +1,74 @@
+import sys
+import os
+
+parent_dir = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
+sys.path.insert(0, parent_dir)
+import llaisys
+import torch
+from test_utils import random_tensor, random_int_tensor, zero_tensor, from_torch, check_equal, benchmark
+from ops.linear_topk import torch_logits
+
+
+def torch_linear_logprob(x, w, target):
+    logprobs = torch.log_softmax(torch_logits(x, w).float(), dim=-1)
+    return logprobs.gather(1, target.unsqueeze(1)).squeeze(1)
+
+
+def test_op_linear_logprob(
+    m,
+    kd,
+    n,
+    dtype_name="f32",
+    atol=1e-5,
+    rtol=1e-5,
+    device_name="cpu",
+    profile=False,
+):
+    print(f"   x ({m}, {kd}) w ({n}, {kd}) dtype <{dtype_name}>")
+    x, x_ = random_tensor((m, kd), dtype_name, device_name, scale=2.0, bias=-1.0)
+    w, w_ = random_tensor((n, kd), dtype_name, device_name, scale=0.2, bias=-0.1)
+    target, _ = random_int_tensor((m,), device_name, "i64", low=0, high=n)
+    # 第一个与最后一个词表下标
+    target[0] = 0
+    target[-1] = n - 1
+    target_ = from_torch(target, "i64", device_name)
+    _, out_ = zero_tensor((m,), "f32", device_name)
+
+    out = torch_linear_logprob(x, w, target)
+    llaisys.Ops.linear_logprob(out_, x_, w_, target_)
+    assert check_equal(out_, out, atol=atol, rtol=rtol)
+
+    if profile:
+        benchmark(
+            lambda: torch_linear_logprob(x, w, target),
+            lambda: llaisys.Ops.linear_logprob(out_, x_, w_, target_),
+            device_name,
+        )
+
+
+if __name__ == "__main__":
+    import argparse
+
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--device", default="cpu", choices=["cpu", "nvidia"], type=str)
+    parser.add_argument("--profile", action="store_true")
+    args = parser.parse_args()
+    testShapes = [
+        # m, k_dim, n
+        (1, 16, 7),
+        (5, 64, 1000),
+        (300, 128, 5000),
+        (3, 896, 151936),
+    ]
+    testDtypePrec = [
+        # type, atol, rtol
+        ("f32", 1e-4, 1e-5),
+        ("f16", 1e-3, 1e-3),
+        ("bf16", 1e-2, 1e-2),
+    ]
+    print(f"Testing Ops.linear_logprob on {args.device}")
+    for shape in testShapes:
+        for dtype_name, atol, rtol in testDtypePrec:
+            test_op_linear_logprob(*shape, dtype_name, atol, rtol, args.device, args.profile)
+
+    print("\033[92mTest passed!\033[0m\n")
@@ -0,0 +1,90 @@
+import sys
+import os
+
+parent_dir = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
+sys.path.insert(0, parent_dir)
+import llaisys
+import torch
+from test_utils import random_tensor, zero_tensor, to_torch, check_equal, benchmark
+
+
+def torch_logits(x, w):
+    # 与 llaisys 一致：f32 累加，logits 按输入类型舍入
+    return (x.float() @ w.float().T).to(x.dtype)
+
+
+def torch_linear_topk(x, w, k):
+    logits = torch_logits(x, w)
+    vals, idx = torch.sort(logits, dim=-1, descending=True, stable=True)
+    lse = torch.logsumexp(logits.float(), dim=-1)
+    return logits, idx[:, :k], vals[:, :k], lse
+
+
+def test_op_linear_topk(
+    m,
+    kd,
+    n,
+    k,
+    dtype_name="f32",
+    atol=1e-5,
+    rtol=1e-5,
+    device_name="cpu",
+    profile=False,
+):
+    print(f"   x ({m}, {kd}) w ({n}, {kd}) k={k} dtype <{dtype_name}>")
+    x, x_ = random_tensor((m, kd), dtype_name, device_name, scale=2.0, bias=-1.0)
+    w, w_ = random_tensor((n, kd), dtype_name, device_name, scale=0.2, bias=-0.1)
+    _, out_idx_ = zero_tensor((m, k), "i64", device_name)
+    _, out_val_ = zero_tensor((m, k), dtype_name, device_name)
+    _, lse_ = zero_tensor((m,), "f32", device_name)
+
+    logits, _, out_val, lse = torch_linear_topk(x, w, k)
+    llaisys.Ops.linear_topk(out_idx_, out_val_, lse_, x_, w_)
+    assert check_equal(out_val_, out_val, atol=atol, rtol=rtol)
+    assert check_equal(lse_, lse, atol=atol, rtol=rtol)
+    # 累加顺序不同时，舍入后相等的 logits 可能换位：只要求选出的下标在参考 logits 中取到同样的值
+    out_idx = to_torch(out_idx_)
+    assert torch.all((out_idx >= 0) & (out_idx < n))
+    assert torch.allclose(logits.gather(1, out_idx), out_val, atol=atol, rtol=rtol)
+
+    # 不需要 lse 时传空
+    _, idx_no_lse_ = zero_tensor((m, k), "i64", device_name)
+    _, val_no_lse_ = zero_tensor((m, k), dtype_name, device_name)
+    llaisys.Ops.linear_topk(idx_no_lse_, val_no_lse_, None, x_, w_)
+    assert check_equal(idx_no_lse_, out_idx, strict=True)
+    assert check_equal(val_no_lse_, to_torch(out_val_), strict=True)
+
+    if profile:
+        benchmark(
+            lambda: torch.topk(torch_logits(x, w), k, dim=-1),
+            lambda: llaisys.Ops.linear_topk(out_idx_, out_val_, None, x_, w_),
+            device_name,
+        )
+
+
+if __name__ == "__main__":
+    import argparse
+
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--device", default="cpu", choices=["cpu", "nvidia"], type=str)
+    parser.add_argument("--profile", action="store_true")
+    args = parser.parse_args()
+    testShapes = [
+        # m, k_dim, n, k
+        (1, 16, 7, 1),
+        (1, 64, 1000, 8),
+        (4, 128, 5000, 50),
+        (3, 896, 151936, 40),
+    ]
+    testDtypePrec = [
+        # type, atol, rtol
+        ("f32", 1e-4, 1e-5),
+        ("f16", 1e-3, 1e-3),
+        ("bf16", 1e-2, 1e-2),
+    ]
+    print(f"Testing Ops.linear_topk on {args.device}")
+    for shape in testShapes:
+        for dtype_name, atol, rtol in testDtypePrec:
+            test_op_linear_topk(*shape, dtype_name, atol, rtol, args.device, args.profile)
+
+    print("\033[92mTest passed!\033[0m\n")
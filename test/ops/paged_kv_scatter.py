@@ -0,0 +1,130 @@
+import sys
+import os
+
+parent_dir = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
+sys.path.insert(0, parent_dir)
+import llaisys
+import torch
+from test_utils import random_tensor, zero_tensor, from_torch, check_equal, benchmark
+from ops.rope_append_kv import slot_mapping
+
+
+def torch_paged_kv_scatter(paged_kv, k, v, slots):
+    page_size = paged_kv.shape[3]
+    pages, rows = slots // page_size, slots % page_size
+    paged_kv[pages, 0, :, rows] = k
+    paged_kv[pages, 1, :, rows] = v
+
+
+def torch_paged_kv_gather(k, v, paged_kv, slots):
+    page_size = paged_kv.shape[3]
+    pages, rows = slots // page_size, slots % page_size
+    k.copy_(paged_kv[pages, 0, :, rows])
+    v.copy_(paged_kv[pages, 1, :, rows])
+
+
+def test_op_paged_kv_scatter(
+    seq_len,
+    nkvh,
+    head_dim,
+    page_size,
+    pages,
+    start,
+    dtype_name="f32",
+    device_name="cpu",
+    profile=False,
+):
+    print(
+        f"   seq={seq_len} nkvh={nkvh} d={head_dim} page_size={page_size} pages={pages} start={start} dtype <{dtype_name}>"
+    )
+    num_pages = max(pages) + 2
+    k, k_ = random_tensor((seq_len, nkvh, head_dim), dtype_name, device_name)
+    v, v_ = random_tensor((seq_len, nkvh, head_dim), dtype_name, device_name)
+    slots = slot_mapping(pages, page_size, start, seq_len, k.device)
+    slots_ = from_torch(slots, "i64", device_name)
+
+    # 缓存里已有的内容：没有被 slot 指到的行必须原样保留
+    paged_kv, paged_kv_ = random_tensor((num_pages, 2, nkvh, page_size, head_dim), dtype_name, device_name)
+    torch_paged_kv_scatter(paged_kv, k, v, slots)
+    llaisys.Ops.paged_kv_scatter(paged_kv_, k_, v_, slots_)
+    assert check_equal(paged_kv_, paged_kv, strict=True)
+
+    # gather 为 scatter 的逆操作：读回刚写入的行
+    _, k_back_ = zero_tensor((seq_len, nkvh, head_dim), dtype_name, device_name)
+    _, v_back_ = zero_tensor((seq_len, nkvh, head_dim), dtype_name, device_name)
+    llaisys.Ops.paged_kv_gather(k_back_, v_back_, paged_kv_, slots_)
+    assert check_equal(k_back_, k, strict=True)
+    assert check_equal(v_back_, v, strict=True)
+
+    if profile:
+        benchmark(
+            lambda: torch_paged_kv_scatter(paged_kv, k, v, slots),
+            lambda: llaisys.Ops.paged_kv_scatter(paged_kv_, k_, v_, slots_),
+            device_name,
+        )
+
+
+def test_op_paged_kv_gather(
+    seq_len,
+    nkvh,
+    head_dim,
+    page_size,
+    pages,
+    start,
+    dtype_name="f32",
+    device_name="cpu",
+    profile=False,
+):
+    print(
+        f"   seq={seq_len} nkvh={nkvh} d={head_dim} page_size={page_size} pages={pages} start={start} dtype <{dtype_name}>"
+    )
+    num_pages = max(pages) + 2
+    paged_kv, paged_kv_ = random_tensor((num_pages, 2, nkvh, page_size, head_dim), dtype_name, device_name)
+    slots = slot_mapping(pages, page_size, start, seq_len, paged_kv.device)
+    slots_ = from_torch(slots, "i64", device_name)
+
+    k, k_ = zero_tensor((seq_len, nkvh, head_dim), dtype_name, device_name)
+    v, v_ = zero_tensor((seq_len, nkvh, head_dim), dtype_name, device_name)
+    torch_paged_kv_gather(k, v, paged_kv, slots)
+    llaisys.Ops.paged_kv_gather(k_, v_, paged_kv_, slots_)
+    assert check_equal(k_, k, strict=True)
+    assert check_equal(v_, v, strict=True)
+
+    if profile:
+        benchmark(
+            lambda: torch_paged_kv_gather(k, v, paged_kv, slots),
+            lambda: llaisys.Ops.paged_kv_gather(k_, v_, paged_kv_, slots_),
+            device_name,
+        )
+
+
+if __name__ == "__main__":
+    import argparse
+
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--device", default="cpu", choices=["cpu", "nvidia"], type=str)
+    parser.add_argument("--profile", action="store_true")
+    args = parser.parse_args()
+    testShapes = [
+        # seq, nkvh, d, page_size, pages, start
+        # 解码：页内最后一行、下一页的第一行
+        (1, 2, 8, 4, [1, 0], 3),
+        (1, 2, 8, 4, [1, 0], 4),
+        # 跨两个页边界，页号不连续
+        (7, 2, 8, 4, [2, 0, 3], 2),
+        # 恰好写满一页；多页的大块写入
+        (16, 4, 128, 16, [1], 0),
+        (300, 2, 128, 16, [(i * 7) % 19 for i in range(19)], 0),
+    ]
+    testDtype = ["f32", "f16", "bf16"]
+    print(f"Testing Ops.paged_kv_scatter on {args.device}")
+    for shape in testShapes:
+        for dtype_name in testDtype:
+            test_op_paged_kv_scatter(*shape, dtype_name, args.device, args.profile)
+
+    print(f"Testing Ops.paged_kv_gather on {args.device}")
+    for shape in testShapes:
+        for dtype_name in testDtype:
+            test_op_paged_kv_gather(*shape, dtype_name, args.device, args.profile)
+
+    print("\033[92mTest passed!\033[0m\n")
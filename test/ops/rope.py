@@ -6,7 +6,16 @@ sys.path.insert(0, os.path.join(project_root, "python"))
 sys.path.insert(0, os.path.join(project_root, "test"))
 import llaisys
 import torch
-from test_utils import arrange_tensor, random_tensor, check_equal, benchmark
+from test_utils import (
+    arrange_tensor,
+    random_tensor,
+    random_int_tensor,
+    zero_tensor,
+    check_equal,
+    benchmark,
+    to_torch,
+    torch_device,
+)
 
 
 def torch_rope(y: torch.Tensor, x: torch.Tensor, pos_ids: torch.Tensor, theta: float):
@@ -33,6 +42,23 @@ def torch_rope(y: torch.Tensor, x: torch.Tensor, pos_ids: torch.Tensor, theta: f
     y[..., head_dim // 2 :] = x_b * cos + x_a * sin
 
 
+def torch_rope_table(max_pos: int, head_dim: int, theta: float, device):
+    # f64 精确值：cos/sin(pos * theta^(-2i / d))
+    i = torch.arange(0, head_dim // 2, dtype=torch.float64, device=device)
+    positions = torch.arange(0, max_pos, dtype=torch.float64, device=device).unsqueeze(1)
+    freqs = positions / (theta ** (2 * i / head_dim))
+    return freqs.cos().float(), freqs.sin().float()
+
+
+def torch_rope_with_table(y: torch.Tensor, x: torch.Tensor, pos_ids: torch.Tensor, cos: torch.Tensor, sin: torch.Tensor):
+    head_dim = x.shape[-1]
+    x_a, x_b = x[..., : head_dim // 2].float(), x[..., head_dim // 2 :].float()
+    cos = cos[pos_ids].unsqueeze(1)  # [seq_len, 1, dim/2]
+    sin = sin[pos_ids].unsqueeze(1)
+    y[..., : head_dim // 2] = (x_a * cos - x_b * sin).to(y.dtype)
+    y[..., head_dim // 2 :] = (x_b * cos + x_a * sin).to(y.dtype)
+
+
 def test_op_rope(
     shape,
     start_end,
@@ -60,6 +86,62 @@ def test_op_rope(
         )
 
 
+def test_op_rope_table(
+    shape,
+    nkvh,
+    max_pos,
+    dtype_name="f32",
+    atol=1e-5,
+    rtol=1e-5,
+    device_name="cpu",
+    profile=False,
+):
+    seq_len, nh, head_dim = shape
+    print(f"   q {shape} nkvh={nkvh} max_pos={max_pos} dtype <{dtype_name}>")
+    theta = 10000.0
+    _, cos_ = zero_tensor((max_pos, head_dim // 2), "f32", device_name)
+    _, sin_ = zero_tensor((max_pos, head_dim // 2), "f32", device_name)
+    llaisys.Ops.rope_init_table(cos_, sin_, theta)
+    # 表按 f32 计算角度，误差随位置增长：允许角度差几个 f32 ulp
+    cos, sin = torch_rope_table(max_pos, head_dim, theta, torch_device(device_name))
+    assert check_equal(cos_, cos, atol=max_pos * 2**-22, rtol=0)
+    assert check_equal(sin_, sin, atol=max_pos * 2**-22, rtol=0)
+
+    # 旋转本身用 llaisys 生成的表做参考
+    cos, sin = to_torch(cos_), to_torch(sin_)
+    q, q_ = random_tensor(shape, dtype_name, device_name)
+    k, k_ = random_tensor((seq_len, nkvh, head_dim), dtype_name, device_name)
+    # 一组位置连续并用到表的最后一行，一组随机取行
+    for pos_ids, pos_ids_ in (
+        arrange_tensor(max_pos - seq_len, max_pos, device_name),
+        random_int_tensor((seq_len,), device_name, "i64", low=0, high=max_pos),
+    ):
+        y, y_ = zero_tensor(shape, dtype_name, device_name)
+        torch_rope_with_table(y, q, pos_ids, cos, sin)
+        llaisys.Ops.rope_table(y_, q_, pos_ids_, cos_, sin_)
+        assert check_equal(y_, y, atol=atol, rtol=rtol)
+
+        q_out, q_out_ = zero_tensor(shape, dtype_name, device_name)
+        k_out, k_out_ = zero_tensor((seq_len, nkvh, head_dim), dtype_name, device_name)
+        torch_rope_with_table(q_out, q, pos_ids, cos, sin)
+        torch_rope_with_table(k_out, k, pos_ids, cos, sin)
+        llaisys.Ops.rope_qk(q_out_, k_out_, q_, k_, pos_ids_, cos_, sin_)
+        assert check_equal(q_out_, q_out, atol=atol, rtol=rtol)
+        assert check_equal(k_out_, k_out, atol=atol, rtol=rtol)
+
+    if profile:
+
+        def torch_rope_qk():
+            torch_rope_with_table(q_out, q, pos_ids, cos, sin)
+            torch_rope_with_table(k_out, k, pos_ids, cos, sin)
+
+        benchmark(
+            torch_rope_qk,
+            lambda: llaisys.Ops.rope_qk(q_out_, k_out_, q_, k_, pos_ids_, cos_, sin_),
+            device_name,
+        )
+
+
 if __name__ == "__main__":
     import argparse
 
@@ -81,4 +163,15 @@ if __name__ == "__main__":
         for dtype_name, atol, rtol in testDtypePrec:
             test_op_rope(shape, start_end, dtype_name, atol, rtol, args.device, args.profile)
 
+    testTableShapes = [
+        # q shape, nkvh, max_pos
+        ((2, 1, 4), 1, 2),
+        ((7, 4, 64), 2, 32),
+        ((128, 12, 128), 2, 4096),
+    ]
+    print(f"Testing Ops.rope_table / Ops.rope_qk on {args.device}")
+    for shape, nkvh, max_pos in testTableShapes:
+        for dtype_name, atol, rtol in testDtypePrec:
+            test_op_rope_table(shape, nkvh, max_pos, dtype_name, atol, rtol, args.device, args.profile)
+
     print("\033[92mTest passed!\033[0m\n")
@@ -0,0 +1,155 @@
+import sys
+import os
+
+parent_dir = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
+sys.path.insert(0, parent_dir)
+import llaisys
+import torch
+from test_utils import (
+    arrange_tensor,
+    random_tensor,
+    zero_tensor,
+    from_torch,
+    to_torch,
+    check_equal,
+    benchmark,
+)
+from ops.rope import torch_rope_with_table
+
+
+def rope_table(max_pos, head_dim, device_name):
+    _, cos_ = zero_tensor((max_pos, head_dim // 2), "f32", device_name)
+    _, sin_ = zero_tensor((max_pos, head_dim // 2), "f32", device_name)
+    llaisys.Ops.rope_init_table(cos_, sin_, 10000.0)
+    return to_torch(cos_), to_torch(sin_), cos_, sin_
+
+
+def slot_mapping(pages, page_size, start, seq_len, device):
+    # 逻辑位置 p 落在第 p // page_size 个页表项所指的物理页的 p % page_size 行
+    pos = torch.arange(start, start + seq_len, device=device)
+    return torch.tensor(pages, device=device)[pos // page_size] * page_size + pos % page_size
+
+
+def test_op_rope_append_kv(
+    seq_len,
+    nkvh,
+    head_dim,
+    max_len,
+    start,
+    dtype_name="f32",
+    atol=1e-5,
+    rtol=1e-5,
+    device_name="cpu",
+    profile=False,
+):
+    print(
+        f"   seq={seq_len} nkvh={nkvh} d={head_dim} cache_len={max_len} start={start} dtype <{dtype_name}>"
+    )
+    cos, sin, cos_, sin_ = rope_table(max_len, head_dim, device_name)
+    k, k_ = random_tensor((seq_len, nkvh, head_dim), dtype_name, device_name)
+    v, v_ = random_tensor((seq_len, nkvh, head_dim), dtype_name, device_name)
+    pos_ids, pos_ids_ = arrange_tensor(start, start + seq_len, device_name)
+
+    # 缓存中目标行之外的内容必须保持不变
+    k_cache, k_cache_ = zero_tensor((max_len, nkvh, head_dim), dtype_name, device_name)
+    v_cache, v_cache_ = zero_tensor((max_len, nkvh, head_dim), dtype_name, device_name)
+    torch_rope_with_table(k_cache[start : start + seq_len], k, pos_ids, cos, sin)
+    v_cache[start : start + seq_len] = v
+
+    k_rows_ = k_cache_.slice(0, start, start + seq_len)
+    v_rows_ = v_cache_.slice(0, start, start + seq_len)
+    llaisys.Ops.rope_append_kv(k_rows_, v_rows_, k_, v_, pos_ids_, cos_, sin_)
+    assert check_equal(k_cache_, k_cache, atol=atol, rtol=rtol)
+    assert check_equal(v_cache_, v_cache, strict=True)
+
+    if profile:
+        benchmark(
+            lambda: torch_rope_with_table(k_cache[start : start + seq_len], k, pos_ids, cos, sin),
+            lambda: llaisys.Ops.rope_append_kv(k_rows_, v_rows_, k_, v_, pos_ids_, cos_, sin_),
+            device_name,
+        )
+
+
+def test_op_rope_append_kv_paged(
+    seq_len,
+    nkvh,
+    head_dim,
+    page_size,
+    pages,
+    start,
+    dtype_name="f32",
+    atol=1e-5,
+    rtol=1e-5,
+    device_name="cpu",
+    profile=False,
+):
+    print(
+        f"   seq={seq_len} nkvh={nkvh} d={head_dim} page_size={page_size} pages={pages} start={start} dtype <{dtype_name}>"
+    )
+    # 多留一页不在页表里，检查不会被写到
+    num_pages = max(pages) + 2
+    cos, sin, cos_, sin_ = rope_table(len(pages) * page_size, head_dim, device_name)
+    k, k_ = random_tensor((seq_len, nkvh, head_dim), dtype_name, device_name)
+    v, v_ = random_tensor((seq_len, nkvh, head_dim), dtype_name, device_name)
+    pos_ids, pos_ids_ = arrange_tensor(start, start + seq_len, device_name)
+    slots = slot_mapping(pages, page_size, start, seq_len, k.device)
+    slots_ = from_torch(slots, "i64", device_name)
+
+    paged_kv, paged_kv_ = zero_tensor((num_pages, 2, nkvh, page_size, head_dim), dtype_name, device_name)
+    k_rope = torch.zeros_like(k)
+    torch_rope_with_table(k_rope, k, pos_ids, cos, sin)
+    for i, slot in enumerate(slots.tolist()):
+        paged_kv[slot // page_size, 0, :, slot % page_size] = k_rope[i]
+        paged_kv[slot // page_size, 1, :, slot % page_size] = v[i]
+
+    llaisys.Ops.rope_append_kv_paged(paged_kv_, k_, v_, pos_ids_, cos_, sin_, slots_)
+    assert check_equal(paged_kv_, paged_kv, atol=atol, rtol=rtol)
+
+    if profile:
+        benchmark(
+            lambda: torch_rope_with_table(k_rope, k, pos_ids, cos, sin),
+            lambda: llaisys.Ops.rope_append_kv_paged(paged_kv_, k_, v_, pos_ids_, cos_, sin_, slots_),
+            device_name,
+        )
+
+
+if __name__ == "__main__":
+    import argparse
+
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--device", default="cpu", choices=["cpu", "nvidia"], type=str)
+    parser.add_argument("--profile", action="store_true")
+    args = parser.parse_args()
+    testDtypePrec = [
+        # type, atol, rtol
+        ("f32", 1e-5, 1e-5),
+        ("f16", 1e-3, 1e-3),
+        ("bf16", 1e-2, 1e-2),
+    ]
+    testShapes = [
+        # seq, nkvh, d, cache_len, start
+        (1, 2, 8, 16, 15),
+        (7, 2, 64, 32, 5),
+        (32, 4, 128, 32, 0),
+    ]
+    print(f"Testing Ops.rope_append_kv on {args.device}")
+    for shape in testShapes:
+        for dtype_name, atol, rtol in testDtypePrec:
+            test_op_rope_append_kv(*shape, dtype_name, atol, rtol, args.device, args.profile)
+
+    testPagedShapes = [
+        # seq, nkvh, d, page_size, pages, start
+        # 解码：页内最后一行、下一页的第一行
+        (1, 2, 8, 4, [1, 0], 3),
+        (1, 2, 8, 4, [1, 0], 4),
+        # 跨两个页边界，页号不连续
+        (7, 2, 8, 4, [2, 0, 3], 2),
+        # 恰好写满一页
+        (16, 2, 64, 16, [1], 0),
+    ]
+    print(f"Testing Ops.rope_append_kv_paged on {args.device}")
+    for shape in testPagedShapes:
+        for dtype_name, atol, rtol in testDtypePrec:
+            test_op_rope_append_kv_paged(*shape, dtype_name, atol, rtol, args.device, args.profile)
+
+    print("\033[92mTest passed!\033[0m\n")
@@ -8,7 +8,7 @@ import torch
 from test_utils import random_tensor, check_equal, benchmark
 
 
-def torch_self_attention(attn_val, query, key, value, scale):
+def torch_self_attention(attn_val, query, key, value, scale, window=0):
     query = query.transpose(-2, -3)
     key = key.transpose(-2, -3)
     value = value.transpose(-2, -3)
@@ -16,6 +16,9 @@ def torch_self_attention(attn_val, query, key, value, scale):
     attn_bias = torch.zeros(L, S, dtype=query.dtype, device=query.device)
 
     temp_mask = torch.ones(L, S, dtype=torch.bool).tril(diagonal=S-L)
+    if window > 0:
+        # 滑动窗口：第 i 个 query 只保留最近 window 个 key（含自身）
+        temp_mask = temp_mask & torch.ones(L, S, dtype=torch.bool).tril(diagonal=S-L-window).logical_not()
     attn_bias.masked_fill_(temp_mask.logical_not(), float("-inf"))
     attn_bias.to(query.dtype)
 
@@ -34,6 +37,7 @@ def test_op_self_attention(
     nh,
     nkvh,
     hd,
+    window=0,
     dtype_name="f32",
     atol=1e-5,
     rtol=1e-5,
@@ -41,7 +45,7 @@ def test_op_self_attention(
     profile=False,
 ):
     print(
-        f"   qlen={qlen} kvlen={kvlen} nh={nh} nkvh={nkvh} hd={hd} dtype <{dtype_name}>"
+        f"   qlen={qlen} kvlen={kvlen} nh={nh} nkvh={nkvh} hd={hd} window={window} dtype <{dtype_name}>"
     )
     q, q_ = random_tensor((qlen, nh, hd), dtype_name, device_name)
     k, k_ = random_tensor((kvlen, nkvh, hd), dtype_name, device_name)
@@ -49,14 +53,14 @@ def test_op_self_attention(
     scale = 1.0 / (hd**0.5)
 
     attn_val, attn_val_ = random_tensor((qlen, nh, hd), dtype_name, device_name)
-    torch_self_attention(attn_val, q, k, v, scale)
-    llaisys.Ops.self_attention(attn_val_, q_, k_, v_, scale)
+    torch_self_attention(attn_val, q, k, v, scale, window)
+    llaisys.Ops.self_attention(attn_val_, q_, k_, v_, scale, window)
     assert check_equal(attn_val_, attn_val, atol=atol, rtol=rtol)
 
     if profile:
         benchmark(
-            lambda: torch_self_attention(attn_val, q, k, v, scale),
-            lambda: llaisys.Ops.self_attention(attn_val_, q_, k_, v_, scale),
+            lambda: torch_self_attention(attn_val, q, k, v, scale, window),
+            lambda: llaisys.Ops.self_attention(attn_val_, q_, k_, v_, scale, window),
             device_name,
         )
 
@@ -69,9 +73,16 @@ if __name__ == "__main__":
     parser.add_argument("--profile", action="store_true")
     args = parser.parse_args()
     testShapes = [
-        # qlen, kvlen, nh, nkvh, hd
-        (2, 2, 1, 1, 4),
-        (5, 11, 4, 2, 8),
+        # qlen, kvlen, nh, nkvh, hd, window
+        (2, 2, 1, 1, 4, 0),
+        (5, 11, 4, 2, 8, 0),
+        # 窗口边界：只看自身、小于 qlen、等于 qlen、等于 kvlen、大于 kvlen
+        (5, 11, 4, 2, 8, 1),
+        (5, 11, 4, 2, 8, 3),
+        (5, 5, 4, 2, 8, 5),
+        (5, 11, 4, 2, 8, 11),
+        (5, 11, 4, 2, 8, 16),
+        (1, 11, 4, 2, 8, 4),
     ]
     testDtypePrec = [
         # type, atol, rtol
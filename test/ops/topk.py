@@ -0,0 +1,66 @@
+import sys
+import os
+
+parent_dir = os.path.abspath(os.path.join(os.path.dirname(__file__), ".."))
+sys.path.insert(0, parent_dir)
+import llaisys
+import torch
+from test_utils import random_tensor, check_equal, benchmark, zero_tensor
+
+
+def torch_topk(out_idx, out_val, vals):
+    # 稳定排序：值相同时下标小的在前，与 llaisys 的约定一致
+    sorted_val, sorted_idx = torch.sort(vals, dim=-1, descending=True, stable=True)
+    k = out_idx.shape[-1]
+    out_idx.copy_(sorted_idx[..., :k])
+    out_val.copy_(sorted_val[..., :k])
+
+
+def test_op_topk(
+    shape,
+    k,
+    dtype_name="f32",
+    device_name="cpu",
+    profile=False,
+):
+    print(f"   shape {shape} k={k} dtype <{dtype_name}>")
+    out_shape = (*shape[:-1], k)
+    vals, vals_ = random_tensor(shape, dtype_name, device_name)
+    out_idx, out_idx_ = zero_tensor(out_shape, "i64", device_name)
+    out_val, out_val_ = zero_tensor(out_shape, dtype_name, device_name)
+
+    torch_topk(out_idx, out_val, vals)
+    llaisys.Ops.topk(out_idx_, out_val_, vals_)
+
+    assert check_equal(out_val_, out_val, strict=True)
+    assert check_equal(out_idx_, out_idx, strict=True)
+
+    if profile:
+        benchmark(
+            lambda: torch.topk(vals, k, dim=-1),
+            lambda: llaisys.Ops.topk(out_idx_, out_val_, vals_),
+            device_name,
+        )
+
+
+if __name__ == "__main__":
+    import argparse
+
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--device", default="cpu", choices=["cpu", "nvidia"], type=str)
+    parser.add_argument("--profile", action="store_true")
+    args = parser.parse_args()
+    testShapes = [
+        # shape, k
+        ((4,), 1),
+        ((4096,), 8),
+        ((3, 4096), 50),
+        ((8, 151936), 40),
+    ]
+    testDtype = ["f32", "f16", "bf16"]
+    print(f"Testing Ops.topk on {args.device}")
+    for shape, k in testShapes:
+        for dtype_name in testDtype:
+            test_op_topk(shape, k, dtype_name, args.device, args.profile)
+
+    print("\033[92mTest passed!\033[0m\n")
@@ -116,6 +116,29 @@ def arrange_tensor(
     return torch_tensor, llaisys_tensor
 
 
+def from_torch(
+    torch_tensor: torch.Tensor, dtype_name, device_name, device_id=0
+) -> llaisys.Tensor:
+    torch_tensor = torch_tensor.contiguous()
+    llaisys_tensor = llaisys.Tensor(
+        tuple(torch_tensor.shape),
+        dtype=llaisys_dtype(dtype_name),
+        device=llaisys_device(device_name),
+        device_id=device_id,
+    )
+
+    api = llaisys.RuntimeAPI(llaisys_device(device_name))
+    bytes_ = torch_tensor.numel() * torch_tensor.element_size()
+    api.memcpy_sync(
+        llaisys_tensor.data_ptr(),
+        torch_tensor.data_ptr(),
+        bytes_,
+        llaisys.MemcpyKind.D2D,
+    )
+
+    return llaisys_tensor
+
+
 def to_torch(llaisys_tensor: llaisys.Tensor) -> torch.Tensor:
     shape = llaisys_tensor.shape()
     strides = llaisys_tensor.strides()
@@ -228,6 +251,10 @@ def torch_dtype(dtype_name: str):
         return torch.float64
     elif dtype_name == "bf16":
         return torch.bfloat16
+    elif dtype_name == "f8":
+        return torch.float8_e4m3fn
+    elif dtype_name == "i8":
+        return torch.int8
     elif dtype_name == "i32":
         return torch.int32
     elif dtype_name == "i64":
@@ -251,6 +278,10 @@ def llaisys_dtype(dtype_name: str):
         return llaisys.DataType.F64
     elif dtype_name == "bf16":
         return llaisys.DataType.BF16
+    elif dtype_name == "f8":
+        return llaisys.DataType.F8
+    elif dtype_name == "i8":
+        return llaisys.DataType.I8
     elif dtype_name == "i32":
         return llaisys.DataType.I32
     elif dtype_name == "i64":
@@ -274,6 +305,10 @@ def dtype_name(llaisys_dtype: llaisys.DataType):
         return "f64"
     elif llaisys_dtype == llaisys.DataType.BF16:
         return "bf16"
+    elif llaisys_dtype == llaisys.DataType.F8:
+        return "f8"
+    elif llaisys_dtype == llaisys.DataType.I8:
+        return "i8"
     elif llaisys_dtype == llaisys.DataType.I32:
         return "i32"
     elif llaisys_dtype == llaisys.DataType.I64:
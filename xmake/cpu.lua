@@ -7,6 +7,10 @@ target("llaisys-device-cpu")
     end
 
     add_files("../src/device/cpu/*.cpp")
+    -- 线程池与 stream 执行线程
+    if not is_plat("windows") then
+        add_syslinks("pthread")
+    end
 
     on_install(function (target) end)
 target_end()